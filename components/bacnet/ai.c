@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "bacdef.h"
 #include "bacdcode.h"
@@ -38,15 +39,36 @@
 #include "device.h"
 #include "handlers.h"
 #include "timestamp.h"
+#include "objpool.h"
 #include "ai.h"
 
 
 #ifndef MAX_ANALOG_INPUTS
 #define MAX_ANALOG_INPUTS 4
 #endif
+/* objects that can have intrinsic reporting set up at once */
+#ifndef MAX_ANALOG_INPUT_EVENTS
+#define MAX_ANALOG_INPUT_EVENTS 2
+#endif
+
+/* what each sample and COV scan touches, apart from the rest */
+static float AI_Present_Value[MAX_ANALOG_INPUTS];
+static uint8_t AI_Flags[MAX_ANALOG_INPUTS];
+static float AI_Prior_Value[MAX_ANALOG_INPUTS];
+static float AI_COV_Increment[MAX_ANALOG_INPUTS];
+static ANALOG_INPUT_DESCR AI_Descr[MAX_ANALOG_INPUTS];
 
+/* AI_Flags */
+#define AI_OUT_OF_SERVICE 0x01
+#define AI_CHANGED 0x02
 
-ANALOG_INPUT_DESCR AI_Descr[MAX_ANALOG_INPUTS];
+#if defined(INTRINSIC_REPORTING)
+/* the event state of the objects set up for reporting, found by the
+   index of the object; the others read AI_Event_Default */
+OBJECT_POOL_DEFINE(AI_Event_Pool, MAX_ANALOG_INPUT_EVENTS);
+static ANALOG_INPUT_EVENT AI_Event[MAX_ANALOG_INPUT_EVENTS];
+static ANALOG_INPUT_EVENT AI_Event_Default;
+#endif
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Properties_Required[] = {
@@ -103,43 +125,93 @@ void Analog_Input_Property_Lists(
 }
 
 
+#if defined(INTRINSIC_REPORTING)
+/* no limits, no notification class, and every transition acknowledged */
+static void Analog_Input_Event_Init(
+    ANALOG_INPUT_EVENT * event)
+{
+    unsigned j;
+
+    memset(event, 0x00, sizeof(ANALOG_INPUT_EVENT));
+    event->Event_State = EVENT_STATE_NORMAL;
+    /* notification class not connected */
+    event->Notification_Class = BACNET_MAX_INSTANCE;
+    /* initialize Event time stamps using wildcards
+       and set Acked_transitions */
+    for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
+        datetime_wildcard_set(&event->Event_Time_Stamps[j]);
+        event->Acked_Transitions[j].bIsAcked = true;
+    }
+}
+
+/* the event state of an object, or NULL if it has none */
+static ANALOG_INPUT_EVENT *Analog_Input_Event(
+    unsigned index)
+{
+    unsigned event_index = Object_Pool_Slot(&AI_Event_Pool, index);
+
+    if (event_index < MAX_ANALOG_INPUT_EVENTS) {
+        return &AI_Event[event_index];
+    }
+
+    return NULL;
+}
+
+/* the event state to read: the defaults if the object has none */
+static ANALOG_INPUT_EVENT *Analog_Input_Event_Read(
+    unsigned index)
+{
+    ANALOG_INPUT_EVENT *event = Analog_Input_Event(index);
+
+    return event ? event : &AI_Event_Default;
+}
+
+/* the event state to write, given to the object on its first reporting
+   property; NULL if all are in use */
+static ANALOG_INPUT_EVENT *Analog_Input_Event_Write(
+    unsigned index)
+{
+    ANALOG_INPUT_EVENT *event = Analog_Input_Event(index);
+    unsigned event_index = 0;
+
+    if (!event) {
+        event_index = Object_Pool_Create(&AI_Event_Pool, index, true);
+        if (event_index < MAX_ANALOG_INPUT_EVENTS) {
+            event = &AI_Event[event_index];
+            Analog_Input_Event_Init(event);
+        }
+    }
+
+    return event;
+}
+#endif
+
 void Analog_Input_Init(
     void)
 {
     unsigned i;
-#if defined(INTRINSIC_REPORTING)
-    unsigned j;
-#endif
 
     for (i = 0; i < MAX_ANALOG_INPUTS; i++) {
-        AI_Descr[i].Present_Value = 0.0f;
-        AI_Descr[i].Out_Of_Service = false;
+        AI_Present_Value[i] = 0.0f;
+        AI_Flags[i] = 0;
+        AI_Prior_Value[i] = 0.0f;
+        AI_COV_Increment[i] = 1.0f;
         AI_Descr[i].Units = UNITS_PERCENT;
         AI_Descr[i].Reliability = RELIABILITY_NO_FAULT_DETECTED;
-        AI_Descr[i].Prior_Value = 0.0f;
-        AI_Descr[i].COV_Increment = 1.0f;
-        AI_Descr[i].Changed = false;
+    }
 #if defined(INTRINSIC_REPORTING)
-        AI_Descr[i].Event_State = EVENT_STATE_NORMAL;
-        /* notification class not connected */
-        AI_Descr[i].Notification_Class = BACNET_MAX_INSTANCE;
-        /* initialize Event time stamps using wildcards
-           and set Acked_transitions */
-        for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
-            datetime_wildcard_set(&AI_Descr[i].Event_Time_Stamps[j]);
-            AI_Descr[i].Acked_Transitions[j].bIsAcked = true;
-        }
-
-        /* Set handler for GetEventInformation function */
-        handler_get_event_information_set(OBJECT_ANALOG_INPUT,
-            Analog_Input_Event_Information);
-        /* Set handler for AcknowledgeAlarm function */
-        handler_alarm_ack_set(OBJECT_ANALOG_INPUT, Analog_Input_Alarm_Ack);
-        /* Set handler for GetAlarmSummary Service */
-        handler_get_alarm_summary_set(OBJECT_ANALOG_INPUT,
-            Analog_Input_Alarm_Summary);
+    /* none is set up for reporting yet */
+    Object_Pool_Init(&AI_Event_Pool);
+    Analog_Input_Event_Init(&AI_Event_Default);
+    /* Set handler for GetEventInformation function */
+    handler_get_event_information_set(OBJECT_ANALOG_INPUT,
+        Analog_Input_Event_Information);
+    /* Set handler for AcknowledgeAlarm function */
+    handler_alarm_ack_set(OBJECT_ANALOG_INPUT, Analog_Input_Alarm_Ack);
+    /* Set handler for GetAlarmSummary Service */
+    handler_get_alarm_summary_set(OBJECT_ANALOG_INPUT,
+        Analog_Input_Alarm_Summary);
 #endif
-    }
 }
 
 /* we simply have 0-n object instances.  Yours might be */
@@ -196,7 +268,7 @@ float Analog_Input_Present_Value(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        value = AI_Descr[index].Present_Value;
+        value = AI_Present_Value[index];
     }
 
     return value;
@@ -210,16 +282,16 @@ static void Analog_Input_COV_Detect(unsigned int index,
     float cov_delta = 0.0;
 
     if (index < MAX_ANALOG_INPUTS) {
-        prior_value = AI_Descr[index].Prior_Value;
-        cov_increment = AI_Descr[index].COV_Increment;
+        prior_value = AI_Prior_Value[index];
+        cov_increment = AI_COV_Increment[index];
         if (prior_value > value) {
             cov_delta = prior_value - value;
         } else {
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            AI_Descr[index].Changed = true;
-            AI_Descr[index].Prior_Value = value;
+            AI_Flags[index] |= AI_CHANGED;
+            AI_Prior_Value[index] = value;
         }
     }
 }
@@ -233,7 +305,7 @@ void Analog_Input_Present_Value_Set(
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
         Analog_Input_COV_Detect(index, value);
-        AI_Descr[index].Present_Value = value;
+        AI_Present_Value[index] = value;
     }
 }
 
@@ -262,7 +334,7 @@ bool Analog_Input_Change_Of_Value(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        changed = AI_Descr[index].Changed;
+        changed = (AI_Flags[index] & AI_CHANGED) ? true : false;
     }
 
     return changed;
@@ -275,7 +347,7 @@ void Analog_Input_Change_Of_Value_Clear(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        AI_Descr[index].Changed = false;
+        AI_Flags[index] &= ~AI_CHANGED;
     }
 }
 
@@ -340,7 +412,7 @@ float Analog_Input_COV_Increment(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        value = AI_Descr[index].COV_Increment;
+        value = AI_COV_Increment[index];
     }
 
     return value;
@@ -354,8 +426,8 @@ void Analog_Input_COV_Increment_Set(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        AI_Descr[index].COV_Increment = value;
-        Analog_Input_COV_Detect(index, AI_Descr[index].Present_Value);
+        AI_COV_Increment[index] = value;
+        Analog_Input_COV_Detect(index, AI_Present_Value[index]);
     }
 }
 
@@ -367,7 +439,7 @@ bool Analog_Input_Out_Of_Service(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        value = AI_Descr[index].Out_Of_Service;
+        value = (AI_Flags[index] & AI_OUT_OF_SERVICE) ? true : false;
     }
 
     return value;
@@ -381,10 +453,14 @@ void Analog_Input_Out_Of_Service_Set(
 
     index = Analog_Input_Instance_To_Index(object_instance);
     if (index < MAX_ANALOG_INPUTS) {
-        if (AI_Descr[index].Out_Of_Service != value) {
-            AI_Descr[index].Changed = true;
+        if (((AI_Flags[index] & AI_OUT_OF_SERVICE) ? true : false) != value) {
+            AI_Flags[index] |= AI_CHANGED;
+        }
+        if (value) {
+            AI_Flags[index] |= AI_OUT_OF_SERVICE;
+        } else {
+            AI_Flags[index] &= ~AI_OUT_OF_SERVICE;
         }
-        AI_Descr[index].Out_Of_Service = value;
     }
 }
 
@@ -399,6 +475,7 @@ int Analog_Input_Read_Property(
     ANALOG_INPUT_DESCR *CurrentAI;
     unsigned object_index = 0;
 #if defined(INTRINSIC_REPORTING)
+    ANALOG_INPUT_EVENT *CurrentEvent;
     unsigned i = 0;
     int len = 0;
 #endif
@@ -414,6 +491,9 @@ int Analog_Input_Read_Property(
         CurrentAI = &AI_Descr[object_index];
     else
         return BACNET_STATUS_ERROR;
+#if defined(INTRINSIC_REPORTING)
+    CurrentEvent = Analog_Input_Event_Read(object_index);
+#endif
 
     apdu = rpdata->application_data;
     switch ((int) rpdata->object_property) {
@@ -445,14 +525,14 @@ int Analog_Input_Read_Property(
             bitstring_init(&bit_string);
 #if defined(INTRINSIC_REPORTING)
             bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM,
-                CurrentAI->Event_State ? true : false);
+                CurrentEvent->Event_State ? true : false);
 #else
             bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM, false);
 #endif
             bitstring_set_bit(&bit_string, STATUS_FLAG_FAULT, false);
             bitstring_set_bit(&bit_string, STATUS_FLAG_OVERRIDDEN, false);
             bitstring_set_bit(&bit_string, STATUS_FLAG_OUT_OF_SERVICE,
-                CurrentAI->Out_Of_Service);
+                (AI_Flags[object_index] & AI_OUT_OF_SERVICE) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
             break;
@@ -461,7 +541,7 @@ int Analog_Input_Read_Property(
 #if defined(INTRINSIC_REPORTING)
             apdu_len =
                 encode_application_enumerated(&apdu[0],
-                CurrentAI->Event_State);
+                CurrentEvent->Event_State);
 #else
             apdu_len =
                 encode_application_enumerated(&apdu[0], EVENT_STATE_NORMAL);
@@ -477,7 +557,7 @@ int Analog_Input_Read_Property(
         case PROP_OUT_OF_SERVICE:
             apdu_len =
                 encode_application_boolean(&apdu[0],
-                CurrentAI->Out_Of_Service);
+                (AI_Flags[object_index] & AI_OUT_OF_SERVICE) ? true : false);
             break;
 
         case PROP_UNITS:
@@ -487,41 +567,43 @@ int Analog_Input_Read_Property(
 
         case PROP_COV_INCREMENT:
             apdu_len = encode_application_real(&apdu[0],
-                CurrentAI->COV_Increment);
+                AI_COV_Increment[object_index]);
             break;
 
 #if defined(INTRINSIC_REPORTING)
         case PROP_TIME_DELAY:
             apdu_len =
-                encode_application_unsigned(&apdu[0], CurrentAI->Time_Delay);
+                encode_application_unsigned(&apdu[0], CurrentEvent->Time_Delay);
             break;
 
         case PROP_NOTIFICATION_CLASS:
             apdu_len =
                 encode_application_unsigned(&apdu[0],
-                CurrentAI->Notification_Class);
+                CurrentEvent->Notification_Class);
             break;
 
         case PROP_HIGH_LIMIT:
             apdu_len =
-                encode_application_real(&apdu[0], CurrentAI->High_Limit);
+                encode_application_real(&apdu[0], CurrentEvent->High_Limit);
             break;
 
         case PROP_LOW_LIMIT:
-            apdu_len = encode_application_real(&apdu[0], CurrentAI->Low_Limit);
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentEvent->Low_Limit);
             break;
 
         case PROP_DEADBAND:
-            apdu_len = encode_application_real(&apdu[0], CurrentAI->Deadband);
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentEvent->Deadband);
             break;
 
         case PROP_LIMIT_ENABLE:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, 0,
-                (CurrentAI->
+                (CurrentEvent->
                     Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ? true : false);
             bitstring_set_bit(&bit_string, 1,
-                (CurrentAI->
+                (CurrentEvent->
                     Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
@@ -530,13 +612,13 @@ int Analog_Input_Read_Property(
         case PROP_EVENT_ENABLE:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, TRANSITION_TO_OFFNORMAL,
-                (CurrentAI->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ? true : false);
             bitstring_set_bit(&bit_string, TRANSITION_TO_FAULT,
-                (CurrentAI->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_FAULT) ? true : false);
             bitstring_set_bit(&bit_string, TRANSITION_TO_NORMAL,
-                (CurrentAI->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_NORMAL) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
@@ -545,12 +627,12 @@ int Analog_Input_Read_Property(
         case PROP_ACKED_TRANSITIONS:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, TRANSITION_TO_OFFNORMAL,
-                CurrentAI->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked);
             bitstring_set_bit(&bit_string, TRANSITION_TO_FAULT,
-                CurrentAI->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
             bitstring_set_bit(&bit_string, TRANSITION_TO_NORMAL,
-                CurrentAI->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
             break;
@@ -558,7 +640,7 @@ int Analog_Input_Read_Property(
         case PROP_NOTIFY_TYPE:
             apdu_len =
                 encode_application_enumerated(&apdu[0],
-                CurrentAI->Notify_Type ? NOTIFY_EVENT : NOTIFY_ALARM);
+                CurrentEvent->Notify_Type ? NOTIFY_EVENT : NOTIFY_ALARM);
             break;
 
         case PROP_EVENT_TIME_STAMPS:
@@ -576,10 +658,10 @@ int Analog_Input_Read_Property(
                         TIME_STAMP_DATETIME);
                     len +=
                         encode_application_date(&apdu[apdu_len + len],
-                        &CurrentAI->Event_Time_Stamps[i].date);
+                        &CurrentEvent->Event_Time_Stamps[i].date);
                     len +=
                         encode_application_time(&apdu[apdu_len + len],
-                        &CurrentAI->Event_Time_Stamps[i].time);
+                        &CurrentEvent->Event_Time_Stamps[i].time);
                     len +=
                         encode_closing_tag(&apdu[apdu_len + len],
                         TIME_STAMP_DATETIME);
@@ -599,10 +681,10 @@ int Analog_Input_Read_Property(
                     encode_opening_tag(&apdu[apdu_len], TIME_STAMP_DATETIME);
                 apdu_len +=
                     encode_application_date(&apdu[apdu_len],
-                    &CurrentAI->Event_Time_Stamps[rpdata->array_index].date);
+                    &CurrentEvent->Event_Time_Stamps[rpdata->array_index].date);
                 apdu_len +=
                     encode_application_time(&apdu[apdu_len],
-                    &CurrentAI->Event_Time_Stamps[rpdata->array_index].time);
+                    &CurrentEvent->Event_Time_Stamps[rpdata->array_index].time);
                 apdu_len +=
                     encode_closing_tag(&apdu[apdu_len], TIME_STAMP_DATETIME);
             } else {
@@ -651,6 +733,9 @@ bool Analog_Input_Write_Property(
     int len = 0;
     BACNET_APPLICATION_DATA_VALUE value;
     ANALOG_INPUT_DESCR *CurrentAI;
+#if defined(INTRINSIC_REPORTING)
+    ANALOG_INPUT_EVENT *CurrentEvent = NULL;
+#endif
 
     /* decode the some of the request */
     len =
@@ -676,6 +761,28 @@ bool Analog_Input_Write_Property(
     } else {
         return false;
     }
+#if defined(INTRINSIC_REPORTING)
+    switch (wp_data->object_property) {
+        case PROP_TIME_DELAY:
+        case PROP_NOTIFICATION_CLASS:
+        case PROP_HIGH_LIMIT:
+        case PROP_LOW_LIMIT:
+        case PROP_DEADBAND:
+        case PROP_LIMIT_ENABLE:
+        case PROP_EVENT_ENABLE:
+        case PROP_NOTIFY_TYPE:
+            /* the first of these gives the object its event state */
+            CurrentEvent = Analog_Input_Event_Write(object_index);
+            if (!CurrentEvent) {
+                wp_data->error_class = ERROR_CLASS_RESOURCES;
+                wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+#endif
 
     switch ((int) wp_data->object_property) {
         case PROP_PRESENT_VALUE:
@@ -684,7 +791,7 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                if (CurrentAI->Out_Of_Service == true) {
+                if (AI_Flags[object_index] & AI_OUT_OF_SERVICE) {
                     Analog_Input_Present_Value_Set(wp_data->object_instance,
                         value.type.Real);
                 } else {
@@ -739,8 +846,8 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAI->Time_Delay = value.type.Unsigned_Int;
-                CurrentAI->Remaining_Time_Delay = CurrentAI->Time_Delay;
+                CurrentEvent->Time_Delay = value.type.Unsigned_Int;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
             }
             break;
 
@@ -750,7 +857,7 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAI->Notification_Class = value.type.Unsigned_Int;
+                CurrentEvent->Notification_Class = value.type.Unsigned_Int;
             }
             break;
 
@@ -760,7 +867,7 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAI->High_Limit = value.type.Real;
+                CurrentEvent->High_Limit = value.type.Real;
             }
             break;
 
@@ -770,7 +877,7 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAI->Low_Limit = value.type.Real;
+                CurrentEvent->Low_Limit = value.type.Real;
             }
             break;
 
@@ -780,7 +887,7 @@ bool Analog_Input_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAI->Deadband = value.type.Real;
+                CurrentEvent->Deadband = value.type.Real;
             }
             break;
 
@@ -791,7 +898,7 @@ bool Analog_Input_Write_Property(
 
             if (status) {
                 if (value.type.Bit_String.bits_used == 2) {
-                    CurrentAI->Limit_Enable = value.type.Bit_String.value[0];
+                    CurrentEvent->Limit_Enable = value.type.Bit_String.value[0];
                 } else {
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
                     wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
@@ -807,7 +914,7 @@ bool Analog_Input_Write_Property(
 
             if (status) {
                 if (value.type.Bit_String.bits_used == 3) {
-                    CurrentAI->Event_Enable = value.type.Bit_String.value[0];
+                    CurrentEvent->Event_Enable = value.type.Bit_String.value[0];
                 } else {
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
                     wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
@@ -824,10 +931,10 @@ bool Analog_Input_Write_Property(
             if (status) {
                 switch ((BACNET_NOTIFY_TYPE) value.type.Enumerated) {
                     case NOTIFY_EVENT:
-                        CurrentAI->Notify_Type = 1;
+                        CurrentEvent->Notify_Type = 1;
                         break;
                     case NOTIFY_ALARM:
-                        CurrentAI->Notify_Type = 0;
+                        CurrentEvent->Notify_Type = 0;
                         break;
                     default:
                         wp_data->error_class = ERROR_CLASS_PROPERTY;
@@ -871,7 +978,7 @@ void Analog_Input_Intrinsic_Reporting(
 #if defined(INTRINSIC_REPORTING)
     BACNET_EVENT_NOTIFICATION_DATA event_data;
     BACNET_CHARACTER_STRING msgText;
-    ANALOG_INPUT_DESCR *CurrentAI;
+    ANALOG_INPUT_EVENT *CurrentEvent;
     unsigned int object_index;
     uint8_t FromState = 0;
     uint8_t ToState;
@@ -882,20 +989,23 @@ void Analog_Input_Intrinsic_Reporting(
 
     object_index = Analog_Input_Instance_To_Index(object_instance);
     if (object_index < MAX_ANALOG_INPUTS)
-        CurrentAI = &AI_Descr[object_index];
+        CurrentEvent = Analog_Input_Event(object_index);
     else
         return;
+    /* not set up for reporting */
+    if (!CurrentEvent)
+        return;
 
     /* check limits */
-    if (!CurrentAI->Limit_Enable)
+    if (!CurrentEvent->Limit_Enable)
         return; /* limits are not configured */
 
 
-    if (CurrentAI->Ack_notify_data.bSendAckNotify) {
+    if (CurrentEvent->Ack_notify_data.bSendAckNotify) {
         /* clean bSendAckNotify flag */
-        CurrentAI->Ack_notify_data.bSendAckNotify = false;
+        CurrentEvent->Ack_notify_data.bSendAckNotify = false;
         /* copy toState */
-        ToState = CurrentAI->Ack_notify_data.EventState;
+        ToState = CurrentEvent->Ack_notify_data.EventState;
 
 #if PRINT_ENABLED
         fprintf(stderr, "Send Acknotification for (%s,%d).\n",
@@ -912,23 +1022,23 @@ void Analog_Input_Intrinsic_Reporting(
     } else {
         /* actual Present_Value */
         PresentVal = Analog_Input_Present_Value(object_instance);
-        FromState = CurrentAI->Event_State;
-        switch (CurrentAI->Event_State) {
+        FromState = CurrentEvent->Event_State;
+        switch (CurrentEvent->Event_State) {
             case EVENT_STATE_NORMAL:
                 /* A TO-OFFNORMAL event is generated under these conditions:
                    (a) the Present_Value must exceed the High_Limit for a minimum
                    period of time, specified in the Time_Delay property, and
                    (b) the HighLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-OFFNORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal > CurrentAI->High_Limit) &&
-                    ((CurrentAI->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
+                if ((PresentVal > CurrentEvent->High_Limit) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
                         EVENT_HIGH_LIMIT_ENABLE) &&
-                    ((CurrentAI->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
                         EVENT_ENABLE_TO_OFFNORMAL)) {
-                    if (!CurrentAI->Remaining_Time_Delay)
-                        CurrentAI->Event_State = EVENT_STATE_HIGH_LIMIT;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_HIGH_LIMIT;
                     else
-                        CurrentAI->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
 
@@ -937,19 +1047,19 @@ void Analog_Input_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the LowLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal < CurrentAI->Low_Limit) &&
-                    ((CurrentAI->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
+                if ((PresentVal < CurrentEvent->Low_Limit) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
                         EVENT_LOW_LIMIT_ENABLE) &&
-                    ((CurrentAI->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
                         EVENT_ENABLE_TO_OFFNORMAL)) {
-                    if (!CurrentAI->Remaining_Time_Delay)
-                        CurrentAI->Event_State = EVENT_STATE_LOW_LIMIT;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_LOW_LIMIT;
                     else
-                        CurrentAI->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAI->Remaining_Time_Delay = CurrentAI->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             case EVENT_STATE_HIGH_LIMIT:
@@ -959,19 +1069,20 @@ void Analog_Input_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the HighLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal < CurrentAI->High_Limit - CurrentAI->Deadband)
-                    && ((CurrentAI->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
+                if ((PresentVal <
+                        CurrentEvent->High_Limit - CurrentEvent->Deadband) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
                         EVENT_HIGH_LIMIT_ENABLE) &&
-                    ((CurrentAI->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
                         EVENT_ENABLE_TO_NORMAL)) {
-                    if (!CurrentAI->Remaining_Time_Delay)
-                        CurrentAI->Event_State = EVENT_STATE_NORMAL;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_NORMAL;
                     else
-                        CurrentAI->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAI->Remaining_Time_Delay = CurrentAI->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             case EVENT_STATE_LOW_LIMIT:
@@ -982,26 +1093,27 @@ void Analog_Input_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the LowLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal > CurrentAI->Low_Limit + CurrentAI->Deadband)
-                    && ((CurrentAI->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
+                if ((PresentVal >
+                        CurrentEvent->Low_Limit + CurrentEvent->Deadband) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
                         EVENT_LOW_LIMIT_ENABLE) &&
-                    ((CurrentAI->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
                         EVENT_ENABLE_TO_NORMAL)) {
-                    if (!CurrentAI->Remaining_Time_Delay)
-                        CurrentAI->Event_State = EVENT_STATE_NORMAL;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_NORMAL;
                     else
-                        CurrentAI->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAI->Remaining_Time_Delay = CurrentAI->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             default:
                 return; /* shouldn't happen */
         }       /* switch (FromState) */
 
-        ToState = CurrentAI->Event_State;
+        ToState = CurrentEvent->Event_State;
 
         if (FromState != ToState) {
             /* Event_State has changed.
@@ -1010,22 +1122,22 @@ void Analog_Input_Intrinsic_Reporting(
 
             switch (ToState) {
                 case EVENT_STATE_HIGH_LIMIT:
-                    ExceededLimit = CurrentAI->High_Limit;
+                    ExceededLimit = CurrentEvent->High_Limit;
                     characterstring_init_ansi(&msgText, "Goes to high limit");
                     break;
 
                 case EVENT_STATE_LOW_LIMIT:
-                    ExceededLimit = CurrentAI->Low_Limit;
+                    ExceededLimit = CurrentEvent->Low_Limit;
                     characterstring_init_ansi(&msgText, "Goes to low limit");
                     break;
 
                 case EVENT_STATE_NORMAL:
                     if (FromState == EVENT_STATE_HIGH_LIMIT) {
-                        ExceededLimit = CurrentAI->High_Limit;
+                        ExceededLimit = CurrentEvent->High_Limit;
                         characterstring_init_ansi(&msgText,
                             "Back to normal state from high limit");
                     } else {
-                        ExceededLimit = CurrentAI->Low_Limit;
+                        ExceededLimit = CurrentEvent->Low_Limit;
                         characterstring_init_ansi(&msgText,
                             "Back to normal state from low limit");
                     }
@@ -1044,7 +1156,7 @@ void Analog_Input_Intrinsic_Reporting(
 #endif /* PRINT_ENABLED */
 
             /* Notify Type */
-            event_data.notifyType = CurrentAI->Notify_Type;
+            event_data.notifyType = CurrentEvent->Notify_Type;
 
             /* Send EventNotification. */
             SendNotify = true;
@@ -1066,24 +1178,24 @@ void Analog_Input_Intrinsic_Reporting(
             switch (ToState) {
                 case EVENT_STATE_HIGH_LIMIT:
                 case EVENT_STATE_LOW_LIMIT:
-                    CurrentAI->Event_Time_Stamps[TRANSITION_TO_OFFNORMAL] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_OFFNORMAL] =
                         event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_FAULT:
-                    CurrentAI->Event_Time_Stamps[TRANSITION_TO_FAULT] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_FAULT] =
                         event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_NORMAL:
-                    CurrentAI->Event_Time_Stamps[TRANSITION_TO_NORMAL] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_NORMAL] =
                         event_data.timeStamp.value.dateTime;
                     break;
             }
         }
 
         /* Notification Class */
-        event_data.notificationClass = CurrentAI->Notification_Class;
+        event_data.notificationClass = CurrentEvent->Notification_Class;
 
         /* Event Type */
         event_data.eventType = EVENT_OUT_OF_RANGE;
@@ -1099,7 +1211,7 @@ void Analog_Input_Intrinsic_Reporting(
             event_data.fromState = FromState;
 
         /* To State */
-        event_data.toState = CurrentAI->Event_State;
+        event_data.toState = CurrentEvent->Event_State;
 
         /* Event Values */
         if (event_data.notifyType != NOTIFY_ACK_NOTIFICATION) {
@@ -1111,17 +1223,17 @@ void Analog_Input_Intrinsic_Reporting(
                 statusFlags);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_IN_ALARM,
-                CurrentAI->Event_State ? true : false);
+                CurrentEvent->Event_State ? true : false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_FAULT, false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_OVERRIDDEN, false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_OUT_OF_SERVICE,
-                CurrentAI->Out_Of_Service);
+                (AI_Flags[object_index] & AI_OUT_OF_SERVICE) ? true : false);
             /* Deadband used for limit checking. */
             event_data.notificationParams.outOfRange.deadband =
-                CurrentAI->Deadband;
+                CurrentEvent->Deadband;
             /* Limit that was exceeded. */
             event_data.notificationParams.outOfRange.exceededLimit =
                 ExceededLimit;
@@ -1137,23 +1249,23 @@ void Analog_Input_Intrinsic_Reporting(
                 case EVENT_STATE_OFFNORMAL:
                 case EVENT_STATE_HIGH_LIMIT:
                 case EVENT_STATE_LOW_LIMIT:
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                         bIsAcked = false;
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_FAULT:
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_FAULT].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
                         bIsAcked = false;
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_FAULT].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_NORMAL:
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_NORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
                         bIsAcked = false;
-                    CurrentAI->Acked_Transitions[TRANSITION_TO_NORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
             }
@@ -1171,21 +1283,26 @@ int Analog_Input_Event_Information(
     bool IsNotAckedTransitions;
     bool IsActiveEvent;
     int i;
+    ANALOG_INPUT_EVENT *CurrentEvent;
 
 
     /* check index */
     if (index < MAX_ANALOG_INPUTS) {
+        CurrentEvent = Analog_Input_Event(index);
+        /* not set up for reporting: NORMAL, all acknowledged */
+        if (!CurrentEvent)
+            return 0;
         /* Event_State not equal to NORMAL */
-        IsActiveEvent = (AI_Descr[index].Event_State != EVENT_STATE_NORMAL);
+        IsActiveEvent = (CurrentEvent->Event_State != EVENT_STATE_NORMAL);
 
         /* Acked_Transitions property, which has at least one of the bits
            (TO-OFFNORMAL, TO-FAULT, TONORMAL) set to FALSE. */
         IsNotAckedTransitions =
-            (AI_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            (CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
             bIsAcked ==
-            false) | (AI_Descr[index].Acked_Transitions[TRANSITION_TO_FAULT].
+            false) | (CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
             bIsAcked ==
-            false) | (AI_Descr[index].Acked_Transitions[TRANSITION_TO_NORMAL].
+            false) | (CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
             bIsAcked == false);
     } else
         return -1;      /* end of list  */
@@ -1196,40 +1313,40 @@ int Analog_Input_Event_Information(
         getevent_data->objectIdentifier.instance =
             Analog_Input_Index_To_Instance(index);
         /* Event State */
-        getevent_data->eventState = AI_Descr[index].Event_State;
+        getevent_data->eventState = CurrentEvent->Event_State;
         /* Acknowledged Transitions */
         bitstring_init(&getevent_data->acknowledgedTransitions);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_OFFNORMAL,
-            AI_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
             bIsAcked);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_FAULT,
-            AI_Descr[index].Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_NORMAL,
-            AI_Descr[index].Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
         /* Event Time Stamps */
         for (i = 0; i < 3; i++) {
             getevent_data->eventTimeStamps[i].tag = TIME_STAMP_DATETIME;
             getevent_data->eventTimeStamps[i].value.dateTime =
-                AI_Descr[index].Event_Time_Stamps[i];
+                CurrentEvent->Event_Time_Stamps[i];
         }
         /* Notify Type */
-        getevent_data->notifyType = AI_Descr[index].Notify_Type;
+        getevent_data->notifyType = CurrentEvent->Notify_Type;
         /* Event Enable */
         bitstring_init(&getevent_data->eventEnable);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_OFFNORMAL,
-            (AI_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ? true : false);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_FAULT,
-            (AI_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_FAULT) ? true : false);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_NORMAL,
-            (AI_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_NORMAL) ? true : false);
         /* Event Priorities */
-        Notification_Class_Get_Priorities(AI_Descr[index].Notification_Class,
+        Notification_Class_Get_Priorities(CurrentEvent->Notification_Class,
             getevent_data->eventPriorities);
 
         return 1;       /* active event */
@@ -1242,7 +1359,7 @@ int Analog_Input_Alarm_Ack(
     BACNET_ALARM_ACK_DATA * alarmack_data,
     BACNET_ERROR_CODE * error_code)
 {
-    ANALOG_INPUT_DESCR *CurrentAI;
+    ANALOG_INPUT_EVENT *CurrentEvent;
     unsigned int object_index;
 
 
@@ -1251,23 +1368,28 @@ int Analog_Input_Alarm_Ack(
         instance);
 
     if (object_index < MAX_ANALOG_INPUTS)
-        CurrentAI = &AI_Descr[object_index];
+        CurrentEvent = Analog_Input_Event(object_index);
     else {
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
         return -1;
     }
+    /* not set up for reporting, so nothing to acknowledge */
+    if (!CurrentEvent) {
+        *error_code = ERROR_CODE_INVALID_EVENT_STATE;
+        return -1;
+    }
 
     switch (alarmack_data->eventStateAcked) {
         case EVENT_STATE_OFFNORMAL:
         case EVENT_STATE_HIGH_LIMIT:
         case EVENT_STATE_LOW_LIMIT:
-            if (CurrentAI->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked == false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAI->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_OFFNORMAL].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1275,7 +1397,7 @@ int Analog_Input_Alarm_Ack(
                 }
 
                 /* FIXME: Send ack notification */
-                CurrentAI->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                     bIsAcked = true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1284,13 +1406,13 @@ int Analog_Input_Alarm_Ack(
             break;
 
         case EVENT_STATE_FAULT:
-            if (CurrentAI->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ==
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ==
                 false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAI->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_FAULT].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1298,7 +1420,7 @@ int Analog_Input_Alarm_Ack(
                 }
 
                 /* FIXME: Send ack notification */
-                CurrentAI->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked =
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked =
                     true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1307,13 +1429,13 @@ int Analog_Input_Alarm_Ack(
             break;
 
         case EVENT_STATE_NORMAL:
-            if (CurrentAI->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked ==
-                false) {
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
+                bIsAcked == false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAI->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_NORMAL].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1321,7 +1443,7 @@ int Analog_Input_Alarm_Ack(
                 }
 
                 /* FIXME: Send ack notification */
-                CurrentAI->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked =
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked =
                     true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1332,8 +1454,8 @@ int Analog_Input_Alarm_Ack(
         default:
             return -2;
     }
-    CurrentAI->Ack_notify_data.bSendAckNotify = true;
-    CurrentAI->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
+    CurrentEvent->Ack_notify_data.bSendAckNotify = true;
+    CurrentEvent->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
     return 1;
 }
@@ -1342,32 +1464,37 @@ int Analog_Input_Alarm_Summary(
     unsigned index,
     BACNET_GET_ALARM_SUMMARY_DATA * getalarm_data)
 {
+    ANALOG_INPUT_EVENT *CurrentEvent;
 
     /* check index */
     if (index < MAX_ANALOG_INPUTS) {
+        CurrentEvent = Analog_Input_Event(index);
+        /* not set up for reporting: never in alarm */
+        if (!CurrentEvent)
+            return 0;
         /* Event_State is not equal to NORMAL  and
            Notify_Type property value is ALARM */
-        if ((AI_Descr[index].Event_State != EVENT_STATE_NORMAL) &&
-            (AI_Descr[index].Notify_Type == NOTIFY_ALARM)) {
+        if ((CurrentEvent->Event_State != EVENT_STATE_NORMAL) &&
+            (CurrentEvent->Notify_Type == NOTIFY_ALARM)) {
             /* Object Identifier */
             getalarm_data->objectIdentifier.type = OBJECT_ANALOG_INPUT;
             getalarm_data->objectIdentifier.instance =
                 Analog_Input_Index_To_Instance(index);
             /* Alarm State */
-            getalarm_data->alarmState = AI_Descr[index].Event_State;
+            getalarm_data->alarmState = CurrentEvent->Event_State;
             /* Acknowledged Transitions */
             bitstring_init(&getalarm_data->acknowledgedTransitions);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_OFFNORMAL,
-                AI_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_FAULT,
-                AI_Descr[index].
+                CurrentEvent->
                 Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_NORMAL,
-                AI_Descr[index].
+                CurrentEvent->
                 Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
 
             return 1;   /* active alarm */
@@ -89,7 +89,9 @@ static BACNET_SERVICES_SUPPORTED
     SERVICE_SUPPORTED_READ_RANGE,
     SERVICE_SUPPORTED_LIFE_SAFETY_OPERATION,
     SERVICE_SUPPORTED_SUBSCRIBE_COV_PROPERTY,
-    SERVICE_SUPPORTED_GET_EVENT_INFORMATION
+    SERVICE_SUPPORTED_GET_EVENT_INFORMATION,
+    SERVICE_SUPPORTED_SUBSCRIBE_COV_PROPERTY_MULTIPLE,
+    SERVICE_SUPPORTED_CONFIRMED_COV_NOTIFICATION_MULTIPLE
 };
 
 /* a simple table for crossing the services supported */
@@ -104,7 +106,9 @@ static BACNET_SERVICES_SUPPORTED
     SERVICE_SUPPORTED_TIME_SYNCHRONIZATION,
     SERVICE_SUPPORTED_WHO_HAS,
     SERVICE_SUPPORTED_WHO_IS,
-    SERVICE_SUPPORTED_UTC_TIME_SYNCHRONIZATION
+    SERVICE_SUPPORTED_UTC_TIME_SYNCHRONIZATION,
+    SERVICE_SUPPORTED_WRITE_GROUP,
+    SERVICE_SUPPORTED_UNCONFIRMED_COV_NOTIFICATION_MULTIPLE
 };
 
 /* Confirmed Function Handlers */
@@ -241,6 +245,8 @@ void apdu_set_confirmed_simple_ack_handler(
         case SERVICE_CONFIRMED_EVENT_NOTIFICATION:
         case SERVICE_CONFIRMED_SUBSCRIBE_COV:
         case SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY:
+        case SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE:
+        case SERVICE_CONFIRMED_COV_NOTIFICATION_MULTIPLE:
         case SERVICE_CONFIRMED_LIFE_SAFETY_OPERATION:
             /* Object Access Services */
         case SERVICE_CONFIRMED_ADD_LIST_ELEMENT:
@@ -506,6 +512,8 @@ void apdu_handler(
                     case SERVICE_CONFIRMED_EVENT_NOTIFICATION:
                     case SERVICE_CONFIRMED_SUBSCRIBE_COV:
                     case SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY:
+                    case SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE:
+                    case SERVICE_CONFIRMED_COV_NOTIFICATION_MULTIPLE:
                     case SERVICE_CONFIRMED_LIFE_SAFETY_OPERATION:
                         /* Object Access Services */
                     case SERVICE_CONFIRMED_ADD_LIST_ELEMENT:
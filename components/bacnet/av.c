@@ -39,18 +39,60 @@
 #include "config.h"     /* the custom stuff */
 #include "device.h"
 #include "handlers.h"
+#include "objpool.h"
 #include "av.h"
 
 // For ESP32 logging
 #ifdef ESP_PLATFORM
+#include "sdkconfig.h"
 #include "esp_log.h"
 #endif
 
-#ifndef MAX_ANALOG_VALUES
-#define MAX_ANALOG_VALUES 4  
+/* ANALOG_VALUES_FIXED (av.h), and room for those made by CreateObject */
+#define MAX_ANALOG_VALUES (ANALOG_VALUES_FIXED + BACNET_CREATED_OBJECTS)
+
+/* objects that can have intrinsic reporting set up at once */
+#ifndef MAX_ANALOG_VALUE_EVENTS
+#define MAX_ANALOG_VALUE_EVENTS 8
 #endif
 
-ANALOG_VALUE_DESCR AV_Descr[MAX_ANALOG_VALUES];
+/* All indexed by the slot the pool gave the object, not by instance.
+   Each sample touches only the arrays below, each a few bytes per
+   object: not the names and filter parameters in AV_Descr, nor the
+   event state, which only objects set up for reporting have. */
+OBJECT_POOL_DEFINE(AV_Pool, MAX_ANALOG_VALUES);
+static float AV_Present_Value[MAX_ANALOG_VALUES];
+static uint8_t AV_Flags[MAX_ANALOG_VALUES];
+/* the last value reported by COV, and the last one seen */
+static float AV_Prior_Value[MAX_ANALOG_VALUES];
+static float AV_Sampled_Value[MAX_ANALOG_VALUES];
+static float AV_COV_Increment[MAX_ANALOG_VALUES];
+/* the source value before filtering, see PROP_PM_RAW_VALUE */
+static float AV_Raw_Value[MAX_ANALOG_VALUES];
+static ANALOG_VALUE_DESCR AV_Descr[MAX_ANALOG_VALUES];
+
+/* AV_Flags */
+#define AV_OUT_OF_SERVICE 0x01
+/* moved by COV_Increment since the last report */
+#define AV_CHANGED 0x02
+/* Present_Value is pushed by a data source, see
+   Analog_Value_Source_Update() */
+#define AV_BOUND 0x04
+/* the source has filters: the PROP_PM_ filter properties */
+#define AV_FILTERED 0x08
+/* they were written and the source has not taken them yet */
+#define AV_FILTER_CHANGED 0x10
+
+#if defined(INTRINSIC_REPORTING)
+/* The event state of the objects set up for reporting, found by the
+   slot of the object.  The others read AV_Event_Default. */
+OBJECT_POOL_DEFINE(AV_Event_Pool, MAX_ANALOG_VALUE_EVENTS);
+static ANALOG_VALUE_EVENT AV_Event[MAX_ANALOG_VALUE_EVENTS];
+static ANALOG_VALUE_EVENT AV_Event_Default;
+#endif
+
+/* told about Present_Value writes, so it need not poll for them */
+static analog_value_write_function Analog_Value_Write_Notify;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Analog_Value_Properties_Required[] = {
@@ -67,6 +109,7 @@ static const int Analog_Value_Properties_Required[] = {
 
 static const int Analog_Value_Properties_Optional[] = {
     PROP_DESCRIPTION,
+    PROP_COV_INCREMENT,
 #if defined(INTRINSIC_REPORTING)
     PROP_TIME_DELAY,
     PROP_NOTIFICATION_CLASS,
@@ -82,10 +125,26 @@ static const int Analog_Value_Properties_Optional[] = {
     -1
 };
 
+/* all an object can have: Raw_Value if it is bound, the rest if its
+   source has filters */
 static const int Analog_Value_Properties_Proprietary[] = {
+    PROP_PM_RAW_VALUE,
+    PROP_PM_MEDIAN_WINDOW,
+    PROP_PM_EMA_ALPHA,
+    PROP_PM_MEAN_WINDOW,
+    -1
+};
+
+static const int Analog_Value_Properties_Bound[] = {
+    PROP_PM_RAW_VALUE,
     -1
 };
 
+/* Limits of the filter properties; the source checks them again when it
+   takes the new parameters (main/pm_filter.h) */
+#define AV_MEDIAN_WINDOW_MAX 9
+#define AV_MEAN_WINDOW_MAX 16
+
 void Analog_Value_Property_Lists(
     const int **pRequired,
     const int **pOptional,
@@ -101,102 +160,244 @@ void Analog_Value_Property_Lists(
     return;
 }
 
-void Analog_Value_Init(
-    void)
+/* the proprietary properties the object has, as read by
+   Analog_Value_Read_Proprietary() */
+void Analog_Value_Instance_Property_Lists(
+    uint32_t object_instance,
+    const int **pRequired,
+    const int **pOptional,
+    const int **pProprietary)
 {
-    unsigned i;
-#if defined(INTRINSIC_REPORTING)
-    unsigned j;
-#endif
+    unsigned index = 0;
+    uint8_t flags = 0;
 
-    for (i = 0; i < MAX_ANALOG_VALUES; i++) {
-        memset(&AV_Descr[i], 0x00, sizeof(ANALOG_VALUE_DESCR));
-        AV_Descr[i].Present_Value = 0.0;
-        
-        // Set appropriate units for each PM value
-        switch (i) {
-            case 0:  // PM1.0
-            case 1:  // PM2.5
-            case 2:  // PM10
-            case 3:  // PM2.5_SETPOINT - ADDED
-                AV_Descr[i].Units = UNITS_MICROGRAMS_PER_CUBIC_METER;
-                break;
-            default:
-                AV_Descr[i].Units = UNITS_NO_UNITS;
-                break;
+    Analog_Value_Property_Lists(pRequired, pOptional, NULL);
+    if (pProprietary) {
+        index = Object_Pool_Slot(&AV_Pool, object_instance);
+        if (index < MAX_ANALOG_VALUES) {
+            flags = AV_Flags[index] & (AV_BOUND | AV_FILTERED);
         }
-        
-        // SET DEFAULT VALUE FOR PM2.5_SETPOINT (Instance 3) to 25.0
-        if (i == 3) {  // PM2.5_SETPOINT instance
-            AV_Descr[i].Present_Value = 25.0;
-#ifdef ESP_PLATFORM
-            ESP_LOGI("AV", "Initialized PM2.5_SETPOINT (instance %d) to default 25.0", i);
-#endif
+        if (flags == (AV_BOUND | AV_FILTERED)) {
+            *pProprietary = Analog_Value_Properties_Proprietary;
+        } else if (flags == AV_FILTERED) {
+            *pProprietary = &Analog_Value_Properties_Proprietary[1];
+        } else if (flags == AV_BOUND) {
+            *pProprietary = Analog_Value_Properties_Bound;
+        } else {
+            *pProprietary = NULL;
         }
-        
+    }
+
+    return;
+}
+
 #if defined(INTRINSIC_REPORTING)
-        AV_Descr[i].Event_State = EVENT_STATE_NORMAL;
-        /* notification class not connected */
-        AV_Descr[i].Notification_Class = BACNET_MAX_INSTANCE;
-        /* initialize Event time stamps using wildcards
-           and set Acked_transitions */
-        for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
-            datetime_wildcard_set(&AV_Descr[i].Event_Time_Stamps[j]);
-            AV_Descr[i].Acked_Transitions[j].bIsAcked = true;
+/* no limits, no notification class, and every transition acknowledged */
+static void Analog_Value_Event_Init(
+    ANALOG_VALUE_EVENT * event)
+{
+    unsigned j;
+
+    memset(event, 0x00, sizeof(ANALOG_VALUE_EVENT));
+    event->Event_State = EVENT_STATE_NORMAL;
+    /* notification class not connected */
+    event->Notification_Class = BACNET_MAX_INSTANCE;
+    /* initialize Event time stamps using wildcards
+       and set Acked_transitions */
+    for (j = 0; j < MAX_BACNET_EVENT_TRANSITION; j++) {
+        datetime_wildcard_set(&event->Event_Time_Stamps[j]);
+        event->Acked_Transitions[j].bIsAcked = true;
+    }
+}
+
+/* the event state of the object in a slot, or NULL if it has none */
+static ANALOG_VALUE_EVENT *Analog_Value_Event(
+    unsigned index)
+{
+    unsigned event_index = Object_Pool_Slot(&AV_Event_Pool, index);
+
+    if (event_index < MAX_ANALOG_VALUE_EVENTS) {
+        return &AV_Event[event_index];
+    }
+
+    return NULL;
+}
+
+/* the event state to read: the defaults if the object has none */
+static ANALOG_VALUE_EVENT *Analog_Value_Event_Read(
+    unsigned index)
+{
+    ANALOG_VALUE_EVENT *event = Analog_Value_Event(index);
+
+    return event ? event : &AV_Event_Default;
+}
+
+/* the event state to write, given to the object on its first reporting
+   property; NULL if all are in use */
+static ANALOG_VALUE_EVENT *Analog_Value_Event_Write(
+    unsigned index)
+{
+    ANALOG_VALUE_EVENT *event = Analog_Value_Event(index);
+    unsigned event_index = 0;
+
+    if (!event) {
+        event_index = Object_Pool_Create(&AV_Event_Pool, index, true);
+        if (event_index < MAX_ANALOG_VALUE_EVENTS) {
+            event = &AV_Event[event_index];
+            Analog_Value_Event_Init(event);
         }
+    }
 
-        /* Set handler for GetEventInformation function */
-        handler_get_event_information_set(OBJECT_ANALOG_VALUE,
-            Analog_Value_Event_Information);
-        /* Set handler for AcknowledgeAlarm function */
-        handler_alarm_ack_set(OBJECT_ANALOG_VALUE, Analog_Value_Alarm_Ack);
-        /* Set handler for GetAlarmSummary Service */
-        handler_get_alarm_summary_set(OBJECT_ANALOG_VALUE,
-            Analog_Value_Alarm_Summary);
+    return event;
+}
 #endif
+
+/* a new object in a slot: the defaults */
+static void Analog_Value_Object_Init(
+    unsigned index)
+{
+    memset(&AV_Descr[index], 0x00, sizeof(ANALOG_VALUE_DESCR));
+    AV_Present_Value[index] = 0.0;
+    AV_Flags[index] = 0;
+    AV_Prior_Value[index] = 0.0;
+    AV_Sampled_Value[index] = 0.0;
+    AV_COV_Increment[index] = 1.0f;
+    AV_Raw_Value[index] = 0.0;
+    AV_Descr[index].Units = UNITS_NO_UNITS;
+    /* names, units and data sources are bound by the application */
+}
+
+void Analog_Value_Init(
+    void)
+{
+    unsigned i;
+
+    /* the application's objects, which cannot be deleted */
+    Object_Pool_Init(&AV_Pool);
+    for (i = 0; i < ANALOG_VALUES_FIXED; i++) {
+        Analog_Value_Object_Init(Object_Pool_Create(&AV_Pool, i, false));
     }
+#if defined(INTRINSIC_REPORTING)
+    /* none is set up for reporting yet */
+    Object_Pool_Init(&AV_Event_Pool);
+    Analog_Value_Event_Init(&AV_Event_Default);
+    /* Set handler for GetEventInformation function */
+    handler_get_event_information_set(OBJECT_ANALOG_VALUE,
+        Analog_Value_Event_Information);
+    /* Set handler for AcknowledgeAlarm function */
+    handler_alarm_ack_set(OBJECT_ANALOG_VALUE, Analog_Value_Alarm_Ack);
+    /* Set handler for GetAlarmSummary Service */
+    handler_get_alarm_summary_set(OBJECT_ANALOG_VALUE,
+        Analog_Value_Alarm_Summary);
+#endif
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need validate that the */
-/* given instance exists */
-bool Analog_Value_Valid_Instance(
+/**
+ * Creates an object for CreateObject.  It has the defaults of a new
+ * object, no name of its own, and can be deleted again.
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  true if the object was created; false if the instance is in
+ *          use or there is no room
+ */
+bool Analog_Value_Create(
     uint32_t object_instance)
 {
-    if (object_instance < MAX_ANALOG_VALUES)
+    unsigned index = 0;
+
+    index = Object_Pool_Create(&AV_Pool, object_instance, true);
+    if (index < MAX_ANALOG_VALUES) {
+        Analog_Value_Object_Init(index);
         return true;
+    }
 
     return false;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then count how many you have */
+/**
+ * Deletes an object made by CreateObject.  The application's own
+ * objects cannot be deleted.
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  true if the object was deleted
+ */
+bool Analog_Value_Delete(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Delete(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+#if defined(INTRINSIC_REPORTING)
+        /* its event state goes back for other objects */
+        Object_Pool_Delete(&AV_Event_Pool, index);
+#endif
+        return true;
+    }
+
+    return false;
+}
+
+bool Analog_Value_Valid_Instance(
+    uint32_t object_instance)
+{
+    return (Object_Pool_Slot(&AV_Pool, object_instance) < MAX_ANALOG_VALUES);
+}
+
 unsigned Analog_Value_Count(void)
 {
-    return MAX_ANALOG_VALUES; // Should be 4 (PM1.0, PM2.5, PM10, PM2.5_SETPOINT)
+    return Object_Pool_Count(&AV_Pool);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the instance */
-/* that correlates to the correct index */
+/* the objects are listed in instance order */
 uint32_t Analog_Value_Index_To_Instance(
     unsigned index)
 {
-    return index;
+    return Object_Pool_Index_To_Instance(&AV_Pool, index);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the index */
-/* that correlates to the correct instance number */
 unsigned Analog_Value_Instance_To_Index(
     uint32_t object_instance)
 {
-    unsigned index = MAX_ANALOG_VALUES;
+    return Object_Pool_Instance_To_Index(&AV_Pool, object_instance);
+}
 
-    if (object_instance < MAX_ANALOG_VALUES)
-        index = object_instance;
+/* Changed is set when the value moved by COV_Increment since the last
+   report.  Any movement at all is passed on to the COV handler, since
+   SubscribeCOVProperty clients may ask for a finer increment. */
+static void Analog_Value_COV_Detect(uint32_t object_instance,
+    unsigned int index,
+    float value)
+{
+    float prior_value = 0.0;
+    float cov_increment = 0.0;
+    float cov_delta = 0.0;
+    bool changed = false;
 
-    return index;
+    if (index < MAX_ANALOG_VALUES) {
+        prior_value = AV_Prior_Value[index];
+        cov_increment = AV_COV_Increment[index];
+        if (prior_value > value) {
+            cov_delta = prior_value - value;
+        } else {
+            cov_delta = value - prior_value;
+        }
+        if ((cov_delta > 0.0) && (cov_delta >= cov_increment)) {
+            AV_Flags[index] |= AV_CHANGED;
+            AV_Prior_Value[index] = value;
+            changed = true;
+        }
+        if (AV_Sampled_Value[index] != value) {
+            AV_Sampled_Value[index] = value;
+            changed = true;
+        }
+        if (changed) {
+            handler_cov_object_changed(OBJECT_ANALOG_VALUE,
+                object_instance);
+        }
+    }
 }
 
 /**
@@ -217,11 +418,12 @@ bool Analog_Value_Present_Value_Set(
     unsigned index = 0;
     bool status = false;
 
-    index = Analog_Value_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
     if (index < MAX_ANALOG_VALUES) {
         // Note: priority is ignored for Analog Value objects in this implementation
         // but we keep it for compatibility with the BACnet stack
-        AV_Descr[index].Present_Value = value;
+        Analog_Value_COV_Detect(object_instance, index, value);
+        AV_Present_Value[index] = value;
         
 #ifdef ESP_PLATFORM
         ESP_LOGI("AV", "Set Present_Value: instance=%lu, index=%u, value=%.2f, priority=%u", 
@@ -237,57 +439,321 @@ bool Analog_Value_Present_Value_Set(
 float Analog_Value_Present_Value(uint32_t object_instance)
 {
     unsigned index = 0;
-    
-    index = Analog_Value_Instance_To_Index(object_instance);
+    float value = 0.0f;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
     if (index < MAX_ANALOG_VALUES) {
-        // Check if this is a sensor value (0-2) or a stored value (3+)
-        switch (index) {
-            case 0:  // PM1.0 - read from sensor
-            {
-                float pm25_get_pm1_0(void);  // Forward declaration
-                float value = pm25_get_pm1_0();
-#ifdef ESP_PLATFORM
-                ESP_LOGD("AV", "PM1.0 sensor value: %.1f", value);
-#endif
-                return value;
-            }
-                
-            case 1:  // PM2.5 - read from sensor
-            {
-                float pm25_get_pm2_5(void);  // Forward declaration
-                float value = pm25_get_pm2_5();
-#ifdef ESP_PLATFORM
-                ESP_LOGD("AV", "PM2.5 sensor value: %.1f", value);
-#endif
-                return value;
-            }
-                
-            case 2:  // PM10 - read from sensor
-            {
-                float pm25_get_pm10(void);  // Forward declaration
-                float value = pm25_get_pm10();
-#ifdef ESP_PLATFORM
-                ESP_LOGD("AV", "PM10 sensor value: %.1f", value);
-#endif
-                return value;
-            }
-                
-            case 3:  // PM2.5_SETPOINT (index 3) - return stored value
-#ifdef ESP_PLATFORM
-                ESP_LOGD("AV", "Returning PM2.5_SETPOINT stored value: %.1f", AV_Descr[index].Present_Value);
-#endif
-                return AV_Descr[index].Present_Value;
-                
-            default:  // Any others - return stored value
-#ifdef ESP_PLATFORM
-                ESP_LOGD("AV", "Stored value for index %u: %.1f", index, AV_Descr[index].Present_Value);
+        value = AV_Present_Value[index];
+    }
+
+    return value;
+}
+
+bool Analog_Value_Change_Of_Value(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    bool changed = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        changed = (AV_Flags[index] & AV_CHANGED) ? true : false;
+    }
+
+    return changed;
+}
+
+/**
+ * Sets the function told when a WriteProperty changes the Present_Value
+ * of any Analog Value.  It runs in the task handling the request.
+ *
+ * @param  notify - the function, or NULL for none
+ */
+void Analog_Value_Write_Notify_Set(
+    analog_value_write_function notify)
+{
+    Analog_Value_Write_Notify = notify;
+}
+
+/**
+ * Binds an object to a data source, or releases it.  The Present_Value
+ * of a bound object is pushed by its source and can only be written
+ * while the object is Out_Of_Service.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  bound - true if a data source now owns the Present_Value
+ */
+void Analog_Value_Bind(
+    uint32_t object_instance,
+    bool bound)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        if (bound) {
+            AV_Flags[index] |= AV_BOUND;
+        } else {
+            AV_Flags[index] &= ~AV_BOUND;
+        }
+    }
+}
+
+/**
+ * Pushes a new value from the data source of a bound object.  While the
+ * object is Out_Of_Service only the raw value is kept.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  value - the value for the Present_Value
+ * @param  raw_value - the same value before any filtering
+ *
+ * @return  true if the Present_Value was updated
+ */
+bool Analog_Value_Source_Update(
+    uint32_t object_instance,
+    float value,
+    float raw_value)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_Raw_Value[index] = raw_value;
+        if (!(AV_Flags[index] & AV_OUT_OF_SERVICE)) {
+            Analog_Value_COV_Detect(object_instance, index, value);
+            AV_Present_Value[index] = value;
+            status = true;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Sets the filter parameters of a bound object, as its source uses them,
+ * and gives the object the filter properties.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  median_window - samples in the median, odd
+ * @param  ema_alpha - weight of a new sample in the EMA
+ * @param  mean_window - samples in the mean
+ */
+void Analog_Value_Filter_Set(
+    uint32_t object_instance,
+    unsigned median_window,
+    float ema_alpha,
+    unsigned mean_window)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_Flags[index] |= AV_FILTERED;
+        AV_Flags[index] &= ~AV_FILTER_CHANGED;
+        AV_Descr[index].Median_Window = (uint8_t) median_window;
+        AV_Descr[index].EMA_Alpha = ema_alpha;
+        AV_Descr[index].Mean_Window = (uint8_t) mean_window;
+    }
+}
+
+/**
+ * Hands filter parameters written over BACnet to the data source.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  median_window - [out] samples in the median
+ * @param  ema_alpha - [out] weight of a new sample in the EMA
+ * @param  mean_window - [out] samples in the mean
+ *
+ * @return  true, once, after any filter property was written
+ */
+bool Analog_Value_Filter_Pending(
+    uint32_t object_instance,
+    unsigned *median_window,
+    float *ema_alpha,
+    unsigned *mean_window)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if ((index < MAX_ANALOG_VALUES) && (AV_Flags[index] & AV_FILTER_CHANGED)) {
+        AV_Flags[index] &= ~AV_FILTER_CHANGED;
+        if (median_window) {
+            *median_window = AV_Descr[index].Median_Window;
+        }
+        if (ema_alpha) {
+            *ema_alpha = AV_Descr[index].EMA_Alpha;
+        }
+        if (mean_window) {
+            *mean_window = AV_Descr[index].Mean_Window;
+        }
+        status = true;
+    }
+
+    return status;
+}
+
+void Analog_Value_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_Flags[index] &= ~AV_CHANGED;
+    }
+}
+
+/**
+ * Encode the Value List for Present-Value and Status-Flags
+ *
+ * @param object_instance - object-instance number of the object
+ * @param  value_list - #BACNET_PROPERTY_VALUE with at least 2 entries
+ *
+ * @return true if values were encoded
+ */
+bool Analog_Value_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    bool status = false;
+    bool in_alarm = false;
+#if defined(INTRINSIC_REPORTING)
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        in_alarm = Analog_Value_Event_Read(index)->Event_State ? true : false;
+    }
 #endif
-                return AV_Descr[index].Present_Value;
+
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+        value_list->value.type.Real =
+            Analog_Value_Present_Value(object_instance);
+        value_list->value.next = NULL;
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list = value_list->next;
+    }
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+        bitstring_init(&value_list->value.type.Bit_String);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_IN_ALARM, in_alarm);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_FAULT, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OVERRIDDEN, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OUT_OF_SERVICE,
+            Analog_Value_Out_Of_Service(object_instance));
+        value_list->value.next = NULL;
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list->next = NULL;
+        status = true;
+    }
+
+    return status;
+}
+
+float Analog_Value_COV_Increment(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    float value = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        value = AV_COV_Increment[index];
+    }
+
+    return value;
+}
+
+void Analog_Value_COV_Increment_Set(
+    uint32_t object_instance,
+    float value)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_COV_Increment[index] = value;
+        Analog_Value_COV_Detect(object_instance, index,
+            AV_Present_Value[index]);
+    }
+}
+
+bool Analog_Value_Out_Of_Service(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    bool value = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        value = (AV_Flags[index] & AV_OUT_OF_SERVICE) ? true : false;
+    }
+
+    return value;
+}
+
+void Analog_Value_Out_Of_Service_Set(
+    uint32_t object_instance,
+    bool value)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        /* a change in Out_Of_Service changes the Status_Flags */
+        if (((AV_Flags[index] & AV_OUT_OF_SERVICE) ? true : false) != value) {
+            AV_Flags[index] |= AV_CHANGED;
+            handler_cov_object_changed(OBJECT_ANALOG_VALUE, object_instance);
+        }
+        if (value) {
+            AV_Flags[index] |= AV_OUT_OF_SERVICE;
+        } else {
+            AV_Flags[index] &= ~AV_OUT_OF_SERVICE;
         }
     }
-    
-    // Default return if index is out of bounds
-    return 0.0f;
+}
+
+uint16_t Analog_Value_Units(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    uint16_t units = UNITS_NO_UNITS;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        units = AV_Descr[index].Units;
+    }
+
+    return units;
+}
+
+bool Analog_Value_Units_Set(
+    uint32_t object_instance,
+    uint16_t units)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_Descr[index].Units = units;
+        status = true;
+    }
+
+    return status;
 }
 
 /* note: the object name must be unique within this device */
@@ -296,33 +762,92 @@ bool Analog_Value_Object_Name(
     BACNET_CHARACTER_STRING * object_name)
 {
     static char text_string[32] = "";   /* okay for single thread */
+    unsigned index = 0;
     bool status = false;
 
-    if (object_instance < MAX_ANALOG_VALUES) {
-        switch (object_instance) {
-            case 0:
-                sprintf(text_string, "PM1.0 Concentration");
-                break;
-            case 1:
-                sprintf(text_string, "PM2.5 Concentration");
-                break;
-            case 2:
-                sprintf(text_string, "PM10 Concentration");
-                break;
-            case 3:
-                sprintf(text_string, "PM2.5_SETPOINT");
-                break;
-            default:
-                sprintf(text_string, "ANALOG VALUE %lu",
-                    (unsigned long) object_instance);
-                break;
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        if (AV_Descr[index].Object_Name) {
+            status =
+                characterstring_init_ansi(object_name,
+                AV_Descr[index].Object_Name);
+        } else {
+            sprintf(text_string, "ANALOG VALUE %lu",
+                (unsigned long) object_instance);
+            status = characterstring_init_ansi(object_name, text_string);
         }
-        status = characterstring_init_ansi(object_name, text_string);
     }
 
     return status;
 }
 
+/* note: the name is not copied, so it must stay valid; NULL restores
+   the default name */
+bool Analog_Value_Name_Set(
+    uint32_t object_instance,
+    char *new_name)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Object_Pool_Slot(&AV_Pool, object_instance);
+    if (index < MAX_ANALOG_VALUES) {
+        AV_Descr[index].Object_Name = new_name;
+        status = true;
+    }
+
+    return status;
+}
+
+/* the proprietary properties of the bound objects */
+static int Analog_Value_Read_Proprietary(
+    BACNET_READ_PROPERTY_DATA * rpdata,
+    unsigned object_index)
+{
+    int apdu_len = BACNET_STATUS_ERROR;
+    uint8_t *apdu = rpdata->application_data;
+    ANALOG_VALUE_DESCR *CurrentAV = &AV_Descr[object_index];
+    bool filtered = (AV_Flags[object_index] & AV_FILTERED) ? true : false;
+
+    switch ((int) rpdata->object_property) {
+        case PROP_PM_RAW_VALUE:
+            if (AV_Flags[object_index] & AV_BOUND) {
+                apdu_len =
+                    encode_application_real(&apdu[0],
+                    AV_Raw_Value[object_index]);
+            }
+            break;
+        case PROP_PM_MEDIAN_WINDOW:
+            if (filtered) {
+                apdu_len =
+                    encode_application_unsigned(&apdu[0],
+                    CurrentAV->Median_Window);
+            }
+            break;
+        case PROP_PM_EMA_ALPHA:
+            if (filtered) {
+                apdu_len =
+                    encode_application_real(&apdu[0], CurrentAV->EMA_Alpha);
+            }
+            break;
+        case PROP_PM_MEAN_WINDOW:
+            if (filtered) {
+                apdu_len =
+                    encode_application_unsigned(&apdu[0],
+                    CurrentAV->Mean_Window);
+            }
+            break;
+        default:
+            break;
+    }
+    if (apdu_len == BACNET_STATUS_ERROR) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+    }
+
+    return apdu_len;
+}
+
 /* return apdu len, or BACNET_STATUS_ERROR on error */
 int Analog_Value_Read_Property(
     BACNET_READ_PROPERTY_DATA * rpdata)
@@ -336,6 +861,7 @@ int Analog_Value_Read_Property(
     uint8_t *apdu = NULL;
     ANALOG_VALUE_DESCR *CurrentAV;
 #if defined(INTRINSIC_REPORTING)
+    ANALOG_VALUE_EVENT *CurrentEvent;
     int len = 0;
     unsigned i = 0;
 #endif
@@ -347,11 +873,14 @@ int Analog_Value_Read_Property(
 
     apdu = rpdata->application_data;
 
-    object_index = Analog_Value_Instance_To_Index(rpdata->object_instance);
+    object_index = Object_Pool_Slot(&AV_Pool, rpdata->object_instance);
     if (object_index < MAX_ANALOG_VALUES)
         CurrentAV = &AV_Descr[object_index];
     else
         return BACNET_STATUS_ERROR;
+#if defined(INTRINSIC_REPORTING)
+    CurrentEvent = Analog_Value_Event_Read(object_index);
+#endif
 
     switch (rpdata->object_property) {
         case PROP_OBJECT_IDENTIFIER:
@@ -385,14 +914,14 @@ int Analog_Value_Read_Property(
             bitstring_init(&bit_string);
 #if defined(INTRINSIC_REPORTING)
             bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM,
-                CurrentAV->Event_State ? true : false);
+                CurrentEvent->Event_State ? true : false);
 #else
             bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM, false);
 #endif
             bitstring_set_bit(&bit_string, STATUS_FLAG_FAULT, false);
             bitstring_set_bit(&bit_string, STATUS_FLAG_OVERRIDDEN, false);
             bitstring_set_bit(&bit_string, STATUS_FLAG_OUT_OF_SERVICE,
-                CurrentAV->Out_Of_Service);
+                (AV_Flags[object_index] & AV_OUT_OF_SERVICE) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
             break;
@@ -401,7 +930,7 @@ int Analog_Value_Read_Property(
 #if defined(INTRINSIC_REPORTING)
             apdu_len =
                 encode_application_enumerated(&apdu[0],
-                CurrentAV->Event_State);
+                CurrentEvent->Event_State);
 #else
             apdu_len =
                 encode_application_enumerated(&apdu[0], EVENT_STATE_NORMAL);
@@ -409,7 +938,7 @@ int Analog_Value_Read_Property(
             break;
 
         case PROP_OUT_OF_SERVICE:
-            state = CurrentAV->Out_Of_Service;
+            state = (AV_Flags[object_index] & AV_OUT_OF_SERVICE) ? true : false;
             apdu_len = encode_application_boolean(&apdu[0], state);
             break;
 
@@ -418,38 +947,46 @@ int Analog_Value_Read_Property(
                 encode_application_enumerated(&apdu[0], CurrentAV->Units);
             break;
 
+        case PROP_COV_INCREMENT:
+            apdu_len =
+                encode_application_real(&apdu[0],
+                AV_COV_Increment[object_index]);
+            break;
+
 #if defined(INTRINSIC_REPORTING)
         case PROP_TIME_DELAY:
             apdu_len =
-                encode_application_unsigned(&apdu[0], CurrentAV->Time_Delay);
+                encode_application_unsigned(&apdu[0], CurrentEvent->Time_Delay);
             break;
 
         case PROP_NOTIFICATION_CLASS:
             apdu_len =
                 encode_application_unsigned(&apdu[0],
-                CurrentAV->Notification_Class);
+                CurrentEvent->Notification_Class);
             break;
 
         case PROP_HIGH_LIMIT:
             apdu_len =
-                encode_application_real(&apdu[0], CurrentAV->High_Limit);
+                encode_application_real(&apdu[0], CurrentEvent->High_Limit);
             break;
 
         case PROP_LOW_LIMIT:
-            apdu_len = encode_application_real(&apdu[0], CurrentAV->Low_Limit);
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentEvent->Low_Limit);
             break;
 
         case PROP_DEADBAND:
-            apdu_len = encode_application_real(&apdu[0], CurrentAV->Deadband);
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentEvent->Deadband);
             break;
 
         case PROP_LIMIT_ENABLE:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, 0,
-                (CurrentAV->
+                (CurrentEvent->
                     Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ? true : false);
             bitstring_set_bit(&bit_string, 1,
-                (CurrentAV->
+                (CurrentEvent->
                     Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
@@ -458,13 +995,13 @@ int Analog_Value_Read_Property(
         case PROP_EVENT_ENABLE:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, TRANSITION_TO_OFFNORMAL,
-                (CurrentAV->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ? true : false);
             bitstring_set_bit(&bit_string, TRANSITION_TO_FAULT,
-                (CurrentAV->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_FAULT) ? true : false);
             bitstring_set_bit(&bit_string, TRANSITION_TO_NORMAL,
-                (CurrentAV->
+                (CurrentEvent->
                     Event_Enable & EVENT_ENABLE_TO_NORMAL) ? true : false);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
@@ -473,12 +1010,12 @@ int Analog_Value_Read_Property(
         case PROP_ACKED_TRANSITIONS:
             bitstring_init(&bit_string);
             bitstring_set_bit(&bit_string, TRANSITION_TO_OFFNORMAL,
-                CurrentAV->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked);
             bitstring_set_bit(&bit_string, TRANSITION_TO_FAULT,
-                CurrentAV->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
             bitstring_set_bit(&bit_string, TRANSITION_TO_NORMAL,
-                CurrentAV->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
 
             apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
             break;
@@ -486,7 +1023,7 @@ int Analog_Value_Read_Property(
         case PROP_NOTIFY_TYPE:
             apdu_len =
                 encode_application_enumerated(&apdu[0],
-                CurrentAV->Notify_Type ? NOTIFY_EVENT : NOTIFY_ALARM);
+                CurrentEvent->Notify_Type ? NOTIFY_EVENT : NOTIFY_ALARM);
             break;
 
         case PROP_EVENT_TIME_STAMPS:
@@ -504,10 +1041,10 @@ int Analog_Value_Read_Property(
                         TIME_STAMP_DATETIME);
                     len +=
                         encode_application_date(&apdu[apdu_len + len],
-                        &CurrentAV->Event_Time_Stamps[i].date);
+                        &CurrentEvent->Event_Time_Stamps[i].date);
                     len +=
                         encode_application_time(&apdu[apdu_len + len],
-                        &CurrentAV->Event_Time_Stamps[i].time);
+                        &CurrentEvent->Event_Time_Stamps[i].time);
                     len +=
                         encode_closing_tag(&apdu[apdu_len + len],
                         TIME_STAMP_DATETIME);
@@ -527,10 +1064,10 @@ int Analog_Value_Read_Property(
                     encode_opening_tag(&apdu[apdu_len], TIME_STAMP_DATETIME);
                 apdu_len +=
                     encode_application_date(&apdu[apdu_len],
-                    &CurrentAV->Event_Time_Stamps[rpdata->array_index].date);
+                    &CurrentEvent->Event_Time_Stamps[rpdata->array_index].date);
                 apdu_len +=
                     encode_application_time(&apdu[apdu_len],
-                    &CurrentAV->Event_Time_Stamps[rpdata->array_index].time);
+                    &CurrentEvent->Event_Time_Stamps[rpdata->array_index].time);
                 apdu_len +=
                     encode_closing_tag(&apdu[apdu_len], TIME_STAMP_DATETIME);
             } else {
@@ -542,9 +1079,7 @@ int Analog_Value_Read_Property(
 #endif
 
         default:
-            rpdata->error_class = ERROR_CLASS_PROPERTY;
-            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
-            apdu_len = BACNET_STATUS_ERROR;
+            apdu_len = Analog_Value_Read_Proprietary(rpdata, object_index);
             break;
     }
     /*  only array properties can have array options */
@@ -559,6 +1094,87 @@ int Analog_Value_Read_Property(
     return apdu_len;
 }
 
+/* the writable proprietary properties of the bound objects: the new
+   filter parameters are taken by the source on its next update */
+static bool Analog_Value_Write_Proprietary(
+    BACNET_WRITE_PROPERTY_DATA * wp_data,
+    unsigned object_index,
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    bool status = false;
+    BACNET_APPLICATION_TAG tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    ANALOG_VALUE_DESCR *CurrentAV = &AV_Descr[object_index];
+    bool filtered = (AV_Flags[object_index] & AV_FILTERED) ? true : false;
+
+    switch ((int) wp_data->object_property) {
+        case PROP_PM_RAW_VALUE:
+            if (AV_Flags[object_index] & AV_BOUND) {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+                return false;
+            }
+            break;
+        case PROP_PM_EMA_ALPHA:
+            tag = BACNET_APPLICATION_TAG_REAL;
+            status = filtered;
+            break;
+        case PROP_PM_MEDIAN_WINDOW:
+        case PROP_PM_MEAN_WINDOW:
+            status = filtered;
+            break;
+        default:
+            break;
+    }
+    if (!status) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+#ifdef ESP_PLATFORM
+        ESP_LOGI("AV", "Unknown property: %d", wp_data->object_property);
+#endif
+        return false;
+    }
+    status =
+        WPValidateArgType(value, tag, &wp_data->error_class,
+        &wp_data->error_code);
+    if (!status) {
+        return false;
+    }
+    if (wp_data->object_property == (BACNET_PROPERTY_ID) PROP_PM_EMA_ALPHA) {
+        /* also rejects NaN */
+        status = (value->type.Real > 0.0f) && (value->type.Real <= 1.0f);
+        if (status) {
+            CurrentAV->EMA_Alpha = value->type.Real;
+        }
+    } else if (wp_data->object_property ==
+        (BACNET_PROPERTY_ID) PROP_PM_MEDIAN_WINDOW) {
+        status = (value->type.Unsigned_Int >= 1) &&
+            (value->type.Unsigned_Int <= AV_MEDIAN_WINDOW_MAX) &&
+            ((value->type.Unsigned_Int % 2) == 1);
+        if (status) {
+            CurrentAV->Median_Window = (uint8_t) value->type.Unsigned_Int;
+        }
+    } else {
+        status = (value->type.Unsigned_Int >= 1) &&
+            (value->type.Unsigned_Int <= AV_MEAN_WINDOW_MAX);
+        if (status) {
+            CurrentAV->Mean_Window = (uint8_t) value->type.Unsigned_Int;
+        }
+    }
+    if (status) {
+        AV_Flags[object_index] |= AV_FILTER_CHANGED;
+    } else {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+    }
+#ifdef ESP_PLATFORM
+    ESP_LOGI("AV", "Set filter property %d: instance=%lu, %s",
+        wp_data->object_property, wp_data->object_instance,
+        status ? "ok" : "out of range");
+#endif
+
+    return status;
+}
+
 /* returns true if successful */
 bool Analog_Value_Write_Property(
     BACNET_WRITE_PROPERTY_DATA * wp_data)
@@ -568,6 +1184,9 @@ bool Analog_Value_Write_Property(
     int len = 0;
     BACNET_APPLICATION_DATA_VALUE value;
     ANALOG_VALUE_DESCR *CurrentAV;
+#if defined(INTRINSIC_REPORTING)
+    ANALOG_VALUE_EVENT *CurrentEvent = NULL;
+#endif
 
 #ifdef ESP_PLATFORM
     ESP_LOGI("AV", "Write property request: instance=%lu, property=%d, priority=%u", 
@@ -593,7 +1212,7 @@ bool Analog_Value_Write_Property(
         wp_data->error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
         return false;
     }
-    object_index = Analog_Value_Instance_To_Index(wp_data->object_instance);
+    object_index = Object_Pool_Slot(&AV_Pool, wp_data->object_instance);
     if (object_index < MAX_ANALOG_VALUES)
         CurrentAV = &AV_Descr[object_index];
     else {
@@ -602,10 +1221,41 @@ bool Analog_Value_Write_Property(
 #endif
         return false;
     }
+#if defined(INTRINSIC_REPORTING)
+    switch (wp_data->object_property) {
+        case PROP_TIME_DELAY:
+        case PROP_NOTIFICATION_CLASS:
+        case PROP_HIGH_LIMIT:
+        case PROP_LOW_LIMIT:
+        case PROP_DEADBAND:
+        case PROP_LIMIT_ENABLE:
+        case PROP_EVENT_ENABLE:
+        case PROP_NOTIFY_TYPE:
+            /* the first of these gives the object its event state */
+            CurrentEvent = Analog_Value_Event_Write(object_index);
+            if (!CurrentEvent) {
+                wp_data->error_class = ERROR_CLASS_RESOURCES;
+                wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+#endif
 
     switch (wp_data->object_property) {
         case PROP_PRESENT_VALUE:
-            if (value.tag == BACNET_APPLICATION_TAG_REAL) {
+            if ((AV_Flags[object_index] & AV_BOUND) &&
+                !(AV_Flags[object_index] & AV_OUT_OF_SERVICE)) {
+                /* the data source owns it until taken out of service */
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+#ifdef ESP_PLATFORM
+                ESP_LOGW("AV", "Write access denied: instance %lu is bound",
+                    wp_data->object_instance);
+#endif
+            } else if (value.tag == BACNET_APPLICATION_TAG_REAL) {
                 /* Command priority 6 is reserved for use by Minimum On/Off
                    algorithm and may not be used for other purposes in any
                    object. */
@@ -617,13 +1267,16 @@ bool Analog_Value_Write_Property(
                 if (Analog_Value_Present_Value_Set(wp_data->object_instance,
                         value.type.Real, wp_data->priority)) {
                     status = true;
+                    if (Analog_Value_Write_Notify) {
+                        Analog_Value_Write_Notify(wp_data->object_instance);
+                    }
                     
 #ifdef ESP_PLATFORM
                     ESP_LOGI("AV", "Successfully set Present_Value for instance %lu to %.2f", 
                              wp_data->object_instance, value.type.Real);
                     // Verify the value was stored
-                    float stored_value = AV_Descr[object_index].Present_Value;
-                    ESP_LOGI("AV", "Verified: AV_Descr[%u].Present_Value = %.2f", 
+                    float stored_value = AV_Present_Value[object_index];
+                    ESP_LOGI("AV", "Verified: AV_Present_Value[%u] = %.2f", 
                              object_index, stored_value);
 #endif
                 } else if (wp_data->priority == 6) {
@@ -657,7 +1310,8 @@ bool Analog_Value_Write_Property(
                 WPValidateArgType(&value, BACNET_APPLICATION_TAG_BOOLEAN,
                 &wp_data->error_class, &wp_data->error_code);
             if (status) {
-                CurrentAV->Out_Of_Service = value.type.Boolean;
+                Analog_Value_Out_Of_Service_Set(wp_data->object_instance,
+                    value.type.Boolean);
 #ifdef ESP_PLATFORM
                 ESP_LOGI("AV", "Set Out_Of_Service: instance=%lu, value=%s", 
                          wp_data->object_instance, value.type.Boolean ? "true" : "false");
@@ -678,6 +1332,22 @@ bool Analog_Value_Write_Property(
             }
             break;
 
+        case PROP_COV_INCREMENT:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status) {
+                if (value.type.Real >= 0.0) {
+                    Analog_Value_COV_Increment_Set(wp_data->object_instance,
+                        value.type.Real);
+                } else {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            }
+            break;
+
 #if defined(INTRINSIC_REPORTING)
         case PROP_TIME_DELAY:
             status =
@@ -685,8 +1355,8 @@ bool Analog_Value_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAV->Time_Delay = value.type.Unsigned_Int;
-                CurrentAV->Remaining_Time_Delay = CurrentAV->Time_Delay;
+                CurrentEvent->Time_Delay = value.type.Unsigned_Int;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
             }
             break;
 
@@ -696,7 +1366,7 @@ bool Analog_Value_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAV->Notification_Class = value.type.Unsigned_Int;
+                CurrentEvent->Notification_Class = value.type.Unsigned_Int;
             }
             break;
 
@@ -706,7 +1376,7 @@ bool Analog_Value_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAV->High_Limit = value.type.Real;
+                CurrentEvent->High_Limit = value.type.Real;
             }
             break;
 
@@ -716,7 +1386,7 @@ bool Analog_Value_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAV->Low_Limit = value.type.Real;
+                CurrentEvent->Low_Limit = value.type.Real;
             }
             break;
 
@@ -726,7 +1396,7 @@ bool Analog_Value_Write_Property(
                 &wp_data->error_class, &wp_data->error_code);
 
             if (status) {
-                CurrentAV->Deadband = value.type.Real;
+                CurrentEvent->Deadband = value.type.Real;
             }
             break;
 
@@ -737,7 +1407,7 @@ bool Analog_Value_Write_Property(
 
             if (status) {
                 if (value.type.Bit_String.bits_used == 2) {
-                    CurrentAV->Limit_Enable = value.type.Bit_String.value[0];
+                    CurrentEvent->Limit_Enable = value.type.Bit_String.value[0];
                 } else {
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
                     wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
@@ -753,7 +1423,7 @@ bool Analog_Value_Write_Property(
 
             if (status) {
                 if (value.type.Bit_String.bits_used == 3) {
-                    CurrentAV->Event_Enable = value.type.Bit_String.value[0];
+                    CurrentEvent->Event_Enable = value.type.Bit_String.value[0];
                 } else {
                     wp_data->error_class = ERROR_CLASS_PROPERTY;
                     wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
@@ -770,10 +1440,10 @@ bool Analog_Value_Write_Property(
             if (status) {
                 switch ((BACNET_NOTIFY_TYPE) value.type.Enumerated) {
                     case NOTIFY_EVENT:
-                        CurrentAV->Notify_Type = 1;
+                        CurrentEvent->Notify_Type = 1;
                         break;
                     case NOTIFY_ALARM:
-                        CurrentAV->Notify_Type = 0;
+                        CurrentEvent->Notify_Type = 0;
                         break;
                     default:
                         wp_data->error_class = ERROR_CLASS_PROPERTY;
@@ -802,13 +1472,17 @@ bool Analog_Value_Write_Property(
             break;
         case PROP_RELINQUISH_DEFAULT:
         case PROP_PRIORITY_ARRAY:
-        default:
             wp_data->error_class = ERROR_CLASS_PROPERTY;
             wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
 #ifdef ESP_PLATFORM
             ESP_LOGI("AV", "Unknown property: %d", wp_data->object_property);
 #endif
             break;
+        default:
+            /* the proprietary properties of the bound objects */
+            status =
+                Analog_Value_Write_Proprietary(wp_data, object_index, &value);
+            break;
     }
 
     return status;
@@ -821,7 +1495,7 @@ void Analog_Value_Intrinsic_Reporting(
 {
     BACNET_EVENT_NOTIFICATION_DATA event_data;
     BACNET_CHARACTER_STRING msgText;
-    ANALOG_VALUE_DESCR *CurrentAV;
+    ANALOG_VALUE_EVENT *CurrentEvent;
     unsigned int object_index;
     uint8_t FromState = 0;
     uint8_t ToState;
@@ -830,22 +1504,25 @@ void Analog_Value_Intrinsic_Reporting(
     bool SendNotify = false;
 
 
-    object_index = Analog_Value_Instance_To_Index(object_instance);
+    object_index = Object_Pool_Slot(&AV_Pool, object_instance);
     if (object_index < MAX_ANALOG_VALUES)
-        CurrentAV = &AV_Descr[object_index];
+        CurrentEvent = Analog_Value_Event(object_index);
     else
         return;
+    /* not set up for reporting */
+    if (!CurrentEvent)
+        return;
 
     /* check limits */
-    if (!CurrentAV->Limit_Enable)
+    if (!CurrentEvent->Limit_Enable)
         return; /* limits are not configured */
 
 
-    if (CurrentAV->Ack_notify_data.bSendAckNotify) {
+    if (CurrentEvent->Ack_notify_data.bSendAckNotify) {
         /* clean bSendAckNotify flag */
-        CurrentAV->Ack_notify_data.bSendAckNotify = false;
+        CurrentEvent->Ack_notify_data.bSendAckNotify = false;
         /* copy toState */
-        ToState = CurrentAV->Ack_notify_data.EventState;
+        ToState = CurrentEvent->Ack_notify_data.EventState;
 
         characterstring_init_ansi(&msgText, "AckNotification");
 
@@ -857,23 +1534,23 @@ void Analog_Value_Intrinsic_Reporting(
     } else {
         /* actual Present_Value */
         PresentVal = Analog_Value_Present_Value(object_instance);
-        FromState = CurrentAV->Event_State;
-        switch (CurrentAV->Event_State) {
+        FromState = CurrentEvent->Event_State;
+        switch (CurrentEvent->Event_State) {
             case EVENT_STATE_NORMAL:
                 /* A TO-OFFNORMAL event is generated under these conditions:
                    (a) the Present_Value must exceed the High_Limit for a minimum
                    period of time, specified in the Time_Delay property, and
                    (b) the HighLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-OFFNORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal > CurrentAV->High_Limit) &&
-                    ((CurrentAV->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
+                if ((PresentVal > CurrentEvent->High_Limit) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
                         EVENT_HIGH_LIMIT_ENABLE) &&
-                    ((CurrentAV->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
                         EVENT_ENABLE_TO_OFFNORMAL)) {
-                    if (!CurrentAV->Remaining_Time_Delay)
-                        CurrentAV->Event_State = EVENT_STATE_HIGH_LIMIT;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_HIGH_LIMIT;
                     else
-                        CurrentAV->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
 
@@ -882,19 +1559,19 @@ void Analog_Value_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the LowLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal < CurrentAV->Low_Limit) &&
-                    ((CurrentAV->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
+                if ((PresentVal < CurrentEvent->Low_Limit) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
                         EVENT_LOW_LIMIT_ENABLE) &&
-                    ((CurrentAV->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ==
                         EVENT_ENABLE_TO_OFFNORMAL)) {
-                    if (!CurrentAV->Remaining_Time_Delay)
-                        CurrentAV->Event_State = EVENT_STATE_LOW_LIMIT;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_LOW_LIMIT;
                     else
-                        CurrentAV->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAV->Remaining_Time_Delay = CurrentAV->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             case EVENT_STATE_HIGH_LIMIT:
@@ -904,19 +1581,20 @@ void Analog_Value_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the HighLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal < CurrentAV->High_Limit - CurrentAV->Deadband)
-                    && ((CurrentAV->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
+                if ((PresentVal <
+                        CurrentEvent->High_Limit - CurrentEvent->Deadband) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_HIGH_LIMIT_ENABLE) ==
                         EVENT_HIGH_LIMIT_ENABLE) &&
-                    ((CurrentAV->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
                         EVENT_ENABLE_TO_NORMAL)) {
-                    if (!CurrentAV->Remaining_Time_Delay)
-                        CurrentAV->Event_State = EVENT_STATE_NORMAL;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_NORMAL;
                     else
-                        CurrentAV->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAV->Remaining_Time_Delay = CurrentAV->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             case EVENT_STATE_LOW_LIMIT:
@@ -927,26 +1605,27 @@ void Analog_Value_Intrinsic_Reporting(
                    for a minimum period of time, specified in the Time_Delay property, and
                    (b) the LowLimitEnable flag must be set in the Limit_Enable property, and
                    (c) the TO-NORMAL flag must be set in the Event_Enable property. */
-                if ((PresentVal > CurrentAV->Low_Limit + CurrentAV->Deadband)
-                    && ((CurrentAV->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
+                if ((PresentVal >
+                        CurrentEvent->Low_Limit + CurrentEvent->Deadband) &&
+                    ((CurrentEvent->Limit_Enable & EVENT_LOW_LIMIT_ENABLE) ==
                         EVENT_LOW_LIMIT_ENABLE) &&
-                    ((CurrentAV->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
+                    ((CurrentEvent->Event_Enable & EVENT_ENABLE_TO_NORMAL) ==
                         EVENT_ENABLE_TO_NORMAL)) {
-                    if (!CurrentAV->Remaining_Time_Delay)
-                        CurrentAV->Event_State = EVENT_STATE_NORMAL;
+                    if (!CurrentEvent->Remaining_Time_Delay)
+                        CurrentEvent->Event_State = EVENT_STATE_NORMAL;
                     else
-                        CurrentAV->Remaining_Time_Delay--;
+                        CurrentEvent->Remaining_Time_Delay--;
                     break;
                 }
                 /* value of the object is still in the same event state */
-                CurrentAV->Remaining_Time_Delay = CurrentAV->Time_Delay;
+                CurrentEvent->Remaining_Time_Delay = CurrentEvent->Time_Delay;
                 break;
 
             default:
                 return; /* shouldn't happen */
         }       /* switch (FromState) */
 
-        ToState = CurrentAV->Event_State;
+        ToState = CurrentEvent->Event_State;
 
         if (FromState != ToState) {
             /* Event_State has changed.
@@ -955,22 +1634,22 @@ void Analog_Value_Intrinsic_Reporting(
 
             switch (ToState) {
                 case EVENT_STATE_HIGH_LIMIT:
-                    ExceededLimit = CurrentAV->High_Limit;
+                    ExceededLimit = CurrentEvent->High_Limit;
                     characterstring_init_ansi(&msgText, "Goes to high limit");
                     break;
 
                 case EVENT_STATE_LOW_LIMIT:
-                    ExceededLimit = CurrentAV->Low_Limit;
+                    ExceededLimit = CurrentEvent->Low_Limit;
                     characterstring_init_ansi(&msgText, "Goes to low limit");
                     break;
 
                 case EVENT_STATE_NORMAL:
                     if (FromState == EVENT_STATE_HIGH_LIMIT) {
-                        ExceededLimit = CurrentAV->High_Limit;
+                        ExceededLimit = CurrentEvent->High_Limit;
                         characterstring_init_ansi(&msgText,
                             "Back to normal state from high limit");
                     } else {
-                        ExceededLimit = CurrentAV->Low_Limit;
+                        ExceededLimit = CurrentEvent->Low_Limit;
                         characterstring_init_ansi(&msgText,
                             "Back to normal state from low limit");
                     }
@@ -982,7 +1661,7 @@ void Analog_Value_Intrinsic_Reporting(
             }   /* switch (ToState) */
 
             /* Notify Type */
-            event_data.notifyType = CurrentAV->Notify_Type;
+            event_data.notifyType = CurrentEvent->Notify_Type;
 
             /* Send EventNotification. */
             SendNotify = true;
@@ -1004,24 +1683,24 @@ void Analog_Value_Intrinsic_Reporting(
             switch (ToState) {
                 case EVENT_STATE_HIGH_LIMIT:
                 case EVENT_STATE_LOW_LIMIT:
-                    CurrentAV->Event_Time_Stamps[TRANSITION_TO_OFFNORMAL] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_OFFNORMAL] =
                         event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_FAULT:
-                    CurrentAV->Event_Time_Stamps[TRANSITION_TO_FAULT] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_FAULT] =
                         event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_NORMAL:
-                    CurrentAV->Event_Time_Stamps[TRANSITION_TO_NORMAL] =
+                    CurrentEvent->Event_Time_Stamps[TRANSITION_TO_NORMAL] =
                         event_data.timeStamp.value.dateTime;
                     break;
             }
         }
 
         /* Notification Class */
-        event_data.notificationClass = CurrentAV->Notification_Class;
+        event_data.notificationClass = CurrentEvent->Notification_Class;
 
         /* Event Type */
         event_data.eventType = EVENT_OUT_OF_RANGE;
@@ -1037,7 +1716,7 @@ void Analog_Value_Intrinsic_Reporting(
             event_data.fromState = FromState;
 
         /* To State */
-        event_data.toState = CurrentAV->Event_State;
+        event_data.toState = CurrentEvent->Event_State;
 
         /* Event Values */
         if (event_data.notifyType != NOTIFY_ACK_NOTIFICATION) {
@@ -1049,17 +1728,17 @@ void Analog_Value_Intrinsic_Reporting(
                 statusFlags);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_IN_ALARM,
-                CurrentAV->Event_State ? true : false);
+                CurrentEvent->Event_State ? true : false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_FAULT, false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_OVERRIDDEN, false);
             bitstring_set_bit(&event_data.notificationParams.outOfRange.
                 statusFlags, STATUS_FLAG_OUT_OF_SERVICE,
-                CurrentAV->Out_Of_Service);
+                (AV_Flags[object_index] & AV_OUT_OF_SERVICE) ? true : false);
             /* Deadband used for limit checking. */
             event_data.notificationParams.outOfRange.deadband =
-                CurrentAV->Deadband;
+                CurrentEvent->Deadband;
             /* Limit that was exceeded. */
             event_data.notificationParams.outOfRange.exceededLimit =
                 ExceededLimit;
@@ -1075,23 +1754,23 @@ void Analog_Value_Intrinsic_Reporting(
                 case EVENT_STATE_OFFNORMAL:
                 case EVENT_STATE_HIGH_LIMIT:
                 case EVENT_STATE_LOW_LIMIT:
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                         bIsAcked = false;
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_FAULT:
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_FAULT].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
                         bIsAcked = false;
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_FAULT].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
 
                 case EVENT_STATE_NORMAL:
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_NORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
                         bIsAcked = false;
-                    CurrentAV->Acked_Transitions[TRANSITION_TO_NORMAL].
+                    CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
                         Time_Stamp = event_data.timeStamp.value.dateTime;
                     break;
             }
@@ -1106,21 +1785,28 @@ int Analog_Value_Event_Information(
     bool IsNotAckedTransitions;
     bool IsActiveEvent;
     int i;
+    unsigned slot;
+    ANALOG_VALUE_EVENT *CurrentEvent;
 
 
-    /* check index */
-    if (index < MAX_ANALOG_VALUES) {
+    /* check index: the index-th object, in the slot the pool gave it */
+    slot = Object_Pool_Index_To_Slot(&AV_Pool, index);
+    if (slot < MAX_ANALOG_VALUES) {
+        CurrentEvent = Analog_Value_Event(slot);
+        /* not set up for reporting: NORMAL, all acknowledged */
+        if (!CurrentEvent)
+            return 0;
         /* Event_State not equal to NORMAL */
-        IsActiveEvent = (AV_Descr[index].Event_State != EVENT_STATE_NORMAL);
+        IsActiveEvent = (CurrentEvent->Event_State != EVENT_STATE_NORMAL);
 
         /* Acked_Transitions property, which has at least one of the bits
            (TO-OFFNORMAL, TO-FAULT, TONORMAL) set to FALSE. */
         IsNotAckedTransitions =
-            (AV_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            (CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
             bIsAcked ==
-            false) | (AV_Descr[index].Acked_Transitions[TRANSITION_TO_FAULT].
+            false) | (CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].
             bIsAcked ==
-            false) | (AV_Descr[index].Acked_Transitions[TRANSITION_TO_NORMAL].
+            false) | (CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
             bIsAcked == false);
     } else
         return -1;      /* end of list  */
@@ -1131,40 +1817,40 @@ int Analog_Value_Event_Information(
         getevent_data->objectIdentifier.instance =
             Analog_Value_Index_To_Instance(index);
         /* Event State */
-        getevent_data->eventState = AV_Descr[index].Event_State;
+        getevent_data->eventState = CurrentEvent->Event_State;
         /* Acknowledged Transitions */
         bitstring_init(&getevent_data->acknowledgedTransitions);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_OFFNORMAL,
-            AV_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
             bIsAcked);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_FAULT,
-            AV_Descr[index].Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
         bitstring_set_bit(&getevent_data->acknowledgedTransitions,
             TRANSITION_TO_NORMAL,
-            AV_Descr[index].Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
+            CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
         /* Event Time Stamps */
         for (i = 0; i < 3; i++) {
             getevent_data->eventTimeStamps[i].tag = TIME_STAMP_DATETIME;
             getevent_data->eventTimeStamps[i].value.dateTime =
-                AV_Descr[index].Event_Time_Stamps[i];
+                CurrentEvent->Event_Time_Stamps[i];
         }
         /* Notify Type */
-        getevent_data->notifyType = AV_Descr[index].Notify_Type;
+        getevent_data->notifyType = CurrentEvent->Notify_Type;
         /* Event Enable */
         bitstring_init(&getevent_data->eventEnable);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_OFFNORMAL,
-            (AV_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_OFFNORMAL) ? true : false);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_FAULT,
-            (AV_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_FAULT) ? true : false);
         bitstring_set_bit(&getevent_data->eventEnable, TRANSITION_TO_NORMAL,
-            (AV_Descr[index].
+            (CurrentEvent->
                 Event_Enable & EVENT_ENABLE_TO_NORMAL) ? true : false);
         /* Event Priorities */
-        Notification_Class_Get_Priorities(AV_Descr[index].Notification_Class,
+        Notification_Class_Get_Priorities(CurrentEvent->Notification_Class,
             getevent_data->eventPriorities);
 
         return 1;       /* active event */
@@ -1176,32 +1862,37 @@ int Analog_Value_Alarm_Ack(
     BACNET_ALARM_ACK_DATA * alarmack_data,
     BACNET_ERROR_CODE * error_code)
 {
-    ANALOG_VALUE_DESCR *CurrentAV;
+    ANALOG_VALUE_EVENT *CurrentEvent;
     unsigned int object_index;
 
 
     object_index =
-        Analog_Value_Instance_To_Index(alarmack_data->eventObjectIdentifier.
+        Object_Pool_Slot(&AV_Pool, alarmack_data->eventObjectIdentifier.
         instance);
 
     if (object_index < MAX_ANALOG_VALUES)
-        CurrentAV = &AV_Descr[object_index];
+        CurrentEvent = Analog_Value_Event(object_index);
     else {
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
         return -1;
     }
+    /* not set up for reporting, so nothing to acknowledge */
+    if (!CurrentEvent) {
+        *error_code = ERROR_CODE_INVALID_EVENT_STATE;
+        return -1;
+    }
 
     switch (alarmack_data->eventStateAcked) {
         case EVENT_STATE_OFFNORMAL:
         case EVENT_STATE_HIGH_LIMIT:
         case EVENT_STATE_LOW_LIMIT:
-            if (CurrentAV->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked == false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAV->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_OFFNORMAL].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1209,7 +1900,7 @@ int Analog_Value_Alarm_Ack(
                 }
 
                 /* Clean transitions flag. */
-                CurrentAV->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                     bIsAcked = true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1218,13 +1909,13 @@ int Analog_Value_Alarm_Ack(
             break;
 
         case EVENT_STATE_FAULT:
-            if (CurrentAV->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked ==
-                false) {
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].
+                bIsAcked == false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAV->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_NORMAL].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1232,7 +1923,7 @@ int Analog_Value_Alarm_Ack(
                 }
 
                 /* Clean transitions flag. */
-                CurrentAV->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked =
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked =
                     true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1241,13 +1932,13 @@ int Analog_Value_Alarm_Ack(
             break;
 
         case EVENT_STATE_NORMAL:
-            if (CurrentAV->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ==
+            if (CurrentEvent->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ==
                 false) {
                 if (alarmack_data->eventTimeStamp.tag != TIME_STAMP_DATETIME) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
                     return -1;
                 }
-                if (datetime_compare(&CurrentAV->
+                if (datetime_compare(&CurrentEvent->
                         Acked_Transitions[TRANSITION_TO_FAULT].Time_Stamp,
                         &alarmack_data->eventTimeStamp.value.dateTime) > 0) {
                     *error_code = ERROR_CODE_INVALID_TIME_STAMP;
@@ -1255,7 +1946,7 @@ int Analog_Value_Alarm_Ack(
                 }
 
                 /* Clean transitions flag. */
-                CurrentAV->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked =
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked =
                     true;
             } else {
                 *error_code = ERROR_CODE_INVALID_EVENT_STATE;
@@ -1268,8 +1959,8 @@ int Analog_Value_Alarm_Ack(
     }
 
     /* Need to send AckNotification. */
-    CurrentAV->Ack_notify_data.bSendAckNotify = true;
-    CurrentAV->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
+    CurrentEvent->Ack_notify_data.bSendAckNotify = true;
+    CurrentEvent->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
 
     /* Return OK */
     return 1;
@@ -1279,32 +1970,39 @@ int Analog_Value_Alarm_Summary(
     unsigned index,
     BACNET_GET_ALARM_SUMMARY_DATA * getalarm_data)
 {
-
-    /* check index */
-    if (index < MAX_ANALOG_VALUES) {
+    unsigned slot;
+    ANALOG_VALUE_EVENT *CurrentEvent;
+
+    /* check index: the index-th object, in the slot the pool gave it */
+    slot = Object_Pool_Index_To_Slot(&AV_Pool, index);
+    if (slot < MAX_ANALOG_VALUES) {
+        CurrentEvent = Analog_Value_Event(slot);
+        /* not set up for reporting: never in alarm */
+        if (!CurrentEvent)
+            return 0;
         /* Event_State is not equal to NORMAL  and
            Notify_Type property value is ALARM */
-        if ((AV_Descr[index].Event_State != EVENT_STATE_NORMAL) &&
-            (AV_Descr[index].Notify_Type == NOTIFY_ALARM)) {
+        if ((CurrentEvent->Event_State != EVENT_STATE_NORMAL) &&
+            (CurrentEvent->Notify_Type == NOTIFY_ALARM)) {
             /* Object Identifier */
             getalarm_data->objectIdentifier.type = OBJECT_ANALOG_VALUE;
             getalarm_data->objectIdentifier.instance =
                 Analog_Value_Index_To_Instance(index);
             /* Alarm State */
-            getalarm_data->alarmState = AV_Descr[index].Event_State;
+            getalarm_data->alarmState = CurrentEvent->Event_State;
             /* Acknowledged Transitions */
             bitstring_init(&getalarm_data->acknowledgedTransitions);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_OFFNORMAL,
-                AV_Descr[index].Acked_Transitions[TRANSITION_TO_OFFNORMAL].
+                CurrentEvent->Acked_Transitions[TRANSITION_TO_OFFNORMAL].
                 bIsAcked);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_FAULT,
-                AV_Descr[index].
+                CurrentEvent->
                 Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked);
             bitstring_set_bit(&getalarm_data->acknowledgedTransitions,
                 TRANSITION_TO_NORMAL,
-                AV_Descr[index].
+                CurrentEvent->
                 Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked);
 
             return 1;   /* active alarm */
@@ -36,43 +36,31 @@
 #include "wp.h"
 #include "cov.h"
 #include "config.h"     /* the custom stuff */
+#include "objpool.h"
 #include "bi.h"
 #include "handlers.h"
 
-#ifdef ESP_PLATFORM
-#include "bi_gpio.h"
+/* the application's own objects, instances 0..n-1: FAN_STATUS */
+#ifndef BINARY_INPUTS_FIXED
+#define BINARY_INPUTS_FIXED 1
 #endif
+/* and room for those made by CreateObject */
+#define MAX_BINARY_INPUTS (BINARY_INPUTS_FIXED + BACNET_CREATED_OBJECTS)
 
-#ifndef MAX_BINARY_INPUTS
-#define MAX_BINARY_INPUTS 1  // Changed to 1 for FAN_STATUS
-#endif
+/* the arrays are indexed by the slot the pool gave the object */
+OBJECT_POOL_DEFINE(BI_Pool, MAX_BINARY_INPUTS);
 
-static void bi_gpio_init_simple(void)
-{
-#ifdef ESP_PLATFORM
-    bi_gpio_init();
-#endif
-}
-
-static bool bi_gpio_read_simple(void)
-{
-#ifdef ESP_PLATFORM
-    return bi_gpio_35_read();
-#else
-    return false;
-#endif
-}
+/* stores the current value, a BACNET_BINARY_PV, in a byte */
+static uint8_t Present_Value[MAX_BINARY_INPUTS];
+/* and the BI_ flags, so a COV scan reads two bytes per object */
+static uint8_t Flags[MAX_BINARY_INPUTS];
 
-/* stores the current value */
-static BACNET_BINARY_PV Present_Value[MAX_BINARY_INPUTS];
 /* out of service decouples physical input from Present_Value */
-static bool Out_Of_Service[MAX_BINARY_INPUTS];
+#define BI_OUT_OF_SERVICE 0x01
 /* Change of Value flag */
-static bool Change_Of_Value[MAX_BINARY_INPUTS];
-/* Polarity of Input */
-static BACNET_POLARITY Polarity[MAX_BINARY_INPUTS];
-/* Last GPIO state for change detection */
-static bool Last_Button_State[MAX_BINARY_INPUTS];
+#define BI_CHANGED 0x02
+/* Polarity of Input is POLARITY_REVERSE */
+#define BI_REVERSE 0x04
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Binary_Input_Properties_Required[] = {
@@ -114,34 +102,31 @@ void Binary_Input_Property_Lists(
     return;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need validate that the */
-/* given instance exists */
 bool Binary_Input_Valid_Instance(
     uint32_t object_instance)
 {
-    if (object_instance < MAX_BINARY_INPUTS) {
-        return true;
-    }
-
-    return false;
+    return (Object_Pool_Slot(&BI_Pool, object_instance) < MAX_BINARY_INPUTS);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then count how many you have */
 unsigned Binary_Input_Count(
     void)
 {
-    return MAX_BINARY_INPUTS;  // Should be 1
+    return Object_Pool_Count(&BI_Pool);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the instance */
-/* that correlates to the correct index */
+/* the objects are listed in instance order */
 uint32_t Binary_Input_Index_To_Instance(
     unsigned index)
 {
-    return index;
+    return Object_Pool_Index_To_Instance(&BI_Pool, index);
+}
+
+/* a new object in a slot: the defaults */
+static void Binary_Input_Object_Init(
+    unsigned index)
+{
+    Present_Value[index] = BINARY_INACTIVE;
+    Flags[index] = 0;
 }
 
 void Binary_Input_Init(
@@ -153,84 +138,57 @@ void Binary_Input_Init(
     if (!initialized) {
         initialized = true;
 
-        // Initialize GPIO for button
-        bi_gpio_init_simple();
-        
-        /* initialize all the values */
-        for (i = 0; i < MAX_BINARY_INPUTS; i++) {
-            Present_Value[i] = BINARY_INACTIVE;
-            Polarity[i] = POLARITY_NORMAL;
-            Out_Of_Service[i] = false;
-            Change_Of_Value[i] = false;
-            Last_Button_State[i] = false;  // Default to button not pressed
+        /* the application's objects, which cannot be deleted */
+        Object_Pool_Init(&BI_Pool);
+        for (i = 0; i < BINARY_INPUTS_FIXED; i++) {
+            Binary_Input_Object_Init(Object_Pool_Create(&BI_Pool, i,
+                    false));
         }
     }
 
     return;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the index */
-/* that correlates to the correct instance number */
-unsigned Binary_Input_Instance_To_Index(
+/* an object for CreateObject, which can be deleted again */
+bool Binary_Input_Create(
     uint32_t object_instance)
 {
-    unsigned index = MAX_BINARY_INPUTS;
+    unsigned index = 0;
 
-    if (object_instance < MAX_BINARY_INPUTS) {
-        index = object_instance;
+    index = Object_Pool_Create(&BI_Pool, object_instance, true);
+    if (index < MAX_BINARY_INPUTS) {
+        Binary_Input_Object_Init(index);
+        return true;
     }
 
-    return index;
+    return false;
 }
 
-/* Function to update button state and detect changes */
-void Binary_Input_Update_Button_State(uint32_t object_instance)
+/* only objects made by CreateObject can be deleted */
+bool Binary_Input_Delete(
+    uint32_t object_instance)
 {
-    unsigned index = Binary_Input_Instance_To_Index(object_instance);
-    
-    if (index < MAX_BINARY_INPUTS && !Out_Of_Service[index]) {
-        // Read current button state
-        bool current_state = bi_gpio_read_simple();
-        
-        // Check if state changed
-        if (current_state != Last_Button_State[index]) {
-            Last_Button_State[index] = current_state;
-            Change_Of_Value[index] = true;
-            
-            // Update Present_Value based on button state
-            if (current_state) {  // Button pressed
-                Present_Value[index] = BINARY_ACTIVE;
-            } else {  // Button released
-                Present_Value[index] = BINARY_INACTIVE;
-            }
-            
-            // Apply polarity if needed
-            if (Polarity[index] != POLARITY_NORMAL) {
-                if (Present_Value[index] == BINARY_INACTIVE) {
-                    Present_Value[index] = BINARY_ACTIVE;
-                } else {
-                    Present_Value[index] = BINARY_INACTIVE;
-                }
-            }
-        }
-    }
+    return (Object_Pool_Delete(&BI_Pool, object_instance) < MAX_BINARY_INPUTS);
+}
+
+unsigned Binary_Input_Instance_To_Index(
+    uint32_t object_instance)
+{
+    return Object_Pool_Instance_To_Index(&BI_Pool, object_instance);
 }
 
 BACNET_BINARY_PV Binary_Input_Present_Value(
     uint32_t object_instance)
 {
+    BACNET_BINARY_PV value = BINARY_INACTIVE;
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        // Update button state before returning value
-        Binary_Input_Update_Button_State(object_instance);
-        
-        return Present_Value[index];
+        value = (BACNET_BINARY_PV) Present_Value[index];
     }
 
-    return BINARY_INACTIVE;
+    return value;
 }
 
 bool Binary_Input_Out_Of_Service(
@@ -239,9 +197,9 @@ bool Binary_Input_Out_Of_Service(
     bool value = false;
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        value = Out_Of_Service[index];
+        value = (Flags[index] & BI_OUT_OF_SERVICE) ? true : false;
     }
 
     return value;
@@ -253,11 +211,9 @@ bool Binary_Input_Change_Of_Value(
     bool status = false;
     unsigned index;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        // Update button state to detect changes
-        Binary_Input_Update_Button_State(object_instance);
-        status = Change_Of_Value[index];
+        status = (Flags[index] & BI_CHANGED) ? true : false;
     }
 
     return status;
@@ -268,9 +224,9 @@ void Binary_Input_Change_Of_Value_Clear(
 {
     unsigned index;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        Change_Of_Value[index] = false;
+        Flags[index] &= ~BI_CHANGED;
     }
 
     return;
@@ -336,9 +292,9 @@ bool Binary_Input_Present_Value_Set(
     unsigned index = 0;
     bool status = false;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        if (Polarity[index] != POLARITY_NORMAL) {
+        if (Flags[index] & BI_REVERSE) {
             if (value == BINARY_INACTIVE) {
                 value = BINARY_ACTIVE;
             } else {
@@ -346,27 +302,59 @@ bool Binary_Input_Present_Value_Set(
             }
         }
         if (Present_Value[index] != value) {
-            Change_Of_Value[index] = true;
+            Flags[index] |= BI_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_INPUT, object_instance);
         }
-        Present_Value[index] = value;
+        Present_Value[index] = (uint8_t) value;
         status = true;
     }
 
     return status;
 }
 
+/**
+ * Pushes the state of the physical input from its data source.  It is
+ * ignored while the object is Out_Of_Service.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  active - true if the input is active, before polarity
+ *
+ * @return  true if the Present_Value was updated
+ */
+bool Binary_Input_Source_Update(
+    uint32_t object_instance,
+    bool active)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
+    if ((index < MAX_BINARY_INPUTS) && !(Flags[index] & BI_OUT_OF_SERVICE)) {
+        status =
+            Binary_Input_Present_Value_Set(object_instance,
+            active ? BINARY_ACTIVE : BINARY_INACTIVE);
+    }
+
+    return status;
+}
+
 void Binary_Input_Out_Of_Service_Set(
     uint32_t object_instance,
     bool value)
 {
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        if (Out_Of_Service[index] != value) {
-            Change_Of_Value[index] = true;
+        if (((Flags[index] & BI_OUT_OF_SERVICE) ? true : false) != value) {
+            Flags[index] |= BI_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_INPUT, object_instance);
+        }
+        if (value) {
+            Flags[index] |= BI_OUT_OF_SERVICE;
+        } else {
+            Flags[index] &= ~BI_OUT_OF_SERVICE;
         }
-        Out_Of_Service[index] = value;
     }
 
     return;
@@ -380,9 +368,9 @@ bool Binary_Input_Object_Name(
     bool status = false;
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        if (index == 0) {
+        if (object_instance == 0) {
             sprintf(text_string, "FAN_STATUS");
         } else {
             sprintf(text_string, "BINARY INPUT %lu",
@@ -400,9 +388,11 @@ BACNET_POLARITY Binary_Input_Polarity(
     BACNET_POLARITY polarity = POLARITY_NORMAL;
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        polarity = Polarity[index];
+        if (Flags[index] & BI_REVERSE) {
+            polarity = POLARITY_REVERSE;
+        }
     }
 
     return polarity;
@@ -415,9 +405,13 @@ bool Binary_Input_Polarity_Set(
     bool status = false;
     unsigned index = 0;
 
-    index = Binary_Input_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BI_Pool, object_instance);
     if (index < MAX_BINARY_INPUTS) {
-        Polarity[index] = polarity;
+        if (polarity == POLARITY_REVERSE) {
+            Flags[index] |= BI_REVERSE;
+        } else {
+            Flags[index] &= ~BI_REVERSE;
+        }
     }
 
     return status;
@@ -533,7 +527,12 @@ bool Binary_Input_Write_Property(
                 WPValidateArgType(&value, BACNET_APPLICATION_TAG_ENUMERATED,
                 &wp_data->error_class, &wp_data->error_code);
             if (status) {
-                if (value.type.Enumerated <= MAX_BINARY_PV) {
+                if (!Binary_Input_Out_Of_Service(wp_data->object_instance)) {
+                    /* the input owns it until taken out of service */
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+                } else if (value.type.Enumerated <= MAX_BINARY_PV) {
                     Binary_Input_Present_Value_Set(wp_data->object_instance,
                         (BACNET_BINARY_PV) value.type.Enumerated);
                 } else {
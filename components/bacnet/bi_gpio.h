@@ -1,15 +0,0 @@
-#ifndef BI_GPIO_H
-#define BI_GPIO_H
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-void bi_gpio_init(void);
-bool bi_gpio_35_read(void);
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif /* BI_GPIO_H */
\ No newline at end of file
@@ -35,22 +35,38 @@
 #include "config.h"     /* the custom stuff */
 #include "rp.h"
 #include "wp.h"
+#include "cov.h"
+#include "objpool.h"
 #include "bo.h"
 #include "handlers.h"
 
-#ifndef MAX_BINARY_OUTPUTS
-#define MAX_BINARY_OUTPUTS 1  // Changed to 1 for FAN_COMMAND
+/* the application's own objects, instances 0..n-1: FAN_COMMAND */
+#ifndef BINARY_OUTPUTS_FIXED
+#define BINARY_OUTPUTS_FIXED 1
 #endif
+/* and room for those made by CreateObject */
+#define MAX_BINARY_OUTPUTS (BINARY_OUTPUTS_FIXED + BACNET_CREATED_OBJECTS)
+
+/* the arrays are indexed by the slot the pool gave the object */
+OBJECT_POOL_DEFINE(BO_Pool, MAX_BINARY_OUTPUTS);
 
 /* When all the priorities are level null, the present value returns */
 /* the Relinquish Default value */
 #define RELINQUISH_DEFAULT BINARY_INACTIVE
-/* Here is our Priority Array.*/
-static BACNET_BINARY_PV
+/* Here is our Priority Array, a BACNET_BINARY_PV in each byte.  It is
+   only read when a level is written or the array is asked for. */
+static uint8_t
     Binary_Output_Level[MAX_BINARY_OUTPUTS][BACNET_MAX_PRIORITY];
+/* the Present_Value it gives, kept up to date on each write */
+static uint8_t Present_Value[MAX_BINARY_OUTPUTS];
+/* and the BO_ flags, so a COV scan reads two bytes per object */
+static uint8_t Flags[MAX_BINARY_OUTPUTS];
+
 /* Writable out-of-service allows others to play with our Present Value */
 /* without changing the physical output */
-static bool Out_Of_Service[MAX_BINARY_OUTPUTS];
+#define BO_OUT_OF_SERVICE 0x01
+/* Change of Value flag */
+#define BO_CHANGED 0x02
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Binary_Output_Properties_Required[] = {
@@ -93,67 +109,84 @@ void Binary_Output_Property_Lists(
     return;
 }
 
+/* a new object in a slot: the priority array all NULL */
+static void Binary_Output_Object_Init(
+    unsigned index)
+{
+    unsigned j;
+
+    for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
+        Binary_Output_Level[index][j] = BINARY_NULL;
+    }
+    Present_Value[index] = RELINQUISH_DEFAULT;
+    Flags[index] = 0;
+}
+
 void Binary_Output_Init(
     void)
 {
-    unsigned i, j;
+    unsigned i;
     static bool initialized = false;
 
     if (!initialized) {
         initialized = true;
 
-        /* initialize all the analog output priority arrays to NULL */
-        for (i = 0; i < MAX_BINARY_OUTPUTS; i++) {
-            for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
-                Binary_Output_Level[i][j] = BINARY_NULL;
-            }
+        /* the application's objects, which cannot be deleted */
+        Object_Pool_Init(&BO_Pool);
+        for (i = 0; i < BINARY_OUTPUTS_FIXED; i++) {
+            Binary_Output_Object_Init(Object_Pool_Create(&BO_Pool, i,
+                    false));
         }
     }
 
     return;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need validate that the */
-/* given instance exists */
-bool Binary_Output_Valid_Instance(
+/* an object for CreateObject, which can be deleted again */
+bool Binary_Output_Create(
     uint32_t object_instance)
 {
-    if (object_instance < MAX_BINARY_OUTPUTS)
+    unsigned index = 0;
+
+    index = Object_Pool_Create(&BO_Pool, object_instance, true);
+    if (index < MAX_BINARY_OUTPUTS) {
+        Binary_Output_Object_Init(index);
         return true;
+    }
 
     return false;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then count how many you have */
+/* only objects made by CreateObject can be deleted */
+bool Binary_Output_Delete(
+    uint32_t object_instance)
+{
+    return (Object_Pool_Delete(&BO_Pool, object_instance) < MAX_BINARY_OUTPUTS);
+}
+
+bool Binary_Output_Valid_Instance(
+    uint32_t object_instance)
+{
+    return (Object_Pool_Slot(&BO_Pool, object_instance) < MAX_BINARY_OUTPUTS);
+}
+
 unsigned Binary_Output_Count(
     void)
 {
-    return MAX_BINARY_OUTPUTS;  // Should be 1
+    return Object_Pool_Count(&BO_Pool);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the instance */
-/* that correlates to the correct index */
+/* the objects are listed in instance order */
 uint32_t Binary_Output_Index_To_Instance(
     unsigned index)
 {
-    return index;
+    return Object_Pool_Index_To_Instance(&BO_Pool, index);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the index */
-/* that correlates to the correct instance number */
 unsigned Binary_Output_Instance_To_Index(
     uint32_t object_instance)
 {
-    unsigned index = MAX_BINARY_OUTPUTS;
-
-    if (object_instance < MAX_BINARY_OUTPUTS)
-        index = object_instance;
-
-    return index;
+    return Object_Pool_Instance_To_Index(&BO_Pool, object_instance);
 }
 
 BACNET_BINARY_PV Binary_Output_Present_Value(
@@ -161,19 +194,42 @@ BACNET_BINARY_PV Binary_Output_Present_Value(
 {
     BACNET_BINARY_PV value = RELINQUISH_DEFAULT;
     unsigned index = 0;
-    unsigned i = 0;
 
-    index = Binary_Output_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
     if (index < MAX_BINARY_OUTPUTS) {
+        value = (BACNET_BINARY_PV) Present_Value[index];
+    }
+
+    return value;
+}
+
+/* writes one slot of the priority array, and flags a COV
+   when the resulting Present_Value differs from before */
+static void Binary_Output_Level_Set(
+    uint32_t object_instance,
+    unsigned priority_index,
+    BACNET_BINARY_PV level)
+{
+    unsigned index = 0;
+    unsigned i = 0;
+    uint8_t value = RELINQUISH_DEFAULT;
+
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
+    if ((index < MAX_BINARY_OUTPUTS) &&
+        (priority_index < BACNET_MAX_PRIORITY)) {
+        Binary_Output_Level[index][priority_index] = (uint8_t) level;
         for (i = 0; i < BACNET_MAX_PRIORITY; i++) {
             if (Binary_Output_Level[index][i] != BINARY_NULL) {
                 value = Binary_Output_Level[index][i];
                 break;
             }
         }
+        if (Present_Value[index] != value) {
+            Present_Value[index] = value;
+            Flags[index] |= BO_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_OUTPUT, object_instance);
+        }
     }
-
-    return value;
 }
 
 bool Binary_Output_Out_Of_Service(
@@ -182,14 +238,110 @@ bool Binary_Output_Out_Of_Service(
     bool value = false;
     unsigned index = 0;
 
-    index = Binary_Output_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
     if (index < MAX_BINARY_OUTPUTS) {
-        value = Out_Of_Service[index];
+        value = (Flags[index] & BO_OUT_OF_SERVICE) ? true : false;
     }
 
     return value;
 }
 
+void Binary_Output_Out_Of_Service_Set(
+    uint32_t object_instance,
+    bool value)
+{
+    unsigned index = 0;
+
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
+    if (index < MAX_BINARY_OUTPUTS) {
+        if (((Flags[index] & BO_OUT_OF_SERVICE) ? true : false) != value) {
+            Flags[index] |= BO_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_OUTPUT, object_instance);
+        }
+        if (value) {
+            Flags[index] |= BO_OUT_OF_SERVICE;
+        } else {
+            Flags[index] &= ~BO_OUT_OF_SERVICE;
+        }
+    }
+}
+
+bool Binary_Output_Change_Of_Value(
+    uint32_t object_instance)
+{
+    bool status = false;
+    unsigned index;
+
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
+    if (index < MAX_BINARY_OUTPUTS) {
+        status = (Flags[index] & BO_CHANGED) ? true : false;
+    }
+
+    return status;
+}
+
+void Binary_Output_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index;
+
+    index = Object_Pool_Slot(&BO_Pool, object_instance);
+    if (index < MAX_BINARY_OUTPUTS) {
+        Flags[index] &= ~BO_CHANGED;
+    }
+
+    return;
+}
+
+/**
+ * Encode the Value List for Present-Value and Status-Flags
+ *
+ * @param object_instance - object-instance number of the object
+ * @param  value_list - #BACNET_PROPERTY_VALUE with at least 2 entries
+ *
+ * @return true if values were encoded
+ */
+bool Binary_Output_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    bool status = false;
+
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_ENUMERATED;
+        value_list->value.next = NULL;
+        value_list->value.type.Enumerated =
+            Binary_Output_Present_Value(object_instance);
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list = value_list->next;
+    }
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+        value_list->value.next = NULL;
+        bitstring_init(&value_list->value.type.Bit_String);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_IN_ALARM, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_FAULT, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OVERRIDDEN, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OUT_OF_SERVICE,
+            Binary_Output_Out_Of_Service(object_instance));
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list->next = NULL;
+        status = true;
+    }
+
+    return status;
+}
+
 /* note: the object name must be unique within this device */
 bool Binary_Output_Object_Name(
     uint32_t object_instance,
@@ -198,7 +350,7 @@ bool Binary_Output_Object_Name(
     static char text_string[32] = "";   /* okay for single thread */
     bool status = false;
 
-    if (object_instance < MAX_BINARY_OUTPUTS) {
+    if (Binary_Output_Valid_Instance(object_instance)) {
         if (object_instance == 0) {
             sprintf(text_string, "FAN_COMMAND");
         } else {
@@ -228,17 +380,17 @@ bool Binary_Output_Present_Value_Set(
         return false;
     }
     
-    index = Binary_Output_Instance_To_Index(instance);
+    index = Object_Pool_Slot(&BO_Pool, instance);
     if (index >= MAX_BINARY_OUTPUTS) {
         return false;
     }
     
     /* Priority is 1-based, array is 0-based */
     array_index = priority - 1;
-    Binary_Output_Level[index][array_index] = binary_value;
+    Binary_Output_Level_Set(instance, array_index, binary_value);
     
     /* Update physical GPIO output if not out of service */
-    if (!Out_Of_Service[index]) {
+    if (!(Flags[index] & BO_OUT_OF_SERVICE)) {
         /* Add your GPIO control here */
         /* Example:
         if (binary_value == BINARY_ACTIVE) {
@@ -311,8 +463,8 @@ int Binary_Output_Read_Property(
             break;
         case PROP_OUT_OF_SERVICE:
             object_index =
-                Binary_Output_Instance_To_Index(rpdata->object_instance);
-            state = Out_Of_Service[object_index];
+                Object_Pool_Slot(&BO_Pool, rpdata->object_instance);
+            state = (Flags[object_index] & BO_OUT_OF_SERVICE) ? true : false;
             apdu_len = encode_application_boolean(&apdu[0], state);
             break;
         case PROP_POLARITY:
@@ -327,7 +479,7 @@ int Binary_Output_Read_Property(
             /* into one packet. */
             else if (rpdata->array_index == BACNET_ARRAY_ALL) {
                 object_index =
-                    Binary_Output_Instance_To_Index(rpdata->object_instance);
+                    Object_Pool_Slot(&BO_Pool, rpdata->object_instance);
                 for (i = 0; i < BACNET_MAX_PRIORITY; i++) {
                     /* FIXME: check if we have room before adding it to APDU */
                     if (Binary_Output_Level[object_index][i] == BINARY_NULL)
@@ -350,7 +502,7 @@ int Binary_Output_Read_Property(
                 }
             } else {
                 object_index =
-                    Binary_Output_Instance_To_Index(rpdata->object_instance);
+                    Object_Pool_Slot(&BO_Pool, rpdata->object_instance);
                 if (rpdata->array_index <= BACNET_MAX_PRIORITY) {
                     if (Binary_Output_Level[object_index][rpdata->array_index -
                             1] == BINARY_NULL)
@@ -442,13 +594,13 @@ bool Binary_Output_Write_Property(
                     (value.type.Enumerated <= MAX_BINARY_PV)) {
                     level = (BACNET_BINARY_PV) value.type.Enumerated;
                     object_index =
-                        Binary_Output_Instance_To_Index
-                        (wp_data->object_instance);
+                        Object_Pool_Slot(&BO_Pool, wp_data->object_instance);
                     priority--;
-                    Binary_Output_Level[object_index][priority] = level;
+                    Binary_Output_Level_Set(wp_data->object_instance,
+                        priority, level);
                     
                     // Update physical GPIO output if not out of service
-                    if (!Out_Of_Service[object_index]) {
+                    if (!(Flags[object_index] & BO_OUT_OF_SERVICE)) {
                         /* Add your GPIO control here */
                         /*
                         if (level == BINARY_ACTIVE) {
@@ -476,13 +628,11 @@ bool Binary_Output_Write_Property(
                     &wp_data->error_class, &wp_data->error_code);
                 if (status) {
                     level = BINARY_NULL;
-                    object_index =
-                        Binary_Output_Instance_To_Index
-                        (wp_data->object_instance);
                     priority = wp_data->priority;
                     if (priority && (priority <= BACNET_MAX_PRIORITY)) {
                         priority--;
-                        Binary_Output_Level[object_index][priority] = level;
+                        Binary_Output_Level_Set(wp_data->object_instance,
+                            priority, level);
                     } else {
                         status = false;
                         wp_data->error_class = ERROR_CLASS_PROPERTY;
@@ -496,10 +646,8 @@ bool Binary_Output_Write_Property(
                 WPValidateArgType(&value, BACNET_APPLICATION_TAG_BOOLEAN,
                 &wp_data->error_class, &wp_data->error_code);
             if (status) {
-                object_index =
-                    Binary_Output_Instance_To_Index(wp_data->object_instance);
-                Out_Of_Service[object_index] =
-                    value.type.Boolean;
+                Binary_Output_Out_Of_Service_Set(wp_data->object_instance,
+                    value.type.Boolean);
             }
             break;
         case PROP_OBJECT_IDENTIFIER:
@@ -35,22 +35,38 @@
 #include "config.h"     /* the custom stuff */
 #include "wp.h"
 #include "rp.h"
+#include "cov.h"
+#include "objpool.h"
 #include "bv.h"
 #include "handlers.h"
 
-#ifndef MAX_BINARY_VALUES
-#define MAX_BINARY_VALUES 1  // Changed to 1 for SENSOR_ERROR
+/* the application's own objects, instances 0..n-1: SENSOR_ERROR */
+#ifndef BINARY_VALUES_FIXED
+#define BINARY_VALUES_FIXED 1
 #endif
+/* and room for those made by CreateObject */
+#define MAX_BINARY_VALUES (BINARY_VALUES_FIXED + BACNET_CREATED_OBJECTS)
+
+/* the arrays are indexed by the slot the pool gave the object */
+OBJECT_POOL_DEFINE(BV_Pool, MAX_BINARY_VALUES);
 
 /* When all the priorities are level null, the present value returns */
 /* the Relinquish Default value */
 #define RELINQUISH_DEFAULT BINARY_INACTIVE
-/* Here is our Priority Array.*/
-static BACNET_BINARY_PV
+/* Here is our Priority Array, a BACNET_BINARY_PV in each byte.  It is
+   only read when a level is written or the array is asked for. */
+static uint8_t
     Binary_Value_Level[MAX_BINARY_VALUES][BACNET_MAX_PRIORITY];
+/* the Present_Value it gives, kept up to date on each write */
+static uint8_t Present_Value[MAX_BINARY_VALUES];
+/* and the BV_ flags, so a COV scan reads two bytes per object */
+static uint8_t Flags[MAX_BINARY_VALUES];
+
 /* Writable out-of-service allows others to play with our Present Value */
 /* without changing the physical output */
-static bool Out_Of_Service[MAX_BINARY_VALUES];
+#define BV_OUT_OF_SERVICE 0x01
+/* Change of Value flag */
+#define BV_CHANGED 0x02
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Binary_Value_Properties_Required[] = {
@@ -90,67 +106,84 @@ void Binary_Value_Property_Lists(
     return;
 }
 
+/* a new object in a slot: the priority array all NULL */
+static void Binary_Value_Object_Init(
+    unsigned index)
+{
+    unsigned j;
+
+    for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
+        Binary_Value_Level[index][j] = BINARY_NULL;
+    }
+    Present_Value[index] = RELINQUISH_DEFAULT;
+    Flags[index] = 0;
+}
+
 void Binary_Value_Init(
     void)
 {
-    unsigned i, j;
+    unsigned i;
     static bool initialized = false;
 
     if (!initialized) {
         initialized = true;
 
-        /* initialize all the analog output priority arrays to NULL */
-        for (i = 0; i < MAX_BINARY_VALUES; i++) {
-            for (j = 0; j < BACNET_MAX_PRIORITY; j++) {
-                Binary_Value_Level[i][j] = BINARY_NULL;
-            }
+        /* the application's objects, which cannot be deleted */
+        Object_Pool_Init(&BV_Pool);
+        for (i = 0; i < BINARY_VALUES_FIXED; i++) {
+            Binary_Value_Object_Init(Object_Pool_Create(&BV_Pool, i,
+                    false));
         }
     }
 
     return;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need validate that the */
-/* given instance exists */
-bool Binary_Value_Valid_Instance(
+/* an object for CreateObject, which can be deleted again */
+bool Binary_Value_Create(
     uint32_t object_instance)
 {
-    if (object_instance < MAX_BINARY_VALUES)
+    unsigned index = 0;
+
+    index = Object_Pool_Create(&BV_Pool, object_instance, true);
+    if (index < MAX_BINARY_VALUES) {
+        Binary_Value_Object_Init(index);
         return true;
+    }
 
     return false;
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then count how many you have */
+/* only objects made by CreateObject can be deleted */
+bool Binary_Value_Delete(
+    uint32_t object_instance)
+{
+    return (Object_Pool_Delete(&BV_Pool, object_instance) < MAX_BINARY_VALUES);
+}
+
+bool Binary_Value_Valid_Instance(
+    uint32_t object_instance)
+{
+    return (Object_Pool_Slot(&BV_Pool, object_instance) < MAX_BINARY_VALUES);
+}
+
 unsigned Binary_Value_Count(
     void)
 {
-    return MAX_BINARY_VALUES;  // Should be 1
+    return Object_Pool_Count(&BV_Pool);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the instance */
-/* that correlates to the correct index */
+/* the objects are listed in instance order */
 uint32_t Binary_Value_Index_To_Instance(
     unsigned index)
 {
-    return index;
+    return Object_Pool_Index_To_Instance(&BV_Pool, index);
 }
 
-/* we simply have 0-n object instances.  Yours might be */
-/* more complex, and then you need to return the index */
-/* that correlates to the correct instance number */
 unsigned Binary_Value_Instance_To_Index(
     uint32_t object_instance)
 {
-    unsigned index = MAX_BINARY_VALUES;
-
-    if (object_instance < MAX_BINARY_VALUES)
-        index = object_instance;
-
-    return index;
+    return Object_Pool_Instance_To_Index(&BV_Pool, object_instance);
 }
 
 BACNET_BINARY_PV Binary_Value_Present_Value(
@@ -158,28 +191,134 @@ BACNET_BINARY_PV Binary_Value_Present_Value(
 {
     BACNET_BINARY_PV value = RELINQUISH_DEFAULT;
     unsigned index = 0;
-    unsigned i = 0;
 
-    index = Binary_Value_Instance_To_Index(object_instance);
+    index = Object_Pool_Slot(&BV_Pool, object_instance);
     if (index < MAX_BINARY_VALUES) {
+        value = (BACNET_BINARY_PV) Present_Value[index];
+    }
+
+    return value;
+}
+
+/* writes one slot of the priority array, and flags a COV
+   when the resulting Present_Value differs from before */
+static void Binary_Value_Level_Set(
+    uint32_t object_instance,
+    unsigned priority_index,
+    BACNET_BINARY_PV level)
+{
+    unsigned index = 0;
+    unsigned i = 0;
+    uint8_t value = RELINQUISH_DEFAULT;
+
+    index = Object_Pool_Slot(&BV_Pool, object_instance);
+    if ((index < MAX_BINARY_VALUES) &&
+        (priority_index < BACNET_MAX_PRIORITY)) {
+        Binary_Value_Level[index][priority_index] = (uint8_t) level;
         for (i = 0; i < BACNET_MAX_PRIORITY; i++) {
             if (Binary_Value_Level[index][i] != BINARY_NULL) {
                 value = Binary_Value_Level[index][i];
                 break;
             }
         }
+        if (Present_Value[index] != value) {
+            Present_Value[index] = value;
+            Flags[index] |= BV_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_VALUE, object_instance);
+        }
     }
-
-    return value;
 }
 
+/* local application writes go in at the lowest priority,
+   so an operator command still overrides them */
 bool Binary_Value_Present_Value_Set(
     uint32_t instance,
     BACNET_BINARY_PV value)
 {
-    (void)instance;
-    (void)value;
-    return false;  // Dummy implementation
+    bool status = false;
+
+    if (Binary_Value_Valid_Instance(instance) && (value <= MAX_BINARY_PV)) {
+        Binary_Value_Level_Set(instance, BACNET_MAX_PRIORITY - 1, value);
+        status = true;
+    }
+
+    return status;
+}
+
+bool Binary_Value_Change_Of_Value(
+    uint32_t object_instance)
+{
+    bool status = false;
+    unsigned index;
+
+    index = Object_Pool_Slot(&BV_Pool, object_instance);
+    if (index < MAX_BINARY_VALUES) {
+        status = (Flags[index] & BV_CHANGED) ? true : false;
+    }
+
+    return status;
+}
+
+void Binary_Value_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index;
+
+    index = Object_Pool_Slot(&BV_Pool, object_instance);
+    if (index < MAX_BINARY_VALUES) {
+        Flags[index] &= ~BV_CHANGED;
+    }
+
+    return;
+}
+
+/**
+ * Encode the Value List for Present-Value and Status-Flags
+ *
+ * @param object_instance - object-instance number of the object
+ * @param  value_list - #BACNET_PROPERTY_VALUE with at least 2 entries
+ *
+ * @return true if values were encoded
+ */
+bool Binary_Value_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    bool status = false;
+
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_ENUMERATED;
+        value_list->value.next = NULL;
+        value_list->value.type.Enumerated =
+            Binary_Value_Present_Value(object_instance);
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list = value_list->next;
+    }
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+        value_list->value.next = NULL;
+        bitstring_init(&value_list->value.type.Bit_String);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_IN_ALARM, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_FAULT, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OVERRIDDEN, false);
+        bitstring_set_bit(&value_list->value.type.Bit_String,
+            STATUS_FLAG_OUT_OF_SERVICE,
+            Binary_Value_Out_Of_Service(object_instance));
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list->next = NULL;
+        status = true;
+    }
+
+    return status;
 }
 
 /* note: the object name must be unique within this device */
@@ -190,7 +329,7 @@ bool Binary_Value_Object_Name(
     static char text_string[32] = "";   /* okay for single thread */
     bool status = false;
 
-    if (object_instance < MAX_BINARY_VALUES) {
+    if (Binary_Value_Valid_Instance(object_instance)) {
         if (object_instance == 0) {
             sprintf(text_string, "SENSOR_ERROR");
         } else {
@@ -209,9 +348,9 @@ bool Binary_Value_Out_Of_Service(
     unsigned index = 0;
     bool oos_flag = false;
 
-    index = Binary_Value_Instance_To_Index(instance);
+    index = Object_Pool_Slot(&BV_Pool, instance);
     if (index < MAX_BINARY_VALUES) {
-        oos_flag = Out_Of_Service[index];
+        oos_flag = (Flags[index] & BV_OUT_OF_SERVICE) ? true : false;
     }
 
     return oos_flag;
@@ -223,9 +362,17 @@ void Binary_Value_Out_Of_Service_Set(
 {
     unsigned index = 0;
 
-    index = Binary_Value_Instance_To_Index(instance);
+    index = Object_Pool_Slot(&BV_Pool, instance);
     if (index < MAX_BINARY_VALUES) {
-        Out_Of_Service[index] = oos_flag;
+        if (((Flags[index] & BV_OUT_OF_SERVICE) ? true : false) != oos_flag) {
+            Flags[index] |= BV_CHANGED;
+            handler_cov_object_changed(OBJECT_BINARY_VALUE, instance);
+        }
+        if (oos_flag) {
+            Flags[index] |= BV_OUT_OF_SERVICE;
+        } else {
+            Flags[index] &= ~BV_OUT_OF_SERVICE;
+        }
     }
 }
 
@@ -299,7 +446,7 @@ int Binary_Value_Read_Property(
             /* into one packet. */
             else if (rpdata->array_index == BACNET_ARRAY_ALL) {
                 object_index =
-                    Binary_Value_Instance_To_Index(rpdata->object_instance);
+                    Object_Pool_Slot(&BV_Pool, rpdata->object_instance);
                 for (i = 0; i < BACNET_MAX_PRIORITY; i++) {
                     /* FIXME: check if we have room before adding it to APDU */
                     if (Binary_Value_Level[object_index][i] == BINARY_NULL)
@@ -322,7 +469,7 @@ int Binary_Value_Read_Property(
                 }
             } else {
                 object_index =
-                    Binary_Value_Instance_To_Index(rpdata->object_instance);
+                    Object_Pool_Slot(&BV_Pool, rpdata->object_instance);
                 if (rpdata->array_index <= BACNET_MAX_PRIORITY) {
                     if (Binary_Value_Level[object_index][rpdata->array_index]
                         == BINARY_NULL)
@@ -367,7 +514,6 @@ bool Binary_Value_Write_Property(
     BACNET_WRITE_PROPERTY_DATA * wp_data)
 {
     bool status = false;        /* return value */
-    unsigned int object_index = 0;
     unsigned int priority = 0;
     BACNET_BINARY_PV level = BINARY_NULL;
     int len = 0;
@@ -402,11 +548,9 @@ bool Binary_Value_Write_Property(
                     (priority != 6 /* reserved */ ) &&
                     (value.type.Enumerated <= MAX_BINARY_PV)) {
                     level = (BACNET_BINARY_PV) value.type.Enumerated;
-                    object_index =
-                        Binary_Value_Instance_To_Index
-                        (wp_data->object_instance);
                     priority--;
-                    Binary_Value_Level[object_index][priority] = level;
+                    Binary_Value_Level_Set(wp_data->object_instance,
+                        priority, level);
                     status = true;
                 } else if (priority == 6) {
                     /* Command priority 6 is reserved for use by Minimum On/Off
@@ -424,13 +568,11 @@ bool Binary_Value_Write_Property(
                     &wp_data->error_class, &wp_data->error_code);
                 if (status) {
                     level = BINARY_NULL;
-                    object_index =
-                        Binary_Value_Instance_To_Index
-                        (wp_data->object_instance);
                     priority = wp_data->priority;
                     if (priority && (priority <= BACNET_MAX_PRIORITY)) {
                         priority--;
-                        Binary_Value_Level[object_index][priority] = level;
+                        Binary_Value_Level_Set(wp_data->object_instance,
+                            priority, level);
                     } else {
                         status = false;
                         wp_data->error_class = ERROR_CLASS_PROPERTY;
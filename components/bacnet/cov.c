@@ -43,8 +43,11 @@
 /* Change-Of-Value Services
 COV Subscribe
 COV Subscribe Property
+COV Subscribe Property Multiple
 COV Notification
 Unconfirmed COV Notification
+COV Notification Multiple
+Unconfirmed COV Notification Multiple
 */
 static int notify_encode_apdu(
     uint8_t * apdu,
@@ -678,6 +681,557 @@ void cov_data_value_list_link(
     }
 }
 
+/*
+COVNotificationMultiple-Request ::= SEQUENCE {
+        subscriberProcessIdentifier  [0] Unsigned32,
+        initiatingDeviceIdentifier   [1] BACnetObjectIdentifier,
+        timeRemaining                [2] Unsigned,
+        timestamp                    [3] BACnetDateTime OPTIONAL,
+        listOfCOVNotifications       [4] SEQUENCE OF SEQUENCE {
+            monitoredObjectIdentifier  [0] BACnetObjectIdentifier,
+            listOfValues               [1] SEQUENCE OF SEQUENCE {
+                propertyIdentifier  [0] BACnetPropertyIdentifier,
+                propertyArrayIndex  [1] Unsigned OPTIONAL,
+                value               [2] ABSTRACT-SYNTAX.&Type,
+                timeOfChange        [3] Time OPTIONAL
+                }
+            }
+        }
+
+The notification is encoded in pieces, one monitored object at a time,
+so that a caller only needs the values of one object in memory:
+    *_notify_multiple_encode_apdu_init()
+    cov_notify_multiple_encode_object() - once per object
+    cov_notify_multiple_encode_apdu_end()
+*/
+
+static int notify_multiple_encode_apdu_init(
+    uint8_t * apdu,
+    BACNET_COV_DATA * data)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu && data) {
+        /* tag 0 - subscriberProcessIdentifier */
+        len =
+            encode_context_unsigned(&apdu[apdu_len], 0,
+            data->subscriberProcessIdentifier);
+        apdu_len += len;
+        /* tag 1 - initiatingDeviceIdentifier */
+        len =
+            encode_context_object_id(&apdu[apdu_len], 1, OBJECT_DEVICE,
+            data->initiatingDeviceIdentifier);
+        apdu_len += len;
+        /* tag 2 - timeRemaining */
+        len = encode_context_unsigned(&apdu[apdu_len], 2, data->timeRemaining);
+        apdu_len += len;
+        /* tag 4 - listOfCOVNotifications */
+        len = encode_opening_tag(&apdu[apdu_len], 4);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+int ccov_notify_multiple_encode_apdu_init(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    BACNET_COV_DATA * data)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu && data) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_COV_NOTIFICATION_MULTIPLE;
+        apdu_len = 4;
+        len = notify_multiple_encode_apdu_init(&apdu[apdu_len], data);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+int ucov_notify_multiple_encode_apdu_init(
+    uint8_t * apdu,
+    BACNET_COV_DATA * data)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu && data) {
+        apdu[0] = PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST;
+        apdu[1] = SERVICE_UNCONFIRMED_COV_NOTIFICATION_MULTIPLE;
+        apdu_len = 2;
+        len = notify_multiple_encode_apdu_init(&apdu[apdu_len], data);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+/* encodes data->monitoredObjectIdentifier and data->listOfValues */
+int cov_notify_multiple_encode_object(
+    uint8_t * apdu,
+    BACNET_COV_DATA * data)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+    BACNET_PROPERTY_VALUE *value = NULL;        /* value in list */
+    BACNET_APPLICATION_DATA_VALUE *app_data = NULL;
+
+    if (apdu && data) {
+        /* tag 0 - monitoredObjectIdentifier */
+        len =
+            encode_context_object_id(&apdu[apdu_len], 0,
+            (int) data->monitoredObjectIdentifier.type,
+            data->monitoredObjectIdentifier.instance);
+        apdu_len += len;
+        /* tag 1 - listOfValues */
+        len = encode_opening_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+        value = data->listOfValues;
+        while (value != NULL) {
+            /* tag 0 - propertyIdentifier */
+            len =
+                encode_context_enumerated(&apdu[apdu_len], 0,
+                value->propertyIdentifier);
+            apdu_len += len;
+            /* tag 1 - propertyArrayIndex OPTIONAL */
+            if (value->propertyArrayIndex != BACNET_ARRAY_ALL) {
+                len =
+                    encode_context_unsigned(&apdu[apdu_len], 1,
+                    value->propertyArrayIndex);
+                apdu_len += len;
+            }
+            /* tag 2 - value */
+            len = encode_opening_tag(&apdu[apdu_len], 2);
+            apdu_len += len;
+            app_data = &value->value;
+            while (app_data != NULL) {
+                len =
+                    bacapp_encode_application_data(&apdu[apdu_len],
+                    app_data);
+                apdu_len += len;
+                app_data = app_data->next;
+            }
+            len = encode_closing_tag(&apdu[apdu_len], 2);
+            apdu_len += len;
+            value = value->next;
+        }
+        len = encode_closing_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+int cov_notify_multiple_encode_apdu_end(
+    uint8_t * apdu)
+{
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu) {
+        /* tag 4 - listOfCOVNotifications */
+        apdu_len = encode_closing_tag(&apdu[0], 4);
+    }
+
+    return apdu_len;
+}
+
+/*
+SubscribeCOVPropertyMultiple-Request ::= SEQUENCE {
+        subscriberProcessIdentifier  [0] Unsigned32,
+        issueConfirmedNotifications  [1] BOOLEAN OPTIONAL,
+        lifetime                     [2] Unsigned OPTIONAL,
+        maxNotificationDelay         [3] Unsigned OPTIONAL,
+        listOfCOVSubscriptionSpecifications [4] SEQUENCE OF SEQUENCE {
+            monitoredObjectIdentifier  [0] BACnetObjectIdentifier,
+            listOfCOVReferences        [1] SEQUENCE OF SEQUENCE {
+                monitoredProperty  [0] BACnetPropertyReference,
+                covIncrement       [1] REAL OPTIONAL,
+                timestamped        [2] BOOLEAN
+                }
+            }
+        }
+
+Each COV reference is decoded into its own BACNET_SUBSCRIBE_COV_DATA,
+with the subscriber, confirmation and lifetime repeated in each, and
+the entries linked through their next field.
+*/
+
+/* decodes one context tagged BACnetPropertyReference, tag already checked */
+static int cov_property_reference_decode(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    uint8_t tag,
+    BACNET_PROPERTY_REFERENCE * reference)
+{
+    int len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value = 0;
+    uint32_t decoded_value = 0;
+    uint32_t property = 0;
+
+    /* opening tag */
+    len++;
+    if (((unsigned) len < apdu_len) && decode_is_context_tag(&apdu[len], 0)) {
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len += decode_enumerated(&apdu[len], len_value, &property);
+        reference->propertyIdentifier = (BACNET_PROPERTY_ID) property;
+    } else {
+        return BACNET_STATUS_REJECT;
+    }
+    if (((unsigned) len < apdu_len) && decode_is_context_tag(&apdu[len], 1)) {
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len += decode_unsigned(&apdu[len], len_value, &decoded_value);
+        reference->propertyArrayIndex = decoded_value;
+    } else {
+        reference->propertyArrayIndex = BACNET_ARRAY_ALL;
+    }
+    if (((unsigned) len >= apdu_len) ||
+        !decode_is_closing_tag_number(&apdu[len], tag)) {
+        return BACNET_STATUS_REJECT;
+    }
+    len++;
+
+    return len;
+}
+
+int cov_subscribe_property_multiple_decode_service_request(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    uint32_t * max_notification_delay,
+    BACNET_SUBSCRIBE_COV_DATA * data,
+    unsigned data_size,
+    unsigned *data_count)
+{
+    int len = 0;        /* return value */
+    int section_len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value = 0;
+    uint32_t decoded_value = 0; /* for decoding */
+    uint16_t decoded_type = 0;  /* for decoding */
+    BACNET_SUBSCRIBE_COV_DATA header = { 0 };
+    BACNET_OBJECT_ID object_id;
+    BACNET_SUBSCRIBE_COV_DATA *entry = NULL;
+    unsigned count = 0;
+
+    if (!apdu_len || !data || !data_size) {
+        return BACNET_STATUS_REJECT;
+    }
+    /* tag 0 - subscriberProcessIdentifier */
+    if (decode_is_context_tag(&apdu[len], 0)) {
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len += decode_unsigned(&apdu[len], len_value, &decoded_value);
+        header.subscriberProcessIdentifier = decoded_value;
+    } else {
+        data->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+        return BACNET_STATUS_REJECT;
+    }
+    /* tag 1 - issueConfirmedNotifications - optional */
+    header.cancellationRequest = true;
+    header.issueConfirmedNotifications = false;
+    if (((unsigned) len < apdu_len) && decode_is_context_tag(&apdu[len], 1)) {
+        header.cancellationRequest = false;
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        header.issueConfirmedNotifications =
+            decode_context_boolean(&apdu[len]);
+        len++;
+    }
+    /* tag 2 - lifetime - optional */
+    header.lifetime = 0;
+    if (((unsigned) len < apdu_len) && decode_is_context_tag(&apdu[len], 2)) {
+        header.cancellationRequest = false;
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len += decode_unsigned(&apdu[len], len_value, &decoded_value);
+        header.lifetime = decoded_value;
+    }
+    /* tag 3 - maxNotificationDelay - optional */
+    *max_notification_delay = 0;
+    if (((unsigned) len < apdu_len) && decode_is_context_tag(&apdu[len], 3)) {
+        header.cancellationRequest = false;
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len += decode_unsigned(&apdu[len], len_value, &decoded_value);
+        *max_notification_delay = decoded_value;
+    }
+    /* tag 4 - listOfCOVSubscriptionSpecifications */
+    if (((unsigned) len >= apdu_len) ||
+        !decode_is_opening_tag_number(&apdu[len], 4)) {
+        data->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+        return BACNET_STATUS_REJECT;
+    }
+    len++;
+    while (((unsigned) len < apdu_len) &&
+        !decode_is_closing_tag_number(&apdu[len], 4)) {
+        /* tag 0 - monitoredObjectIdentifier */
+        if (!decode_is_context_tag(&apdu[len], 0)) {
+            data->error_code = ERROR_CODE_REJECT_INVALID_TAG;
+            return BACNET_STATUS_REJECT;
+        }
+        len +=
+            decode_tag_number_and_value(&apdu[len], &tag_number, &len_value);
+        len +=
+            decode_object_id(&apdu[len], &decoded_type, &object_id.instance);
+        object_id.type = decoded_type;
+        /* tag 1 - listOfCOVReferences */
+        if (((unsigned) len >= apdu_len) ||
+            !decode_is_opening_tag_number(&apdu[len], 1)) {
+            data->error_code = ERROR_CODE_REJECT_INVALID_TAG;
+            return BACNET_STATUS_REJECT;
+        }
+        len++;
+        while (((unsigned) len < apdu_len) &&
+            !decode_is_closing_tag_number(&apdu[len], 1)) {
+            if (count >= data_size) {
+                data->error_code = ERROR_CODE_ABORT_BUFFER_OVERFLOW;
+                return BACNET_STATUS_ABORT;
+            }
+            entry = &data[count];
+            *entry = header;
+            entry->monitoredObjectIdentifier = object_id;
+            /* tag 0 - monitoredProperty */
+            if (!decode_is_opening_tag_number(&apdu[len], 0)) {
+                data->error_code = ERROR_CODE_REJECT_INVALID_TAG;
+                return BACNET_STATUS_REJECT;
+            }
+            section_len =
+                cov_property_reference_decode(&apdu[len], apdu_len - len, 0,
+                &entry->monitoredProperty);
+            if (section_len < 0) {
+                data->error_code = ERROR_CODE_REJECT_INVALID_TAG;
+                return BACNET_STATUS_REJECT;
+            }
+            len += section_len;
+            /* tag 1 - covIncrement - optional */
+            entry->covIncrementPresent = false;
+            if (((unsigned) len < apdu_len) &&
+                decode_is_context_tag(&apdu[len], 1)) {
+                entry->covIncrementPresent = true;
+                len +=
+                    decode_tag_number_and_value(&apdu[len], &tag_number,
+                    &len_value);
+                len += decode_real(&apdu[len], &entry->covIncrement);
+            }
+            /* tag 2 - timestamped */
+            if (((unsigned) len < apdu_len) &&
+                decode_is_context_tag(&apdu[len], 2)) {
+                len +=
+                    decode_tag_number_and_value(&apdu[len], &tag_number,
+                    &len_value);
+                len++;
+            } else {
+                data->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+                return BACNET_STATUS_REJECT;
+            }
+            if (count) {
+                data[count - 1].next = entry;
+            }
+            entry->next = NULL;
+            count++;
+        }
+        if ((unsigned) len >= apdu_len) {
+            data->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+            return BACNET_STATUS_REJECT;
+        }
+        /* closing tag 1 */
+        len++;
+    }
+    if ((unsigned) len >= apdu_len) {
+        data->error_code = ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+        return BACNET_STATUS_REJECT;
+    }
+    /* closing tag 4 */
+    len++;
+    if (data_count) {
+        *data_count = count;
+    }
+
+    return len;
+}
+
+/* encode a SubscribeCOVPropertyMultiple request from a list of
+   references linked by next; consecutive references of one object
+   share one listOfCOVReferences.  The process, the confirmation, the
+   lifetime and a cancellation are taken from the first reference.
+   No reference is timestamped. */
+int cov_subscribe_property_multiple_encode_apdu(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    uint32_t max_notification_delay,
+    BACNET_SUBSCRIBE_COV_DATA * data)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+    BACNET_SUBSCRIBE_COV_DATA *entry = NULL;
+    BACNET_SUBSCRIBE_COV_DATA *object = NULL;   /* first of its object */
+
+    if (apdu && data) {
+        apdu[0] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        apdu[1] = encode_max_segs_max_apdu(0, MAX_APDU);
+        apdu[2] = invoke_id;
+        apdu[3] = SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE;
+        apdu_len = 4;
+        /* tag 0 - subscriberProcessIdentifier */
+        len =
+            encode_context_unsigned(&apdu[apdu_len], 0,
+            data->subscriberProcessIdentifier);
+        apdu_len += len;
+        if (!data->cancellationRequest) {
+            /* tag 1 - issueConfirmedNotifications */
+            len =
+                encode_context_boolean(&apdu[apdu_len], 1,
+                data->issueConfirmedNotifications);
+            apdu_len += len;
+            /* tag 2 - lifetime */
+            len = encode_context_unsigned(&apdu[apdu_len], 2, data->lifetime);
+            apdu_len += len;
+            /* tag 3 - maxNotificationDelay */
+            len =
+                encode_context_unsigned(&apdu[apdu_len], 3,
+                max_notification_delay);
+            apdu_len += len;
+        }
+        /* tag 4 - listOfCOVSubscriptionSpecifications */
+        len = encode_opening_tag(&apdu[apdu_len], 4);
+        apdu_len += len;
+        for (entry = data; entry; entry = entry->next) {
+            if ((!object) ||
+                (entry->monitoredObjectIdentifier.type !=
+                    object->monitoredObjectIdentifier.type) ||
+                (entry->monitoredObjectIdentifier.instance !=
+                    object->monitoredObjectIdentifier.instance)) {
+                if (object) {
+                    len = encode_closing_tag(&apdu[apdu_len], 1);
+                    apdu_len += len;
+                }
+                /* tag 0 - monitoredObjectIdentifier */
+                len =
+                    encode_context_object_id(&apdu[apdu_len], 0,
+                    (int) entry->monitoredObjectIdentifier.type,
+                    entry->monitoredObjectIdentifier.instance);
+                apdu_len += len;
+                /* tag 1 - listOfCOVReferences */
+                len = encode_opening_tag(&apdu[apdu_len], 1);
+                apdu_len += len;
+                object = entry;
+            }
+            /* tag 0 - monitoredProperty */
+            len = encode_opening_tag(&apdu[apdu_len], 0);
+            apdu_len += len;
+            len =
+                encode_context_enumerated(&apdu[apdu_len], 0,
+                entry->monitoredProperty.propertyIdentifier);
+            apdu_len += len;
+            if (entry->monitoredProperty.propertyArrayIndex !=
+                BACNET_ARRAY_ALL) {
+                len =
+                    encode_context_unsigned(&apdu[apdu_len], 1,
+                    entry->monitoredProperty.propertyArrayIndex);
+                apdu_len += len;
+            }
+            len = encode_closing_tag(&apdu[apdu_len], 0);
+            apdu_len += len;
+            /* tag 1 - covIncrement - optional */
+            if (entry->covIncrementPresent) {
+                len =
+                    encode_context_real(&apdu[apdu_len], 1,
+                    entry->covIncrement);
+                apdu_len += len;
+            }
+            /* tag 2 - timestamped */
+            len = encode_context_boolean(&apdu[apdu_len], 2, false);
+            apdu_len += len;
+        }
+        len = encode_closing_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+        len = encode_closing_tag(&apdu[apdu_len], 4);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
+/*
+SubscribeCOVPropertyMultiple-Error ::= SEQUENCE {
+        error-type                 [0] Error,
+        first-failed-subscription  [1] SEQUENCE {
+            monitoredObjectIdentifier   [0] BACnetObjectIdentifier,
+            monitoredPropertyReference  [1] BACnetPropertyReference,
+            errorType                   [2] Error
+            }
+        }
+*/
+int cov_subscribe_property_multiple_error_encode_apdu(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code,
+    BACNET_SUBSCRIBE_COV_DATA * failed)
+{
+    int len = 0;        /* length of each encoding */
+    int apdu_len = 0;   /* total length of the apdu, return value */
+
+    if (apdu && failed) {
+        apdu[0] = PDU_TYPE_ERROR;
+        apdu[1] = invoke_id;
+        apdu[2] = SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE;
+        apdu_len = 3;
+        /* tag 0 - error-type */
+        len = encode_opening_tag(&apdu[apdu_len], 0);
+        apdu_len += len;
+        len = encode_application_enumerated(&apdu[apdu_len], error_class);
+        apdu_len += len;
+        len = encode_application_enumerated(&apdu[apdu_len], error_code);
+        apdu_len += len;
+        len = encode_closing_tag(&apdu[apdu_len], 0);
+        apdu_len += len;
+        /* tag 1 - first-failed-subscription */
+        len = encode_opening_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+        len =
+            encode_context_object_id(&apdu[apdu_len], 0,
+            (int) failed->monitoredObjectIdentifier.type,
+            failed->monitoredObjectIdentifier.instance);
+        apdu_len += len;
+        len = encode_opening_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+        len =
+            encode_context_enumerated(&apdu[apdu_len], 0,
+            failed->monitoredProperty.propertyIdentifier);
+        apdu_len += len;
+        if (failed->monitoredProperty.propertyArrayIndex != BACNET_ARRAY_ALL) {
+            len =
+                encode_context_unsigned(&apdu[apdu_len], 1,
+                failed->monitoredProperty.propertyArrayIndex);
+            apdu_len += len;
+        }
+        len = encode_closing_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+        len = encode_opening_tag(&apdu[apdu_len], 2);
+        apdu_len += len;
+        len = encode_application_enumerated(&apdu[apdu_len], error_class);
+        apdu_len += len;
+        len = encode_application_enumerated(&apdu[apdu_len], error_code);
+        apdu_len += len;
+        len = encode_closing_tag(&apdu[apdu_len], 2);
+        apdu_len += len;
+        len = encode_closing_tag(&apdu[apdu_len], 1);
+        apdu_len += len;
+    }
+
+    return apdu_len;
+}
+
 #ifdef TEST
 #include <assert.h>
 #include <string.h>
@@ -0,0 +1,109 @@
+/**************************************************************************
+*
+* CreateObject service (16.7 of the standard): the server side
+*
+*********************************************************************/
+#include <stdint.h>
+#include "bacenum.h"
+#include "bacdcode.h"
+#include "bacdef.h"
+#include "create_object.h"
+
+/** @file create_object.c  Encode/Decode CreateObject APDUs */
+
+/* decode the service request only */
+int create_object_decode_service_request(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    BACNET_CREATE_OBJECT_DATA * data)
+{
+    unsigned len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+    uint32_t value = 0;
+    uint16_t object_type = 0;
+
+    if ((apdu_len < 2) || !data)
+        return -1;
+    data->initial_values = NULL;
+    data->initial_values_len = 0;
+    data->first_failed_element = 0;
+    /* Tag 0: objectSpecifier */
+    if (!decode_is_opening_tag_number(&apdu[len], 0))
+        return -1;
+    len++;
+    len +=
+        decode_tag_number_and_value(&apdu[len], &tag_number, &len_value_type);
+    if (tag_number == 0) {
+        /* objectType: the server picks the instance */
+        len += decode_enumerated(&apdu[len], len_value_type, &value);
+        data->object_type = (BACNET_OBJECT_TYPE) value;
+        data->object_instance = BACNET_MAX_INSTANCE;
+    } else if (tag_number == 1) {
+        /* objectIdentifier */
+        len +=
+            decode_object_id(&apdu[len], &object_type,
+            &data->object_instance);
+        data->object_type = (BACNET_OBJECT_TYPE) object_type;
+    } else {
+        return -1;
+    }
+    if ((len >= apdu_len) || !decode_is_closing_tag_number(&apdu[len], 0))
+        return -1;
+    len++;
+    /* Tag 1: listOfInitialValues - optional, the rest of the request */
+    if (len < apdu_len) {
+        if (!decode_is_opening_tag_number(&apdu[len], 1) ||
+            !decode_is_closing_tag_number(&apdu[apdu_len - 1], 1))
+            return -1;
+        len++;
+        data->initial_values = &apdu[len];
+        data->initial_values_len = (uint16_t) (apdu_len - 1 - len);
+        len = apdu_len;
+    }
+
+    return (int) len;
+}
+
+int create_object_ack_encode_apdu(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    BACNET_CREATE_OBJECT_DATA * data)
+{
+    int len = 0;
+
+    if (apdu) {
+        apdu[len++] = PDU_TYPE_COMPLEX_ACK;
+        apdu[len++] = invoke_id;
+        apdu[len++] = SERVICE_CONFIRMED_CREATE_OBJECT;
+        len +=
+            encode_application_object_id(&apdu[len], data->object_type,
+            data->object_instance);
+    }
+
+    return len;
+}
+
+int create_object_error_ack_encode_apdu(
+    uint8_t * apdu,
+    uint8_t invoke_id,
+    BACNET_CREATE_OBJECT_DATA * data)
+{
+    int len = 0;
+
+    if (apdu) {
+        apdu[len++] = PDU_TYPE_ERROR;
+        apdu[len++] = invoke_id;
+        apdu[len++] = SERVICE_CONFIRMED_CREATE_OBJECT;
+
+        len += encode_opening_tag(&apdu[len], 0);
+        len += encode_application_enumerated(&apdu[len], data->error_class);
+        len += encode_application_enumerated(&apdu[len], data->error_code);
+        len += encode_closing_tag(&apdu[len], 0);
+        len +=
+            encode_context_unsigned(&apdu[len], 1,
+            data->first_failed_element);
+    }
+
+    return len;
+}
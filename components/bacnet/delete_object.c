@@ -0,0 +1,36 @@
+/**************************************************************************
+*
+* DeleteObject service (16.8 of the standard): the server side
+*
+*********************************************************************/
+#include <stdint.h>
+#include "bacenum.h"
+#include "bacdcode.h"
+#include "bacdef.h"
+#include "delete_object.h"
+
+/** @file delete_object.c  Decode DeleteObject APDUs */
+
+/* decode the service request only */
+int delete_object_decode_service_request(
+    uint8_t * apdu,
+    unsigned apdu_len,
+    BACNET_DELETE_OBJECT_DATA * data)
+{
+    int len = 0;
+    uint8_t tag_number = 0;
+    uint32_t len_value_type = 0;
+    uint16_t object_type = 0;
+
+    if (!apdu_len || !data)
+        return -1;
+    /* objectIdentifier, application tagged */
+    len = decode_tag_number_and_value(&apdu[0], &tag_number, &len_value_type);
+    if ((tag_number != BACNET_APPLICATION_TAG_OBJECT_ID) ||
+        ((unsigned) len + len_value_type != apdu_len))
+        return -1;
+    len += decode_object_id(&apdu[len], &object_type, &data->object_instance);
+    data->object_type = (BACNET_OBJECT_TYPE) object_type;
+
+    return len;
+}
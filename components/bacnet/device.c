@@ -37,6 +37,7 @@
 #include "config.h"     /* the custom stuff */
 #include "apdu.h"
 #include "wp.h" /* WriteProperty handling */
+#include "wpm.h"        /* the initial values of CreateObject */
 #include "rp.h" /* ReadProperty handling */
 #include "dcc.h"        /* DeviceCommunicationControl handling */
 #include "version.h"
@@ -89,7 +90,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ },
     {OBJECT_ANALOG_INPUT,
             Analog_Input_Init,
             Analog_Input_Count,
@@ -104,7 +108,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        Analog_Input_Intrinsic_Reporting},
+            Analog_Input_Intrinsic_Reporting,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ },
     {OBJECT_ANALOG_OUTPUT,
             Analog_Output_Init,
             Analog_Output_Count,
@@ -119,7 +126,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ },
     {OBJECT_ANALOG_VALUE,
             Analog_Value_Init,
             Analog_Value_Count,
@@ -134,7 +144,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        Analog_Value_Intrinsic_Reporting},
+            Analog_Value_Intrinsic_Reporting,
+            Analog_Value_Create,
+            Analog_Value_Delete,
+        Analog_Value_Instance_Property_Lists},
     {OBJECT_BINARY_INPUT,
             Binary_Input_Init,
             Binary_Input_Count,
@@ -149,7 +162,10 @@ static object_functions_t My_Object_Table[] = {
             Binary_Input_Encode_Value_List,
             Binary_Input_Change_Of_Value,
             Binary_Input_Change_Of_Value_Clear,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            Binary_Input_Create,
+            Binary_Input_Delete,
+        NULL /* Instance_Property_Lists */ },
     {OBJECT_BINARY_OUTPUT,
             Binary_Output_Init,
             Binary_Output_Count,
@@ -164,7 +180,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            Binary_Output_Create,
+            Binary_Output_Delete,
+        NULL /* Instance_Property_Lists */ },
     {OBJECT_BINARY_VALUE,
             Binary_Value_Init,
             Binary_Value_Count,
@@ -179,7 +198,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            Binary_Value_Create,
+            Binary_Value_Delete,
+        NULL /* Instance_Property_Lists */ },
 #if 0
     {OBJECT_CHARACTERSTRING_VALUE,
             CharacterString_Value_Init,
@@ -195,7 +217,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ },
 #endif
 #if defined(INTRINSIC_REPORTING)
     {OBJECT_NOTIFICATION_CLASS,
@@ -212,7 +237,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ },
+            NULL /* Intrinsic Reporting */ ,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ },
 #endif
 
     {MAX_BACNET_OBJECT_TYPE,
@@ -229,7 +257,10 @@ static object_functions_t My_Object_Table[] = {
             NULL /* Value_Lists */ ,
             NULL /* COV */ ,
             NULL /* COV Clear */ ,
-        NULL /* Intrinsic Reporting */ }
+            NULL /* Intrinsic Reporting */ ,
+            NULL /* Create */ ,
+            NULL /* Delete */ ,
+        NULL /* Instance_Property_Lists */ }
 };
 
 /** Glue function to let the Device object, when called by a handler,
@@ -281,12 +312,15 @@ rr_info_function Device_Objects_RR_Info(
  *
  * @param object_type [in] The desired BACNET_OBJECT_TYPE whose properties
  *            are to be listed.
+ * @param object_instance [in] The object, for the types whose objects do
+ *            not all have the same properties.
  * @param pPropertyList [out] Reference to the structure which will, on return,
  *            list, separately, the Required, Optional, and Proprietary object
  *            properties with their counts.
  */
 void Device_Objects_Property_List(
     BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
     struct special_property_list_t *pPropertyList)
 {
     struct object_functions *pObject = NULL;
@@ -301,7 +335,11 @@ void Device_Objects_Property_List(
      */
 
     pObject = Device_Objects_Find_Functions(object_type);
-    if ((pObject != NULL) && (pObject->Object_RPM_List != NULL)) {
+    if ((pObject != NULL) && (pObject->Object_RPM_Instance_List != NULL)) {
+        pObject->Object_RPM_Instance_List(object_instance,
+            &pPropertyList->Required.pList, &pPropertyList->Optional.pList,
+            &pPropertyList->Proprietary.pList);
+    } else if ((pObject != NULL) && (pObject->Object_RPM_List != NULL)) {
         pObject->Object_RPM_List(&pPropertyList->Required.pList,
             &pPropertyList->Optional.pList, &pPropertyList->Proprietary.pList);
     }
@@ -373,6 +411,113 @@ bool Device_Reinitialize(
     return status;
 }
 
+/** Creates an object for the CreateObject service, and writes the
+ * initial values into it.  If any cannot be written, the object is
+ * deleted again.  Changes the Database_Revision.
+ * @ingroup ObjIntf
+ *
+ * @param data [in,out] The information from the request.  On success the
+ *                      instance of the new object, on failure the error
+ *                      class and code and the failed initial value.
+ * @return True if the object was created.
+ */
+bool Device_Create_Object(
+    BACNET_CREATE_OBJECT_DATA * data)
+{
+    struct object_functions *pObject = NULL;
+    BACNET_WRITE_PROPERTY_DATA wp_data;
+    uint32_t instance = 0;
+    uint16_t offset = 0;
+    int len = 0;
+
+    data->first_failed_element = 0;
+    data->error_class = ERROR_CLASS_OBJECT;
+    pObject = Device_Objects_Find_Functions(data->object_type);
+    if (pObject == NULL) {
+        data->error_code = ERROR_CODE_UNSUPPORTED_OBJECT_TYPE;
+        return false;
+    }
+    if (!pObject->Object_Create || !pObject->Object_Valid_Instance) {
+        data->error_code = ERROR_CODE_DYNAMIC_CREATION_NOT_SUPPORTED;
+        return false;
+    }
+    instance = data->object_instance;
+    if (instance >= BACNET_MAX_INSTANCE) {
+        /* only the type was given: the lowest instance not in use */
+        for (instance = 0; pObject->Object_Valid_Instance(instance);
+            instance++) {
+        }
+    } else if (pObject->Object_Valid_Instance(instance)) {
+        data->error_code = ERROR_CODE_OBJECT_IDENTIFIER_ALREADY_EXISTS;
+        return false;
+    }
+    if (!pObject->Object_Create(instance)) {
+        data->error_class = ERROR_CLASS_RESOURCES;
+        data->error_code = ERROR_CODE_NO_SPACE_FOR_OBJECT;
+        return false;
+    }
+    data->object_instance = instance;
+    wp_data.object_type = data->object_type;
+    wp_data.object_instance = instance;
+    while (offset < data->initial_values_len) {
+        data->first_failed_element++;
+        len =
+            wpm_decode_object_property(&data->initial_values[offset],
+            data->initial_values_len - offset, &wp_data);
+        if (len <= 0) {
+            data->error_class = ERROR_CLASS_SERVICES;
+            data->error_code = ERROR_CODE_INVALID_TAG;
+        } else if (!Device_Write_Property(&wp_data)) {
+            data->error_class = wp_data.error_class;
+            data->error_code = wp_data.error_code;
+            len = 0;
+        }
+        if (len <= 0) {
+            if (pObject->Object_Delete) {
+                pObject->Object_Delete(instance);
+            }
+            return false;
+        }
+        offset += len;
+    }
+    data->first_failed_element = 0;
+    Device_Inc_Database_Revision();
+
+    return true;
+}
+
+/** Deletes an object for the DeleteObject service, with its COV
+ * subscriptions.  Changes the Database_Revision.
+ * @ingroup ObjIntf
+ *
+ * @param data [in,out] The information from the request.  On failure the
+ *                      error class and code.
+ * @return True if the object was deleted.
+ */
+bool Device_Delete_Object(
+    BACNET_DELETE_OBJECT_DATA * data)
+{
+    struct object_functions *pObject = NULL;
+
+    data->error_class = ERROR_CLASS_OBJECT;
+    pObject = Device_Objects_Find_Functions(data->object_type);
+    if ((pObject == NULL) || !pObject->Object_Valid_Instance ||
+        !pObject->Object_Valid_Instance(data->object_instance)) {
+        data->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return false;
+    }
+    if (!pObject->Object_Delete ||
+        !pObject->Object_Delete(data->object_instance)) {
+        data->error_code = ERROR_CODE_OBJECT_DELETION_NOT_PERMITTED;
+        return false;
+    }
+    /* its COV subscriptions go with it, in RAM and in NVS */
+    handler_cov_object_deleted(data->object_type, data->object_instance);
+    Device_Inc_Database_Revision();
+
+    return true;
+}
+
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Device_Properties_Required[] = {
     PROP_OBJECT_IDENTIFIER,
@@ -417,6 +562,35 @@ static const int Device_Properties_Proprietary[] = {
     -1
 };
 
+/* the application's proprietary properties, see Device_Proprietary_Set() */
+static const int *Device_Proprietary_List = Device_Properties_Proprietary;
+static device_read_proprietary_function Device_Proprietary_Read = NULL;
+
+void Device_Proprietary_Set(
+    const int *properties,
+    device_read_proprietary_function read_function)
+{
+    /* the function is in place before the list names its properties */
+    Device_Proprietary_Read = read_function;
+    Device_Proprietary_List =
+        properties ? properties : Device_Properties_Proprietary;
+}
+
+static bool Device_Proprietary_Listed(
+    int object_property)
+{
+    const int *property = Device_Proprietary_List;
+
+    while (*property != -1) {
+        if (*property == object_property) {
+            return true;
+        }
+        property++;
+    }
+
+    return false;
+}
+
 void Device_Property_Lists(
     const int **pRequired,
     const int **pOptional,
@@ -427,7 +601,7 @@ void Device_Property_Lists(
     if (pOptional)
         *pOptional = Device_Properties_Optional;
     if (pProprietary)
-        *pProprietary = Device_Properties_Proprietary;
+        *pProprietary = Device_Proprietary_List;
 
     return;
 }
@@ -1247,6 +1421,15 @@ int Device_Read_Property_Local(
             apdu_len = handler_cov_encode_subscriptions(&apdu[0], MAX_APDU);
             break;
         default:
+            if (Device_Proprietary_Read &&
+                Device_Proprietary_Listed(rpdata->object_property)) {
+                apdu_len =
+                    Device_Proprietary_Read(rpdata->object_property,
+                    &apdu[0]);
+                if (apdu_len >= 0) {
+                    break;
+                }
+            }
             rpdata->error_class = ERROR_CLASS_PROPERTY;
             rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
             apdu_len = BACNET_STATUS_ERROR;
@@ -1498,7 +1681,11 @@ bool Device_Write_Property_Local(
             break;
         default:
             wp_data->error_class = ERROR_CLASS_PROPERTY;
-            wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            if (Device_Proprietary_Listed(wp_data->object_property)) {
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            } else {
+                wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            }
             break;
     }
 
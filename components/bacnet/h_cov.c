@@ -46,39 +46,192 @@
 /* demo objects */
 #include "device.h"
 #include "handlers.h"
+#include "nvstore.h"
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#endif
 
 /** @file h_cov.c  Handles Change of Value (COV) services. */
 
 typedef struct BACnet_COV_Address{
     bool valid:1;
     BACNET_ADDRESS dest;
+    /* confirmed notification delivery to this recipient */
+    uint8_t in_flight;  /* sent and not yet acknowledged */
+    uint8_t failures;   /* given up on by the TSM, in a row */
+    uint16_t holdoff;   /* seconds before sending again */
 } BACNET_COV_ADDRESS;
 
 /* note: This COV service only monitors the properties
-   of an object that have been specified in the standard.  */
+   of an object that have been specified in the standard:
+   Present_Value and Status_Flags.  */
 typedef struct BACnet_COV_Subscription_Flags {
     bool valid:1;
     bool issueConfirmedNotifications:1; /* optional */
     bool send_requested:1;
+    bool monitorProperty:1;     /* SubscribeCOVProperty */
+    bool covIncrementPresent:1; /* optional */
+    bool priorValid:1;  /* priorValue holds the last value sent */
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
 typedef struct BACnet_COV_Subscription {
     BACNET_COV_SUBSCRIPTION_FLAGS flag;
     uint8_t dest_index;
     uint8_t invokeID;   /* for confirmed COV */
+    /* next subscriber of the same object, or next free slot */
+    uint8_t next;
+    /* SubscribeCOVPropertyMultiple context, or COV_INDEX_NONE */
+    uint8_t context;
+    uint8_t attempts;   /* confirmed notification, sent and failed */
     uint32_t subscriberProcessIdentifier;
     uint32_t lifetime;  /* optional */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+    /* SubscribeCOVProperty only */
+    BACNET_PROPERTY_ID monitoredProperty;
+    float covIncrement;
+    float priorValue;
+    uint8_t priorStatusFlags;
 } BACNET_COV_SUBSCRIPTION;
 
 #ifndef MAX_COV_SUBCRIPTIONS
 #define MAX_COV_SUBCRIPTIONS 128
 #endif
+#if (MAX_COV_SUBCRIPTIONS > 255)
+#error "MAX_COV_SUBCRIPTIONS must fit the uint8_t subscription links"
+#endif
 static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
 #ifndef MAX_COV_ADDRESSES
 #define MAX_COV_ADDRESSES 16
 #endif
 static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
+/* confirmed notifications one recipient may have unacknowledged, so a
+   slow recipient cannot hold every TSM transaction */
+#ifndef COV_RECIPIENT_WINDOW
+#define COV_RECIPIENT_WINDOW 2
+#endif
+/* the TSM retries each notification apdu_retries() times; after that
+   it is sent again, up to COV_RETRY_LIMIT times, with the recipient
+   held off for 1, 2, 4... up to COV_BACKOFF_MAX seconds in between */
+#ifndef COV_RETRY_LIMIT
+#define COV_RETRY_LIMIT 4
+#endif
+#ifndef COV_BACKOFF_MAX
+#define COV_BACKOFF_MAX 64
+#endif
+/* delivery counters, see handler_cov_delivery_counters() */
+static uint32_t COV_Retries;
+static uint32_t COV_Collapsed;
+static uint32_t COV_Failures;
+
+/* end of a subscription list */
+#define COV_INDEX_NONE 0xFF
+
+#ifndef MAX_COV_MULTIPLE
+#define MAX_COV_MULTIPLE 4
+#endif
+/* all the references of a context fit one COVNotificationMultiple */
+#ifndef MAX_COV_MULTIPLE_REFERENCES
+#define MAX_COV_MULTIPLE_REFERENCES 16
+#endif
+
+/* Index of the subscriptions by monitored object.  Each entry heads a
+   list of the subscriptions for that object, so a change is turned into
+   notifications without looking at anybody else's subscriptions. */
+typedef enum {
+    COV_OBJECT_EMPTY = 0,
+    COV_OBJECT_USED
+} BACNET_COV_OBJECT_STATE;
+
+typedef struct BACnet_COV_Object {
+    BACNET_OBJECT_ID monitoredObjectIdentifier;
+    uint8_t first_subscription;
+    uint8_t state;
+    bool changed:1;     /* value changed - notify every subscriber */
+    bool queued:1;      /* waiting in COV_Queue */
+} BACNET_COV_OBJECT;
+
+#ifndef MAX_COV_OBJECTS
+#define MAX_COV_OBJECTS 32
+#endif
+/* open addressing: keep the table at most half full */
+#define COV_OBJECT_SLOTS (2 * MAX_COV_OBJECTS)
+static BACNET_COV_OBJECT COV_Objects[COV_OBJECT_SLOTS];
+static unsigned COV_Object_Count;
+
+/* the changed-object set: objects with notifications to send.
+   An object is queued at most once, so the ring cannot overflow. */
+static uint8_t COV_Queue[COV_OBJECT_SLOTS];
+static unsigned COV_Queue_Head;
+static unsigned COV_Queue_Count;
+
+/* free subscription slots, linked through the next field */
+static uint8_t COV_Free_Subscription = COV_INDEX_NONE;
+
+/* subscriptions holding a TSM invoke ID; bounded by the TSM itself */
+static uint8_t COV_Pending[MAX_TSM_TRANSACTIONS];
+static unsigned COV_Pending_Count;
+
+/* A SubscribeCOVPropertyMultiple context: one recipient and process,
+   whose COV references are ordinary subscriptions in COV_Subscriptions.
+   Changes of any of its references within maxNotificationDelay are
+   sent together in one COVNotificationMultiple. */
+typedef struct BACnet_COV_Multiple {
+    bool valid:1;
+    bool issueConfirmedNotifications:1;
+    bool send_requested:1;      /* a reference changed */
+    uint8_t dest_index;
+    uint8_t invokeID;   /* for confirmed COV */
+    uint8_t reference_count;
+    uint8_t attempts;   /* confirmed notification, sent and failed */
+    uint32_t subscriberProcessIdentifier;
+    uint32_t maxNotificationDelay;      /* seconds */
+    uint32_t delay;     /* seconds left before sending */
+    uint8_t reference[MAX_COV_MULTIPLE_REFERENCES];
+} BACNET_COV_MULTIPLE;
+
+static BACNET_COV_MULTIPLE COV_Multiple[MAX_COV_MULTIPLE];
+
+/* The subscriptions are saved to NVS so that they survive a reset.
+   Changes to the table are coalesced: the table is written once it has
+   been quiet for COV_PERSIST_DELAY seconds, and not at all while only
+   lifetimes count down. */
+#ifndef COV_PERSIST_DELAY
+#define COV_PERSIST_DELAY 2
+#endif
+static bool COV_Persist_Dirty;
+static uint32_t COV_Persist_Delay;
+
+/* Lifetimes are saved as expiry times on the COV clock, the seconds
+   counted by handler_cov_timer_seconds() summed over every boot.  The
+   clock itself is saved with the table, and every COV_CLOCK_CHECKPOINT
+   seconds while a subscription has a lifetime.  The time since the last
+   checkpoint is lost at a reset, so a boot charges a full checkpoint
+   interval: subscriptions expire early rather than live forever in a
+   reset loop. */
+#ifndef COV_CLOCK_CHECKPOINT
+#define COV_CLOCK_CHECKPOINT 60
+#endif
+static uint32_t COV_Clock;
+static uint32_t COV_Clock_Saved;
+static bool COV_Clock_Due;
+
+/* told of every object change, for local users such as the display */
+static handler_cov_changed_function COV_Changed_Notify;
+
+static void cov_persist_save(
+    void);
+static void cov_persist_restore(
+    void);
+static void cov_clock_save(
+    void);
+
+/* notes that the subscription table has to be saved again */
+static void cov_persist_changed(
+    void)
+{
+    COV_Persist_Dirty = true;
+    COV_Persist_Delay = COV_PERSIST_DELAY;
+}
 
 /**
 * Gets the address from the list of COV addresses
@@ -166,6 +319,9 @@ static int cov_address_add(
                     cov_dest = &COV_Addresses[i].dest;
                     bacnet_address_copy(cov_dest, dest);
                     COV_Addresses[i].valid = true;
+                    COV_Addresses[i].in_flight = 0;
+                    COV_Addresses[i].failures = 0;
+                    COV_Addresses[i].holdoff = 0;
                     break;
                 }
             }
@@ -175,6 +331,71 @@ static int cov_address_add(
     return index;
 }
 
+/* true if a confirmed notification may be sent to the recipient now */
+static bool cov_recipient_ready(
+    unsigned dest_index)
+{
+    if (dest_index >= MAX_COV_ADDRESSES) {
+        return false;
+    }
+
+    return (COV_Addresses[dest_index].in_flight < COV_RECIPIENT_WINDOW) &&
+        (COV_Addresses[dest_index].holdoff == 0);
+}
+
+/* a confirmed notification to the recipient is no longer in flight */
+static void cov_recipient_release(
+    unsigned dest_index)
+{
+    if ((dest_index < MAX_COV_ADDRESSES) &&
+        COV_Addresses[dest_index].in_flight) {
+        COV_Addresses[dest_index].in_flight--;
+    }
+}
+
+/* a confirmed notification to the recipient completed: acknowledged,
+   or given up on by the TSM, which doubles the hold off */
+static void cov_recipient_done(
+    unsigned dest_index,
+    bool delivered)
+{
+    BACNET_COV_ADDRESS *recipient = NULL;
+    uint32_t holdoff = 0;
+
+    if (dest_index >= MAX_COV_ADDRESSES) {
+        return;
+    }
+    cov_recipient_release(dest_index);
+    recipient = &COV_Addresses[dest_index];
+    if (delivered) {
+        recipient->failures = 0;
+    } else {
+        if (recipient->failures < 16) {
+            recipient->failures++;
+        }
+        holdoff = 1UL << (recipient->failures - 1);
+        if (holdoff > COV_BACKOFF_MAX) {
+            holdoff = COV_BACKOFF_MAX;
+        }
+        recipient->holdoff = (uint16_t) holdoff;
+    }
+}
+
+/* counts a failed attempt; true if the notification is sent again */
+static bool cov_delivery_retry(
+    uint8_t * attempts)
+{
+    (*attempts)++;
+    if (*attempts >= COV_RETRY_LIMIT) {
+        *attempts = 0;
+        COV_Failures++;
+        return false;
+    }
+    COV_Retries++;
+
+    return true;
+}
+
 /*
 BACnetCOVSubscription ::= SEQUENCE {
 Recipient [0] BACnetRecipientProcess,
@@ -268,8 +489,15 @@ static int cov_encode_subscription(
         cov_subscription->monitoredObjectIdentifier.instance);
     apdu_len += len;
     /* propertyIdentifier [1] */
-    /* FIXME: we are monitoring 2 properties! How to encode? */
-    len = encode_context_enumerated(&apdu[apdu_len], 1, PROP_PRESENT_VALUE);
+    /* SubscribeCOV monitors 2 properties; Present_Value is listed */
+    if (cov_subscription->flag.monitorProperty) {
+        len =
+            encode_context_enumerated(&apdu[apdu_len], 1,
+            cov_subscription->monitoredProperty);
+    } else {
+        len =
+            encode_context_enumerated(&apdu[apdu_len], 1, PROP_PRESENT_VALUE);
+    }
     apdu_len += len;
     /* MonitoredPropertyReference [1] - closing */
     len = encode_closing_tag(&apdu[apdu_len], 1);
@@ -284,6 +512,13 @@ static int cov_encode_subscription(
         encode_context_unsigned(&apdu[apdu_len], 3,
         cov_subscription->lifetime);
     apdu_len += len;
+    /* COVIncrement [4] REAL OPTIONAL */
+    if (cov_subscription->flag.covIncrementPresent) {
+        len =
+            encode_context_real(&apdu[apdu_len], 4,
+            cov_subscription->covIncrement);
+        apdu_len += len;
+    }
 
     return apdu_len;
 }
@@ -324,6 +559,260 @@ int handler_cov_encode_subscriptions(
 
     return apdu_len;
 }
+static unsigned cov_object_hash(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    uint32_t key = ((uint32_t) object_type << 22) ^ object_instance;
+
+    return (unsigned) ((key * 2654435761UL) % COV_OBJECT_SLOTS);
+}
+
+/**
+ * Finds the monitored object in the subscription index
+ *
+ * @return slot number 0..N, or -1 if nobody subscribes to the object
+ */
+static int cov_object_find(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    unsigned slot = cov_object_hash(object_type, object_instance);
+    unsigned probes = 0;
+    BACNET_COV_OBJECT *pObject = NULL;
+
+    for (probes = 0; probes < COV_OBJECT_SLOTS; probes++) {
+        pObject = &COV_Objects[slot];
+        if (pObject->state == COV_OBJECT_EMPTY) {
+            break;
+        }
+        if ((pObject->monitoredObjectIdentifier.type == object_type) &&
+            (pObject->monitoredObjectIdentifier.instance ==
+                object_instance)) {
+            return (int) slot;
+        }
+        slot = (slot + 1) % COV_OBJECT_SLOTS;
+    }
+
+    return -1;
+}
+
+/**
+ * Adds the monitored object to the subscription index
+ *
+ * @return slot number 0..N, or -1 if the index is full
+ */
+static int cov_object_add(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    int slot = -1;
+    unsigned probes = 0;
+    BACNET_COV_OBJECT *pObject = NULL;
+
+    slot = cov_object_find(object_type, object_instance);
+    if ((slot < 0) && (COV_Object_Count < MAX_COV_OBJECTS)) {
+        slot = (int) cov_object_hash(object_type, object_instance);
+        for (probes = 0; probes < COV_OBJECT_SLOTS; probes++) {
+            if (COV_Objects[slot].state == COV_OBJECT_EMPTY) {
+                break;
+            }
+            slot = (slot + 1) % COV_OBJECT_SLOTS;
+        }
+        pObject = &COV_Objects[slot];
+        pObject->state = COV_OBJECT_USED;
+        pObject->monitoredObjectIdentifier.type = object_type;
+        pObject->monitoredObjectIdentifier.instance = object_instance;
+        pObject->first_subscription = COV_INDEX_NONE;
+        pObject->changed = false;
+        pObject->queued = false;
+        COV_Object_Count++;
+    }
+
+    return slot;
+}
+
+/* points the COV_Queue entry of a slot at another slot, or drops it */
+static void cov_object_requeue(
+    unsigned slot,
+    unsigned new_slot)
+{
+    unsigned i = 0;
+    unsigned n = 0;
+
+    for (i = 0; i < COV_Queue_Count; i++) {
+        if (COV_Queue[(COV_Queue_Head + i) % COV_OBJECT_SLOTS] == slot) {
+            break;
+        }
+    }
+    if (i == COV_Queue_Count) {
+        return;
+    }
+    if (new_slot < COV_OBJECT_SLOTS) {
+        COV_Queue[(COV_Queue_Head + i) % COV_OBJECT_SLOTS] =
+            (uint8_t) new_slot;
+    } else {
+        /* close the gap, keeping the order of the others */
+        for (n = i + 1; n < COV_Queue_Count; n++) {
+            COV_Queue[(COV_Queue_Head + n - 1) % COV_OBJECT_SLOTS] =
+                COV_Queue[(COV_Queue_Head + n) % COV_OBJECT_SLOTS];
+        }
+        COV_Queue_Count--;
+    }
+}
+
+/**
+ * Removes the monitored object from the subscription index.
+ * Backward-shift deletion: the entries after it in the probe run are
+ * moved up into the hole where that keeps them reachable from their
+ * home slot, so no tombstones are left and a miss still stops at the
+ * first empty slot however many objects came and went.
+ */
+static void cov_object_remove(
+    unsigned slot)
+{
+    unsigned hole = slot;
+    unsigned next = slot;
+    unsigned home = 0;
+    BACNET_COV_OBJECT *pObject = NULL;
+
+    if (COV_Objects[slot].queued) {
+        cov_object_requeue(slot, COV_OBJECT_SLOTS);
+    }
+    for (;;) {
+        next = (next + 1) % COV_OBJECT_SLOTS;
+        pObject = &COV_Objects[next];
+        if (pObject->state == COV_OBJECT_EMPTY) {
+            break;
+        }
+        home = cov_object_hash((BACNET_OBJECT_TYPE)
+            pObject->monitoredObjectIdentifier.type,
+            pObject->monitoredObjectIdentifier.instance);
+        /* move it unless its home lies cyclically in (hole, next] */
+        if (((next + COV_OBJECT_SLOTS - home) % COV_OBJECT_SLOTS) >=
+            ((next + COV_OBJECT_SLOTS - hole) % COV_OBJECT_SLOTS)) {
+            if (pObject->queued) {
+                cov_object_requeue(next, hole);
+            }
+            COV_Objects[hole] = *pObject;
+            hole = next;
+        }
+    }
+    COV_Objects[hole].state = COV_OBJECT_EMPTY;
+    COV_Objects[hole].first_subscription = COV_INDEX_NONE;
+    COV_Objects[hole].changed = false;
+    COV_Objects[hole].queued = false;
+    COV_Object_Count--;
+}
+
+/* puts the object into the changed-object set */
+static void cov_object_queue(
+    unsigned slot)
+{
+    if ((slot < COV_OBJECT_SLOTS) && (!COV_Objects[slot].queued)) {
+        COV_Objects[slot].queued = true;
+        COV_Queue[(COV_Queue_Head + COV_Queue_Count) % COV_OBJECT_SLOTS] =
+            (uint8_t) slot;
+        COV_Queue_Count++;
+    }
+}
+
+/* forgets the invoke ID of a confirmed notification */
+static void cov_pending_remove(
+    unsigned index)
+{
+    unsigned i = 0;
+
+    while (i < COV_Pending_Count) {
+        if (COV_Pending[i] == index) {
+            COV_Pending_Count--;
+            COV_Pending[i] = COV_Pending[COV_Pending_Count];
+        } else {
+            i++;
+        }
+    }
+}
+
+/* frees the TSM slot held by a subscription, if any */
+static void cov_subscription_release_invoke_id(
+    unsigned index)
+{
+    if (COV_Subscriptions[index].invokeID) {
+        tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
+        COV_Subscriptions[index].invokeID = 0;
+        cov_recipient_release(COV_Subscriptions[index].dest_index);
+    }
+    COV_Subscriptions[index].attempts = 0;
+    cov_pending_remove(index);
+}
+
+/* drops a reference from its SubscribeCOVPropertyMultiple context;
+   the context goes with its last reference */
+static void cov_multiple_reference_remove(
+    unsigned context,
+    unsigned index)
+{
+    BACNET_COV_MULTIPLE *cov_multiple = &COV_Multiple[context];
+    unsigned i = 0;
+
+    for (i = 0; i < cov_multiple->reference_count; i++) {
+        if (cov_multiple->reference[i] == index) {
+            cov_multiple->reference_count--;
+            cov_multiple->reference[i] =
+                cov_multiple->reference[cov_multiple->reference_count];
+            break;
+        }
+    }
+    if (cov_multiple->reference_count == 0) {
+        if (cov_multiple->invokeID) {
+            tsm_free_invoke_id(cov_multiple->invokeID);
+            cov_multiple->invokeID = 0;
+            cov_recipient_release(cov_multiple->dest_index);
+        }
+        cov_multiple->send_requested = false;
+        cov_multiple->valid = false;
+    }
+}
+
+/**
+ * Removes a subscription from its object's list and returns the slot
+ * to the free list.  The object leaves the index with its last subscriber.
+ */
+static void cov_subscription_remove(
+    unsigned index)
+{
+    int slot = -1;
+    uint8_t *link = NULL;
+
+    slot = cov_object_find((BACNET_OBJECT_TYPE)
+        COV_Subscriptions[index].monitoredObjectIdentifier.type,
+        COV_Subscriptions[index].monitoredObjectIdentifier.instance);
+    if (slot >= 0) {
+        link = &COV_Objects[slot].first_subscription;
+        while (*link != COV_INDEX_NONE) {
+            if (*link == index) {
+                *link = COV_Subscriptions[index].next;
+                break;
+            }
+            link = &COV_Subscriptions[*link].next;
+        }
+        if (COV_Objects[slot].first_subscription == COV_INDEX_NONE) {
+            cov_object_remove((unsigned) slot);
+        }
+    }
+    if (COV_Subscriptions[index].context != COV_INDEX_NONE) {
+        cov_multiple_reference_remove(COV_Subscriptions[index].context, index);
+        COV_Subscriptions[index].context = COV_INDEX_NONE;
+    }
+    cov_subscription_release_invoke_id(index);
+    COV_Subscriptions[index].flag.valid = false;
+    COV_Subscriptions[index].flag.send_requested = false;
+    COV_Subscriptions[index].dest_index = -1;
+    COV_Subscriptions[index].next = COV_Free_Subscription;
+    COV_Free_Subscription = (uint8_t) index;
+    cov_address_remove_unused();
+    cov_persist_changed();
+}
 
 /** Handler to initialize the COV list, clearing and disabling each entry.
  * @ingroup DSCOV
@@ -333,42 +822,173 @@ void handler_cov_init(
 {
     unsigned index = 0;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        COV_Subscriptions[index].flag.valid = false;
-        COV_Subscriptions[index].dest_index = -1;
-        COV_Subscriptions[index].subscriberProcessIdentifier = 0;
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
+    COV_Free_Subscription = COV_INDEX_NONE;
+    for (index = MAX_COV_SUBCRIPTIONS; index > 0; index--) {
+        COV_Subscriptions[index - 1].flag.valid = false;
+        COV_Subscriptions[index - 1].dest_index = -1;
+        COV_Subscriptions[index - 1].subscriberProcessIdentifier = 0;
+        COV_Subscriptions[index - 1].monitoredObjectIdentifier.type =
             OBJECT_ANALOG_INPUT;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance = 0;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications = false;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = 0;
-        COV_Subscriptions[index].flag.send_requested = false;
+        COV_Subscriptions[index - 1].monitoredObjectIdentifier.instance = 0;
+        COV_Subscriptions[index - 1].flag.issueConfirmedNotifications = false;
+        COV_Subscriptions[index - 1].invokeID = 0;
+        COV_Subscriptions[index - 1].lifetime = 0;
+        COV_Subscriptions[index - 1].flag.send_requested = false;
+        COV_Subscriptions[index - 1].flag.monitorProperty = false;
+        COV_Subscriptions[index - 1].flag.covIncrementPresent = false;
+        COV_Subscriptions[index - 1].flag.priorValid = false;
+        COV_Subscriptions[index - 1].context = COV_INDEX_NONE;
+        COV_Subscriptions[index - 1].attempts = 0;
+        COV_Subscriptions[index - 1].next = COV_Free_Subscription;
+        COV_Free_Subscription = (uint8_t) (index - 1);
     }
     for (index = 0; index < MAX_COV_ADDRESSES; index++) {
         COV_Addresses[index].valid = false;
     }
+    for (index = 0; index < MAX_COV_MULTIPLE; index++) {
+        COV_Multiple[index].valid = false;
+        COV_Multiple[index].send_requested = false;
+        COV_Multiple[index].invokeID = 0;
+        COV_Multiple[index].reference_count = 0;
+        COV_Multiple[index].attempts = 0;
+    }
+    for (index = 0; index < COV_OBJECT_SLOTS; index++) {
+        COV_Objects[index].state = COV_OBJECT_EMPTY;
+        COV_Objects[index].first_subscription = COV_INDEX_NONE;
+        COV_Objects[index].changed = false;
+        COV_Objects[index].queued = false;
+    }
+    COV_Object_Count = 0;
+    COV_Queue_Head = 0;
+    COV_Queue_Count = 0;
+    COV_Pending_Count = 0;
+    COV_Retries = 0;
+    COV_Collapsed = 0;
+    COV_Failures = 0;
+    COV_Persist_Dirty = false;
+    COV_Persist_Delay = 0;
+    COV_Clock = 0;
+    COV_Clock_Saved = 0;
+    COV_Clock_Due = false;
+    /* resume the subscriptions saved before the reset */
+    cov_persist_restore();
+}
+
+/** Marks an object as changed, so its subscribers are notified on the
+ *  next call to handler_cov_task().
+ * @ingroup DSCOV
+ * Called by the object whenever a COV-reportable property changes.
+ * Objects nobody subscribes to are ignored in O(1).
+ *
+ * @param object_type [in] The type of the object that changed.
+ * @param object_instance [in] The instance of the object that changed.
+ */
+void handler_cov_object_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    int slot = -1;
+
+    if (COV_Changed_Notify) {
+        COV_Changed_Notify(object_type, object_instance);
+    }
+    slot = cov_object_find(object_type, object_instance);
+    if (slot >= 0) {
+        COV_Objects[slot].changed = true;
+        cov_object_queue((unsigned) slot);
+    }
+}
+
+/** Sets a function told of every call to handler_cov_object_changed(),
+ *  whether or not anyone subscribes to the object.
+ * @ingroup DSCOV
+ * It is called in the context of the object change, so it has to be
+ * short; NULL removes it.
+ *
+ * @param notify [in] The function, or NULL.
+ */
+void handler_cov_object_changed_notify_set(
+    handler_cov_changed_function notify)
+{
+    COV_Changed_Notify = notify;
+}
+
+/** Drops every subscription to an object that has been deleted, so an
+ *  object made again under the same identifier starts with none.
+ * @ingroup DSCOV
+ * Called by Device_Delete_Object().  Notifications waiting for the
+ * object are dropped with it, and the table is saved again without its
+ * subscriptions.
+ *
+ * @param object_type [in] The type of the object that was deleted.
+ * @param object_instance [in] The instance of the object that was deleted.
+ */
+void handler_cov_object_deleted(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    int slot = -1;
+
+    /* the object leaves the index with its last subscription, and the
+       index may move it on each removal: look it up every time */
+    slot = cov_object_find(object_type, object_instance);
+    while (slot >= 0) {
+        cov_subscription_remove(COV_Objects[slot].first_subscription);
+        slot = cov_object_find(object_type, object_instance);
+    }
+}
+
+/* copies what SubscribeCOVProperty adds to a subscription */
+static void cov_subscription_property_set(
+    unsigned index,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data,
+    bool monitor_property)
+{
+    COV_Subscriptions[index].flag.monitorProperty = monitor_property;
+    COV_Subscriptions[index].flag.priorValid = false;
+    if (monitor_property) {
+        COV_Subscriptions[index].monitoredProperty =
+            cov_data->monitoredProperty.propertyIdentifier;
+        COV_Subscriptions[index].flag.covIncrementPresent =
+            cov_data->covIncrementPresent;
+        COV_Subscriptions[index].covIncrement = cov_data->covIncrement;
+    } else {
+        COV_Subscriptions[index].monitoredProperty = PROP_PRESENT_VALUE;
+        COV_Subscriptions[index].flag.covIncrementPresent = false;
+        COV_Subscriptions[index].covIncrement = 0.0;
+    }
 }
 
+/* A SubscribeCOV context is the recipient, process and object;
+   a SubscribeCOVProperty context adds the monitored property, and
+   the references of a SubscribeCOVPropertyMultiple context are only
+   matched within that context. */
 static bool cov_list_subscribe(
     BACNET_ADDRESS * src,
     BACNET_SUBSCRIBE_COV_DATA * cov_data,
+    bool monitor_property,
+    unsigned context,
     BACNET_ERROR_CLASS * error_class,
     BACNET_ERROR_CODE * error_code)
 {
-    bool existing_entry = false;
-    int index;
-    int first_invalid_index = -1;
+    unsigned index = COV_INDEX_NONE;
+    int slot = -1;
+    int dest_index = -1;
     bool found = true;
     bool address_match = false;
     BACNET_ADDRESS *dest = NULL;
+    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
+    uint32_t object_instance = 0;
 
-    /* unable to subscribe - resources? */
-    /* unable to cancel subscription - other? */
-
-    /* existing? - match Object ID and Process ID and address */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].flag.valid) {
+    object_type =
+        (BACNET_OBJECT_TYPE) cov_data->monitoredObjectIdentifier.type;
+    object_instance = cov_data->monitoredObjectIdentifier.instance;
+    /* existing? - match Process ID and address among the subscribers
+       of this object */
+    slot = cov_object_find(object_type, object_instance);
+    if (slot >= 0) {
+        index = COV_Objects[slot].first_subscription;
+        while (index != COV_INDEX_NONE) {
             dest = cov_address_get(COV_Subscriptions[index].dest_index);
             if (dest) {
                 address_match = bacnet_address_same(src, dest);
@@ -376,66 +996,89 @@ static bool cov_list_subscribe(
                 /* skip address matching - we don't have an address */
                 address_match = true;
             }
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                    cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                    cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                    cov_data->subscriberProcessIdentifier) && address_match) {
-                existing_entry = true;
-                if (cov_data->cancellationRequest) {
-                    COV_Subscriptions[index].flag.valid = false;
-                    COV_Subscriptions[index].dest_index = -1;
-                    cov_address_remove_unused();
-                } else {
-                    COV_Subscriptions[index].dest_index = cov_address_add(src);
-                    COV_Subscriptions[index].flag.issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].flag.send_requested = true;
-                }
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
+            if ((COV_Subscriptions[index].subscriberProcessIdentifier ==
+                    cov_data->subscriberProcessIdentifier) && address_match &&
+                (COV_Subscriptions[index].context == context) &&
+                (COV_Subscriptions[index].flag.monitorProperty ==
+                    monitor_property) && (!monitor_property ||
+                    (COV_Subscriptions[index].monitoredProperty ==
+                        cov_data->monitoredProperty.propertyIdentifier))) {
                 break;
             }
-        } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
-            }
+            index = COV_Subscriptions[index].next;
         }
     }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        index = first_invalid_index;
+    if (index != COV_INDEX_NONE) {
+        if (cov_data->cancellationRequest) {
+            cov_subscription_remove(index);
+        } else {
+            cov_subscription_release_invoke_id(index);
+            COV_Subscriptions[index].dest_index = cov_address_add(src);
+            COV_Subscriptions[index].flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            COV_Subscriptions[index].lifetime = cov_data->lifetime;
+            cov_subscription_property_set(index, cov_data, monitor_property);
+            COV_Subscriptions[index].flag.send_requested = true;
+            cov_object_queue((unsigned) slot);
+            cov_persist_changed();
+        }
+    } else if (cov_data->cancellationRequest) {
+        /* cancellationRequest - valid object not subscribed */
+        /* From BACnet Standard 135-2010-13.14.2
+           ...Cancellations that are issued for which no matching COV
+           context can be found shall succeed as if a context had
+           existed, returning 'Result(+)'. */
         found = true;
-        COV_Subscriptions[index].flag.valid = true;
-        COV_Subscriptions[index].dest_index = cov_address_add(src);
-        COV_Subscriptions[index].monitoredObjectIdentifier.type =
-            cov_data->monitoredObjectIdentifier.type;
-        COV_Subscriptions[index].monitoredObjectIdentifier.instance =
-            cov_data->monitoredObjectIdentifier.instance;
-        COV_Subscriptions[index].subscriberProcessIdentifier =
-            cov_data->subscriberProcessIdentifier;
-        COV_Subscriptions[index].flag.issueConfirmedNotifications =
-            cov_data->issueConfirmedNotifications;
-        COV_Subscriptions[index].invokeID = 0;
-        COV_Subscriptions[index].lifetime = cov_data->lifetime;
-        COV_Subscriptions[index].flag.send_requested = true;
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
+    } else {
+        if ((COV_Free_Subscription == COV_INDEX_NONE) ||
+            ((context != COV_INDEX_NONE) &&
+                (COV_Multiple[context].reference_count >=
+                    MAX_COV_MULTIPLE_REFERENCES))) {
+            slot = -1;
+        } else if (slot < 0) {
+            slot = cov_object_add(object_type, object_instance);
+        }
+        if (slot >= 0) {
+            dest_index = cov_address_add(src);
+        }
+        if (dest_index < 0) {
             /* Out of resources */
+            if ((slot >= 0) &&
+                (COV_Objects[slot].first_subscription == COV_INDEX_NONE)) {
+                cov_object_remove((unsigned) slot);
+            }
             *error_class = ERROR_CLASS_RESOURCES;
             *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
             found = false;
         } else {
-            /* cancellationRequest - valid object not subscribed */
-            /* From BACnet Standard 135-2010-13.14.2
-               ...Cancellations that are issued for which no matching COV
-               context can be found shall succeed as if a context had
-               existed, returning 'Result(+)'. */
-            found = true;
+            index = COV_Free_Subscription;
+            COV_Free_Subscription = COV_Subscriptions[index].next;
+            COV_Subscriptions[index].flag.valid = true;
+            COV_Subscriptions[index].dest_index = (uint8_t) dest_index;
+            COV_Subscriptions[index].monitoredObjectIdentifier.type =
+                object_type;
+            COV_Subscriptions[index].monitoredObjectIdentifier.instance =
+                object_instance;
+            COV_Subscriptions[index].subscriberProcessIdentifier =
+                cov_data->subscriberProcessIdentifier;
+            COV_Subscriptions[index].flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            COV_Subscriptions[index].invokeID = 0;
+            COV_Subscriptions[index].attempts = 0;
+            COV_Subscriptions[index].lifetime = cov_data->lifetime;
+            cov_subscription_property_set(index, cov_data, monitor_property);
+            COV_Subscriptions[index].flag.send_requested = true;
+            COV_Subscriptions[index].next =
+                COV_Objects[slot].first_subscription;
+            COV_Objects[slot].first_subscription = (uint8_t) index;
+            COV_Subscriptions[index].context = (uint8_t) context;
+            if (context != COV_INDEX_NONE) {
+                COV_Multiple[context].reference[COV_Multiple[context].
+                    reference_count] = (uint8_t) index;
+                COV_Multiple[context].reference_count++;
+            }
+            cov_persist_changed();
+            cov_object_queue((unsigned) slot);
         }
     }
 
@@ -553,37 +1196,19 @@ static void cov_lifetime_expiration_handler(
                 COV_Subscriptions[index].lifetime);
             fprintf(stderr, "\n");
 #endif
-            COV_Subscriptions[index].flag.valid = false;
-            COV_Subscriptions[index].dest_index = -1;
-            cov_address_remove_unused();
-            if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
+            cov_subscription_remove(index);
         }
     }
 }
 
-/** Handler to check the list of subscribed objects for any that have changed
- *  and so need to have notifications sent.
+/** Handler to expire COV subscriptions whose lifetime has run out.
  * @ingroup DSCOV
  * This handler will be invoked by the main program every second or so.
- * This example only handles Binary Inputs, but can be easily extended to
- * support other types.
- * For each subscribed object,
- *  - See if the subscription has timed out
- *    - Remove it if it has timed out.
- *  - See if the subscribed object instance has changed
- *    (eg, check with Binary_Input_Change_Of_Value() )
- *  - If changed,
- *    - Clear the COV (eg, Binary_Input_Change_Of_Value_Clear() )
- *    - Send the notice with cov_send_request()
- *      - Will be confirmed or unconfirmed, as per the subscription.
- *
- * @note worst case tasking: MS/TP with the ability to send only
- *        one notification per task cycle.
+ * For each subscription with a definite lifetime, the lifetime is
+ * reduced, and the subscription is removed when it reaches zero.
+ * The max notification delay of SubscribeCOVPropertyMultiple contexts,
+ * the hold off of recipients that failed to acknowledge, and the delay
+ * before the table is saved, are counted down here too.
  *
  * @param elapsed_seconds [in] How many seconds have elapsed since last called.
  */
@@ -592,8 +1217,10 @@ void handler_cov_timer_seconds(
 {
     unsigned index = 0;
     uint32_t lifetime_seconds = 0;
+    bool definite = false;
 
     if (elapsed_seconds) {
+        COV_Clock += elapsed_seconds;
         /* handle the subscription timeouts */
         for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
             if (COV_Subscriptions[index].flag.valid) {
@@ -602,159 +1229,517 @@ void handler_cov_timer_seconds(
                     /* only expire COV with definite lifetimes */
                     cov_lifetime_expiration_handler(index, elapsed_seconds,
                         lifetime_seconds);
+                    definite = true;
                 }
             }
         }
-    }
-}
-
-bool handler_cov_fsm(
-    void)
-{
-    static int index = 0;
-    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
-    uint32_t object_instance = 0;
-    bool status = false;
-    bool send = false;
-    BACNET_PROPERTY_VALUE value_list[2];
-    /* states for transmitting */
-    static enum {
-        COV_STATE_IDLE = 0,
-        COV_STATE_MARK,
-        COV_STATE_CLEAR,
-        COV_STATE_FREE,
-        COV_STATE_SEND
-    } cov_task_state = COV_STATE_IDLE;
-
-    switch (cov_task_state) {
-        case COV_STATE_IDLE:
-            index = 0;
-            cov_task_state = COV_STATE_MARK;
-            break;
-        case COV_STATE_MARK:
-            /* mark any subscriptions where the value has changed */
-            if (COV_Subscriptions[index].flag.valid) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                status = Device_COV(object_type, object_instance);
-                if (status) {
-                    COV_Subscriptions[index].flag.send_requested = true;
-#if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Marking...\n");
-#endif
-                }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_CLEAR;
-            }
-            break;
-        case COV_STATE_CLEAR:
-            /* clear the COV flag after checking all subscriptions */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                object_type = (BACNET_OBJECT_TYPE)
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].
-                    monitoredObjectIdentifier.instance;
-                Device_COV_Clear(object_type, object_instance);
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_FREE;
-            }
-            break;
-        case COV_STATE_FREE:
-            /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
-                } else
-                    if (tsm_invoke_id_failed(COV_Subscriptions
-                        [index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_SEND;
+        if (definite &&
+            ((COV_Clock - COV_Clock_Saved) >= COV_CLOCK_CHECKPOINT)) {
+            COV_Clock_Due = true;
+        }
+        for (index = 0; index < MAX_COV_ADDRESSES; index++) {
+            if (COV_Addresses[index].holdoff > elapsed_seconds) {
+                COV_Addresses[index].holdoff -= elapsed_seconds;
+            } else {
+                COV_Addresses[index].holdoff = 0;
             }
-            break;
-        case COV_STATE_SEND:
-            /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
-                        /* already sending */
-                        send = false;
-                    }
-                    if (!tsm_transaction_available()) {
-                        /* no transactions available - can't send now */
-                        send = false;
-                    }
-                }
-                if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.type;
-                    object_instance =
-                        COV_Subscriptions[index].
-                        monitoredObjectIdentifier.instance;
-#if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Sending...\n");
-#endif
-                    /* configure the linked list for the two properties */
-                    value_list[0].next = &value_list[1];
-                    value_list[1].next = NULL;
-                    status =
-                        Device_Encode_Value_List(object_type,
-                        object_instance, &value_list[0]);
-                    if (status) {
-                        status =
-                            cov_send_request(&COV_Subscriptions[index],
-                            &value_list[0]);
-                    }
-                    if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
-                    }
+        }
+        if (COV_Persist_Delay > elapsed_seconds) {
+            COV_Persist_Delay -= elapsed_seconds;
+        } else {
+            COV_Persist_Delay = 0;
+        }
+        for (index = 0; index < MAX_COV_MULTIPLE; index++) {
+            if (COV_Multiple[index].valid &&
+                COV_Multiple[index].send_requested) {
+                if (COV_Multiple[index].delay > elapsed_seconds) {
+                    COV_Multiple[index].delay -= elapsed_seconds;
+                } else {
+                    COV_Multiple[index].delay = 0;
                 }
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
-                index = 0;
-                cov_task_state = COV_STATE_IDLE;
-            }
-            break;
-        default:
-            index = 0;
-            cov_task_state = COV_STATE_IDLE;
-            break;
+        }
     }
+}
 
-    return (cov_task_state == COV_STATE_IDLE);
+/* starts the max notification delay of a context, unless running */
+static void cov_multiple_request(
+    unsigned context)
+{
+    if (!COV_Multiple[context].send_requested) {
+        COV_Multiple[context].send_requested = true;
+        COV_Multiple[context].delay =
+            COV_Multiple[context].maxNotificationDelay;
+    }
 }
 
-void handler_cov_task(
+/* confirmed notification house keeping: release the invoke IDs of
+   notifications that were acknowledged or that failed, and ask for
+   the failed ones again.  A retry carries the current value, so only
+   the latest value ever reaches a slow recipient. */
+static void cov_pending_task(
     void)
 {
-    handler_cov_fsm();
-}
+    unsigned i = 0;
+    unsigned index = 0;
+    unsigned context = 0;
+    int slot = -1;
+    uint8_t invoke_id = 0;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
 
-static bool cov_subscribe(
-    BACNET_ADDRESS * src,
+    while (i < COV_Pending_Count) {
+        index = COV_Pending[i];
+        cov_subscription = &COV_Subscriptions[index];
+        invoke_id = cov_subscription->invokeID;
+        if (invoke_id && tsm_invoke_id_failed(invoke_id)) {
+            tsm_free_invoke_id(invoke_id);
+            invoke_id = 0;
+            cov_recipient_done(cov_subscription->dest_index, false);
+            if (cov_delivery_retry(&cov_subscription->attempts)) {
+                cov_subscription->flag.send_requested = true;
+                slot = cov_object_find((BACNET_OBJECT_TYPE)
+                    cov_subscription->monitoredObjectIdentifier.type,
+                    cov_subscription->monitoredObjectIdentifier.instance);
+                if (slot >= 0) {
+                    cov_object_queue((unsigned) slot);
+                }
+            }
+        } else if (invoke_id && tsm_invoke_id_free(invoke_id)) {
+            invoke_id = 0;
+            cov_recipient_done(cov_subscription->dest_index, true);
+            cov_subscription->attempts = 0;
+        }
+        if (invoke_id == 0) {
+            COV_Subscriptions[index].invokeID = 0;
+            COV_Pending_Count--;
+            COV_Pending[i] = COV_Pending[COV_Pending_Count];
+        } else {
+            i++;
+        }
+    }
+    for (context = 0; context < MAX_COV_MULTIPLE; context++) {
+        invoke_id = COV_Multiple[context].invokeID;
+        if (invoke_id && tsm_invoke_id_failed(invoke_id)) {
+            tsm_free_invoke_id(invoke_id);
+            COV_Multiple[context].invokeID = 0;
+            cov_recipient_done(COV_Multiple[context].dest_index, false);
+            if (cov_delivery_retry(&COV_Multiple[context].attempts)) {
+                /* which references it carried is not kept:
+                   send the current value of all of them */
+                for (i = 0; i < COV_Multiple[context].reference_count; i++) {
+                    index = COV_Multiple[context].reference[i];
+                    COV_Subscriptions[index].flag.send_requested = true;
+                }
+                cov_multiple_request(context);
+            }
+        } else if (invoke_id && tsm_invoke_id_free(invoke_id)) {
+            COV_Multiple[context].invokeID = 0;
+            cov_recipient_done(COV_Multiple[context].dest_index, true);
+            COV_Multiple[context].attempts = 0;
+        }
+    }
+}
+
+/* sends one requested notification; false if it has to wait */
+static bool cov_send_subscription(
+    unsigned index,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    bool status = false;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = &COV_Subscriptions[index];
+
+    if (cov_subscription->flag.issueConfirmedNotifications) {
+        if ((cov_subscription->invokeID != 0) ||
+            (COV_Pending_Count >= MAX_TSM_TRANSACTIONS) ||
+            (!cov_recipient_ready(cov_subscription->dest_index)) ||
+            (!tsm_transaction_available())) {
+            /* already sending, recipient busy or held off,
+               or no transactions available */
+            return false;
+        }
+    }
+#if PRINT_ENABLED
+    fprintf(stderr, "COVtask: Sending...\n");
+#endif
+    status = cov_send_request(cov_subscription, value_list);
+    if (cov_subscription->invokeID) {
+        COV_Pending[COV_Pending_Count] = (uint8_t) index;
+        COV_Pending_Count++;
+        COV_Addresses[cov_subscription->dest_index].in_flight++;
+    }
+    if (status) {
+        cov_subscription->flag.send_requested = false;
+    }
+
+    return status;
+}
+
+/* the monitored value as a number, for the change comparisons */
+static float cov_value_real(
+    BACNET_APPLICATION_DATA_VALUE * value)
+{
+    float real_value = 0.0;
+
+    switch (value->tag) {
+        case BACNET_APPLICATION_TAG_REAL:
+            real_value = value->type.Real;
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            real_value = (float) value->type.Enumerated;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            real_value = (float) value->type.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            real_value = value->type.Boolean ? 1.0 : 0.0;
+            break;
+        default:
+            break;
+    }
+
+    return real_value;
+}
+
+/* remembers what a SubscribeCOVProperty subscriber was last sent */
+static void cov_subscription_prior_set(
+    BACNET_COV_SUBSCRIPTION * cov_subscription,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    if (cov_subscription->flag.monitorProperty) {
+        cov_subscription->priorValue = cov_value_real(&value_list[0].value);
+        cov_subscription->priorStatusFlags =
+            bitstring_octet(&value_list[1].value.type.Bit_String, 0);
+        cov_subscription->flag.priorValid = true;
+    }
+}
+
+/**
+ * Decides if a subscriber of a changed object gets a notification.
+ * SubscribeCOV subscribers, and SubscribeCOVProperty subscribers that
+ * gave no increment, follow the object's own COV criteria.  A client
+ * specified increment is checked against the value last sent to that
+ * client; any change in Status_Flags always triggers.
+ */
+static bool cov_subscription_triggered(
+    BACNET_COV_SUBSCRIPTION * cov_subscription,
+    BACNET_PROPERTY_VALUE * value_list,
+    bool object_changed)
+{
+    float value = 0.0;
+    float cov_delta = 0.0;
+
+    if (!cov_subscription->flag.monitorProperty) {
+        return object_changed;
+    }
+    if (!cov_subscription->flag.priorValid) {
+        return true;
+    }
+    if (cov_subscription->priorStatusFlags !=
+        bitstring_octet(&value_list[1].value.type.Bit_String, 0)) {
+        return true;
+    }
+    if (cov_subscription->monitoredProperty == PROP_STATUS_FLAGS) {
+        return false;
+    }
+    if (cov_subscription->flag.covIncrementPresent &&
+        (value_list[0].value.tag == BACNET_APPLICATION_TAG_REAL)) {
+        value = value_list[0].value.type.Real;
+        if (cov_subscription->priorValue > value) {
+            cov_delta = cov_subscription->priorValue - value;
+        } else {
+            cov_delta = value - cov_subscription->priorValue;
+        }
+        return ((cov_delta > 0.0) &&
+            (cov_delta >= cov_subscription->covIncrement));
+    }
+
+    return object_changed;
+}
+
+/**
+ * Sends one COVNotificationMultiple with the current values of every
+ * reference of the context that changed since the last one.
+ * The values are encoded one object at a time.
+ *
+ * @return false if it has to wait for a free transaction
+ */
+static bool cov_multiple_send(
+    unsigned context)
+{
+    BACNET_COV_MULTIPLE *cov_multiple = &COV_Multiple[context];
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+    BACNET_ADDRESS *dest = NULL;
+    BACNET_COV_DATA cov_data;
+    BACNET_PROPERTY_VALUE value_list[2];
+    int pdu_len = 0;
+    int bytes_sent = 0;
+    uint8_t invoke_id = 0;
+    unsigned i = 0;
+
+    if (!dcc_communication_enabled()) {
+        return true;
+    }
+    dest = cov_address_get(cov_multiple->dest_index);
+    if (!dest) {
+        return true;
+    }
+    if (cov_multiple->issueConfirmedNotifications) {
+        if ((cov_multiple->invokeID != 0) ||
+            (!cov_recipient_ready(cov_multiple->dest_index)) ||
+            (!tsm_transaction_available())) {
+            /* already sending, recipient busy or held off,
+               or no transactions available */
+            return false;
+        }
+        invoke_id = tsm_next_free_invokeID();
+        if (!invoke_id) {
+            return false;
+        }
+    }
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, cov_multiple->issueConfirmedNotifications,
+        MESSAGE_PRIORITY_NORMAL);
+    pdu_len =
+        npdu_encode_pdu(&Handler_Transmit_Buffer[0], dest, &my_address,
+        &npdu_data);
+    cov_data.subscriberProcessIdentifier =
+        cov_multiple->subscriberProcessIdentifier;
+    cov_data.initiatingDeviceIdentifier = Device_Object_Instance_Number();
+    cov_data.timeRemaining =
+        COV_Subscriptions[cov_multiple->reference[0]].lifetime;
+    if (cov_multiple->issueConfirmedNotifications) {
+        pdu_len +=
+            ccov_notify_multiple_encode_apdu_init(&Handler_Transmit_Buffer
+            [pdu_len], invoke_id, &cov_data);
+    } else {
+        pdu_len +=
+            ucov_notify_multiple_encode_apdu_init(&Handler_Transmit_Buffer
+            [pdu_len], &cov_data);
+    }
+    for (i = 0; i < cov_multiple->reference_count; i++) {
+        cov_subscription = &COV_Subscriptions[cov_multiple->reference[i]];
+        if (!cov_subscription->flag.send_requested) {
+            continue;
+        }
+        value_list[0].next = &value_list[1];
+        value_list[1].next = NULL;
+        if (!Device_Encode_Value_List((BACNET_OBJECT_TYPE)
+                cov_subscription->monitoredObjectIdentifier.type,
+                cov_subscription->monitoredObjectIdentifier.instance,
+                &value_list[0])) {
+            continue;
+        }
+        cov_data.monitoredObjectIdentifier =
+            cov_subscription->monitoredObjectIdentifier;
+        if (cov_subscription->monitoredProperty == PROP_STATUS_FLAGS) {
+            cov_data.listOfValues = &value_list[1];
+        } else {
+            cov_data.listOfValues = &value_list[0];
+        }
+        pdu_len +=
+            cov_notify_multiple_encode_object(&Handler_Transmit_Buffer
+            [pdu_len], &cov_data);
+        cov_subscription_prior_set(cov_subscription, &value_list[0]);
+        cov_subscription->flag.send_requested = false;
+    }
+    pdu_len +=
+        cov_notify_multiple_encode_apdu_end(&Handler_Transmit_Buffer[pdu_len]);
+    if (cov_multiple->issueConfirmedNotifications) {
+        cov_multiple->invokeID = invoke_id;
+        COV_Addresses[cov_multiple->dest_index].in_flight++;
+        tsm_set_confirmed_unsegmented_transaction(invoke_id, dest,
+            &npdu_data, &Handler_Transmit_Buffer[0], (uint16_t) pdu_len);
+    }
+    bytes_sent =
+        datalink_send_pdu(dest, &npdu_data, &Handler_Transmit_Buffer[0],
+        pdu_len);
+#if PRINT_ENABLED
+    if (bytes_sent <= 0) {
+        fprintf(stderr, "COVnotificationMultiple: Failed to send PDU!\n");
+    }
+#else
+    (void) bytes_sent;
+#endif
+
+    return true;
+}
+
+/* sends the contexts whose max notification delay has run out */
+static void cov_multiple_task(
+    void)
+{
+    unsigned context = 0;
+
+    for (context = 0; context < MAX_COV_MULTIPLE; context++) {
+        if (COV_Multiple[context].valid &&
+            COV_Multiple[context].send_requested &&
+            (COV_Multiple[context].delay == 0)) {
+            if (cov_multiple_send(context)) {
+                COV_Multiple[context].send_requested = false;
+            }
+        }
+    }
+}
+
+/** Handler to turn one changed object into COV notifications.
+ * @ingroup DSCOV
+ * Takes the next object from the changed-object set, and
+ *  - If its value changed,
+ *    - Requests a notification for each subscriber whose COV criteria
+ *      are met (see cov_subscription_triggered())
+ *    - Clears the object's COV flag (eg, Binary_Input_Change_Of_Value_Clear() )
+ *  - Sends each requested notice with cov_send_request()
+ *    - Will be confirmed or unconfirmed, as per the subscription.
+ *  - Puts the object back in the set if a notice has to wait
+ *    for a free transaction.
+ * Only subscribers of changed objects are visited.
+ *
+ * @return true if no more objects are waiting.
+ */
+bool handler_cov_fsm(
+    void)
+{
+    unsigned slot = 0;
+    unsigned index = COV_INDEX_NONE;
+    BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
+    uint32_t object_instance = 0;
+    bool object_changed = false;
+    bool status = false;
+    bool waiting = false;
+    BACNET_COV_SUBSCRIPTION *cov_subscription = NULL;
+    BACNET_PROPERTY_VALUE value_list[2];
+
+    if (COV_Queue_Count == 0) {
+        return true;
+    }
+    slot = COV_Queue[COV_Queue_Head];
+    COV_Queue_Head = (COV_Queue_Head + 1) % COV_OBJECT_SLOTS;
+    COV_Queue_Count--;
+    COV_Objects[slot].queued = false;
+    if (COV_Objects[slot].state != COV_OBJECT_USED) {
+        /* not expected: removal takes the object out of the queue */
+        return (COV_Queue_Count == 0);
+    }
+    object_type = (BACNET_OBJECT_TYPE)
+        COV_Objects[slot].monitoredObjectIdentifier.type;
+    object_instance = COV_Objects[slot].monitoredObjectIdentifier.instance;
+    /* configure the linked list for the two properties,
+       encoded once for all the subscribers */
+    value_list[0].next = &value_list[1];
+    value_list[1].next = NULL;
+    if (!Device_Encode_Value_List(object_type, object_instance,
+            &value_list[0])) {
+        return (COV_Queue_Count == 0);
+    }
+    if (COV_Objects[slot].changed) {
+        COV_Objects[slot].changed = false;
+        object_changed = Device_COV(object_type, object_instance);
+        for (index = COV_Objects[slot].first_subscription;
+            index != COV_INDEX_NONE; index = COV_Subscriptions[index].next) {
+            if (cov_subscription_triggered(&COV_Subscriptions[index],
+                    &value_list[0], object_changed)) {
+                if (COV_Subscriptions[index].flag.send_requested) {
+                    /* the value still waiting is superseded */
+                    COV_Collapsed++;
+                }
+                COV_Subscriptions[index].flag.send_requested = true;
+            }
+        }
+        if (object_changed) {
+            Device_COV_Clear(object_type, object_instance);
+        }
+#if PRINT_ENABLED
+        fprintf(stderr, "COVtask: Marking...\n");
+#endif
+    }
+    for (index = COV_Objects[slot].first_subscription;
+        index != COV_INDEX_NONE; index = COV_Subscriptions[index].next) {
+        cov_subscription = &COV_Subscriptions[index];
+        if (!cov_subscription->flag.send_requested) {
+            continue;
+        }
+        if (cov_subscription->context != COV_INDEX_NONE) {
+            /* sent later, together with the rest of its context */
+            cov_multiple_request(cov_subscription->context);
+            continue;
+        }
+        /* SubscribeCOVProperty on Status_Flags sends only that one */
+        if (cov_subscription->flag.monitorProperty &&
+            (cov_subscription->monitoredProperty == PROP_STATUS_FLAGS)) {
+            status = cov_send_subscription(index, &value_list[1]);
+        } else {
+            status = cov_send_subscription(index, &value_list[0]);
+        }
+        if (status) {
+            cov_subscription_prior_set(cov_subscription, &value_list[0]);
+        } else {
+            waiting = true;
+        }
+    }
+    if (waiting) {
+        cov_object_queue(slot);
+    }
+
+    return (COV_Queue_Count == 0);
+}
+
+/** Handler to send the COV notifications for every object that changed
+ *  since the last call.
+ * @ingroup DSCOV
+ * Objects that have to wait for a transaction are tried again
+ * on the next call, not in this one.
+ */
+void handler_cov_task(
+    void)
+{
+    unsigned count = COV_Queue_Count;
+
+    cov_pending_task();
+    while (count--) {
+        if (handler_cov_fsm()) {
+            break;
+        }
+    }
+    cov_multiple_task();
+    if (COV_Persist_Dirty && (COV_Persist_Delay == 0)) {
+        cov_persist_save();
+    } else if (COV_Clock_Due) {
+        cov_clock_save();
+    }
+}
+
+/** Gets the confirmed COV notification delivery counters.
+ * @ingroup DSCOV
+ *
+ * @param retries [out] Notifications sent again after the TSM gave up.
+ * @param collapsed [out] Changes that replaced a value still waiting
+ *                        to be sent, so only the latest one was sent.
+ * @param failures [out] Notifications dropped after COV_RETRY_LIMIT
+ *                       attempts.
+ */
+void handler_cov_delivery_counters(
+    uint32_t * retries,
+    uint32_t * collapsed,
+    uint32_t * failures)
+{
+    if (retries) {
+        *retries = COV_Retries;
+    }
+    if (collapsed) {
+        *collapsed = COV_Collapsed;
+    }
+    if (failures) {
+        *failures = COV_Failures;
+    }
+}
+
+/* checks the monitored object, and for SubscribeCOVProperty the
+   monitored property and COV increment */
+static bool cov_subscribe_check(
     BACNET_SUBSCRIBE_COV_DATA * cov_data,
+    bool monitor_property,
     BACNET_ERROR_CLASS * error_class,
     BACNET_ERROR_CODE * error_code)
 {
@@ -766,45 +1751,67 @@ static bool cov_subscribe(
         (BACNET_OBJECT_TYPE) cov_data->monitoredObjectIdentifier.type;
     object_instance = cov_data->monitoredObjectIdentifier.instance;
     status = Device_Valid_Object_Id(object_type, object_instance);
-    if (status) {
-        status = Device_Value_List_Supported(object_type);
-        if (status) {
-            status =
-                cov_list_subscribe(src, cov_data, error_class, error_code);
-        } else {
-            *error_class = ERROR_CLASS_OBJECT;
-            *error_code = ERROR_CODE_OPTIONAL_FUNCTIONALITY_NOT_SUPPORTED;
-        }
-    } else {
+    if (!status) {
         *error_class = ERROR_CLASS_OBJECT;
         *error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    } else if (!Device_Value_List_Supported(object_type)) {
+        *error_class = ERROR_CLASS_OBJECT;
+        *error_code = ERROR_CODE_OPTIONAL_FUNCTIONALITY_NOT_SUPPORTED;
+        status = false;
+    } else if (monitor_property && !cov_data->cancellationRequest) {
+        /* only the properties in the object's value list */
+        if ((cov_data->monitoredProperty.propertyIdentifier !=
+                PROP_PRESENT_VALUE) &&
+            (cov_data->monitoredProperty.propertyIdentifier !=
+                PROP_STATUS_FLAGS)) {
+            *error_class = ERROR_CLASS_PROPERTY;
+            *error_code = ERROR_CODE_NOT_COV_PROPERTY;
+            status = false;
+        } else if (cov_data->monitoredProperty.propertyArrayIndex !=
+            BACNET_ARRAY_ALL) {
+            *error_class = ERROR_CLASS_PROPERTY;
+            *error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
+            status = false;
+        } else if (cov_data->covIncrementPresent &&
+            !(cov_data->covIncrement >= 0.0)) {
+            *error_class = ERROR_CLASS_SERVICES;
+            *error_code = ERROR_CODE_PARAMETER_OUT_OF_RANGE;
+            status = false;
+        }
     }
 
     return status;
 }
 
-/** Handler for a COV Subscribe Service request.
- * @ingroup DSCOV
- * This handler will be invoked by apdu_handler() if it has been enabled
- * by a call to apdu_set_confirmed_handler().
- * This handler builds a response packet, which is
- * - an Abort if
- *   - the message is segmented
- *   - if decoding fails
- * - an ACK, if cov_subscribe() succeeds
- * - an Error if cov_subscribe() fails
- *
- * @param service_request [in] The contents of the service request.
- * @param service_len [in] The length of the service_request.
- * @param src [in] BACNET_ADDRESS of the source of the message
- * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
- *                          decoded from the APDU header of this message.
- */
-void handler_cov_subscribe(
+static bool cov_subscribe(
+    BACNET_ADDRESS * src,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data,
+    bool monitor_property,
+    BACNET_ERROR_CLASS * error_class,
+    BACNET_ERROR_CODE * error_code)
+{
+    bool status = false;        /* return value */
+
+    status =
+        cov_subscribe_check(cov_data, monitor_property, error_class,
+        error_code);
+    if (status) {
+        status =
+            cov_list_subscribe(src, cov_data, monitor_property,
+            COV_INDEX_NONE, error_class, error_code);
+    }
+
+    return status;
+}
+
+/* common to SubscribeCOV and SubscribeCOVProperty: decode, subscribe,
+   and reply with an ACK, Error, Reject or Abort */
+static void cov_subscribe_handler(
     uint8_t * service_request,
     uint16_t service_len,
     BACNET_ADDRESS * src,
-    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+    BACNET_CONFIRMED_SERVICE_DATA * service_data,
+    BACNET_CONFIRMED_SERVICE service)
 {
     BACNET_SUBSCRIBE_COV_DATA cov_data;
     int len = 0;
@@ -816,7 +1823,9 @@ void handler_cov_subscribe(
     int bytes_sent = 0;
     BACNET_ADDRESS my_address;
     bool error = false;
+    bool monitor_property = false;
 
+    monitor_property = (service == SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY);
     /* initialize a common abort code */
     cov_data.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
     /* encode the NPDU portion of the packet */
@@ -834,9 +1843,15 @@ void handler_cov_subscribe(
         error = true;
         goto COV_ABORT;
     }
-    len =
-        cov_subscribe_decode_service_request(service_request, service_len,
-        &cov_data);
+    if (monitor_property) {
+        len =
+            cov_subscribe_property_decode_service_request(service_request,
+            service_len, &cov_data);
+    } else {
+        len =
+            cov_subscribe_decode_service_request(service_request,
+            service_len, &cov_data);
+    }
 #if PRINT_ENABLED
     if (len <= 0)
         fprintf(stderr, "SubscribeCOV: Unable to decode Request!\n");
@@ -848,12 +1863,12 @@ void handler_cov_subscribe(
     cov_data.error_class = ERROR_CLASS_OBJECT;
     cov_data.error_code = ERROR_CODE_UNKNOWN_OBJECT;
     success =
-        cov_subscribe(src, &cov_data, &cov_data.error_class,
-        &cov_data.error_code);
+        cov_subscribe(src, &cov_data, monitor_property,
+        &cov_data.error_class, &cov_data.error_code);
     if (success) {
         apdu_len =
             encode_simple_ack(&Handler_Transmit_Buffer[npdu_len],
-            service_data->invoke_id, SERVICE_CONFIRMED_SUBSCRIBE_COV);
+            service_data->invoke_id, service);
 #if PRINT_ENABLED
         fprintf(stderr, "SubscribeCOV: Sending Simple Ack!\n");
 #endif
@@ -877,7 +1892,7 @@ void handler_cov_subscribe(
         } else if (len == BACNET_STATUS_ERROR) {
             apdu_len =
                 bacerror_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
-                service_data->invoke_id, SERVICE_CONFIRMED_SUBSCRIBE_COV,
+                service_data->invoke_id, service,
                 cov_data.error_class, cov_data.error_code);
 #if PRINT_ENABLED
             fprintf(stderr, "SubscribeCOV: Sending Error!\n");
@@ -905,3 +1920,603 @@ void handler_cov_subscribe(
 
     return;
 }
+
+/** Handler for a COV Subscribe Service request.
+ * @ingroup DSCOV
+ * This handler will be invoked by apdu_handler() if it has been enabled
+ * by a call to apdu_set_confirmed_handler().
+ * This handler builds a response packet, which is
+ * - an Abort if
+ *   - the message is segmented
+ *   - if decoding fails
+ * - an ACK, if cov_subscribe() succeeds
+ * - an Error if cov_subscribe() fails
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_cov_subscribe(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    cov_subscribe_handler(service_request, service_len, src, service_data,
+        SERVICE_CONFIRMED_SUBSCRIBE_COV);
+}
+
+/** Handler for a COV Subscribe Property Service request.
+ * @ingroup DSCOV
+ * Same as handler_cov_subscribe(), for a single property of the object:
+ * Present_Value or Status_Flags.  The optional COV Increment applies to
+ * a REAL Present_Value and is kept per subscription, so each client
+ * gets the update rate it asked for.  Without it, the object's own
+ * COV_Increment is used.
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_cov_subscribe_property(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    cov_subscribe_handler(service_request, service_len, src, service_data,
+        SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY);
+}
+
+/* finds the SubscribeCOVPropertyMultiple context of a recipient */
+static unsigned cov_multiple_find(
+    BACNET_ADDRESS * src,
+    uint32_t subscriber_process_identifier)
+{
+    unsigned context = 0;
+    BACNET_ADDRESS *dest = NULL;
+
+    for (context = 0; context < MAX_COV_MULTIPLE; context++) {
+        if (COV_Multiple[context].valid &&
+            (COV_Multiple[context].subscriberProcessIdentifier ==
+                subscriber_process_identifier)) {
+            dest = cov_address_get(COV_Multiple[context].dest_index);
+            if (dest && bacnet_address_same(src, dest)) {
+                return context;
+            }
+        }
+    }
+
+    return COV_INDEX_NONE;
+}
+
+/**
+ * Subscribes, or cancels, every COV reference of a
+ * SubscribeCOVPropertyMultiple request.  All the references are
+ * checked before any of them is subscribed.
+ *
+ * @param failed [out] the reference that failed, if any
+ * @return true if all the references were subscribed
+ */
+static bool cov_subscribe_multiple(
+    BACNET_ADDRESS * src,
+    BACNET_SUBSCRIBE_COV_DATA * cov_data,
+    uint32_t max_notification_delay,
+    BACNET_SUBSCRIBE_COV_DATA ** failed,
+    BACNET_ERROR_CLASS * error_class,
+    BACNET_ERROR_CODE * error_code)
+{
+    BACNET_SUBSCRIBE_COV_DATA *reference = NULL;
+    unsigned context = COV_INDEX_NONE;
+    int dest_index = -1;
+    bool status = true;
+
+    context = cov_multiple_find(src, cov_data->subscriberProcessIdentifier);
+    if (cov_data->cancellationRequest) {
+        /* cancelling what is not subscribed succeeds anyway */
+        for (reference = cov_data; reference && (context != COV_INDEX_NONE);
+            reference = reference->next) {
+            cov_list_subscribe(src, reference, true, context, error_class,
+                error_code);
+            if (!COV_Multiple[context].valid) {
+                context = COV_INDEX_NONE;
+            }
+        }
+        return true;
+    }
+    for (reference = cov_data; reference; reference = reference->next) {
+        *failed = reference;
+        status =
+            cov_subscribe_check(reference, true, error_class, error_code);
+        if (!status) {
+            return false;
+        }
+    }
+    if (context == COV_INDEX_NONE) {
+        *failed = cov_data;
+        for (context = 0; context < MAX_COV_MULTIPLE; context++) {
+            if (!COV_Multiple[context].valid) {
+                break;
+            }
+        }
+        if (context < MAX_COV_MULTIPLE) {
+            dest_index = cov_address_add(src);
+        }
+        if (dest_index < 0) {
+            *error_class = ERROR_CLASS_RESOURCES;
+            *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
+            return false;
+        }
+        COV_Multiple[context].valid = true;
+        COV_Multiple[context].send_requested = false;
+        COV_Multiple[context].invokeID = 0;
+        COV_Multiple[context].reference_count = 0;
+        COV_Multiple[context].dest_index = (uint8_t) dest_index;
+        COV_Multiple[context].subscriberProcessIdentifier =
+            cov_data->subscriberProcessIdentifier;
+    }
+    COV_Multiple[context].issueConfirmedNotifications =
+        cov_data->issueConfirmedNotifications;
+    COV_Multiple[context].maxNotificationDelay = max_notification_delay;
+    for (reference = cov_data; reference; reference = reference->next) {
+        *failed = reference;
+        status =
+            cov_list_subscribe(src, reference, true, context, error_class,
+            error_code);
+        if (!status) {
+            break;
+        }
+    }
+    if (COV_Multiple[context].reference_count == 0) {
+        COV_Multiple[context].valid = false;
+        cov_address_remove_unused();
+    }
+
+    return status;
+}
+
+/** Handler for a COV Subscribe Property Multiple Service request.
+ * @ingroup DSCOV
+ * Subscribes one recipient to several properties of several objects.
+ * The changes of all of them within the max notification delay are
+ * sent together, in one COVNotificationMultiple.
+ * This handler builds a response packet, which is
+ * - an Abort if
+ *   - the message is segmented
+ *   - there are more COV references than one context can hold
+ * - a Reject if decoding fails
+ * - an ACK, if every reference was subscribed or cancelled
+ * - a SubscribeCOVPropertyMultiple-Error naming the first reference
+ *   that failed, otherwise
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_cov_subscribe_property_multiple(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data[MAX_COV_MULTIPLE_REFERENCES];
+    BACNET_SUBSCRIBE_COV_DATA *failed = NULL;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    uint32_t max_notification_delay = 0;
+    unsigned count = 0;
+    int len = 0;
+    int pdu_len = 0;
+    int npdu_len = 0;
+    int apdu_len = 0;
+    BACNET_NPDU_DATA npdu_data;
+    int bytes_sent = 0;
+    BACNET_ADDRESS my_address;
+
+    /* encode the NPDU portion of the packet */
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    npdu_len =
+        npdu_encode_pdu(&Handler_Transmit_Buffer[0], src, &my_address,
+        &npdu_data);
+    if (service_data->segmented_message) {
+        /* we don't support segmentation - send an abort */
+        len = BACNET_STATUS_ABORT;
+        cov_data[0].error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+    } else {
+        len =
+            cov_subscribe_property_multiple_decode_service_request
+            (service_request, service_len, &max_notification_delay,
+            &cov_data[0], MAX_COV_MULTIPLE_REFERENCES, &count);
+        if ((len > 0) && (count == 0)) {
+            len = BACNET_STATUS_REJECT;
+            cov_data[0].error_code =
+                ERROR_CODE_REJECT_MISSING_REQUIRED_PARAMETER;
+        }
+    }
+    if (len == BACNET_STATUS_ABORT) {
+        apdu_len =
+            abort_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+            service_data->invoke_id,
+            abort_convert_error_code(cov_data[0].error_code), true);
+#if PRINT_ENABLED
+        fprintf(stderr, "SubscribeCOVPropertyMultiple: Sending Abort!\n");
+#endif
+    } else if (len < 0) {
+        apdu_len =
+            reject_encode_apdu(&Handler_Transmit_Buffer[npdu_len],
+            service_data->invoke_id,
+            reject_convert_error_code(cov_data[0].error_code));
+#if PRINT_ENABLED
+        fprintf(stderr, "SubscribeCOVPropertyMultiple: Sending Reject!\n");
+#endif
+    } else if (cov_subscribe_multiple(src, &cov_data[0],
+            max_notification_delay, &failed, &error_class, &error_code)) {
+        apdu_len =
+            encode_simple_ack(&Handler_Transmit_Buffer[npdu_len],
+            service_data->invoke_id,
+            SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE);
+#if PRINT_ENABLED
+        fprintf(stderr, "SubscribeCOVPropertyMultiple: Sending Simple Ack!\n");
+#endif
+    } else {
+        apdu_len =
+            cov_subscribe_property_multiple_error_encode_apdu
+            (&Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+            error_class, error_code, failed);
+#if PRINT_ENABLED
+        fprintf(stderr, "SubscribeCOVPropertyMultiple: Sending Error!\n");
+#endif
+    }
+    pdu_len = npdu_len + apdu_len;
+    bytes_sent =
+        datalink_send_pdu(src, &npdu_data, &Handler_Transmit_Buffer[0],
+        pdu_len);
+    if (bytes_sent <= 0) {
+#if PRINT_ENABLED
+        fprintf(stderr,
+            "SubscribeCOVPropertyMultiple: Failed to send PDU (%s)!\n",
+            strerror(errno));
+#endif
+    }
+
+    return;
+}
+
+/* NVS layout: the address table and the contexts as blobs, then the
+   subscriptions in chunks of COV_PERSIST_CHUNK records, so that no blob
+   has to be assembled beyond one small stack buffer. */
+#define COV_NVS_NAMESPACE "bacnet_cov"
+#define COV_NVS_VERSION 2
+#ifndef COV_PERSIST_CHUNK
+#define COV_PERSIST_CHUNK 16
+#endif
+#define COV_PERSIST_CHUNKS \
+    ((MAX_COV_SUBCRIPTIONS + COV_PERSIST_CHUNK - 1) / COV_PERSIST_CHUNK)
+
+typedef struct BACnet_COV_Persist_Context {
+    uint8_t valid;
+    uint8_t issueConfirmedNotifications;
+    uint8_t dest_index;
+    uint32_t subscriberProcessIdentifier;
+    uint32_t maxNotificationDelay;
+} BACNET_COV_PERSIST_CONTEXT;
+
+typedef struct BACnet_COV_Persist_Subscription {
+    uint32_t subscriberProcessIdentifier;
+    uint32_t expiry;    /* on the COV clock; 0 if indefinite */
+    BACNET_OBJECT_ID monitoredObjectIdentifier;
+    uint32_t monitoredProperty;
+    float covIncrement;
+    uint8_t dest_index;
+    uint8_t context;
+    uint8_t issueConfirmedNotifications;
+    uint8_t monitorProperty;
+    uint8_t covIncrementPresent;
+} BACNET_COV_PERSIST_SUBSCRIPTION;
+
+/* writes the COV clock, so that lifetimes keep running across a reset */
+static void cov_clock_save(
+    void)
+{
+    NVSTORE_HANDLE handle = 0;
+    NVSTORE_STATUS status = NVSTORE_OK;
+
+    COV_Clock_Due = false;
+    status = nvstore_open(COV_NVS_NAMESPACE, true, &handle);
+    if (status == NVSTORE_OK) {
+        status = nvstore_set_u32(handle, "clock", COV_Clock);
+        if (status == NVSTORE_OK) {
+            status = nvstore_commit(handle);
+        }
+        nvstore_close(handle);
+    }
+    if (status == NVSTORE_OK) {
+        COV_Clock_Saved = COV_Clock;
+    } else {
+#ifdef ESP_PLATFORM
+        ESP_LOGW("COV", "Saving the clock failed: %d", (int) status);
+#endif
+    }
+}
+
+/* writes the whole subscription table to NVS */
+static void cov_persist_save(
+    void)
+{
+    BACNET_COV_PERSIST_CONTEXT contexts[MAX_COV_MULTIPLE];
+    BACNET_COV_PERSIST_SUBSCRIPTION chunk[COV_PERSIST_CHUNK];
+    BACNET_COV_PERSIST_SUBSCRIPTION *record = NULL;
+    NVSTORE_HANDLE handle = 0;
+    NVSTORE_STATUS status = NVSTORE_OK;
+    char key[8];
+    unsigned index = 0;
+    unsigned count = 0;
+    unsigned chunk_count = 0;
+    unsigned chunks = 0;
+
+    status = nvstore_open(COV_NVS_NAMESPACE, true, &handle);
+    if (status != NVSTORE_OK) {
+#ifdef ESP_PLATFORM
+        ESP_LOGW("COV", "NVS open failed: %d", (int) status);
+#endif
+        /* try again after the next change */
+        COV_Persist_Dirty = false;
+        return;
+    }
+    status = nvstore_set_u8(handle, "version", COV_NVS_VERSION);
+    if (status == NVSTORE_OK) {
+        status = nvstore_set_u32(handle, "clock", COV_Clock);
+    }
+    if (status == NVSTORE_OK) {
+        status = nvstore_set_blob(handle, "addr", COV_Addresses,
+            sizeof(COV_Addresses));
+    }
+    for (index = 0; index < MAX_COV_MULTIPLE; index++) {
+        memset(&contexts[index], 0, sizeof(contexts[index]));
+        if (COV_Multiple[index].valid) {
+            contexts[index].valid = 1;
+            contexts[index].issueConfirmedNotifications =
+                COV_Multiple[index].issueConfirmedNotifications;
+            contexts[index].dest_index = COV_Multiple[index].dest_index;
+            contexts[index].subscriberProcessIdentifier =
+                COV_Multiple[index].subscriberProcessIdentifier;
+            contexts[index].maxNotificationDelay =
+                COV_Multiple[index].maxNotificationDelay;
+        }
+    }
+    if (status == NVSTORE_OK) {
+        status = nvstore_set_blob(handle, "mult", contexts, sizeof(contexts));
+    }
+    for (index = 0; (index < MAX_COV_SUBCRIPTIONS) &&
+        (status == NVSTORE_OK); index++) {
+        if (COV_Subscriptions[index].flag.valid) {
+            record = &chunk[chunk_count];
+            memset(record, 0, sizeof(*record));
+            record->subscriberProcessIdentifier =
+                COV_Subscriptions[index].subscriberProcessIdentifier;
+            if (COV_Subscriptions[index].lifetime) {
+                record->expiry =
+                    COV_Clock + COV_Subscriptions[index].lifetime;
+            }
+            record->monitoredObjectIdentifier =
+                COV_Subscriptions[index].monitoredObjectIdentifier;
+            record->monitoredProperty =
+                COV_Subscriptions[index].monitoredProperty;
+            record->covIncrement = COV_Subscriptions[index].covIncrement;
+            record->dest_index = COV_Subscriptions[index].dest_index;
+            record->context = COV_Subscriptions[index].context;
+            record->issueConfirmedNotifications =
+                COV_Subscriptions[index].flag.issueConfirmedNotifications;
+            record->monitorProperty =
+                COV_Subscriptions[index].flag.monitorProperty;
+            record->covIncrementPresent =
+                COV_Subscriptions[index].flag.covIncrementPresent;
+            chunk_count++;
+            count++;
+        }
+        if ((chunk_count == COV_PERSIST_CHUNK) || ((chunk_count > 0) &&
+                (index == (MAX_COV_SUBCRIPTIONS - 1)))) {
+            snprintf(key, sizeof(key), "sub%u", chunks);
+            status = nvstore_set_blob(handle, key, chunk,
+                chunk_count * sizeof(chunk[0]));
+            chunk_count = 0;
+            chunks++;
+        }
+    }
+    if (status == NVSTORE_OK) {
+        status = nvstore_set_u16(handle, "count", (uint16_t) count);
+    }
+    /* drop the chunks of a longer table saved before */
+    for (index = chunks; (index < COV_PERSIST_CHUNKS) &&
+        (status == NVSTORE_OK); index++) {
+        snprintf(key, sizeof(key), "sub%u", index);
+        status = nvstore_erase_key(handle, key);
+        if (status == NVSTORE_NOT_FOUND) {
+            status = NVSTORE_OK;
+        }
+    }
+    if (status == NVSTORE_OK) {
+        status = nvstore_commit(handle);
+    }
+    nvstore_close(handle);
+    if (status == NVSTORE_OK) {
+        COV_Clock_Saved = COV_Clock;
+        COV_Clock_Due = false;
+    } else {
+#ifdef ESP_PLATFORM
+        ESP_LOGW("COV", "Saving %u subscriptions failed: %d", count,
+            (int) status);
+#endif
+    }
+    COV_Persist_Dirty = false;
+}
+
+/* reads back the subscription table saved by cov_persist_save(),
+   as if every subscription had just been received again, with what is
+   left of its lifetime.  Subscriptions that expired are dropped. */
+static void cov_persist_restore(
+    void)
+{
+    BACNET_COV_PERSIST_CONTEXT contexts[MAX_COV_MULTIPLE];
+    BACNET_COV_PERSIST_SUBSCRIPTION chunk[COV_PERSIST_CHUNK];
+    BACNET_COV_PERSIST_SUBSCRIPTION *record = NULL;
+    BACNET_COV_ADDRESS addresses[MAX_COV_ADDRESSES];
+    BACNET_SUBSCRIBE_COV_DATA cov_data;
+    BACNET_ERROR_CLASS error_class = ERROR_CLASS_OBJECT;
+    BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    uint8_t context_map[MAX_COV_MULTIPLE];
+    BACNET_ADDRESS *dest = NULL;
+    NVSTORE_HANDLE handle = 0;
+    NVSTORE_STATUS status = NVSTORE_OK;
+    char key[8];
+    size_t length = 0;
+    uint8_t version = 0;
+    uint16_t count = 0;
+    uint32_t clock = 0;
+    unsigned restored = 0;
+    unsigned expired = 0;
+    unsigned context = COV_INDEX_NONE;
+    unsigned index = 0;
+    unsigned chunks = 0;
+    unsigned i = 0;
+    int dest_index = -1;
+
+    if (nvstore_open(COV_NVS_NAMESPACE, false, &handle) != NVSTORE_OK) {
+        /* nothing saved yet */
+        return;
+    }
+    status = nvstore_get_u8(handle, "version", &version);
+    if ((status == NVSTORE_OK) && (version == COV_NVS_VERSION)) {
+        status = nvstore_get_u32(handle, "clock", &clock);
+    } else {
+        status = NVSTORE_NOT_FOUND;
+    }
+    if (status == NVSTORE_OK) {
+        /* the time since the last checkpoint is unknown: charge it all */
+        COV_Clock = clock + COV_CLOCK_CHECKPOINT;
+        length = sizeof(addresses);
+        status = nvstore_get_blob(handle, "addr", addresses, &length);
+        if ((status == NVSTORE_OK) && (length != sizeof(addresses))) {
+            status = NVSTORE_INVALID_LENGTH;
+        }
+    }
+    if (status == NVSTORE_OK) {
+        length = sizeof(contexts);
+        status = nvstore_get_blob(handle, "mult", contexts, &length);
+        if ((status == NVSTORE_OK) && (length != sizeof(contexts))) {
+            status = NVSTORE_INVALID_LENGTH;
+        }
+    }
+    if (status == NVSTORE_OK) {
+        status = nvstore_get_u16(handle, "count", &count);
+    }
+    /* the contexts first, so their references can join them */
+    for (index = 0; index < MAX_COV_MULTIPLE; index++) {
+        context_map[index] = COV_INDEX_NONE;
+        if ((status != NVSTORE_OK) || !contexts[index].valid ||
+            (contexts[index].dest_index >= MAX_COV_ADDRESSES) ||
+            !addresses[contexts[index].dest_index].valid) {
+            continue;
+        }
+        dest_index =
+            cov_address_add(&addresses[contexts[index].dest_index].dest);
+        if (dest_index >= 0) {
+            COV_Multiple[index].valid = true;
+            COV_Multiple[index].send_requested = false;
+            COV_Multiple[index].invokeID = 0;
+            COV_Multiple[index].reference_count = 0;
+            COV_Multiple[index].dest_index = (uint8_t) dest_index;
+            COV_Multiple[index].issueConfirmedNotifications =
+                contexts[index].issueConfirmedNotifications;
+            COV_Multiple[index].subscriberProcessIdentifier =
+                contexts[index].subscriberProcessIdentifier;
+            COV_Multiple[index].maxNotificationDelay =
+                contexts[index].maxNotificationDelay;
+            context_map[index] = (uint8_t) index;
+        }
+    }
+    while ((status == NVSTORE_OK) && (count > 0) &&
+        (chunks < COV_PERSIST_CHUNKS)) {
+        snprintf(key, sizeof(key), "sub%u", chunks);
+        length = sizeof(chunk);
+        status = nvstore_get_blob(handle, key, chunk, &length);
+        if (status != NVSTORE_OK) {
+            break;
+        }
+        chunks++;
+        for (i = 0; (i < (length / sizeof(chunk[0]))) && (count > 0); i++) {
+            count--;
+            record = &chunk[i];
+            if ((record->dest_index >= MAX_COV_ADDRESSES) ||
+                !addresses[record->dest_index].valid) {
+                continue;
+            }
+            if (record->expiry && (record->expiry <= COV_Clock)) {
+                expired++;
+                continue;
+            }
+            context = COV_INDEX_NONE;
+            if (record->context != COV_INDEX_NONE) {
+                if ((record->context >= MAX_COV_MULTIPLE) ||
+                    (context_map[record->context] == COV_INDEX_NONE)) {
+                    continue;
+                }
+                context = context_map[record->context];
+            }
+            memset(&cov_data, 0, sizeof(cov_data));
+            cov_data.subscriberProcessIdentifier =
+                record->subscriberProcessIdentifier;
+            cov_data.monitoredObjectIdentifier =
+                record->monitoredObjectIdentifier;
+            cov_data.cancellationRequest = false;
+            cov_data.issueConfirmedNotifications =
+                record->issueConfirmedNotifications;
+            if (record->expiry) {
+                cov_data.lifetime = record->expiry - COV_Clock;
+            }
+            cov_data.monitoredProperty.propertyIdentifier =
+                (BACNET_PROPERTY_ID) record->monitoredProperty;
+            cov_data.monitoredProperty.propertyArrayIndex = BACNET_ARRAY_ALL;
+            cov_data.covIncrementPresent = record->covIncrementPresent;
+            cov_data.covIncrement = record->covIncrement;
+            dest = &addresses[record->dest_index].dest;
+            /* the object may be gone after a firmware update */
+            if (cov_subscribe_check(&cov_data, record->monitorProperty,
+                    &error_class, &error_code) &&
+                cov_list_subscribe(dest, &cov_data, record->monitorProperty,
+                    context, &error_class, &error_code)) {
+                restored++;
+            }
+        }
+    }
+    nvstore_close(handle);
+    for (index = 0; index < MAX_COV_MULTIPLE; index++) {
+        if (COV_Multiple[index].valid &&
+            (COV_Multiple[index].reference_count == 0)) {
+            COV_Multiple[index].valid = false;
+        }
+    }
+    cov_address_remove_unused();
+    /* what was restored is what was saved, less what expired */
+    COV_Persist_Dirty = false;
+    if (expired) {
+        cov_persist_changed();
+    }
+    /* count this boot's charge even if the next reset comes early */
+    if (COV_Clock != clock) {
+        cov_clock_save();
+    }
+#ifdef ESP_PLATFORM
+    if (restored || expired) {
+        ESP_LOGI("COV", "Restored %u subscriptions, %u expired", restored,
+            expired);
+    }
+#endif
+}
@@ -0,0 +1,112 @@
+/**************************************************************************
+*
+* DeleteObject service handler
+*
+*********************************************************************/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "config.h"
+#include "txbuf.h"
+#include "bacdef.h"
+#include "bacdcode.h"
+#include "bacerror.h"
+#include "apdu.h"
+#include "npdu.h"
+#include "abort.h"
+#include "reject.h"
+#include "delete_object.h"
+/* the device object finds the object type and deletes the object */
+#include "device.h"
+#include "handlers.h"
+
+/** @file h_delete_object.c  Handles DeleteObject requests. */
+
+/** Handler for a DeleteObject request.
+ * @ingroup DMDO
+ * This handler will be invoked by apdu_handler() if it has been enabled
+ * by a call to apdu_set_confirmed_handler().
+ * This handler builds a response packet, which is
+ * - an Abort if
+ *   - the message is segmented
+ *   - if decoding fails
+ * - an Error if there is no such object or it cannot be deleted
+ * - else a simple ACK.
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ *                          decoded from the APDU header of this message.
+ */
+void handler_delete_object(
+    uint8_t * service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS * src,
+    BACNET_CONFIRMED_SERVICE_DATA * service_data)
+{
+    BACNET_DELETE_OBJECT_DATA data;
+    int len = 0;
+    int pdu_len = 0;
+    BACNET_NPDU_DATA npdu_data;
+    BACNET_ADDRESS my_address;
+
+    /* encode the NPDU portion of the packet */
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len =
+        npdu_encode_pdu(&Handler_Transmit_Buffer[0], src, &my_address,
+        &npdu_data);
+    if (service_data->segmented_message) {
+        len =
+            abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, ABORT_REASON_SEGMENTATION_NOT_SUPPORTED,
+            true);
+#if PRINT_ENABLED
+        fprintf(stderr, "DeleteObject: Sending Abort - segmented message.\n");
+#endif
+        goto DO_ABORT;
+    }
+    len = delete_object_decode_service_request(service_request, service_len,
+        &data);
+    if (len < 0) {
+        len =
+            abort_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, ABORT_REASON_OTHER, true);
+#if PRINT_ENABLED
+        fprintf(stderr, "DeleteObject: Sending Abort - could not decode.\n");
+#endif
+        goto DO_ABORT;
+    }
+    if (Device_Delete_Object(&data)) {
+        len =
+            encode_simple_ack(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, SERVICE_CONFIRMED_DELETE_OBJECT);
+#if PRINT_ENABLED
+        fprintf(stderr, "DeleteObject: Sending Simple Ack!\n");
+#endif
+    } else {
+        len =
+            bacerror_encode_apdu(&Handler_Transmit_Buffer[pdu_len],
+            service_data->invoke_id, SERVICE_CONFIRMED_DELETE_OBJECT,
+            data.error_class, data.error_code);
+#if PRINT_ENABLED
+        fprintf(stderr, "DeleteObject: Sending Error.\n");
+#endif
+    }
+  DO_ABORT:
+    pdu_len += len;
+    len =
+        datalink_send_pdu(src, &npdu_data, &Handler_Transmit_Buffer[0],
+        pdu_len);
+    if (len <= 0) {
+#if PRINT_ENABLED
+        fprintf(stderr, "DeleteObject: Failed to send PDU (%s)!\n",
+            strerror(errno));
+#endif
+    }
+
+    return;
+}
@@ -42,16 +42,17 @@
 extern "C" {
 #endif /* __cplusplus */
 
+    /* the Present_Value, flags and COV state are kept apart, in
+       arrays by object in ai.c */
     typedef struct analog_input_descr {
-        unsigned Event_State:3;
-        float Present_Value;
         BACNET_RELIABILITY Reliability;
-        bool Out_Of_Service;
         uint8_t Units;
-        float Prior_Value;
-        float COV_Increment;
-        bool Changed;
+    } ANALOG_INPUT_DESCR;
+
 #if defined(INTRINSIC_REPORTING)
+    /* held only by the objects intrinsic reporting was set up for */
+    typedef struct analog_input_event {
+        unsigned Event_State:3;
         uint32_t Time_Delay;
         uint32_t Notification_Class;
         float High_Limit;
@@ -66,8 +67,8 @@ extern "C" {
         uint32_t Remaining_Time_Delay;
         /* AckNotification informations */
         ACK_NOTIFICATION Ack_notify_data;
+    } ANALOG_INPUT_EVENT;
 #endif
-    } ANALOG_INPUT_DESCR;
 
     void Analog_Input_Property_Lists(
         const int **pRequired,
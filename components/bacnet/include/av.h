@@ -32,6 +32,9 @@
 #include "bacerror.h"
 #include "wp.h"
 #include "rp.h"
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
 #if defined(INTRINSIC_REPORTING)
 #include "nc.h"
 #include "alarm_ack.h"
@@ -43,12 +46,44 @@
 extern "C" {
 #endif /* __cplusplus */
 
+    /* proprietary properties of the bound Analog Values */
+    /* REAL, read only: the source value before filtering */
+#define PROP_PM_RAW_VALUE 512
+    /* Unsigned, odd 1..9: median of that many samples, 1 = off */
+#define PROP_PM_MEDIAN_WINDOW 513
+    /* REAL, 0 < alpha <= 1: weight of a new sample in the EMA, 1 = off */
+#define PROP_PM_EMA_ALPHA 514
+    /* Unsigned 1..16: mean of that many samples, 1 = off */
+#define PROP_PM_MEAN_WINDOW 515
+
+    /* the application's own objects, instances 0..n-1, which CreateObject
+       can add to and DeleteObject cannot remove: the setpoint and the 12
+       channels of each PMS5003 sensor (PM25_CHANNEL_COUNT, checked in
+       point_binding.c) */
+#if !defined(ANALOG_VALUES_FIXED)
+#if defined(CONFIG_PM25_SENSOR_COUNT)
+#define ANALOG_VALUES_FIXED (1 + 12 * CONFIG_PM25_SENSOR_COUNT)
+#else
+#error "ANALOG_VALUES_FIXED needs CONFIG_PM25_SENSOR_COUNT"
+#endif
+#endif
+
+    /* What a present-value read or a COV scan needs is kept apart, in
+       arrays by slot in av.c; these are the rarely used properties. */
     typedef struct analog_value_descr {
-        unsigned Event_State:3;
-        bool Out_Of_Service;
+        char *Object_Name;
         uint16_t Units;
-        float Present_Value;
+        /* the PROP_PM_ filter parameters of a bound object */
+        uint8_t Median_Window;
+        uint8_t Mean_Window;
+        float EMA_Alpha;
+    } ANALOG_VALUE_DESCR;
+
 #if defined(INTRINSIC_REPORTING)
+    /* Intrinsic reporting, held only by the objects it was set up for:
+       the others read the defaults and stay NORMAL */
+    typedef struct analog_value_event {
+        unsigned Event_State:3;
         uint32_t Time_Delay;
         uint32_t Notification_Class;
         float High_Limit;
@@ -63,14 +98,24 @@ extern "C" {
         uint32_t Remaining_Time_Delay;
         /* AckNotification informations */
         ACK_NOTIFICATION Ack_notify_data;
+    } ANALOG_VALUE_EVENT;
 #endif
-    } ANALOG_VALUE_DESCR;
+
+    /* called after a WriteProperty has changed a Present_Value */
+    typedef void (
+        *analog_value_write_function) (
+        uint32_t object_instance);
 
 
     void Analog_Value_Property_Lists(
         const int **pRequired,
         const int **pOptional,
         const int **pProprietary);
+    void Analog_Value_Instance_Property_Lists(
+        uint32_t object_instance,
+        const int **pRequired,
+        const int **pOptional,
+        const int **pProprietary);
     bool Analog_Value_Valid_Instance(
         uint32_t object_instance);
     unsigned Analog_Value_Count(
@@ -83,6 +128,9 @@ extern "C" {
     bool Analog_Value_Object_Name(
         uint32_t object_instance,
         BACNET_CHARACTER_STRING * object_name);
+    bool Analog_Value_Name_Set(
+        uint32_t object_instance,
+        char *new_name);
 
     int Analog_Value_Read_Property(
         BACNET_READ_PROPERTY_DATA * rpdata);
@@ -96,6 +144,25 @@ extern "C" {
         uint8_t priority);
     float Analog_Value_Present_Value(
         uint32_t object_instance);
+    void Analog_Value_Bind(
+        uint32_t object_instance,
+        bool bound);
+    bool Analog_Value_Source_Update(
+        uint32_t object_instance,
+        float value,
+        float raw_value);
+    void Analog_Value_Filter_Set(
+        uint32_t object_instance,
+        unsigned median_window,
+        float ema_alpha,
+        unsigned mean_window);
+    bool Analog_Value_Filter_Pending(
+        uint32_t object_instance,
+        unsigned *median_window,
+        float *ema_alpha,
+        unsigned *mean_window);
+    void Analog_Value_Write_Notify_Set(
+        analog_value_write_function notify);
     bool Analog_Value_Change_Of_Value(
         uint32_t instance);
     void Analog_Value_Change_Of_Value_Clear(
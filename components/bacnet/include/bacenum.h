@@ -1247,7 +1247,10 @@ typedef enum {
     /* lifeSafetyOperation (27) see Alarm and Event Services */
     /* subscribeCOVProperty (28) see Alarm and Event Services */
     /* getEventInformation (29) see Alarm and Event Services */
-    MAX_BACNET_CONFIRMED_SERVICE = 30
+    /* Services added after 2012 */
+    SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE = 30,
+    SERVICE_CONFIRMED_COV_NOTIFICATION_MULTIPLE = 31,
+    MAX_BACNET_CONFIRMED_SERVICE = 32
 } BACNET_CONFIRMED_SERVICE;
 
 typedef enum {
@@ -1263,12 +1266,13 @@ typedef enum {
     SERVICE_UNCONFIRMED_UTC_TIME_SYNCHRONIZATION = 9,
     /* addendum 2010-aa */
     SERVICE_UNCONFIRMED_WRITE_GROUP = 10,
+    SERVICE_UNCONFIRMED_COV_NOTIFICATION_MULTIPLE = 11,
     /* Other services to be added as they are defined. */
     /* All choice values in this production are reserved */
     /* for definition by ASHRAE. */
     /* Proprietary extensions are made by using the */
     /* UnconfirmedPrivateTransfer service. See Clause 23. */
-    MAX_BACNET_UNCONFIRMED_SERVICE = 11
+    MAX_BACNET_UNCONFIRMED_SERVICE = 12
 } BACNET_UNCONFIRMED_SERVICE;
 
 /* Bit String Enumerations */
@@ -1282,6 +1286,8 @@ typedef enum {
     SERVICE_SUPPORTED_GET_EVENT_INFORMATION = 39,
     SERVICE_SUPPORTED_SUBSCRIBE_COV = 5,
     SERVICE_SUPPORTED_SUBSCRIBE_COV_PROPERTY = 38,
+    SERVICE_SUPPORTED_SUBSCRIBE_COV_PROPERTY_MULTIPLE = 41,
+    SERVICE_SUPPORTED_CONFIRMED_COV_NOTIFICATION_MULTIPLE = 42,
     SERVICE_SUPPORTED_LIFE_SAFETY_OPERATION = 37,
     /* File Access Services */
     SERVICE_SUPPORTED_ATOMIC_READ_FILE = 6,
@@ -1313,6 +1319,7 @@ typedef enum {
     SERVICE_SUPPORTED_I_AM = 26,
     SERVICE_SUPPORTED_I_HAVE = 27,
     SERVICE_SUPPORTED_UNCONFIRMED_COV_NOTIFICATION = 28,
+    SERVICE_SUPPORTED_UNCONFIRMED_COV_NOTIFICATION_MULTIPLE = 43,
     SERVICE_SUPPORTED_UNCONFIRMED_EVENT_NOTIFICATION = 29,
     SERVICE_SUPPORTED_UNCONFIRMED_PRIVATE_TRANSFER = 30,
     SERVICE_SUPPORTED_UNCONFIRMED_TEXT_MESSAGE = 31,
@@ -106,6 +106,43 @@ extern "C" {
         uint8_t invoke_id,
         BACNET_SUBSCRIBE_COV_DATA * data);
 
+    int ccov_notify_multiple_encode_apdu_init(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        BACNET_COV_DATA * data);
+
+    int ucov_notify_multiple_encode_apdu_init(
+        uint8_t * apdu,
+        BACNET_COV_DATA * data);
+
+    int cov_notify_multiple_encode_object(
+        uint8_t * apdu,
+        BACNET_COV_DATA * data);
+
+    int cov_notify_multiple_encode_apdu_end(
+        uint8_t * apdu);
+
+    int cov_subscribe_property_multiple_encode_apdu(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        uint32_t max_notification_delay,
+        BACNET_SUBSCRIBE_COV_DATA * data);
+
+    int cov_subscribe_property_multiple_decode_service_request(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        uint32_t * max_notification_delay,
+        BACNET_SUBSCRIBE_COV_DATA * data,
+        unsigned data_size,
+        unsigned *data_count);
+
+    int cov_subscribe_property_multiple_error_encode_apdu(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        BACNET_ERROR_CLASS error_class,
+        BACNET_ERROR_CODE error_code,
+        BACNET_SUBSCRIBE_COV_DATA * failed);
+
     void cov_data_value_list_link(
         BACNET_COV_DATA *data,
         BACNET_PROPERTY_VALUE *value_list,
@@ -0,0 +1,59 @@
+/**************************************************************************
+*
+* CreateObject service (16.7 of the standard): the server side
+*
+*********************************************************************/
+#ifndef CREATE_OBJECT_H
+#define CREATE_OBJECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bacdef.h"
+#include "bacenum.h"
+
+typedef struct BACnet_Create_Object_Data {
+    BACNET_OBJECT_TYPE object_type;
+    /* BACNET_MAX_INSTANCE when the request gave only the type */
+    uint32_t object_instance;
+    /* listOfInitialValues, still encoded: BACnetPropertyValues as
+       WritePropertyMultiple has them, or NULL */
+    uint8_t *initial_values;
+    uint16_t initial_values_len;
+    /* for the error: the initial value that failed, 1..n, or 0 */
+    uint32_t first_failed_element;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+} BACNET_CREATE_OBJECT_DATA;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* decode the service request only */
+    int create_object_decode_service_request(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        BACNET_CREATE_OBJECT_DATA * data);
+
+/* the ACK: the identifier of the new object */
+    int create_object_ack_encode_apdu(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        BACNET_CREATE_OBJECT_DATA * data);
+
+/* the CreateObject-Error: the error and the failed initial value */
+    int create_object_error_ack_encode_apdu(
+        uint8_t * apdu,
+        uint8_t invoke_id,
+        BACNET_CREATE_OBJECT_DATA * data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+/** @defgroup DMCO Object Access-CreateObject (OA-CO)
+ * 16.7 CreateObject Service <br>
+ * The CreateObject service is used by a client BACnet-user to create a new
+ * instance of an object.  The client gives the type, and may give the
+ * instance number and initial values for properties of the new object.
+ */
+#endif
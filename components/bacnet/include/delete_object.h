@@ -0,0 +1,39 @@
+/**************************************************************************
+*
+* DeleteObject service (16.8 of the standard): the server side
+*
+*********************************************************************/
+#ifndef DELETE_OBJECT_H
+#define DELETE_OBJECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "bacdef.h"
+#include "bacenum.h"
+
+typedef struct BACnet_Delete_Object_Data {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+} BACNET_DELETE_OBJECT_DATA;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* decode the service request only */
+    int delete_object_decode_service_request(
+        uint8_t * apdu,
+        unsigned apdu_len,
+        BACNET_DELETE_OBJECT_DATA * data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+/** @defgroup DMDO Object Access-DeleteObject (OA-DO)
+ * 16.8 DeleteObject Service <br>
+ * The DeleteObject service is used by a client BACnet-user to delete an
+ * existing object.  Objects the device itself depends on may refuse.
+ */
+#endif
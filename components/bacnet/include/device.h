@@ -35,6 +35,8 @@
 #include "bacenum.h"
 #include "wp.h"
 #include "rd.h"
+#include "create_object.h"
+#include "delete_object.h"
 #include "rp.h"
 #include "rpm.h"
 #include "readrange.h"
@@ -138,6 +140,24 @@ typedef void (
     *object_intrinsic_reporting_function) (
     uint32_t object_instance);
 
+/** Creates an object of this type, for CreateObject.
+ * @ingroup ObjHelpers
+ * @param [in] The object instance number, which is not in use.
+ * @return True if the object was created, false if there is no room.
+ */
+typedef bool(
+    *object_create_function) (
+    uint32_t object_instance);
+
+/** Deletes an object of this type, for DeleteObject.
+ * @ingroup ObjHelpers
+ * @param [in] The object instance number of an existing object.
+ * @return True if the object was deleted, false if it may not be.
+ */
+typedef bool(
+    *object_delete_function) (
+    uint32_t object_instance);
+
 
 /** Defines the group of object helper functions for any supported Object.
  * @ingroup ObjHelpers
@@ -164,6 +184,11 @@ typedef struct object_functions {
     object_cov_function Object_COV;
     object_cov_clear_function Object_COV_Clear;
     object_intrinsic_reporting_function Object_Intrinsic_Reporting;
+    /* NULL if the objects cannot be created or deleted */
+    object_create_function Object_Create;
+    object_delete_function Object_Delete;
+    /* NULL if all objects of the type have the same properties */
+    rpm_instance_property_lists_function Object_RPM_Instance_List;
 } object_functions_t;
 
 /* String Lengths - excluding any nul terminator */
@@ -227,6 +252,11 @@ extern "C" {
     bool Device_Reinitialize(
         BACNET_REINITIALIZE_DEVICE_DATA * rd_data);
 
+    bool Device_Create_Object(
+        BACNET_CREATE_OBJECT_DATA * data);
+    bool Device_Delete_Object(
+        BACNET_DELETE_OBJECT_DATA * data);
+
     BACNET_REINITIALIZED_STATE Device_Reinitialized_State(
         void);
 
@@ -248,8 +278,19 @@ extern "C" {
         const int **pRequired,
         const int **pOptional,
         const int **pProprietary);
+    /* read only proprietary properties of the Device, served by the
+       application: the list ends with -1, and the function encodes the
+       value of one of them, returning the length or BACNET_STATUS_ERROR */
+    typedef int (
+        *device_read_proprietary_function) (
+        BACNET_PROPERTY_ID object_property,
+        uint8_t * apdu);
+    void Device_Proprietary_Set(
+        const int *properties,
+        device_read_proprietary_function read_function);
     void Device_Objects_Property_List(
         BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance,
         struct special_property_list_t *pPropertyList);
     /* functions to support COV */
     bool Device_Encode_Value_List(
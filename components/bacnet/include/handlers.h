@@ -163,6 +163,18 @@ extern "C" {
         BACNET_ADDRESS * src,
         BACNET_CONFIRMED_SERVICE_DATA * service_data);
 
+    void handler_create_object(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
+
+    void handler_delete_object(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
+
     void handler_device_communication_control(
         uint8_t * service_request,
         uint16_t service_len,
@@ -233,14 +245,41 @@ extern "C" {
         uint16_t service_len,
         BACNET_ADDRESS * src,
         BACNET_CONFIRMED_SERVICE_DATA * service_data);
+    void handler_cov_subscribe_property(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
+    void handler_cov_subscribe_property_multiple(
+        uint8_t * service_request,
+        uint16_t service_len,
+        BACNET_ADDRESS * src,
+        BACNET_CONFIRMED_SERVICE_DATA * service_data);
     bool handler_cov_fsm(
         void);
     void handler_cov_task(
         void);
     void handler_cov_timer_seconds(
         uint32_t elapsed_seconds);
+    void handler_cov_delivery_counters(
+        uint32_t * retries,
+        uint32_t * collapsed,
+        uint32_t * failures);
     void handler_cov_init(
         void);
+    void handler_cov_object_changed(
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
+    /* also told of every change, whether subscribed to or not */
+    typedef void (
+        *handler_cov_changed_function) (
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
+    void handler_cov_object_changed_notify_set(
+        handler_cov_changed_function notify);
+    void handler_cov_object_deleted(
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
     int handler_cov_encode_subscriptions(
         uint8_t * apdu,
         int max_apdu);
@@ -0,0 +1,132 @@
+/* Loop Objects: the configuration and the last result of each control
+   loop.  The application evaluates the loops, see Loop_Settings() and
+   Loop_Update(). */
+#ifndef LO_H
+#define LO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bacdef.h"
+#include "bacenum.h"
+#include "bacerror.h"
+#include "bacapp.h"
+#include "bacdevobjpropref.h"
+#include "rp.h"
+#include "wp.h"
+
+#ifndef MAX_LOOPS
+#define MAX_LOOPS 4
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    /* proprietary properties of the Loop */
+    /* Enumerated, LOOP_MODE_: the control algorithm */
+#define PROP_LOOP_MODE 512
+    /* REAL >= 0: width of the on/off band, centred on the setpoint,
+       in the units of the controlled variable */
+#define PROP_LOOP_DEADBAND 513
+
+    typedef enum {
+        LOOP_MODE_PID = 0,
+        /* Maximum_Output above the band, Minimum_Output below it, and
+           no change inside it */
+        LOOP_MODE_ON_OFF = 1
+    } BACNET_LOOP_MODE;
+
+    /* What the loop does; all of it is writable over BACnet.  A
+       reference to instance BACNET_MAX_INSTANCE refers to nothing:
+       without a Setpoint_Reference the Setpoint property is used, and
+       a loop without a controlled or manipulated variable is idle. */
+    typedef struct loop_settings {
+        BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE Manipulated_Variable_Reference;
+        BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE Controlled_Variable_Reference;
+        BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE Setpoint_Reference;
+        float Setpoint;
+        BACNET_ACTION Action;
+        uint8_t Priority_For_Writing;
+        /* milliseconds between evaluations */
+        uint32_t Update_Interval;
+        float Proportional_Constant;
+        /* per second */
+        float Integral_Constant;
+        /* seconds */
+        float Derivative_Constant;
+        float Bias;
+        float Maximum_Output;
+        float Minimum_Output;
+        BACNET_LOOP_MODE Mode;
+        float Deadband;
+    } BACNET_LOOP_SETTINGS;
+
+    void Loop_Property_Lists(
+        const int **pRequired,
+        const int **pOptional,
+        const int **pProprietary);
+    bool Loop_Valid_Instance(
+        uint32_t object_instance);
+    unsigned Loop_Count(
+        void);
+    uint32_t Loop_Index_To_Instance(
+        unsigned index);
+    unsigned Loop_Instance_To_Index(
+        uint32_t object_instance);
+
+    bool Loop_Object_Name(
+        uint32_t object_instance,
+        BACNET_CHARACTER_STRING * object_name);
+    bool Loop_Name_Set(
+        uint32_t object_instance,
+        char *new_name);
+
+    int Loop_Read_Property(
+        BACNET_READ_PROPERTY_DATA * rpdata);
+    bool Loop_Write_Property(
+        BACNET_WRITE_PROPERTY_DATA * wp_data);
+
+    float Loop_Present_Value(
+        uint32_t object_instance);
+    bool Loop_Out_Of_Service(
+        uint32_t object_instance);
+
+    bool Loop_Reference_Empty(
+        const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference);
+    void Loop_Reference_Set(
+        BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference,
+        BACNET_OBJECT_TYPE object_type,
+        uint32_t object_instance);
+    bool Loop_Settings(
+        uint32_t object_instance,
+        BACNET_LOOP_SETTINGS * settings,
+        uint32_t * generation);
+    bool Loop_Settings_Set(
+        uint32_t object_instance,
+        const BACNET_LOOP_SETTINGS * settings);
+    bool Loop_Units_Set(
+        uint32_t object_instance,
+        uint16_t output_units);
+    void Loop_Update(
+        uint32_t object_instance,
+        float controlled_value,
+        uint16_t controlled_units,
+        float setpoint,
+        float output,
+        BACNET_RELIABILITY reliability);
+
+    bool Loop_Change_Of_Value(
+        uint32_t object_instance);
+    void Loop_Change_Of_Value_Clear(
+        uint32_t object_instance);
+    bool Loop_Encode_Value_List(
+        uint32_t object_instance,
+        BACNET_PROPERTY_VALUE * value_list);
+
+    void Loop_Init(
+        void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -0,0 +1,83 @@
+/**************************************************************************
+*
+* Non-volatile store: named values that survive a reset
+*
+* A small key-value interface for the state the stack keeps across
+* resets, such as the COV subscriptions.  Values live in a namespace,
+* opened for reading or for writing; writes are durable once committed.
+* nvstore.c puts it on ESP-IDF NVS; another platform, or a test,
+* links its own implementation.
+*
+*********************************************************************/
+#ifndef NVSTORE_H
+#define NVSTORE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t NVSTORE_HANDLE;
+
+typedef enum {
+    NVSTORE_OK = 0,
+    NVSTORE_NOT_FOUND,  /* no such namespace or key */
+    NVSTORE_INVALID_LENGTH,     /* the value does not fit the buffer */
+    NVSTORE_FAILED      /* the store could not do it */
+} NVSTORE_STATUS;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    NVSTORE_STATUS nvstore_open(
+        const char *name_space,
+        bool read_write,
+        NVSTORE_HANDLE * handle);
+    void nvstore_close(
+        NVSTORE_HANDLE handle);
+    NVSTORE_STATUS nvstore_commit(
+        NVSTORE_HANDLE handle);
+
+    NVSTORE_STATUS nvstore_get_u8(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint8_t * value);
+    NVSTORE_STATUS nvstore_set_u8(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint8_t value);
+    NVSTORE_STATUS nvstore_get_u16(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint16_t * value);
+    NVSTORE_STATUS nvstore_set_u16(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint16_t value);
+    NVSTORE_STATUS nvstore_get_u32(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint32_t * value);
+    NVSTORE_STATUS nvstore_set_u32(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        uint32_t value);
+    /* on entry *length is the size of value, on return the size read */
+    NVSTORE_STATUS nvstore_get_blob(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        void *value,
+        size_t * length);
+    NVSTORE_STATUS nvstore_set_blob(
+        NVSTORE_HANDLE handle,
+        const char *key,
+        const void *value,
+        size_t length);
+    NVSTORE_STATUS nvstore_erase_key(
+        NVSTORE_HANDLE handle,
+        const char *key);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
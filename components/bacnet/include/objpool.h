@@ -0,0 +1,97 @@
+/**************************************************************************
+*
+* Object pools: fixed storage for the objects of one type, found by
+* instance number
+*
+* The slots of an object type's storage are handed out and taken back as
+* objects are created and deleted, so instance numbers need not be
+* 0..n-1 and may be sparse.  The instances in use are kept sorted with
+* the slot of each: an instance is found by binary search, and the n-th
+* object of the Object_List is the n-th entry.  Nothing is allocated;
+* OBJECT_POOL_DEFINE() sets aside the arrays for a given capacity.
+*
+*********************************************************************/
+#ifndef OBJPOOL_H
+#define OBJPOOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
+/* room in each object type for the objects made by CreateObject */
+#if defined(CONFIG_BACNET_CREATED_OBJECTS)
+#define BACNET_CREATED_OBJECTS CONFIG_BACNET_CREATED_OBJECTS
+#elif !defined(BACNET_CREATED_OBJECTS)
+#define BACNET_CREATED_OBJECTS 32
+#endif
+
+typedef struct object_pool {
+    uint16_t capacity;
+    uint16_t count;
+    /* the instances in use, ascending, and the slot of each */
+    uint32_t *instance;
+    uint16_t *slot;
+    /* the unused slots, a stack of capacity - count */
+    uint16_t *free_slot;
+    /* by slot: made by CreateObject, so DeleteObject may remove it */
+    bool *deletable;
+} OBJECT_POOL;
+
+#define OBJECT_POOL_DEFINE(name, size) \
+    static uint32_t name##_Instance[size]; \
+    static uint16_t name##_Slot[size]; \
+    static uint16_t name##_Free_Slot[size]; \
+    static bool name##_Deletable[size]; \
+    static OBJECT_POOL name = { (size), 0, name##_Instance, name##_Slot, \
+        name##_Free_Slot, name##_Deletable }
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+    void Object_Pool_Init(
+        OBJECT_POOL * pool);
+
+    unsigned Object_Pool_Count(
+        const OBJECT_POOL * pool);
+
+/* the instance of the index-th object, in instance order, or
+   BACNET_MAX_INSTANCE if there are fewer objects */
+    uint32_t Object_Pool_Index_To_Instance(
+        const OBJECT_POOL * pool,
+        unsigned index);
+
+/* the index of an instance, or the count if there is no such object */
+    unsigned Object_Pool_Instance_To_Index(
+        const OBJECT_POOL * pool,
+        uint32_t object_instance);
+
+/* the slot of an instance or an index, or the capacity if there is
+   no such object */
+    unsigned Object_Pool_Slot(
+        const OBJECT_POOL * pool,
+        uint32_t object_instance);
+    unsigned Object_Pool_Index_To_Slot(
+        const OBJECT_POOL * pool,
+        unsigned index);
+
+/* adds an instance, returning the slot it was given, or the capacity if
+   the instance is in use or invalid or the pool is full.  The caller
+   clears the slot. */
+    unsigned Object_Pool_Create(
+        OBJECT_POOL * pool,
+        uint32_t object_instance,
+        bool deletable);
+
+/* removes a deletable instance, returning the slot it had, or the
+   capacity if there is no such object or it cannot be deleted */
+    unsigned Object_Pool_Delete(
+        OBJECT_POOL * pool,
+        uint32_t object_instance);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -69,6 +69,23 @@ typedef void (
     const int **pOptional,
     const int **pProprietary);
 
+/** Fetches the lists of properties of one object, for object types whose
+ *  objects do not all have the same properties.
+ * @ingroup ObjHelpers
+ *
+ * @param object_instance [in] The object instance number of the object.
+ * @param pRequired [out] Pointer reference for the list of Required properties.
+ * @param pOptional [out] Pointer reference for the list of Optional properties.
+ * @param pProprietary [out] Pointer reference for the list of Proprietary
+ *                           properties of this object.
+ */
+typedef void (
+    *rpm_instance_property_lists_function) (
+    uint32_t object_instance,
+    const int **pRequired,
+    const int **pOptional,
+    const int **pProprietary);
+
 typedef void (
     *rpm_object_property_lists_function) (
     BACNET_OBJECT_TYPE object_type,
@@ -0,0 +1,991 @@
+/**************************************************************************
+*
+* Copyright (C) 2006 Steve Karg <skarg@users.sourceforge.net>
+*
+* Permission is hereby granted, free of charge, to any person obtaining
+* a copy of this software and associated documentation files (the
+* "Software"), to deal in the Software without restriction, including
+* without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to
+* permit persons to whom the Software is furnished to do so, subject to
+* the following conditions:
+*
+* The above copyright notice and this permission notice shall be included
+* in all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+*********************************************************************/
+
+/* Loop Objects - the application runs the control, see lo.h */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "bacdef.h"
+#include "bacdcode.h"
+#include "bacenum.h"
+#include "bacapp.h"
+#include "config.h"     /* the custom stuff */
+#include "device.h"
+#include "handlers.h"
+#include "lo.h"
+
+/* the shortest Update_Interval, in milliseconds */
+#define LOOP_UPDATE_INTERVAL_MIN 100
+
+typedef struct loop_descr {
+    BACNET_LOOP_SETTINGS Settings;
+    /* bumped by every change of the settings, so the application
+       knows to restart the control from scratch */
+    uint32_t Generation;
+    char *Object_Name;
+    float Present_Value;
+    float Prior_Value;
+    float COV_Increment;
+    bool Changed;
+    bool Out_Of_Service;
+    BACNET_RELIABILITY Reliability;
+    uint16_t Output_Units;
+    float Controlled_Variable_Value;
+    uint16_t Controlled_Variable_Units;
+} LOOP_DESCR;
+
+static LOOP_DESCR Loop_Descr[MAX_LOOPS];
+
+/* These three arrays are used by the ReadPropertyMultiple handler */
+static const int Loop_Properties_Required[] = {
+    PROP_OBJECT_IDENTIFIER,
+    PROP_OBJECT_NAME,
+    PROP_OBJECT_TYPE,
+    PROP_PRESENT_VALUE,
+    PROP_STATUS_FLAGS,
+    PROP_EVENT_STATE,
+    PROP_OUT_OF_SERVICE,
+    PROP_OUTPUT_UNITS,
+    PROP_MANIPULATED_VARIABLE_REFERENCE,
+    PROP_CONTROLLED_VARIABLE_REFERENCE,
+    PROP_CONTROLLED_VARIABLE_VALUE,
+    PROP_CONTROLLED_VARIABLE_UNITS,
+    PROP_SETPOINT_REFERENCE,
+    PROP_SETPOINT,
+    PROP_ACTION,
+    PROP_PRIORITY_FOR_WRITING,
+    -1
+};
+
+static const int Loop_Properties_Optional[] = {
+    PROP_RELIABILITY,
+    PROP_UPDATE_INTERVAL,
+    PROP_PROPORTIONAL_CONSTANT,
+    PROP_PROPORTIONAL_CONSTANT_UNITS,
+    PROP_INTEGRAL_CONSTANT,
+    PROP_INTEGRAL_CONSTANT_UNITS,
+    PROP_DERIVATIVE_CONSTANT,
+    PROP_DERIVATIVE_CONSTANT_UNITS,
+    PROP_BIAS,
+    PROP_MAXIMUM_OUTPUT,
+    PROP_MINIMUM_OUTPUT,
+    PROP_COV_INCREMENT,
+    -1
+};
+
+static const int Loop_Properties_Proprietary[] = {
+    PROP_LOOP_MODE,
+    PROP_LOOP_DEADBAND,
+    -1
+};
+
+void Loop_Property_Lists(
+    const int **pRequired,
+    const int **pOptional,
+    const int **pProprietary)
+{
+    if (pRequired)
+        *pRequired = Loop_Properties_Required;
+    if (pOptional)
+        *pOptional = Loop_Properties_Optional;
+    if (pProprietary)
+        *pProprietary = Loop_Properties_Proprietary;
+
+    return;
+}
+
+/* points a reference at the Present_Value of an object in this device;
+   instance BACNET_MAX_INSTANCE points it at nothing */
+void Loop_Reference_Set(
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance)
+{
+    reference->objectIdentifier.type = (uint16_t) object_type;
+    reference->objectIdentifier.instance = object_instance;
+    reference->propertyIdentifier = PROP_PRESENT_VALUE;
+    reference->arrayIndex = BACNET_ARRAY_ALL;
+    reference->deviceIndentifier.type = BACNET_NO_DEV_TYPE;
+    reference->deviceIndentifier.instance = BACNET_NO_DEV_ID;
+}
+
+bool Loop_Reference_Empty(
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference)
+{
+    return (reference->objectIdentifier.instance >= BACNET_MAX_INSTANCE);
+}
+
+void Loop_Init(
+    void)
+{
+    BACNET_LOOP_SETTINGS *settings = NULL;
+    unsigned i;
+
+    for (i = 0; i < MAX_LOOPS; i++) {
+        memset(&Loop_Descr[i], 0x00, sizeof(LOOP_DESCR));
+        settings = &Loop_Descr[i].Settings;
+        Loop_Reference_Set(&settings->Manipulated_Variable_Reference,
+            OBJECT_ANALOG_VALUE, BACNET_MAX_INSTANCE);
+        Loop_Reference_Set(&settings->Controlled_Variable_Reference,
+            OBJECT_ANALOG_VALUE, BACNET_MAX_INSTANCE);
+        Loop_Reference_Set(&settings->Setpoint_Reference,
+            OBJECT_ANALOG_VALUE, BACNET_MAX_INSTANCE);
+        settings->Action = ACTION_DIRECT;
+        settings->Priority_For_Writing = BACNET_MAX_PRIORITY;
+        settings->Update_Interval = 1000;
+        settings->Proportional_Constant = 1.0f;
+        settings->Maximum_Output = 100.0f;
+        settings->Minimum_Output = 0.0f;
+        settings->Mode = LOOP_MODE_PID;
+        settings->Deadband = 1.0f;
+        Loop_Descr[i].Reliability = RELIABILITY_NO_FAULT_DETECTED;
+        Loop_Descr[i].Output_Units = UNITS_PERCENT;
+        Loop_Descr[i].Controlled_Variable_Units = UNITS_NO_UNITS;
+        Loop_Descr[i].COV_Increment = 1.0f;
+    }
+}
+
+/* we simply have 0-n object instances.  Yours might be */
+/* more complex, and then you need validate that the */
+/* given instance exists */
+bool Loop_Valid_Instance(
+    uint32_t object_instance)
+{
+    if (object_instance < MAX_LOOPS)
+        return true;
+
+    return false;
+}
+
+/* we simply have 0-n object instances.  Yours might be */
+/* more complex, and then count how many you have */
+unsigned Loop_Count(
+    void)
+{
+    return MAX_LOOPS;
+}
+
+/* we simply have 0-n object instances.  Yours might be */
+/* more complex, and then you need to return the instance */
+/* that correlates to the correct index */
+uint32_t Loop_Index_To_Instance(
+    unsigned index)
+{
+    return index;
+}
+
+/* we simply have 0-n object instances.  Yours might be */
+/* more complex, and then you need to return the index */
+/* that correlates to the correct instance number */
+unsigned Loop_Instance_To_Index(
+    uint32_t object_instance)
+{
+    unsigned index = MAX_LOOPS;
+
+    if (object_instance < MAX_LOOPS)
+        index = object_instance;
+
+    return index;
+}
+
+/* note: the object name must be unique within this device */
+bool Loop_Object_Name(
+    uint32_t object_instance,
+    BACNET_CHARACTER_STRING * object_name)
+{
+    static char text_string[32] = "";   /* okay for single thread */
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        if (Loop_Descr[index].Object_Name) {
+            status =
+                characterstring_init_ansi(object_name,
+                Loop_Descr[index].Object_Name);
+        } else {
+            sprintf(text_string, "LOOP %lu", (unsigned long) object_instance);
+            status = characterstring_init_ansi(object_name, text_string);
+        }
+    }
+
+    return status;
+}
+
+/* note: the name is not copied, so it must stay valid; NULL restores
+   the default name */
+bool Loop_Name_Set(
+    uint32_t object_instance,
+    char *new_name)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        Loop_Descr[index].Object_Name = new_name;
+        status = true;
+    }
+
+    return status;
+}
+
+float Loop_Present_Value(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    float value = 0.0f;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        value = Loop_Descr[index].Present_Value;
+    }
+
+    return value;
+}
+
+bool Loop_Out_Of_Service(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    bool oos_flag = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        oos_flag = Loop_Descr[index].Out_Of_Service;
+    }
+
+    return oos_flag;
+}
+
+/* flags a COV when the Present_Value moved by COV_Increment or more */
+static void Loop_Present_Value_Set(
+    unsigned index,
+    float value)
+{
+    LOOP_DESCR *CurrentLoop = &Loop_Descr[index];
+
+    if (fabsf(value - CurrentLoop->Prior_Value) >=
+        CurrentLoop->COV_Increment) {
+        CurrentLoop->Prior_Value = value;
+        CurrentLoop->Changed = true;
+        handler_cov_object_changed(OBJECT_LOOP,
+            Loop_Index_To_Instance(index));
+    }
+    CurrentLoop->Present_Value = value;
+}
+
+/* the status flags follow these two, so both changes are reported */
+static void Loop_Status_Changed(
+    unsigned index)
+{
+    Loop_Descr[index].Changed = true;
+    handler_cov_object_changed(OBJECT_LOOP, Loop_Index_To_Instance(index));
+}
+
+/**
+ * Copies the settings of a loop for the application to run it.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  settings - the copy
+ * @param  generation - if not NULL, a number that changes with every
+ *                      change of the settings
+ *
+ * @return  true if the instance exists
+ */
+bool Loop_Settings(
+    uint32_t object_instance,
+    BACNET_LOOP_SETTINGS * settings,
+    uint32_t * generation)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        *settings = Loop_Descr[index].Settings;
+        if (generation) {
+            *generation = Loop_Descr[index].Generation;
+        }
+        status = true;
+    }
+
+    return status;
+}
+
+/* replaces the settings of a loop, as configured by the application */
+bool Loop_Settings_Set(
+    uint32_t object_instance,
+    const BACNET_LOOP_SETTINGS * settings)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        Loop_Descr[index].Settings = *settings;
+        Loop_Descr[index].Generation++;
+        status = true;
+    }
+
+    return status;
+}
+
+bool Loop_Units_Set(
+    uint32_t object_instance,
+    uint16_t output_units)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        Loop_Descr[index].Output_Units = output_units;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * Records the result of one evaluation of a loop.  The output becomes
+ * the Present_Value unless the loop is Out_Of_Service.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  controlled_value - the controlled variable that was used
+ * @param  controlled_units - its units
+ * @param  setpoint - the setpoint that was used
+ * @param  output - the output of the control
+ * @param  reliability - RELIABILITY_NO_FAULT_DETECTED, or why the loop
+ *                       could not run
+ */
+void Loop_Update(
+    uint32_t object_instance,
+    float controlled_value,
+    uint16_t controlled_units,
+    float setpoint,
+    float output,
+    BACNET_RELIABILITY reliability)
+{
+    unsigned index = 0;
+    LOOP_DESCR *CurrentLoop = NULL;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index >= MAX_LOOPS) {
+        return;
+    }
+    CurrentLoop = &Loop_Descr[index];
+    CurrentLoop->Controlled_Variable_Value = controlled_value;
+    CurrentLoop->Controlled_Variable_Units = controlled_units;
+    if (!Loop_Reference_Empty(&CurrentLoop->Settings.Setpoint_Reference)) {
+        /* Setpoint shows the referenced value */
+        CurrentLoop->Settings.Setpoint = setpoint;
+    }
+    if (CurrentLoop->Reliability != reliability) {
+        CurrentLoop->Reliability = reliability;
+        Loop_Status_Changed(index);
+    }
+    if (!CurrentLoop->Out_Of_Service) {
+        Loop_Present_Value_Set(index, output);
+    }
+}
+
+bool Loop_Change_Of_Value(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+    bool changed = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        changed = Loop_Descr[index].Changed;
+    }
+
+    return changed;
+}
+
+void Loop_Change_Of_Value_Clear(
+    uint32_t object_instance)
+{
+    unsigned index = 0;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index < MAX_LOOPS) {
+        Loop_Descr[index].Changed = false;
+    }
+}
+
+static void Loop_Status_Flags(
+    unsigned index,
+    BACNET_BIT_STRING * bit_string)
+{
+    bitstring_init(bit_string);
+    bitstring_set_bit(bit_string, STATUS_FLAG_IN_ALARM, false);
+    bitstring_set_bit(bit_string, STATUS_FLAG_FAULT,
+        Loop_Descr[index].Reliability != RELIABILITY_NO_FAULT_DETECTED);
+    bitstring_set_bit(bit_string, STATUS_FLAG_OVERRIDDEN, false);
+    bitstring_set_bit(bit_string, STATUS_FLAG_OUT_OF_SERVICE,
+        Loop_Descr[index].Out_Of_Service);
+}
+
+/**
+ * Encode the Value List for Present-Value and Status-Flags
+ *
+ * @param object_instance - object-instance number of the object
+ * @param  value_list - #BACNET_PROPERTY_VALUE with at least 2 entries
+ *
+ * @return true if values were encoded
+ */
+bool Loop_Encode_Value_List(
+    uint32_t object_instance,
+    BACNET_PROPERTY_VALUE * value_list)
+{
+    unsigned index = 0;
+    bool status = false;
+
+    index = Loop_Instance_To_Index(object_instance);
+    if (index >= MAX_LOOPS) {
+        return false;
+    }
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_PRESENT_VALUE;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_REAL;
+        value_list->value.next = NULL;
+        value_list->value.type.Real = Loop_Descr[index].Present_Value;
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list = value_list->next;
+    }
+    if (value_list) {
+        value_list->propertyIdentifier = PROP_STATUS_FLAGS;
+        value_list->propertyArrayIndex = BACNET_ARRAY_ALL;
+        value_list->value.context_specific = false;
+        value_list->value.tag = BACNET_APPLICATION_TAG_BIT_STRING;
+        value_list->value.next = NULL;
+        Loop_Status_Flags(index, &value_list->value.type.Bit_String);
+        value_list->priority = BACNET_NO_PRIORITY;
+        value_list->next = NULL;
+        status = true;
+    }
+
+    return status;
+}
+
+/* return apdu len, or BACNET_STATUS_ERROR on error */
+int Loop_Read_Property(
+    BACNET_READ_PROPERTY_DATA * rpdata)
+{
+    int apdu_len = 0;   /* return value */
+    BACNET_BIT_STRING bit_string;
+    BACNET_CHARACTER_STRING char_string;
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE reference;
+    BACNET_LOOP_SETTINGS *settings = NULL;
+    LOOP_DESCR *CurrentLoop = NULL;
+    unsigned object_index = 0;
+    uint8_t *apdu = NULL;
+
+    if ((rpdata == NULL) || (rpdata->application_data == NULL) ||
+        (rpdata->application_data_len == 0)) {
+        return 0;
+    }
+    object_index = Loop_Instance_To_Index(rpdata->object_instance);
+    if (object_index >= MAX_LOOPS) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    CurrentLoop = &Loop_Descr[object_index];
+    settings = &CurrentLoop->Settings;
+    apdu = rpdata->application_data;
+    switch ((int) rpdata->object_property) {
+        case PROP_OBJECT_IDENTIFIER:
+            apdu_len =
+                encode_application_object_id(&apdu[0], OBJECT_LOOP,
+                rpdata->object_instance);
+            break;
+        case PROP_OBJECT_NAME:
+            Loop_Object_Name(rpdata->object_instance, &char_string);
+            apdu_len =
+                encode_application_character_string(&apdu[0], &char_string);
+            break;
+        case PROP_OBJECT_TYPE:
+            apdu_len = encode_application_enumerated(&apdu[0], OBJECT_LOOP);
+            break;
+        case PROP_PRESENT_VALUE:
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentLoop->Present_Value);
+            break;
+        case PROP_STATUS_FLAGS:
+            Loop_Status_Flags(object_index, &bit_string);
+            apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
+            break;
+        case PROP_EVENT_STATE:
+            apdu_len =
+                encode_application_enumerated(&apdu[0], EVENT_STATE_NORMAL);
+            break;
+        case PROP_OUT_OF_SERVICE:
+            apdu_len =
+                encode_application_boolean(&apdu[0],
+                CurrentLoop->Out_Of_Service);
+            break;
+        case PROP_RELIABILITY:
+            apdu_len =
+                encode_application_enumerated(&apdu[0],
+                CurrentLoop->Reliability);
+            break;
+        case PROP_OUTPUT_UNITS:
+            apdu_len =
+                encode_application_enumerated(&apdu[0],
+                CurrentLoop->Output_Units);
+            break;
+        case PROP_MANIPULATED_VARIABLE_REFERENCE:
+            reference = settings->Manipulated_Variable_Reference;
+            apdu_len = bacapp_encode_device_obj_property_ref(&apdu[0],
+                &reference);
+            break;
+        case PROP_CONTROLLED_VARIABLE_REFERENCE:
+            reference = settings->Controlled_Variable_Reference;
+            apdu_len = bacapp_encode_device_obj_property_ref(&apdu[0],
+                &reference);
+            break;
+        case PROP_CONTROLLED_VARIABLE_VALUE:
+            apdu_len =
+                encode_application_real(&apdu[0],
+                CurrentLoop->Controlled_Variable_Value);
+            break;
+        case PROP_CONTROLLED_VARIABLE_UNITS:
+            apdu_len =
+                encode_application_enumerated(&apdu[0],
+                CurrentLoop->Controlled_Variable_Units);
+            break;
+        case PROP_SETPOINT_REFERENCE:
+            /* BACnetSetpointReference: the reference is optional */
+            if (!Loop_Reference_Empty(&settings->Setpoint_Reference)) {
+                reference = settings->Setpoint_Reference;
+                apdu_len =
+                    bacapp_encode_context_device_obj_property_ref(&apdu[0], 0,
+                    &reference);
+            }
+            break;
+        case PROP_SETPOINT:
+            apdu_len = encode_application_real(&apdu[0], settings->Setpoint);
+            break;
+        case PROP_ACTION:
+            apdu_len = encode_application_enumerated(&apdu[0], settings->Action);
+            break;
+        case PROP_PRIORITY_FOR_WRITING:
+            apdu_len =
+                encode_application_unsigned(&apdu[0],
+                settings->Priority_For_Writing);
+            break;
+        case PROP_UPDATE_INTERVAL:
+            apdu_len =
+                encode_application_unsigned(&apdu[0],
+                settings->Update_Interval);
+            break;
+        case PROP_PROPORTIONAL_CONSTANT:
+            apdu_len =
+                encode_application_real(&apdu[0],
+                settings->Proportional_Constant);
+            break;
+        case PROP_PROPORTIONAL_CONSTANT_UNITS:
+            apdu_len = encode_application_enumerated(&apdu[0], UNITS_NO_UNITS);
+            break;
+        case PROP_INTEGRAL_CONSTANT:
+            apdu_len =
+                encode_application_real(&apdu[0], settings->Integral_Constant);
+            break;
+        case PROP_INTEGRAL_CONSTANT_UNITS:
+            apdu_len = encode_application_enumerated(&apdu[0], UNITS_PER_SECOND);
+            break;
+        case PROP_DERIVATIVE_CONSTANT:
+            apdu_len =
+                encode_application_real(&apdu[0],
+                settings->Derivative_Constant);
+            break;
+        case PROP_DERIVATIVE_CONSTANT_UNITS:
+            apdu_len = encode_application_enumerated(&apdu[0], UNITS_SECONDS);
+            break;
+        case PROP_BIAS:
+            apdu_len = encode_application_real(&apdu[0], settings->Bias);
+            break;
+        case PROP_MAXIMUM_OUTPUT:
+            apdu_len =
+                encode_application_real(&apdu[0], settings->Maximum_Output);
+            break;
+        case PROP_MINIMUM_OUTPUT:
+            apdu_len =
+                encode_application_real(&apdu[0], settings->Minimum_Output);
+            break;
+        case PROP_COV_INCREMENT:
+            apdu_len =
+                encode_application_real(&apdu[0], CurrentLoop->COV_Increment);
+            break;
+        case PROP_LOOP_MODE:
+            apdu_len = encode_application_enumerated(&apdu[0], settings->Mode);
+            break;
+        case PROP_LOOP_DEADBAND:
+            apdu_len = encode_application_real(&apdu[0], settings->Deadband);
+            break;
+        default:
+            rpdata->error_class = ERROR_CLASS_PROPERTY;
+            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            apdu_len = BACNET_STATUS_ERROR;
+            break;
+    }
+    /*  only array properties can have array options */
+    if ((apdu_len >= 0) && (rpdata->array_index != BACNET_ARRAY_ALL)) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
+        apdu_len = BACNET_STATUS_ERROR;
+    }
+
+    return apdu_len;
+}
+
+/* A loop reads and writes Present_Value of objects in this device.
+   Its inputs may be any object with a numeric or binary Present_Value,
+   its output only an object it can command. */
+static bool Loop_Reference_Valid(
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference,
+    bool output)
+{
+    if (Loop_Reference_Empty(reference)) {
+        return true;
+    }
+    if ((reference->propertyIdentifier != PROP_PRESENT_VALUE) ||
+        (reference->arrayIndex != BACNET_ARRAY_ALL)) {
+        return false;
+    }
+    if ((reference->deviceIndentifier.type == OBJECT_DEVICE) &&
+        (reference->deviceIndentifier.instance !=
+            Device_Object_Instance_Number())) {
+        return false;
+    }
+    switch (reference->objectIdentifier.type) {
+        case OBJECT_ANALOG_VALUE:
+        case OBJECT_BINARY_OUTPUT:
+        case OBJECT_BINARY_VALUE:
+            return true;
+        case OBJECT_BINARY_INPUT:
+        case OBJECT_LOOP:
+            return !output;
+        default:
+            break;
+    }
+
+    return false;
+}
+
+/* decodes a written BACnetObjectPropertyReference, or the optional one
+   of a BACnetSetpointReference */
+static bool Loop_Reference_Decode(
+    BACNET_WRITE_PROPERTY_DATA * wp_data,
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE * reference,
+    bool setpoint,
+    bool output)
+{
+    int len = 0;
+
+    if (setpoint && (wp_data->application_data_len == 0)) {
+        Loop_Reference_Set(reference, OBJECT_ANALOG_VALUE,
+            BACNET_MAX_INSTANCE);
+        return true;
+    }
+    if (wp_data->application_data_len <= 0) {
+        len = -1;
+    } else if (setpoint) {
+        len =
+            bacapp_decode_context_device_obj_property_ref(wp_data->
+            application_data, 0, reference);
+    } else {
+        len =
+            bacapp_decode_device_obj_property_ref(wp_data->application_data,
+            reference);
+    }
+    if ((len != wp_data->application_data_len) ||
+        !Loop_Reference_Valid(reference, output)) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+        return false;
+    }
+    /* this device is implied */
+    reference->deviceIndentifier.type = BACNET_NO_DEV_TYPE;
+    reference->deviceIndentifier.instance = BACNET_NO_DEV_ID;
+
+    return true;
+}
+
+/* returns true if successful */
+bool Loop_Write_Property(
+    BACNET_WRITE_PROPERTY_DATA * wp_data)
+{
+    bool status = false;        /* return value */
+    unsigned int object_index = 0;
+    int len = 0;
+    BACNET_APPLICATION_DATA_VALUE value;
+    BACNET_LOOP_SETTINGS settings;
+    LOOP_DESCR *CurrentLoop = NULL;
+
+    object_index = Loop_Instance_To_Index(wp_data->object_instance);
+    if (object_index >= MAX_LOOPS) {
+        wp_data->error_class = ERROR_CLASS_OBJECT;
+        wp_data->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return false;
+    }
+    CurrentLoop = &Loop_Descr[object_index];
+    /*  only array properties can have array options */
+    if (wp_data->array_index != BACNET_ARRAY_ALL) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
+        return false;
+    }
+    /* settings are changed on a copy, and only kept when valid */
+    settings = CurrentLoop->Settings;
+    switch ((int) wp_data->object_property) {
+        case PROP_MANIPULATED_VARIABLE_REFERENCE:
+            status = Loop_Reference_Decode(wp_data,
+                &settings.Manipulated_Variable_Reference, false, true);
+            break;
+        case PROP_CONTROLLED_VARIABLE_REFERENCE:
+            status = Loop_Reference_Decode(wp_data,
+                &settings.Controlled_Variable_Reference, false, false);
+            break;
+        case PROP_SETPOINT_REFERENCE:
+            status = Loop_Reference_Decode(wp_data,
+                &settings.Setpoint_Reference, true, false);
+            break;
+        default:
+            /* the other properties are primitive values */
+            len =
+                bacapp_decode_application_data(wp_data->application_data,
+                wp_data->application_data_len, &value);
+            if (len < 0) {
+                /* error while decoding - a value larger than we can handle */
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                return false;
+            }
+            break;
+    }
+    switch ((int) wp_data->object_property) {
+        case PROP_MANIPULATED_VARIABLE_REFERENCE:
+        case PROP_CONTROLLED_VARIABLE_REFERENCE:
+        case PROP_SETPOINT_REFERENCE:
+            /* decoded above */
+            break;
+        case PROP_PRESENT_VALUE:
+            /* the loop owns it until taken out of service */
+            if (!CurrentLoop->Out_Of_Service) {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            } else {
+                status =
+                    WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                    &wp_data->error_class, &wp_data->error_code);
+                if (status) {
+                    Loop_Present_Value_Set(object_index, value.type.Real);
+                }
+            }
+            break;
+        case PROP_OUT_OF_SERVICE:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_BOOLEAN,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status &&
+                (CurrentLoop->Out_Of_Service != value.type.Boolean)) {
+                CurrentLoop->Out_Of_Service = value.type.Boolean;
+                Loop_Status_Changed(object_index);
+            }
+            break;
+        case PROP_SETPOINT:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status &&
+                !Loop_Reference_Empty(&settings.Setpoint_Reference)) {
+                /* it shows the referenced setpoint */
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            } else if (status) {
+                settings.Setpoint = value.type.Real;
+            }
+            break;
+        case PROP_ACTION:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_ENUMERATED,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status && (value.type.Enumerated <= ACTION_REVERSE)) {
+                settings.Action = (BACNET_ACTION) value.type.Enumerated;
+            } else if (status) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_PRIORITY_FOR_WRITING:
+            status =
+                WPValidateArgType(&value,
+                BACNET_APPLICATION_TAG_UNSIGNED_INT, &wp_data->error_class,
+                &wp_data->error_code);
+            /* Command priority 6 is reserved for use by Minimum On/Off
+               algorithm and may not be used for other purposes in any
+               object. */
+            if (status && (value.type.Unsigned_Int >= 1) &&
+                (value.type.Unsigned_Int <= BACNET_MAX_PRIORITY) &&
+                (value.type.Unsigned_Int != 6)) {
+                settings.Priority_For_Writing =
+                    (uint8_t) value.type.Unsigned_Int;
+            } else if (status) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_UPDATE_INTERVAL:
+            status =
+                WPValidateArgType(&value,
+                BACNET_APPLICATION_TAG_UNSIGNED_INT, &wp_data->error_class,
+                &wp_data->error_code);
+            if (status &&
+                (value.type.Unsigned_Int >= LOOP_UPDATE_INTERVAL_MIN)) {
+                settings.Update_Interval = value.type.Unsigned_Int;
+            } else if (status) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_PROPORTIONAL_CONSTANT:
+        case PROP_INTEGRAL_CONSTANT:
+        case PROP_DERIVATIVE_CONSTANT:
+        case PROP_LOOP_DEADBAND:
+            /* the Action gives the sign, so these are never negative */
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status && (value.type.Real < 0.0f)) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            if (!status) {
+                break;
+            }
+            if (wp_data->object_property == PROP_PROPORTIONAL_CONSTANT) {
+                settings.Proportional_Constant = value.type.Real;
+            } else if (wp_data->object_property == PROP_INTEGRAL_CONSTANT) {
+                settings.Integral_Constant = value.type.Real;
+            } else if (wp_data->object_property ==
+                PROP_DERIVATIVE_CONSTANT) {
+                settings.Derivative_Constant = value.type.Real;
+            } else {
+                settings.Deadband = value.type.Real;
+            }
+            break;
+        case PROP_BIAS:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status) {
+                settings.Bias = value.type.Real;
+            }
+            break;
+        case PROP_MAXIMUM_OUTPUT:
+        case PROP_MINIMUM_OUTPUT:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status) {
+                if (wp_data->object_property == PROP_MAXIMUM_OUTPUT) {
+                    settings.Maximum_Output = value.type.Real;
+                } else {
+                    settings.Minimum_Output = value.type.Real;
+                }
+                if (settings.Minimum_Output >= settings.Maximum_Output) {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            }
+            break;
+        case PROP_LOOP_MODE:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_ENUMERATED,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status && (value.type.Enumerated <= LOOP_MODE_ON_OFF)) {
+                settings.Mode = (BACNET_LOOP_MODE) value.type.Enumerated;
+            } else if (status) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_COV_INCREMENT:
+            status =
+                WPValidateArgType(&value, BACNET_APPLICATION_TAG_REAL,
+                &wp_data->error_class, &wp_data->error_code);
+            if (status && (value.type.Real >= 0.0f)) {
+                CurrentLoop->COV_Increment = value.type.Real;
+            } else if (status) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+            }
+            break;
+        case PROP_OBJECT_IDENTIFIER:
+        case PROP_OBJECT_NAME:
+        case PROP_OBJECT_TYPE:
+        case PROP_STATUS_FLAGS:
+        case PROP_EVENT_STATE:
+        case PROP_RELIABILITY:
+        case PROP_OUTPUT_UNITS:
+        case PROP_CONTROLLED_VARIABLE_VALUE:
+        case PROP_CONTROLLED_VARIABLE_UNITS:
+        case PROP_PROPORTIONAL_CONSTANT_UNITS:
+        case PROP_INTEGRAL_CONSTANT_UNITS:
+        case PROP_DERIVATIVE_CONSTANT_UNITS:
+            wp_data->error_class = ERROR_CLASS_PROPERTY;
+            wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            break;
+        default:
+            wp_data->error_class = ERROR_CLASS_PROPERTY;
+            wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            break;
+    }
+    if (status && (wp_data->object_property != PROP_PRESENT_VALUE) &&
+        (wp_data->object_property != PROP_OUT_OF_SERVICE) &&
+        (wp_data->object_property != PROP_COV_INCREMENT)) {
+        CurrentLoop->Settings = settings;
+        CurrentLoop->Generation++;
+    }
+
+    return status;
+}
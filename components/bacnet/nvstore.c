@@ -0,0 +1,130 @@
+/**************************************************************************
+*
+* Non-volatile store on ESP-IDF NVS
+*
+* nvstore.h maps one to one onto the NVS API; only the error codes are
+* translated.  The NVS partition is initialized by the application.
+*
+*********************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nvs.h"
+#include "nvstore.h"
+
+static NVSTORE_STATUS nvstore_status(
+    esp_err_t err)
+{
+    switch (err) {
+        case ESP_OK:
+            return NVSTORE_OK;
+        case ESP_ERR_NVS_NOT_FOUND:
+            return NVSTORE_NOT_FOUND;
+        case ESP_ERR_NVS_INVALID_LENGTH:
+            return NVSTORE_INVALID_LENGTH;
+        default:
+            return NVSTORE_FAILED;
+    }
+}
+
+NVSTORE_STATUS nvstore_open(
+    const char *name_space,
+    bool read_write,
+    NVSTORE_HANDLE * handle)
+{
+    nvs_handle_t nvs = 0;
+    esp_err_t err = ESP_OK;
+
+    err = nvs_open(name_space, read_write ? NVS_READWRITE : NVS_READONLY,
+        &nvs);
+    *handle = (NVSTORE_HANDLE) nvs;
+
+    return nvstore_status(err);
+}
+
+void nvstore_close(
+    NVSTORE_HANDLE handle)
+{
+    nvs_close((nvs_handle_t) handle);
+}
+
+NVSTORE_STATUS nvstore_commit(
+    NVSTORE_HANDLE handle)
+{
+    return nvstore_status(nvs_commit((nvs_handle_t) handle));
+}
+
+NVSTORE_STATUS nvstore_get_u8(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint8_t * value)
+{
+    return nvstore_status(nvs_get_u8((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_set_u8(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint8_t value)
+{
+    return nvstore_status(nvs_set_u8((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_get_u16(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint16_t * value)
+{
+    return nvstore_status(nvs_get_u16((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_set_u16(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint16_t value)
+{
+    return nvstore_status(nvs_set_u16((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_get_u32(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint32_t * value)
+{
+    return nvstore_status(nvs_get_u32((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_set_u32(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    uint32_t value)
+{
+    return nvstore_status(nvs_set_u32((nvs_handle_t) handle, key, value));
+}
+
+NVSTORE_STATUS nvstore_get_blob(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    void *value,
+    size_t * length)
+{
+    return nvstore_status(nvs_get_blob((nvs_handle_t) handle, key, value,
+            length));
+}
+
+NVSTORE_STATUS nvstore_set_blob(
+    NVSTORE_HANDLE handle,
+    const char *key,
+    const void *value,
+    size_t length)
+{
+    return nvstore_status(nvs_set_blob((nvs_handle_t) handle, key, value,
+            length));
+}
+
+NVSTORE_STATUS nvstore_erase_key(
+    NVSTORE_HANDLE handle,
+    const char *key)
+{
+    return nvstore_status(nvs_erase_key((nvs_handle_t) handle, key));
+}
@@ -0,0 +1,158 @@
+/**************************************************************************
+*
+* Object pools: fixed storage for the objects of one type, found by
+* instance number
+*
+* Lookups are a binary search of the sorted instances.  Creating or
+* deleting an object moves the entries above it, which is rare and
+* bounded by the capacity.
+*
+*********************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bacdef.h"
+#include "objpool.h"
+
+/* the position of an instance in the sorted list, or where it would go */
+static unsigned Object_Pool_Search(
+    const OBJECT_POOL * pool,
+    uint32_t object_instance)
+{
+    unsigned low = 0;
+    unsigned high = pool->count;
+    unsigned middle = 0;
+
+    while (low < high) {
+        middle = low + (high - low) / 2;
+        if (pool->instance[middle] < object_instance) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+void Object_Pool_Init(
+    OBJECT_POOL * pool)
+{
+    unsigned i = 0;
+
+    pool->count = 0;
+    /* the lowest slots are handed out first */
+    for (i = 0; i < pool->capacity; i++) {
+        pool->free_slot[i] = (uint16_t) (pool->capacity - 1 - i);
+        pool->deletable[i] = false;
+    }
+}
+
+unsigned Object_Pool_Count(
+    const OBJECT_POOL * pool)
+{
+    return pool->count;
+}
+
+uint32_t Object_Pool_Index_To_Instance(
+    const OBJECT_POOL * pool,
+    unsigned index)
+{
+    if (index < pool->count) {
+        return pool->instance[index];
+    }
+
+    return BACNET_MAX_INSTANCE;
+}
+
+unsigned Object_Pool_Instance_To_Index(
+    const OBJECT_POOL * pool,
+    uint32_t object_instance)
+{
+    unsigned index = Object_Pool_Search(pool, object_instance);
+
+    if ((index < pool->count) && (pool->instance[index] == object_instance)) {
+        return index;
+    }
+
+    return pool->count;
+}
+
+unsigned Object_Pool_Slot(
+    const OBJECT_POOL * pool,
+    uint32_t object_instance)
+{
+    unsigned index = Object_Pool_Search(pool, object_instance);
+
+    if ((index < pool->count) && (pool->instance[index] == object_instance)) {
+        return pool->slot[index];
+    }
+
+    return pool->capacity;
+}
+
+unsigned Object_Pool_Index_To_Slot(
+    const OBJECT_POOL * pool,
+    unsigned index)
+{
+    if (index < pool->count) {
+        return pool->slot[index];
+    }
+
+    return pool->capacity;
+}
+
+unsigned Object_Pool_Create(
+    OBJECT_POOL * pool,
+    uint32_t object_instance,
+    bool deletable)
+{
+    unsigned index = 0;
+    uint16_t slot = 0;
+
+    if ((object_instance >= BACNET_MAX_INSTANCE) ||
+        (pool->count >= pool->capacity)) {
+        return pool->capacity;
+    }
+    index = Object_Pool_Search(pool, object_instance);
+    if ((index < pool->count) && (pool->instance[index] == object_instance)) {
+        return pool->capacity;
+    }
+    slot = pool->free_slot[pool->capacity - pool->count - 1];
+    memmove(&pool->instance[index + 1], &pool->instance[index],
+        (pool->count - index) * sizeof(pool->instance[0]));
+    memmove(&pool->slot[index + 1], &pool->slot[index],
+        (pool->count - index) * sizeof(pool->slot[0]));
+    pool->instance[index] = object_instance;
+    pool->slot[index] = slot;
+    pool->deletable[slot] = deletable;
+    pool->count++;
+
+    return slot;
+}
+
+unsigned Object_Pool_Delete(
+    OBJECT_POOL * pool,
+    uint32_t object_instance)
+{
+    unsigned index = Object_Pool_Search(pool, object_instance);
+    uint16_t slot = 0;
+
+    if ((index >= pool->count) || (pool->instance[index] != object_instance)) {
+        return pool->capacity;
+    }
+    slot = pool->slot[index];
+    if (!pool->deletable[slot]) {
+        return pool->capacity;
+    }
+    pool->count--;
+    memmove(&pool->instance[index], &pool->instance[index + 1],
+        (pool->count - index) * sizeof(pool->instance[0]));
+    memmove(&pool->slot[index], &pool->slot[index + 1],
+        (pool->count - index) * sizeof(pool->slot[0]));
+    pool->free_slot[pool->capacity - pool->count - 1] = slot;
+    pool->deletable[slot] = false;
+
+    return slot;
+}
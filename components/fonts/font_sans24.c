@@ -0,0 +1,316 @@
+#include "fonts.h"
+#include "font_sans24.h"
+
+// Generated by make_rle_font.py from DejaVuSans-Bold.ttf, 24 px, 4 bpp
+static const uint8_t font_sans24_runs[] = {
+    // ' '
+    // '!'
+    0x70, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F,
+    0x09, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F,
+    0x09, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x09, 0x2F, 0x08, 0x20, 0x07, 0x2F,
+    0x06, 0x20, 0x05, 0x2F, 0x04, 0x20, 0x03, 0x2F, 0x02, 0x20, 0x01, 0x2F,
+    0x01, 0x70, 0x70, 0x20, 0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F, 0x09, 0x20,
+    0x0A, 0x2F, 0x09, 0x20, 0x0A, 0x2F, 0x09, 0x70, 0x70, 0x70, 0x70,
+    // '"'
+    0xA0, 0x10, 0x0B, 0x1F, 0x01, 0x00, 0x08, 0x1F, 0x03, 0x10, 0x0B, 0x1F,
+    0x01, 0x00, 0x08, 0x1F, 0x03, 0x10, 0x0B, 0x1F, 0x01, 0x00, 0x08, 0x1F,
+    0x03, 0x10, 0x0B, 0x1F, 0x01, 0x00, 0x08, 0x1F, 0x03, 0x10, 0x0B, 0x1F,
+    0x01, 0x00, 0x08, 0x1F, 0x03, 0x10, 0x0B, 0x1F, 0x01, 0x00, 0x08, 0x1F,
+    0x03, 0x10, 0x0B, 0x1F, 0x01, 0x00, 0x08, 0x1F, 0x03, 0xA0, 0xA0, 0xA0,
+    0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0, 0xA0,
+    // '#'
+    0xF0, 0x20, 0x60, 0x01, 0x1F, 0x08, 0x10, 0x05, 0x1F, 0x04, 0x10, 0x60,
+    0x04, 0x1F, 0x05, 0x10, 0x08, 0x1F, 0x01, 0x10, 0x60, 0x08, 0x1F, 0x02,
+    0x10, 0x0C, 0x0F, 0x0C, 0x20, 0x60, 0x0B, 0x0F, 0x0D, 0x10, 0x01, 0x1F,
+    0x09, 0x20, 0x60, 0x0E, 0x0F, 0x0A, 0x10, 0x04, 0x1F, 0x05, 0x20, 0x20,
+    0xEF, 0x07, 0x20, 0xEF, 0x07, 0x20, 0xEF, 0x07, 0x50, 0x0D, 0x0F, 0x0C,
+    0x10, 0x02, 0x1F, 0x07, 0x30, 0x40, 0x02, 0x1F, 0x07, 0x10, 0x06, 0x1F,
+    0x03, 0x30, 0x40, 0x06, 0x1F, 0x03, 0x10, 0x0A, 0x0F, 0x0E, 0x40, 0x00,
+    0x06, 0xEF, 0x02, 0x00, 0x00, 0x06, 0xEF, 0x02, 0x00, 0x00, 0x06, 0xEF,
+    0x02, 0x00, 0x30, 0x04, 0x1F, 0x06, 0x10, 0x08, 0x1F, 0x01, 0x40, 0x30,
+    0x08, 0x1F, 0x01, 0x10, 0x0C, 0x0F, 0x0C, 0x50, 0x30, 0x0C, 0x0F, 0x0C,
+    0x10, 0x01, 0x1F, 0x07, 0x50, 0x20, 0x01, 0x1F, 0x08, 0x10, 0x06, 0x1F,
+    0x03, 0x50, 0xF0, 0x20, 0xF0, 0x20, 0xF0, 0x20, 0xF0, 0x20,
+    // '$'
+    0x60, 0x09, 0x0F, 0x05, 0x50, 0x60, 0x09, 0x0F, 0x05, 0x50, 0x60, 0x09,
+    0x0F, 0x05, 0x50, 0x30, 0x05, 0x0A, 0x0D, 0x1F, 0x0E, 0x0C, 0x0A, 0x06,
+    0x02, 0x10, 0x20, 0x0B, 0x9F, 0x10, 0x10, 0x08, 0xAF, 0x10, 0x10, 0x0E,
+    0x1F, 0x0E, 0x04, 0x09, 0x0F, 0x05, 0x02, 0x04, 0x08, 0x0D, 0x10, 0x00,
+    0x01, 0x2F, 0x0A, 0x00, 0x09, 0x0F, 0x05, 0x50, 0x00, 0x01, 0x2F, 0x0E,
+    0x03, 0x09, 0x0F, 0x05, 0x50, 0x10, 0x0D, 0x5F, 0x0B, 0x06, 0x02, 0x30,
+    0x10, 0x06, 0x8F, 0x0C, 0x04, 0x10, 0x20, 0x05, 0x0D, 0x8F, 0x04, 0x00,
+    0x40, 0x04, 0x08, 0x0D, 0x5F, 0x0C, 0x00, 0x60, 0x09, 0x0F, 0x16, 0x0E,
+    0x2F, 0x00, 0x60, 0x09, 0x0F, 0x05, 0x00, 0x0A, 0x2F, 0x01, 0x00, 0x01,
+    0x0D, 0x08, 0x04, 0x02, 0x01, 0x09, 0x0F, 0x05, 0x03, 0x0E, 0x1F, 0x0E,
+    0x00, 0x00, 0x01, 0xBF, 0x08, 0x00, 0x00, 0x01, 0xAF, 0x0B, 0x01, 0x00,
+    0x10, 0x02, 0x06, 0x0A, 0x0C, 0x0E, 0x2F, 0x0D, 0x0A, 0x05, 0x20, 0x60,
+    0x09, 0x0F, 0x05, 0x50, 0x60, 0x09, 0x0F, 0x05, 0x50, 0x60, 0x09, 0x0F,
+    0x05, 0x50, 0x60, 0x09, 0x0F, 0x05, 0x50,
+    // '%'
+    0xF0, 0x70, 0x10, 0x02, 0x09, 0x0E, 0x0F, 0x0D, 0x09, 0x01, 0x50, 0x02,
+    0x1F, 0x07, 0x40, 0x00, 0x02, 0x0E, 0x4F, 0x0D, 0x01, 0x40, 0x0B, 0x0F,
+    0x0D, 0x50, 0x00, 0x0B, 0x1F, 0x07, 0x01, 0x08, 0x1F, 0x09, 0x30, 0x05,
+    0x1F, 0x04, 0x50, 0x01, 0x1F, 0x0D, 0x10, 0x01, 0x0E, 0x0F, 0x0E, 0x20,
+    0x01, 0x0D, 0x0F, 0x0A, 0x60, 0x03, 0x1F, 0x0B, 0x20, 0x0D, 0x1F, 0x01,
+    0x10, 0x08, 0x0F, 0x0E, 0x02, 0x60, 0x03, 0x1F, 0x0B, 0x20, 0x0D, 0x1F,
+    0x01, 0x00, 0x02, 0x1F, 0x07, 0x70, 0x01, 0x1F, 0x0D, 0x10, 0x01, 0x0E,
+    0x0F, 0x0E, 0x10, 0x0B, 0x0F, 0x0C, 0x80, 0x00, 0x0B, 0x1F, 0x07, 0x01,
+    0x08, 0x1F, 0x09, 0x00, 0x05, 0x1F, 0x04, 0x80, 0x00, 0x02, 0x0E, 0x4F,
+    0x0D, 0x11, 0x0E, 0x0F, 0x09, 0x00, 0x01, 0x09, 0x0D, 0x0F, 0x0E, 0x0A,
+    0x02, 0x10, 0x10, 0x02, 0x09, 0x0E, 0x0F, 0x0D, 0x09, 0x01, 0x00, 0x09,
+    0x0F, 0x0E, 0x11, 0x0D, 0x4F, 0x0E, 0x03, 0x00, 0x80, 0x03, 0x1F, 0x06,
+    0x00, 0x09, 0x1F, 0x09, 0x01, 0x06, 0x1F, 0x0C, 0x00, 0x80, 0x0C, 0x0F,
+    0x0C, 0x10, 0x0E, 0x1F, 0x01, 0x10, 0x0D, 0x1F, 0x02, 0x70, 0x06, 0x1F,
+    0x03, 0x00, 0x01, 0x1F, 0x0E, 0x20, 0x0B, 0x1F, 0x04, 0x60, 0x01, 0x0E,
+    0x0F, 0x09, 0x10, 0x01, 0x1F, 0x0E, 0x20, 0x0B, 0x1F, 0x04, 0x60, 0x09,
+    0x0F, 0x0E, 0x01, 0x20, 0x0E, 0x1F, 0x01, 0x10, 0x0D, 0x1F, 0x02, 0x50,
+    0x03, 0x1F, 0x06, 0x30, 0x09, 0x1F, 0x09, 0x01, 0x06, 0x1F, 0x0C, 0x00,
+    0x50, 0x0C, 0x0F, 0x0C, 0x40, 0x01, 0x0D, 0x4F, 0x0E, 0x03, 0x00, 0x40,
+    0x06, 0x1F, 0x03, 0x50, 0x01, 0x09, 0x0D, 0x0F, 0x0E, 0x0A, 0x02, 0x10,
+    0xF0, 0x70, 0xF0, 0x70, 0xF0, 0x70, 0xF0, 0x70,
+    // '&'
+    0xF0, 0x30, 0x50, 0x05, 0x0B, 0x0E, 0x0F, 0x0D, 0x0C, 0x08, 0x03, 0x50,
+    0x40, 0x0A, 0x7F, 0x02, 0x40, 0x30, 0x07, 0x8F, 0x02, 0x40, 0x30, 0x0C,
+    0x2F, 0x0A, 0x11, 0x03, 0x06, 0x0B, 0x02, 0x40, 0x30, 0x0E, 0x2F, 0x04,
+    0xA0, 0x30, 0x0C, 0x2F, 0x09, 0xA0, 0x30, 0x06, 0x3F, 0x04, 0x90, 0x30,
+    0x05, 0x3F, 0x0E, 0x03, 0x80, 0x20, 0x09, 0x5F, 0x0E, 0x03, 0x20, 0x09,
+    0x2F, 0x01, 0x10, 0x08, 0x2F, 0x1E, 0x2F, 0x0E, 0x02, 0x10, 0x0B, 0x1F,
+    0x0D, 0x00, 0x00, 0x02, 0x2F, 0x0E, 0x12, 0x0E, 0x2F, 0x0D, 0x12, 0x2F,
+    0x09, 0x00, 0x00, 0x06, 0x2F, 0x09, 0x10, 0x02, 0x0D, 0x2F, 0x0D, 0x0B,
+    0x2F, 0x03, 0x00, 0x00, 0x08, 0x2F, 0x09, 0x20, 0x02, 0x0D, 0x5F, 0x0A,
+    0x10, 0x00, 0x07, 0x2F, 0x0E, 0x01, 0x20, 0x02, 0x0D, 0x3F, 0x0D, 0x01,
+    0x10, 0x00, 0x02, 0x3F, 0x0D, 0x04, 0x11, 0x05, 0x0C, 0x3F, 0x0D, 0x01,
+    0x10, 0x10, 0x09, 0xDF, 0x0B, 0x10, 0x20, 0x09, 0x8F, 0x0B, 0x3F, 0x09,
+    0x00, 0x30, 0x03, 0x09, 0x0C, 0x0E, 0x0F, 0x0E, 0x0C, 0x08, 0x03, 0x00,
+    0x07, 0x3F, 0x07, 0xF0, 0x30, 0xF0, 0x30, 0xF0, 0x30, 0xF0, 0x30,
+    // "'"
+    0x50, 0x10, 0x0B, 0x1F, 0x01, 0x10, 0x0B, 0x1F, 0x01, 0x10, 0x0B, 0x1F,
+    0x01, 0x10, 0x0B, 0x1F, 0x01, 0x10, 0x0B, 0x1F, 0x01, 0x10, 0x0B, 0x1F,
+    0x01, 0x10, 0x0B, 0x1F, 0x01, 0x50, 0x50, 0x50, 0x50, 0x50, 0x50, 0x50,
+    0x50, 0x50, 0x50, 0x50, 0x50, 0x50, 0x50, 0x50,
+    // '('
+    0x80, 0x40, 0x0B, 0x1F, 0x0C, 0x30, 0x04, 0x2F, 0x05, 0x30, 0x0C, 0x1F,
+    0x0D, 0x00, 0x20, 0x04, 0x2F, 0x07, 0x00, 0x20, 0x0B, 0x2F, 0x02, 0x00,
+    0x10, 0x01, 0x2F, 0x0C, 0x10, 0x10, 0x05, 0x2F, 0x08, 0x10, 0x10, 0x09,
+    0x2F, 0x05, 0x10, 0x10, 0x0C, 0x2F, 0x03, 0x10, 0x10, 0x0D, 0x2F, 0x02,
+    0x10, 0x10, 0x0E, 0x2F, 0x01, 0x10, 0x10, 0x0D, 0x2F, 0x02, 0x10, 0x10,
+    0x0C, 0x2F, 0x03, 0x10, 0x10, 0x09, 0x2F, 0x05, 0x10, 0x10, 0x06, 0x2F,
+    0x08, 0x10, 0x10, 0x02, 0x2F, 0x0B, 0x10, 0x20, 0x0B, 0x2F, 0x01, 0x00,
+    0x20, 0x05, 0x2F, 0x07, 0x00, 0x30, 0x0D, 0x1F, 0x0C, 0x00, 0x30, 0x04,
+    0x2F, 0x05, 0x40, 0x0B, 0x1F, 0x0C, 0x80,
+    // ')'
+    0x80, 0x10, 0x0C, 0x1F, 0x0A, 0x20, 0x10, 0x05, 0x2F, 0x04, 0x10, 0x20,
+    0x0D, 0x1F, 0x0C, 0x10, 0x20, 0x07, 0x2F, 0x04, 0x00, 0x20, 0x02, 0x2F,
+    0x0A, 0x00, 0x30, 0x0C, 0x2F, 0x01, 0x30, 0x09, 0x2F, 0x05, 0x30, 0x05,
+    0x2F, 0x09, 0x30, 0x03, 0x2F, 0x0B, 0x30, 0x02, 0x2F, 0x0C, 0x30, 0x01,
+    0x2F, 0x0D, 0x30, 0x02, 0x2F, 0x0C, 0x30, 0x03, 0x2F, 0x0B, 0x30, 0x05,
+    0x2F, 0x09, 0x30, 0x09, 0x2F, 0x05, 0x30, 0x0C, 0x2F, 0x01, 0x20, 0x02,
+    0x2F, 0x0A, 0x00, 0x20, 0x07, 0x2F, 0x04, 0x00, 0x20, 0x0D, 0x1F, 0x0C,
+    0x10, 0x10, 0x05, 0x2F, 0x04, 0x10, 0x10, 0x0C, 0x1F, 0x0A, 0x20, 0x80,
+    // '*'
+    0xC0, 0x40, 0x0B, 0x0F, 0x04, 0x40, 0x40, 0x0B, 0x0F, 0x04, 0x40, 0x00,
+    0x0C, 0x06, 0x10, 0x0B, 0x0F, 0x04, 0x00, 0x02, 0x0A, 0x07, 0x00, 0x04,
+    0x1F, 0x0D, 0x06, 0x0B, 0x0F, 0x06, 0x09, 0x1F, 0x0C, 0x00, 0x00, 0x01,
+    0x08, 0x0E, 0x4F, 0x0D, 0x05, 0x10, 0x20, 0x03, 0x0E, 0x2F, 0x0A, 0x30,
+    0x00, 0x01, 0x08, 0x0E, 0x4F, 0x0D, 0x05, 0x10, 0x04, 0x1F, 0x0D, 0x05,
+    0x0B, 0x0F, 0x06, 0x09, 0x1F, 0x0C, 0x00, 0x00, 0x0C, 0x06, 0x10, 0x0B,
+    0x0F, 0x04, 0x00, 0x02, 0x0A, 0x07, 0x00, 0x40, 0x0B, 0x0F, 0x04, 0x40,
+    0x40, 0x0B, 0x0F, 0x04, 0x40, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0,
+    0xC0, 0xC0, 0xC0, 0xC0,
+    // '+'
+    0xF0, 0x10, 0xF0, 0x10, 0xF0, 0x10, 0xF0, 0x10, 0x70, 0x05, 0x1F, 0x07,
+    0x50, 0x70, 0x05, 0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F, 0x07, 0x50, 0x70,
+    0x05, 0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F,
+    0x07, 0x50, 0x10, 0x07, 0xDF, 0x08, 0x10, 0x07, 0xDF, 0x08, 0x10, 0x07,
+    0xDF, 0x08, 0x70, 0x05, 0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F, 0x07, 0x50,
+    0x70, 0x05, 0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F, 0x07, 0x50, 0x70, 0x05,
+    0x1F, 0x07, 0x50, 0x70, 0x05, 0x1F, 0x07, 0x50, 0xF0, 0x10, 0xF0, 0x10,
+    0xF0, 0x10, 0xF0, 0x10,
+    // ','
+    0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+    0x60, 0x60, 0x10, 0x08, 0x2F, 0x0A, 0x10, 0x08, 0x2F, 0x0A, 0x10, 0x08,
+    0x2F, 0x0A, 0x10, 0x09, 0x2F, 0x09, 0x10, 0x0C, 0x1F, 0x0E, 0x02, 0x00,
+    0x01, 0x2F, 0x06, 0x00, 0x00, 0x05, 0x1F, 0x0B, 0x10, 0x00, 0x09, 0x0F,
+    0x0E, 0x02, 0x10, 0x60,
+    // '-'
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x0B,
+    0x5F, 0x0A, 0x00, 0x0B, 0x5F, 0x0A, 0x00, 0x0B, 0x5F, 0x0A, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    // '.'
+    0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60,
+    0x60, 0x60, 0x10, 0x08, 0x2F, 0x0A, 0x10, 0x08, 0x2F, 0x0A, 0x10, 0x08,
+    0x2F, 0x0A, 0x10, 0x08, 0x2F, 0x0A, 0x10, 0x08, 0x2F, 0x0A, 0x60, 0x60,
+    0x60, 0x60,
+    // '/'
+    0x80, 0x50, 0x0E, 0x0F, 0x09, 0x40, 0x04, 0x1F, 0x04, 0x40, 0x09, 0x0F,
+    0x0E, 0x00, 0x40, 0x0E, 0x0F, 0x0A, 0x00, 0x30, 0x03, 0x1F, 0x06, 0x00,
+    0x30, 0x08, 0x1F, 0x01, 0x00, 0x30, 0x0D, 0x0F, 0x0B, 0x10, 0x20, 0x02,
+    0x1F, 0x07, 0x10, 0x20, 0x07, 0x1F, 0x02, 0x10, 0x20, 0x0B, 0x0F, 0x0C,
+    0x20, 0x10, 0x01, 0x1F, 0x08, 0x20, 0x10, 0x06, 0x1F, 0x03, 0x20, 0x10,
+    0x0A, 0x0F, 0x0E, 0x30, 0x00, 0x01, 0x0E, 0x0F, 0x09, 0x30, 0x00, 0x05,
+    0x1F, 0x04, 0x30, 0x00, 0x09, 0x0F, 0x0E, 0x40, 0x00, 0x0E, 0x0F, 0x0A,
+    0x40, 0x03, 0x1F, 0x05, 0x40, 0x08, 0x1F, 0x01, 0x40, 0x0D, 0x0F, 0x0B,
+    0x50, 0x80, 0x80,
+    // '0'
+    0xF0, 0x30, 0x01, 0x07, 0x0C, 0x0E, 0x0F, 0x0D, 0x0A, 0x05, 0x30, 0x20,
+    0x03, 0x0D, 0x6F, 0x0B, 0x01, 0x10, 0x10, 0x02, 0x0E, 0x8F, 0x0B, 0x10,
+    0x10, 0x0A, 0x2F, 0x0D, 0x03, 0x00, 0x05, 0x3F, 0x06, 0x00, 0x00, 0x02,
+    0x3F, 0x04, 0x20, 0x08, 0x2F, 0x0C, 0x00, 0x00, 0x07, 0x2F, 0x0E, 0x30,
+    0x04, 0x3F, 0x02, 0x00, 0x0A, 0x2F, 0x0C, 0x30, 0x01, 0x3F, 0x05, 0x00,
+    0x0B, 0x2F, 0x0B, 0x40, 0x3F, 0x07, 0x00, 0x0C, 0x2F, 0x0A, 0x40, 0x3F,
+    0x08, 0x00, 0x0C, 0x2F, 0x0A, 0x40, 0x3F, 0x08, 0x00, 0x0B, 0x2F, 0x0B,
+    0x40, 0x3F, 0x07, 0x00, 0x0A, 0x2F, 0x0C, 0x30, 0x01, 0x3F, 0x05, 0x00,
+    0x07, 0x2F, 0x0E, 0x30, 0x04, 0x3F, 0x02, 0x00, 0x02, 0x3F, 0x04, 0x20,
+    0x08, 0x2F, 0x0C, 0x00, 0x10, 0x0A, 0x2F, 0x0D, 0x03, 0x00, 0x05, 0x3F,
+    0x06, 0x00, 0x10, 0x02, 0x0E, 0x8F, 0x0B, 0x10, 0x20, 0x03, 0x0D, 0x6F,
+    0x0B, 0x01, 0x10, 0x30, 0x01, 0x07, 0x0C, 0x0E, 0x0F, 0x0E, 0x0A, 0x05,
+    0x30, 0xF0, 0xF0, 0xF0, 0xF0,
+    // '1'
+    0xF0, 0x20, 0x03, 0x07, 0x0A, 0x0E, 0x3F, 0x01, 0x30, 0x10, 0x04, 0x7F,
+    0x01, 0x30, 0x10, 0x04, 0x7F, 0x01, 0x30, 0x10, 0x04, 0x0C, 0x08, 0x05,
+    0x04, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F,
+    0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30,
+    0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03,
+    0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01,
+    0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x50, 0x03, 0x3F, 0x01, 0x30, 0x10,
+    0x03, 0xBF, 0x01, 0x10, 0x03, 0xBF, 0x01, 0x10, 0x03, 0xBF, 0x01, 0xF0,
+    0xF0, 0xF0, 0xF0,
+    // '2'
+    0xE0, 0x10, 0x02, 0x06, 0x09, 0x0C, 0x0E, 0x0F, 0x0E, 0x0D, 0x0A, 0x05,
+    0x20, 0x00, 0x01, 0x9F, 0x0B, 0x01, 0x00, 0x00, 0x01, 0xAF, 0x0A, 0x00,
+    0x00, 0x01, 0x0F, 0x0E, 0x09, 0x04, 0x11, 0x06, 0x0E, 0x3F, 0x03, 0x00,
+    0x01, 0x0A, 0x01, 0x40, 0x06, 0x3F, 0x06, 0x80, 0x02, 0x3F, 0x07, 0x80,
+    0x02, 0x3F, 0x05, 0x80, 0x07, 0x3F, 0x01, 0x70, 0x03, 0x0E, 0x2F, 0x08,
+    0x00, 0x60, 0x03, 0x0E, 0x2F, 0x0B, 0x10, 0x50, 0x04, 0x0E, 0x2F, 0x0B,
+    0x01, 0x10, 0x40, 0x05, 0x3F, 0x0B, 0x01, 0x20, 0x30, 0x06, 0x3F, 0x0A,
+    0x40, 0x20, 0x07, 0x3F, 0x08, 0x50, 0x10, 0x08, 0x3F, 0x07, 0x60, 0x00,
+    0x01, 0xBF, 0x09, 0x00, 0x01, 0xBF, 0x09, 0x00, 0x01, 0xBF, 0x09, 0xE0,
+    0xE0, 0xE0, 0xE0,
+    // '3'
+    0xE0, 0x10, 0x01, 0x05, 0x09, 0x0C, 0x0D, 0x0F, 0x0E, 0x0D, 0x0B, 0x07,
+    0x01, 0x10, 0x10, 0x0A, 0x8F, 0x0E, 0x04, 0x00, 0x10, 0x0A, 0x9F, 0x0E,
+    0x00, 0x10, 0x19, 0x04, 0x02, 0x11, 0x04, 0x0D, 0x3F, 0x04, 0x80, 0x04,
+    0x3F, 0x05, 0x80, 0x04, 0x3F, 0x03, 0x60, 0x01, 0x05, 0x0D, 0x2F, 0x0A,
+    0x00, 0x30, 0x06, 0x5F, 0x0E, 0x08, 0x10, 0x30, 0x06, 0x5F, 0x0C, 0x06,
+    0x10, 0x30, 0x06, 0x7F, 0x09, 0x00, 0x60, 0x02, 0x05, 0x0C, 0x3F, 0x05,
+    0x80, 0x01, 0x0E, 0x2F, 0x0A, 0x90, 0x0C, 0x2F, 0x0B, 0x80, 0x01, 0x0E,
+    0x2F, 0x0B, 0x00, 0x06, 0x0B, 0x07, 0x03, 0x02, 0x00, 0x01, 0x05, 0x0C,
+    0x3F, 0x07, 0x00, 0x06, 0xAF, 0x0D, 0x01, 0x00, 0x06, 0x9F, 0x0C, 0x02,
+    0x00, 0x10, 0x04, 0x08, 0x0B, 0x0D, 0x0E, 0x0F, 0x0E, 0x0C, 0x09, 0x04,
+    0x20, 0xE0, 0xE0, 0xE0, 0xE0,
+    // '4'
+    0xF0, 0x60, 0x03, 0x4F, 0x02, 0x10, 0x60, 0x0D, 0x4F, 0x02, 0x10, 0x50,
+    0x08, 0x5F, 0x02, 0x10, 0x40, 0x03, 0x6F, 0x02, 0x10, 0x40, 0x0C, 0x1F,
+    0x0B, 0x3F, 0x02, 0x10, 0x30, 0x06, 0x1F, 0x0D, 0x03, 0x3F, 0x02, 0x10,
+    0x20, 0x02, 0x0E, 0x1F, 0x05, 0x02, 0x3F, 0x02, 0x10, 0x20, 0x0B, 0x1F,
+    0x0A, 0x00, 0x02, 0x3F, 0x02, 0x10, 0x10, 0x05, 0x1F, 0x0E, 0x02, 0x00,
+    0x02, 0x3F, 0x02, 0x10, 0x00, 0x01, 0x0E, 0x1F, 0x07, 0x10, 0x02, 0x3F,
+    0x02, 0x10, 0x00, 0x09, 0x1F, 0x0C, 0x20, 0x02, 0x3F, 0x02, 0x10, 0x00,
+    0x0E, 0x1F, 0x03, 0x20, 0x02, 0x3F, 0x02, 0x10, 0x00, 0x0E, 0xCF, 0x09,
+    0x00, 0x0E, 0xCF, 0x09, 0x00, 0x0E, 0xCF, 0x09, 0x70, 0x02, 0x3F, 0x02,
+    0x10, 0x70, 0x02, 0x3F, 0x02, 0x10, 0x70, 0x02, 0x3F, 0x02, 0x10, 0xF0,
+    0xF0, 0xF0, 0xF0,
+    // '5'
+    0xF0, 0x10, 0x07, 0x9F, 0x0C, 0x10, 0x10, 0x07, 0x9F, 0x0C, 0x10, 0x10,
+    0x07, 0x9F, 0x0C, 0x10, 0x10, 0x07, 0x2F, 0x02, 0x80, 0x10, 0x07, 0x2F,
+    0x02, 0x80, 0x10, 0x07, 0x2F, 0x02, 0x80, 0x10, 0x07, 0x2F, 0x0C, 0x0E,
+    0x0F, 0x0E, 0x0B, 0x06, 0x01, 0x20, 0x10, 0x07, 0x8F, 0x0D, 0x03, 0x10,
+    0x10, 0x07, 0x9F, 0x0E, 0x01, 0x00, 0x10, 0x06, 0x0A, 0x05, 0x03, 0x11,
+    0x04, 0x0C, 0x3F, 0x08, 0x00, 0x80, 0x01, 0x0D, 0x2F, 0x0D, 0x00, 0x90,
+    0x09, 0x3F, 0x00, 0x90, 0x09, 0x3F, 0x00, 0x80, 0x01, 0x0D, 0x2F, 0x0D,
+    0x00, 0x00, 0x02, 0x0C, 0x08, 0x04, 0x02, 0x11, 0x04, 0x0C, 0x3F, 0x08,
+    0x00, 0x00, 0x02, 0xAF, 0x0D, 0x01, 0x00, 0x00, 0x02, 0x9F, 0x0C, 0x02,
+    0x10, 0x10, 0x03, 0x06, 0x0A, 0x0C, 0x0E, 0x0F, 0x0E, 0x0D, 0x0A, 0x05,
+    0x30, 0xF0, 0xF0, 0xF0, 0xF0,
+    // '6'
+    0xF0, 0x40, 0x01, 0x07, 0x0B, 0x0D, 0x0F, 0x0E, 0x0C, 0x09, 0x04, 0x10,
+    0x30, 0x04, 0x0E, 0x7F, 0x04, 0x00, 0x20, 0x05, 0x9F, 0x04, 0x00, 0x10,
+    0x02, 0x0E, 0x2F, 0x0C, 0x04, 0x11, 0x02, 0x05, 0x0A, 0x04, 0x00, 0x10,
+    0x09, 0x2F, 0x0B, 0x80, 0x10, 0x0E, 0x2F, 0x03, 0x80, 0x00, 0x03, 0x2F,
+    0x0E, 0x04, 0x0A, 0x0E, 0x0F, 0x0E, 0x0A, 0x04, 0x20, 0x00, 0x06, 0xAF,
+    0x09, 0x10, 0x00, 0x07, 0xBF, 0x07, 0x00, 0x00, 0x07, 0x3F, 0x0E, 0x05,
+    0x01, 0x03, 0x0C, 0x2F, 0x0E, 0x01, 0x00, 0x07, 0x3F, 0x08, 0x20, 0x03,
+    0x3F, 0x04, 0x00, 0x05, 0x3F, 0x06, 0x30, 0x3F, 0x06, 0x00, 0x02, 0x3F,
+    0x05, 0x30, 0x3F, 0x05, 0x10, 0x0D, 0x2F, 0x08, 0x20, 0x03, 0x3F, 0x03,
+    0x10, 0x06, 0x2F, 0x0E, 0x05, 0x01, 0x02, 0x0C, 0x2F, 0x0C, 0x00, 0x20,
+    0x0C, 0x9F, 0x04, 0x00, 0x20, 0x01, 0x0B, 0x6F, 0x0E, 0x05, 0x10, 0x40,
+    0x05, 0x0B, 0x0E, 0x0F, 0x0E, 0x0C, 0x08, 0x01, 0x20, 0xF0, 0xF0, 0xF0,
+    0xF0,
+    // '7'
+    0xE0, 0x00, 0x06, 0xBF, 0x0C, 0x00, 0x06, 0xBF, 0x0C, 0x00, 0x06, 0xBF,
+    0x0B, 0x80, 0x03, 0x3F, 0x06, 0x80, 0x09, 0x2F, 0x0E, 0x01, 0x70, 0x01,
+    0x3F, 0x08, 0x00, 0x70, 0x07, 0x3F, 0x01, 0x00, 0x70, 0x0D, 0x2F, 0x09,
+    0x10, 0x60, 0x05, 0x3F, 0x03, 0x10, 0x60, 0x0C, 0x2F, 0x0B, 0x20, 0x50,
+    0x03, 0x3F, 0x04, 0x20, 0x50, 0x09, 0x2F, 0x0D, 0x30, 0x40, 0x01, 0x3F,
+    0x06, 0x30, 0x40, 0x07, 0x2F, 0x0E, 0x01, 0x30, 0x40, 0x0D, 0x2F, 0x08,
+    0x40, 0x30, 0x05, 0x3F, 0x01, 0x40, 0x30, 0x0C, 0x2F, 0x0A, 0x50, 0x20,
+    0x03, 0x3F, 0x03, 0x50, 0xE0, 0xE0, 0xE0, 0xE0,
+    // '8'
+    0xF0, 0x30, 0x05, 0x0A, 0x0D, 0x0E, 0x0F, 0x0E, 0x0C, 0x09, 0x03, 0x20,
+    0x10, 0x01, 0x0C, 0x8F, 0x09, 0x10, 0x10, 0x0A, 0xAF, 0x05, 0x00, 0x00,
+    0x01, 0x3F, 0x0B, 0x02, 0x01, 0x04, 0x0E, 0x2F, 0x0B, 0x00, 0x00, 0x02,
+    0x3F, 0x03, 0x20, 0x08, 0x2F, 0x0C, 0x00, 0x10, 0x3F, 0x03, 0x20, 0x08,
+    0x2F, 0x0A, 0x00, 0x10, 0x09, 0x2F, 0x0B, 0x02, 0x01, 0x04, 0x0E, 0x2F,
+    0x04, 0x00, 0x10, 0x01, 0x0A, 0x8F, 0x06, 0x10, 0x30, 0x08, 0x5F, 0x0E,
+    0x04, 0x20, 0x10, 0x02, 0x0D, 0x8F, 0x0A, 0x10, 0x10, 0x0D, 0x2F, 0x0A,
+    0x02, 0x01, 0x03, 0x0D, 0x2F, 0x08, 0x00, 0x00, 0x05, 0x2F, 0x0E, 0x30,
+    0x04, 0x3F, 0x00, 0x00, 0x07, 0x2F, 0x0C, 0x30, 0x01, 0x3F, 0x03, 0x00,
+    0x07, 0x2F, 0x0E, 0x30, 0x04, 0x3F, 0x02, 0x00, 0x04, 0x3F, 0x0A, 0x02,
+    0x01, 0x03, 0x0D, 0x2F, 0x0E, 0x00, 0x10, 0x0C, 0xAF, 0x08, 0x00, 0x10,
+    0x02, 0x0D, 0x8F, 0x09, 0x10, 0x30, 0x06, 0x0A, 0x0D, 0x0E, 0x0F, 0x0E,
+    0x0C, 0x09, 0x04, 0x20, 0xF0, 0xF0, 0xF0, 0xF0,
+    // '9'
+    0xF0, 0x30, 0x03, 0x09, 0x0D, 0x1E, 0x0D, 0x09, 0x03, 0x30, 0x20, 0x09,
+    0x7F, 0x07, 0x20, 0x10, 0x09, 0x9F, 0x06, 0x10, 0x00, 0x03, 0x3F, 0x08,
+    0x11, 0x09, 0x2F, 0x0E, 0x01, 0x00, 0x00, 0x08, 0x2F, 0x0D, 0x30, 0x0D,
+    0x2F, 0x07, 0x00, 0x00, 0x0A, 0x2F, 0x0A, 0x30, 0x0B, 0x2F, 0x0C, 0x00,
+    0x00, 0x0B, 0x2F, 0x0A, 0x30, 0x0B, 0x3F, 0x00, 0x00, 0x09, 0x2F, 0x0D,
+    0x30, 0x0D, 0x3F, 0x01, 0x00, 0x05, 0x3F, 0x08, 0x11, 0x09, 0x4F, 0x02,
+    0x10, 0x0C, 0xBF, 0x02, 0x10, 0x02, 0x0D, 0xAF, 0x01, 0x20, 0x01, 0x07,
+    0x0C, 0x0E, 0x0F, 0x0D, 0x08, 0x05, 0x2F, 0x0D, 0x00, 0x90, 0x08, 0x2F,
+    0x09, 0x00, 0x80, 0x02, 0x0E, 0x2F, 0x04, 0x00, 0x10, 0x08, 0x09, 0x04,
+    0x02, 0x00, 0x02, 0x06, 0x0E, 0x2F, 0x0B, 0x10, 0x10, 0x09, 0x8F, 0x0D,
+    0x01, 0x10, 0x10, 0x09, 0x7F, 0x0B, 0x01, 0x20, 0x10, 0x01, 0x06, 0x0A,
+    0x0D, 0x1E, 0x0D, 0x0A, 0x05, 0x40, 0xF0, 0xF0, 0xF0, 0xF0,
+};
+
+static const font_glyph_t font_sans24_glyphs[] = {
+    {     0,  0,  8 },  // ' '
+    {     0,  8, 11 },  // '!'
+    {    71, 11, 13 },  // '"'
+    {   143, 19, 20 },  // '#'
+    {   285, 16, 17 },  // '$'
+    {   448, 24, 24 },  // '%'
+    {   696, 20, 21 },  // '&'
+    {   863,  6,  7 },  // "'"
+    {   907,  9, 11 },  // '('
+    {  1010,  9, 11 },  // ')'
+    {  1106, 13, 13 },  // '*'
+    {  1206, 18, 20 },  // '+'
+    {  1294,  7,  9 },  // ','
+    {  1346,  9, 10 },  // '-'
+    {  1378,  7,  9 },  // '.'
+    {  1416,  9,  9 },  // '/'
+    {  1515, 16, 17 },  // '0'
+    {  1664, 16, 17 },  // '1'
+    {  1763, 15, 17 },  // '2'
+    {  1874, 15, 17 },  // '3'
+    {  1999, 16, 17 },  // '4'
+    {  2122, 16, 17 },  // '5'
+    {  2247, 16, 17 },  // '6'
+    {  2392, 15, 17 },  // '7'
+    {  2484, 16, 17 },  // '8'
+    {  2636, 16, 17 },  // '9'
+};
+
+const font_t font_sans24 = {
+    .data = font_sans24_runs,
+    .char_width = 24,
+    .char_height = 23,
+    .char_spacing = 0,
+    .start_char = ' ',
+    .end_char = '9',
+    .bytes_per_char = 0,
+    .glyphs = font_sans24_glyphs,
+    .bpp = 4
+};
@@ -0,0 +1,9 @@
+#ifndef FONT_SANS24_H
+#define FONT_SANS24_H
+
+#include "fonts.h"
+
+// 23 px DejaVu Sans Bold, run-length, 4 bpp - space to 9 (digits, '.', '-')
+extern const font_t font_sans24;
+
+#endif // FONT_SANS24_H
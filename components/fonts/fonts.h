@@ -7,7 +7,24 @@
 extern "C" {
 #endif
 
+// Glyph of a run-length font.  Its runs start at offset in the font
+// data, and the columns from width to advance are background.
+typedef struct {
+    uint16_t offset;          // fonts of up to 64 KB of runs
+    uint8_t width;            // columns stored
+    uint8_t advance;          // columns to the next character
+} font_glyph_t;
+
 // Font structure - use the same definition style as display_driver.h
+//
+// Bitmap fonts store one byte per column, bit 0 at the top, and are at
+// most 8 pixels high.  Run-length fonts (glyphs set) are any height,
+// each character its own width, with 1, 2 or 4 bits of coverage per
+// pixel for antialiased edges.  A glyph is stored row by row from the
+// top, each row as runs of one coverage level that end with the row:
+// a byte is (run length - 1) << bpp | level.  Level 0 is the
+// background, the highest level the text colour.  make_rle_font.py
+// converts a TrueType font.
 struct font_t {
     const uint8_t *data;       // Pointer to font data
     int char_width;           // Width of each character in pixels
@@ -16,6 +33,8 @@ struct font_t {
     char start_char;          // First character in font (ASCII code)
     char end_char;            // Last character in font (ASCII code)
     int bytes_per_char;       // Bytes per character in data array
+    const font_glyph_t *glyphs; // Run-length fonts: start_char to end_char
+    int bpp;                  // Run-length fonts: bits per coverage level
 };
 
 // This matches what display_driver.h expects
@@ -31,6 +50,9 @@ extern const font_t font_5x8;
 // 8x8 Font (Wider) - Only numbers 0-9
 extern const font_t font_8x8;
 
+// 23 px DejaVu Sans Bold, run-length, 4 bpp - space to 9 (digits, '.', '-')
+extern const font_t font_sans24;
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Convert a TrueType font to a run-length font for fonts.h.
+
+    python3 make_rle_font.py FONT.ttf SIZE BPP FIRST LAST NAME > NAME.c
+
+Renders the characters FIRST..LAST at SIZE pixels with antialiasing,
+keeps BPP bits of coverage (1, 2 or 4) and writes the glyph table and
+runs as C.  The glyphs share one height: the rows any of them touches.
+Needs Pillow.
+"""
+import sys
+
+from PIL import Image, ImageDraw, ImageFont
+
+
+def encode_row(levels, bpp):
+    """Runs of one level, as (length - 1) << bpp | level bytes."""
+    longest = 256 >> bpp
+    runs = []
+    x = 0
+    while x < len(levels):
+        length = 1
+        while (x + length < len(levels) and levels[x + length] == levels[x]
+               and length < longest):
+            length += 1
+        runs.append(((length - 1) << bpp) | levels[x])
+        x += length
+    return runs
+
+
+def main():
+    if len(sys.argv) != 7:
+        sys.exit(__doc__)
+    path, size, bpp, first, last, name = sys.argv[1:]
+    size, bpp = int(size), int(bpp)
+    if bpp not in (1, 2, 4):
+        sys.exit("BPP is 1, 2 or 4")
+    font = ImageFont.truetype(path, size)
+    top_level = (1 << bpp) - 1
+    chars = [chr(c) for c in range(ord(first), ord(last) + 1)]
+
+    # Rows used by any glyph, from the baseline of a size x 2 canvas
+    top, bottom = size * 2, 0
+    for ch in chars:
+        box = font.getbbox(ch)
+        if box[3] > box[1]:
+            top, bottom = min(top, box[1]), max(bottom, box[3])
+    height = bottom - top
+
+    glyphs = []
+    data = []
+    for ch in chars:
+        advance = int(round(font.getlength(ch)))
+        image = Image.new("L", (advance + size, height), 0)
+        ImageDraw.Draw(image).text((0, -top), ch, font=font, fill=255)
+        # Columns up to the last one inked; the rest of the advance is
+        # background, not stored
+        ink = image.getbbox()
+        width = ink[2] if ink else 0
+        advance = max(advance, width)
+        runs = []
+        for y in range(height if width else 0):
+            levels = [(image.getpixel((x, y)) * top_level + 127) // 255
+                      for x in range(width)]
+            runs += encode_row(levels, bpp)
+        glyphs.append((ch, len(data), width, advance, runs))
+        data += runs
+
+    if len(data) > 0xFFFF:
+        sys.exit("more than 64 KB of runs")
+
+    print('#include "fonts.h"')
+    print('#include "%s.h"' % name)
+    print()
+    print("// Generated by make_rle_font.py from %s, %d px, %d bpp" %
+          (path.split("/")[-1], size, bpp))
+    print("static const uint8_t %s_runs[] = {" % name)
+    for ch, offset, width, advance, runs in glyphs:
+        print("    // %r" % ch)
+        for i in range(0, len(runs), 12):
+            print("    " + " ".join("0x%02X," % r for r in runs[i:i + 12]))
+    print("};")
+    print()
+    print("static const font_glyph_t %s_glyphs[] = {" % name)
+    for ch, offset, width, advance, runs in glyphs:
+        print("    { %5d, %2d, %2d },  // %r" % (offset, width, advance, ch))
+    print("};")
+    print()
+    print("const font_t %s = {" % name)
+    print("    .data = %s_runs," % name)
+    print("    .char_width = %d," % max(g[3] for g in glyphs))
+    print("    .char_height = %d," % height)
+    print("    .char_spacing = 0,")
+    print("    .start_char = '%s'," % first.replace("'", "\\'"))
+    print("    .end_char = '%s'," % last.replace("'", "\\'"))
+    print("    .bytes_per_char = 0,")
+    print("    .glyphs = %s_glyphs," % name)
+    print("    .bpp = %d" % bpp)
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,178 @@
+/*
+ * COV value-change to notification latency
+ *
+ * 32 objects with 4 subscribers each, 128 subscriptions, the size of the
+ * subscription table.  The time is taken from the Present_Value write
+ * that changes the object to each notification reaching the datalink,
+ * with the COV task run straight after the write, as the server task
+ * does when the control task wakes it.  Then the cost of a change of an
+ * object nobody subscribes to, before and after the index has seen many
+ * objects come and go.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "handlers.h"
+#include "av.h"
+
+#define BENCH_OBJECTS       32
+// every Analog Value there can be, for the churn
+#define BENCH_CHURN_OBJECTS 57
+#define BENCH_SUBSCRIBERS   4
+#define BENCH_ROUNDS        2000
+#define BENCH_MISSES        1000000
+
+static float bench_values[BENCH_CHURN_OBJECTS];
+
+static uint32_t bench_instance(unsigned n)
+{
+    // 25 objects of the application, the rest made by CreateObject
+    return (n < 25) ? n : 100 + n;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void bench_report(const char *name, uint64_t *samples, unsigned count)
+{
+    qsort(samples, count, sizeof(samples[0]), bench_compare);
+    printf("%-34s p50 %7.2f us  p99 %7.2f us  max %7.2f us\n", name,
+           samples[count / 2] / 1000.0, samples[count * 99 / 100] / 1000.0,
+           samples[count - 1] / 1000.0);
+}
+
+static void bench_subscribe(void)
+{
+    unsigned n = 0;
+    unsigned s = 0;
+
+    for (n = 0; n < BENCH_OBJECTS; n++) {
+        for (s = 0; s < BENCH_SUBSCRIBERS; s++) {
+            HOST_CHECK(host_bacnet_subscribe(s + 1, 1000 + s,
+                                             OBJECT_ANALOG_VALUE,
+                                             bench_instance(n), false, 0,
+                                             false));
+        }
+    }
+    handler_cov_task();
+}
+
+// Latency of the notifications for a change of one object, and for all
+// of them changing at once
+static void bench_latency(void)
+{
+    static uint64_t first[BENCH_ROUNDS];
+    static uint64_t last[BENCH_ROUNDS];
+    static uint64_t all[BENCH_ROUNDS];
+    unsigned round = 0;
+    unsigned n = 0;
+    unsigned sent = 0;
+    uint64_t t0 = 0;
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        n = round % BENCH_OBJECTS;
+        sent = host_datalink_sent();
+        bench_values[n] += 1.0f;
+        t0 = host_now_ns();
+        Analog_Value_Present_Value_Set(bench_instance(n), bench_values[n], 16);
+        handler_cov_task();
+        HOST_CHECK_EQ(host_datalink_sent() - sent, BENCH_SUBSCRIBERS);
+        first[round] = host_datalink_pdu(sent)->time_ns - t0;
+        last[round] = host_datalink_pdu(host_datalink_sent() - 1)->time_ns - t0;
+    }
+    bench_report("1 object, first of 4", first, BENCH_ROUNDS);
+    bench_report("1 object, last of 4", last, BENCH_ROUNDS);
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        sent = host_datalink_sent();
+        t0 = host_now_ns();
+        for (n = 0; n < BENCH_OBJECTS; n++) {
+            bench_values[n] += 1.0f;
+            Analog_Value_Present_Value_Set(bench_instance(n), bench_values[n],
+                                           16);
+        }
+        handler_cov_task();
+        HOST_CHECK_EQ(host_datalink_sent() - sent,
+                      BENCH_OBJECTS * BENCH_SUBSCRIBERS);
+        all[round] = host_datalink_pdu(host_datalink_sent() - 1)->time_ns - t0;
+    }
+    bench_report("32 objects, last of 128", all, BENCH_ROUNDS);
+}
+
+// A change of an object without subscribers costs one failed lookup
+static double bench_miss(void)
+{
+    uint64_t t0 = host_now_ns();
+    unsigned i = 0;
+
+    for (i = 0; i < BENCH_MISSES; i++) {
+        handler_cov_object_changed(OBJECT_BINARY_VALUE, i % 1024);
+    }
+
+    return (double)(host_now_ns() - t0) / BENCH_MISSES;
+}
+
+// Subscribes and cancels objects at random until every slot of the
+// index has held one
+static void bench_churn(bool subscribed[BENCH_CHURN_OBJECTS])
+{
+    unsigned i = 0;
+    unsigned n = 0;
+
+    for (i = 0; i < 20000; i++) {
+        n = (unsigned)rand() % BENCH_CHURN_OBJECTS;
+        if (host_bacnet_subscribe(9, 77, OBJECT_ANALOG_VALUE,
+                                  bench_instance(n), false, 0,
+                                  subscribed[n])) {
+            subscribed[n] = !subscribed[n];
+        }
+        handler_cov_task();
+    }
+}
+
+static void bench_cancel(bool subscribed[BENCH_CHURN_OBJECTS])
+{
+    unsigned n = 0;
+
+    for (n = 0; n < BENCH_CHURN_OBJECTS; n++) {
+        if (subscribed[n]) {
+            host_bacnet_subscribe(9, 77, OBJECT_ANALOG_VALUE,
+                                  bench_instance(n), false, 0, true);
+            subscribed[n] = false;
+        }
+    }
+    handler_cov_task();
+}
+
+int main(void)
+{
+    bool subscribed[BENCH_CHURN_OBJECTS] = { false };
+    unsigned n = 0;
+    double fresh = 0;
+    double churned = 0;
+    double emptied = 0;
+
+    host_bacnet_init();
+    for (n = 25; n < BENCH_CHURN_OBJECTS; n++) {
+        HOST_CHECK(Analog_Value_Create(bench_instance(n)));
+    }
+    fresh = bench_miss();
+    srand(1);
+    bench_churn(subscribed);
+    churned = bench_miss();
+    bench_cancel(subscribed);
+    emptied = bench_miss();
+    printf("change without subscribers: %.1f ns fresh, %.1f ns after churn, "
+           "%.1f ns once emptied\n", fresh, churned, emptied);
+    bench_subscribe();
+    printf("COV latency, %u subscriptions on %u objects, unconfirmed\n",
+           BENCH_OBJECTS * BENCH_SUBSCRIBERS, BENCH_OBJECTS);
+    bench_latency();
+
+    return host_check_result("bench_cov");
+}
@@ -0,0 +1,148 @@
+/*
+ * COVNotificationMultiple against one COVNotification per property
+ *
+ * One client watches the Present_Value of the 12 Analog Values of a PM
+ * sensor, and every sensor frame moves all of them, once a second.
+ * The client subscribes either with 12 SubscribeCOVProperty requests,
+ * or with one SubscribeCOVPropertyMultiple, with a maxNotificationDelay
+ * of 0, 1 or 3 s.  For each: packets and bytes per frame, the time from
+ * the changes to the last packet on the datalink, and how long a change
+ * waits, in seconds of the server's clock, before it is sent.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "handlers.h"
+#include "av.h"
+
+#define BENCH_CHANNELS  12
+#define BENCH_FRAMES    600
+// instances of the first sensor's values
+#define BENCH_INSTANCE  1
+
+static float bench_value;
+
+typedef struct {
+    unsigned packets;
+    unsigned bytes;
+    uint64_t send_ns;           // from the first change to the last packet
+    unsigned wait_s;            // longest wait of a change, server seconds
+} bench_result_t;
+
+static void bench_subscribe_single(void)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < BENCH_CHANNELS; i++) {
+        HOST_CHECK(host_bacnet_subscribe_property(1, 10,
+                                                  OBJECT_ANALOG_VALUE,
+                                                  BENCH_INSTANCE + i,
+                                                  PROP_PRESENT_VALUE, false,
+                                                  0, false));
+    }
+}
+
+static void bench_subscribe_multiple(uint32_t delay)
+{
+    BACNET_SUBSCRIBE_COV_DATA references[BENCH_CHANNELS];
+    unsigned i = 0;
+
+    memset(references, 0, sizeof(references));
+    for (i = 0; i < BENCH_CHANNELS; i++) {
+        references[i].subscriberProcessIdentifier = 10;
+        references[i].monitoredObjectIdentifier.type = OBJECT_ANALOG_VALUE;
+        references[i].monitoredObjectIdentifier.instance = BENCH_INSTANCE + i;
+        references[i].monitoredProperty.propertyIdentifier =
+            PROP_PRESENT_VALUE;
+        references[i].monitoredProperty.propertyArrayIndex = BACNET_ARRAY_ALL;
+        references[i].next = (i + 1 < BENCH_CHANNELS) ? &references[i + 1] :
+                             NULL;
+    }
+    HOST_CHECK(host_bacnet_subscribe_multiple(1, delay, &references[0]));
+}
+
+// One frame a second, as the server task sees it: the sensor changes
+// the values, the COV task sends, and a second passes
+static void bench_run(bench_result_t *result)
+{
+    unsigned frame = 0;
+    unsigned i = 0;
+    unsigned sent = 0;
+    unsigned waiting = 0;   // frames whose changes are not sent yet
+    uint64_t t0 = 0;
+    uint64_t send_ns = 0;
+
+    memset(result, 0, sizeof(*result));
+    // the first notifications of the subscription
+    handler_cov_timer_seconds(60);
+    handler_cov_task();
+    for (frame = 0; frame < BENCH_FRAMES; frame++) {
+        sent = host_datalink_sent();
+        bench_value += 1.0f;
+        t0 = host_now_ns();
+        for (i = 0; i < BENCH_CHANNELS; i++) {
+            Analog_Value_Present_Value_Set(BENCH_INSTANCE + i, bench_value,
+                                           16);
+        }
+        handler_cov_task();
+        waiting++;
+        if (host_datalink_sent() > sent) {
+            send_ns = host_datalink_pdu(host_datalink_sent() - 1)->time_ns -
+                      t0;
+            if (send_ns > result->send_ns) {
+                result->send_ns = send_ns;
+            }
+            if (waiting - 1 > result->wait_s) {
+                result->wait_s = waiting - 1;
+            }
+            waiting = 0;
+        }
+        for (i = sent; i < host_datalink_sent(); i++) {
+            result->packets++;
+            result->bytes += host_datalink_pdu(i)->pdu_len;
+        }
+        handler_cov_timer_seconds(1);
+    }
+}
+
+static void bench_report(const char *name, const bench_result_t *result,
+                         unsigned expected)
+{
+    printf("%-32s %5.2f packets %6.1f bytes per frame, "
+           "sent within %6.2f us, waits up to %u s\n", name,
+           (double)result->packets / BENCH_FRAMES,
+           (double)result->bytes / BENCH_FRAMES, result->send_ns / 1000.0,
+           result->wait_s);
+    HOST_CHECK_EQ(result->packets, expected);
+}
+
+int main(void)
+{
+    static const uint32_t delays[] = { 0, 1, 3 };
+    bench_result_t result;
+    char name[40];
+    unsigned i = 0;
+
+    printf("%u Present_Values changing together, one frame a second, "
+           "unconfirmed\n(bytes of NPDU and APDU; B/IP adds 32 a packet: "
+           "IP, UDP and BVLC headers)\n", BENCH_CHANNELS);
+    host_bacnet_init();
+    bench_subscribe_single();
+    bench_run(&result);
+    bench_report("SubscribeCOVProperty x12", &result,
+                 BENCH_FRAMES * BENCH_CHANNELS);
+    for (i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        host_bacnet_init();
+        bench_subscribe_multiple(delays[i]);
+        bench_run(&result);
+        snprintf(name, sizeof(name), "Multiple, delay %u s",
+                 (unsigned)delays[i]);
+        // a change starts the delay; the next frame after it runs out
+        // goes together with it
+        bench_report(name, &result,
+                     (BENCH_FRAMES + delays[i]) / (delays[i] + 1));
+    }
+
+    return host_check_result("bench_cov_multiple");
+}
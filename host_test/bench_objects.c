@@ -0,0 +1,214 @@
+/*
+ * Object storage at 500 objects of each type
+ *
+ * The stack built with 500 Analog Inputs, Analog Values and Binary
+ * Inputs, Outputs and Values (bacnet_500 in CMakeLists.txt).  Time per
+ * object of what the server does to every object over and over: a new
+ * value from its source, the COV scan that looks for changes and
+ * encodes them, reading Present_Value, and a ReadProperty of it.  A
+ * tenth of the objects change between scans.  The static RAM of the
+ * same build is given by the bench_objects_ram test.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "ai.h"
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+#include "rp.h"
+
+#define BENCH_OBJECTS   500
+#define BENCH_ROUNDS    1000
+
+typedef struct {
+    const char *name;
+    BACNET_OBJECT_TYPE type;
+    void (*update)(uint32_t instance, unsigned round);
+    float (*present_value)(uint32_t instance);
+    bool (*changed)(uint32_t instance);
+    void (*changed_clear)(uint32_t instance);
+    bool (*encode)(uint32_t instance, BACNET_PROPERTY_VALUE *value_list);
+    int (*read_property)(BACNET_READ_PROPERTY_DATA *rpdata);
+} bench_type_t;
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static float bench_value(uint32_t instance, unsigned round)
+{
+    return (float)((round * 7 + instance) % 50);
+}
+
+// each object is updated every tenth round, and changes every time
+static BACNET_BINARY_PV bench_binary(uint32_t instance, unsigned round)
+{
+    return (((round + instance) / 10) & 1) ? BINARY_ACTIVE : BINARY_INACTIVE;
+}
+
+static void bench_ai_update(uint32_t instance, unsigned round)
+{
+    Analog_Input_Present_Value_Set(instance, bench_value(instance, round));
+}
+
+static void bench_av_update(uint32_t instance, unsigned round)
+{
+    float value = bench_value(instance, round);
+
+    Analog_Value_Source_Update(instance, value, value);
+}
+
+static void bench_bi_update(uint32_t instance, unsigned round)
+{
+    Binary_Input_Source_Update(instance,
+                               bench_binary(instance, round) == BINARY_ACTIVE);
+}
+
+static void bench_bo_update(uint32_t instance, unsigned round)
+{
+    Binary_Output_Present_Value_Set(instance, bench_binary(instance, round),
+                                    16);
+}
+
+static void bench_bv_update(uint32_t instance, unsigned round)
+{
+    Binary_Value_Present_Value_Set(instance, bench_binary(instance, round));
+}
+
+static float bench_bi_value(uint32_t instance)
+{
+    return (float)Binary_Input_Present_Value(instance);
+}
+
+static float bench_bo_value(uint32_t instance)
+{
+    return (float)Binary_Output_Present_Value(instance);
+}
+
+static float bench_bv_value(uint32_t instance)
+{
+    return (float)Binary_Value_Present_Value(instance);
+}
+
+static const bench_type_t bench_types[] = {
+    { "Analog Input", OBJECT_ANALOG_INPUT, bench_ai_update,
+      Analog_Input_Present_Value, Analog_Input_Change_Of_Value,
+      Analog_Input_Change_Of_Value_Clear, Analog_Input_Encode_Value_List,
+      Analog_Input_Read_Property },
+    { "Analog Value", OBJECT_ANALOG_VALUE, bench_av_update,
+      Analog_Value_Present_Value, Analog_Value_Change_Of_Value,
+      Analog_Value_Change_Of_Value_Clear, Analog_Value_Encode_Value_List,
+      Analog_Value_Read_Property },
+    { "Binary Input", OBJECT_BINARY_INPUT, bench_bi_update, bench_bi_value,
+      Binary_Input_Change_Of_Value, Binary_Input_Change_Of_Value_Clear,
+      Binary_Input_Encode_Value_List, Binary_Input_Read_Property },
+    { "Binary Output", OBJECT_BINARY_OUTPUT, bench_bo_update, bench_bo_value,
+      Binary_Output_Change_Of_Value, Binary_Output_Change_Of_Value_Clear,
+      Binary_Output_Encode_Value_List, Binary_Output_Read_Property },
+    { "Binary Value", OBJECT_BINARY_VALUE, bench_bv_update, bench_bv_value,
+      Binary_Value_Change_Of_Value, Binary_Value_Change_Of_Value_Clear,
+      Binary_Value_Encode_Value_List, Binary_Value_Read_Property },
+};
+
+static void bench_run(const bench_type_t *type)
+{
+    BACNET_PROPERTY_VALUE value_list[2];
+    BACNET_READ_PROPERTY_DATA rpdata;
+    uint8_t apdu[MAX_APDU];
+    uint64_t update_ns = 0;
+    uint64_t scan_ns = 0;
+    uint64_t value_ns = 0;
+    uint64_t read_ns = 0;
+    uint64_t start = 0;
+    volatile float sink = 0.0f;
+    unsigned changes = 0;
+    unsigned errors = 0;
+    unsigned round = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < BENCH_OBJECTS; i++) {
+        type->changed_clear(i);
+    }
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        start = bench_now_ns();
+        for (i = round % 10; i < BENCH_OBJECTS; i += 10) {
+            type->update(i, round);
+        }
+        update_ns += bench_now_ns() - start;
+
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_OBJECTS; i++) {
+            if (type->changed(i)) {
+                value_list[0].next = &value_list[1];
+                value_list[1].next = NULL;
+                type->encode(i, &value_list[0]);
+                type->changed_clear(i);
+                changes++;
+            }
+        }
+        scan_ns += bench_now_ns() - start;
+
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_OBJECTS; i++) {
+            sink += type->present_value(i);
+        }
+        value_ns += bench_now_ns() - start;
+
+        start = bench_now_ns();
+        for (i = 0; i < BENCH_OBJECTS; i++) {
+            memset(&rpdata, 0, sizeof(rpdata));
+            rpdata.object_type = type->type;
+            rpdata.object_instance = i;
+            rpdata.object_property = PROP_PRESENT_VALUE;
+            rpdata.array_index = BACNET_ARRAY_ALL;
+            rpdata.application_data = apdu;
+            rpdata.application_data_len = sizeof(apdu);
+            errors += type->read_property(&rpdata) <= 0;
+        }
+        read_ns += bench_now_ns() - start;
+    }
+    (void)sink;
+    HOST_CHECK_EQ(errors, 0);
+    HOST_CHECK(changes > 0);
+    printf("%-14s update %5.1f  COV scan %5.1f  Present_Value %5.1f  "
+           "ReadProperty %5.1f ns per object\n", type->name,
+           (double)update_ns * 10 / ((double)BENCH_ROUNDS * BENCH_OBJECTS),
+           (double)scan_ns / ((double)BENCH_ROUNDS * BENCH_OBJECTS),
+           (double)value_ns / ((double)BENCH_ROUNDS * BENCH_OBJECTS),
+           (double)read_ns / ((double)BENCH_ROUNDS * BENCH_OBJECTS));
+}
+
+int main(void)
+{
+    unsigned n = 0;
+    uint32_t i = 0;
+
+    host_bacnet_init();
+    // not in the object table of main.c
+    Analog_Input_Init();
+    for (i = 0; i < BENCH_OBJECTS; i++) {
+        HOST_CHECK(Analog_Input_Valid_Instance(i));
+        HOST_CHECK(Analog_Value_Valid_Instance(i));
+        HOST_CHECK(Binary_Input_Valid_Instance(i));
+        HOST_CHECK(Binary_Output_Valid_Instance(i));
+        HOST_CHECK(Binary_Value_Valid_Instance(i));
+        // as point_binding.c binds the sensor channels
+        Analog_Value_Bind(i, true);
+    }
+    printf("%u objects of each type, a tenth of them updated per scan\n",
+           BENCH_OBJECTS);
+    for (n = 0; n < sizeof(bench_types) / sizeof(bench_types[0]); n++) {
+        bench_run(&bench_types[n]);
+    }
+
+    return host_check_result("bench_objects");
+}
@@ -0,0 +1,79 @@
+/*
+ * PM channel filters: cost per sample
+ *
+ * Each stage alone and the three together, at the default and at the
+ * largest windows, on a stream of PM2.5 readings with spikes.  The
+ * median is the stage that depends on its window.
+ */
+#include <stdio.h>
+#include <time.h>
+#include "host_check.h"
+#include "pm_filter.h"
+
+#define BENCH_SAMPLES   4096
+#define BENCH_ROUNDS    500
+
+static float bench_samples[BENCH_SAMPLES];
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_stream(void)
+{
+    uint32_t rng = 1;
+    unsigned i = 0;
+
+    for (i = 0; i < BENCH_SAMPLES; i++) {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        bench_samples[i] = (rng % 50 == 0) ? 800.0f : (float)(10 + rng % 8);
+    }
+}
+
+static void bench_run(const char *name, uint8_t median_window,
+                      float ema_alpha, uint8_t mean_window)
+{
+    pm_filter_config_t config = { median_window, mean_window, ema_alpha };
+    pm_filter_t filter;
+    volatile float sink = 0.0f;
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    unsigned round = 0;
+    unsigned i = 0;
+
+    HOST_CHECK(pm_filter_config_valid(&config));
+    pm_filter_init(&filter, &config);
+    start = bench_now_ns();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (i = 0; i < BENCH_SAMPLES; i++) {
+            sink = pm_filter_update(&filter, bench_samples[i]);
+        }
+    }
+    elapsed = bench_now_ns() - start;
+    (void)sink;
+    printf("%-30s %6.1f ns per sample\n", name,
+           (double)elapsed / ((double)BENCH_ROUNDS * BENCH_SAMPLES));
+}
+
+int main(void)
+{
+    bench_stream();
+    printf("PM filter, %u samples\n", BENCH_ROUNDS * BENCH_SAMPLES);
+    bench_run("all off", 1, 1.0f, 1);
+    bench_run("median of 5", 5, 1.0f, 1);
+    bench_run("median of 9", PM_FILTER_MEDIAN_MAX, 1.0f, 1);
+    bench_run("EMA", 1, 0.3f, 1);
+    bench_run("mean of 16", 1, 1.0f, PM_FILTER_MEAN_MAX);
+    bench_run("defaults: median 5, EMA", 5, 0.3f, 1);
+    bench_run("all at the largest windows", PM_FILTER_MEDIAN_MAX, 0.3f,
+              PM_FILTER_MEAN_MAX);
+
+    return host_check_result("bench_pm_filter");
+}
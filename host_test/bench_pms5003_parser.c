@@ -0,0 +1,122 @@
+/*
+ * PMS5003 parser: throughput and recovery
+ *
+ * A simulated stream at three fault rates, each of a dropped byte, a
+ * duplicated byte and a bad checksum per frame: bytes parsed per second,
+ * frames recovered out of those sent intact, and frames accepted that
+ * are not readings the simulator sent.  Those false accepts are what the
+ * checksum lets through: it is a plain sum, and a frame that lost one
+ * byte and had another of the same value repeated still adds up.  None
+ * may come from a clean stream.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "host_check.h"
+#include "pms5003_sim.h"
+
+#define BENCH_FRAMES    4096
+#define BENCH_ROUNDS    200
+
+static uint8_t bench_stream[BENCH_FRAMES * PMS5003_SIM_MAX_BYTES];
+static pms5003_frame_t bench_sent[BENCH_FRAMES];
+
+// Faults the simulator has put in so far
+static uint32_t bench_faults(const pms5003_sim_t *sim)
+{
+    return sim->dropped + sim->duplicated + sim->corrupted;
+}
+
+static uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void bench_run(uint16_t fault_permille)
+{
+    pms5003_sim_config_t config = {
+        .pm2_5 = 35,
+        .noise = 20,
+        .drop_permille = fault_permille,
+        .dup_permille = fault_permille,
+        .corrupt_permille = fault_permille,
+    };
+    pms5003_sim_t sim;
+    pms5003_parser_t parser;
+    pms5003_frame_t frame;
+    size_t length = 0;
+    size_t split = 0;
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    unsigned intact = 0;
+    uint32_t faults = 0;
+    unsigned recovered = 0;
+    unsigned false_accepts = 0;
+    unsigned next = 0;
+    unsigned sent = 0;
+    unsigned round = 0;
+    size_t i = 0;
+
+    pms5003_sim_init(&sim, &config, 1);
+    for (sent = 0; sent < BENCH_FRAMES; sent++) {
+        faults = bench_faults(&sim);
+        length += pms5003_sim_next(&sim, &bench_stream[length], &split,
+                                   &bench_sent[sent]);
+        intact += bench_faults(&sim) == faults;
+    }
+
+    // what was recovered, once: each frame accepted must be the next
+    // reading sent, or a later one
+    pms5003_parser_init(&parser);
+    for (i = 0; i < length; i++) {
+        if (!pms5003_parser_feed(&parser, bench_stream[i], &frame)) {
+            continue;
+        }
+        for (sent = next; sent < BENCH_FRAMES; sent++) {
+            if (memcmp(&frame, &bench_sent[sent], sizeof(frame)) == 0) {
+                break;
+            }
+        }
+        if (sent < BENCH_FRAMES) {
+            recovered++;
+            next = sent + 1;
+        } else {
+            false_accepts++;
+        }
+    }
+    if (fault_permille == 0) {
+        HOST_CHECK_EQ(false_accepts, 0);
+        HOST_CHECK_EQ(recovered, BENCH_FRAMES);
+    }
+    // a faulty frame costs at most the one after it as well
+    HOST_CHECK(recovered + 2 * (BENCH_FRAMES - intact) >= BENCH_FRAMES);
+    HOST_CHECK(false_accepts * 100 <= BENCH_FRAMES - intact);
+
+    start = bench_now_ns();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        pms5003_parser_init(&parser);
+        for (i = 0; i < length; i++) {
+            pms5003_parser_feed(&parser, bench_stream[i], &frame);
+        }
+    }
+    elapsed = bench_now_ns() - start;
+    HOST_CHECK_EQ(parser.frames, recovered + false_accepts);
+    printf("faults %4.1f%% each  %7.1f MB/s  %4u of %4u intact frames "
+           "recovered, %u false accepts\n", fault_permille / 10.0,
+           (double)length * BENCH_ROUNDS * 1000.0 / (double)elapsed,
+           recovered, intact, false_accepts);
+}
+
+int main(void)
+{
+    printf("PMS5003 parser, %u frames\n", BENCH_FRAMES);
+    bench_run(0);
+    bench_run(20);
+    bench_run(100);
+
+    return host_check_result("bench_pms5003_parser");
+}
@@ -0,0 +1,125 @@
+/*
+ * Runs a libFuzzer target without libFuzzer, for compilers that lack it
+ *
+ * With files as arguments, each one is an input.  Without, the inputs
+ * are PMS5003 streams from pms5003_sim.c, with every kind of fault, cut
+ * and spliced at random and sprinkled with random bytes: no coverage
+ * guidance, but the same checks on a repeatable set of inputs.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "pms5003_sim.h"
+
+#define FUZZ_INPUTS     20000
+#define FUZZ_INPUT_MAX  1024
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+static int fuzz_file(const char *path)
+{
+    static uint8_t data[1 << 20];
+    FILE *file = fopen(path, "rb");
+    size_t size = 0;
+
+    if (file == NULL) {
+        perror(path);
+        return 1;
+    }
+    size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    LLVMFuzzerTestOneInput(data, size);
+
+    return 0;
+}
+
+static uint32_t fuzz_rng = 1;
+
+static uint32_t fuzz_random(void)
+{
+    fuzz_rng ^= fuzz_rng << 13;
+    fuzz_rng ^= fuzz_rng >> 17;
+    fuzz_rng ^= fuzz_rng << 5;
+
+    return fuzz_rng;
+}
+
+static size_t fuzz_generate(pms5003_sim_t *sim, uint8_t *data)
+{
+    uint8_t buf[PMS5003_SIM_MAX_BYTES];
+    size_t length = 0;
+    size_t count = 0;
+    size_t split = 0;
+    size_t i = 0;
+
+    while (length + PMS5003_SIM_MAX_BYTES + 8 < FUZZ_INPUT_MAX) {
+        switch (fuzz_random() % 8) {
+        case 0:
+            // noise, with the start bytes more likely than chance
+            count = fuzz_random() % 8;
+            for (i = 0; i < count; i++) {
+                data[length++] = (fuzz_random() % 3) ?
+                                 (uint8_t)fuzz_random() :
+                                 ((fuzz_random() & 1) ? PMS5003_START1 :
+                                  PMS5003_START2);
+            }
+            break;
+        case 1:
+            // part of a frame
+            count = pms5003_sim_next(sim, buf, &split, NULL);
+            count = fuzz_random() % count;
+            for (i = 0; i < count; i++) {
+                data[length++] = buf[i];
+            }
+            break;
+        case 2:
+            if ((fuzz_random() % 16) == 0) {
+                return length;
+            }
+            break;
+        default:
+            count = pms5003_sim_next(sim, buf, &split, NULL);
+            for (i = 0; i < count; i++) {
+                data[length++] = buf[i];
+            }
+            break;
+        }
+    }
+
+    return length;
+}
+
+int main(int argc, char **argv)
+{
+    const pms5003_sim_config_t config = {
+        .pm2_5 = 35,
+        .noise = 30,
+        .drop_permille = 100,
+        .dup_permille = 100,
+        .corrupt_permille = 100,
+        .stall_permille = 0,
+    };
+    static uint8_t data[FUZZ_INPUT_MAX];
+    pms5003_sim_t sim;
+    size_t bytes = 0;
+    size_t size = 0;
+    int i = 0;
+
+    if (argc > 1) {
+        for (i = 1; i < argc; i++) {
+            if (fuzz_file(argv[i]) != 0) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    pms5003_sim_init(&sim, &config, 1);
+    for (i = 0; i < FUZZ_INPUTS; i++) {
+        size = fuzz_generate(&sim, data);
+        LLVMFuzzerTestOneInput(data, size);
+        bytes += size;
+    }
+    printf("fuzz_pms5003_parser: %d inputs, %zu bytes, passed\n",
+           FUZZ_INPUTS, bytes);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * libFuzzer target for the PMS5003 parser
+ *
+ * The input is a received byte stream.  Whatever it holds, every byte
+ * fed must end up in a frame, in the discarded count, or still in the
+ * parser; and every frame reported must be the last 32 bytes fed, with
+ * a good length and checksum, decoded word for word.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pms5003_parser.h"
+
+// A failed check crashes, which is what the fuzzer looks for
+#define fuzz_assert(cond)                                                 \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,        \
+                    __LINE__, #cond);                                     \
+            abort();                                                      \
+        }                                                                 \
+    } while (0)
+
+static uint16_t fuzz_word(const uint8_t *data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+// The frame in the last PMS5003_FRAME_SIZE bytes of ring, which ends at
+// pos, must be valid and decode to frame
+static void fuzz_check_frame(const uint8_t *ring, size_t pos,
+                             const pms5003_frame_t *frame)
+{
+    uint8_t raw[PMS5003_FRAME_SIZE];
+    uint16_t sum = 0;
+    size_t i = 0;
+
+    for (i = 0; i < PMS5003_FRAME_SIZE; i++) {
+        raw[i] = ring[(pos + i) % PMS5003_FRAME_SIZE];
+    }
+    fuzz_assert(raw[0] == PMS5003_START1);
+    fuzz_assert(raw[1] == PMS5003_START2);
+    fuzz_assert(fuzz_word(&raw[2]) == PMS5003_FRAME_LEN);
+    for (i = 0; i < PMS5003_FRAME_SIZE - 2; i++) {
+        sum += raw[i];
+    }
+    fuzz_assert(fuzz_word(&raw[PMS5003_FRAME_SIZE - 2]) == sum);
+    fuzz_assert(frame->pm1_0_standard == fuzz_word(&raw[4]));
+    fuzz_assert(frame->pm2_5_standard == fuzz_word(&raw[6]));
+    fuzz_assert(frame->pm10_standard == fuzz_word(&raw[8]));
+    fuzz_assert(frame->pm1_0_env == fuzz_word(&raw[10]));
+    fuzz_assert(frame->pm2_5_env == fuzz_word(&raw[12]));
+    fuzz_assert(frame->pm10_env == fuzz_word(&raw[14]));
+    fuzz_assert(frame->particles_03um == fuzz_word(&raw[16]));
+    fuzz_assert(frame->particles_05um == fuzz_word(&raw[18]));
+    fuzz_assert(frame->particles_10um == fuzz_word(&raw[20]));
+    fuzz_assert(frame->particles_25um == fuzz_word(&raw[22]));
+    fuzz_assert(frame->particles_50um == fuzz_word(&raw[24]));
+    fuzz_assert(frame->particles_100um == fuzz_word(&raw[26]));
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    pms5003_parser_t parser;
+    pms5003_frame_t frame;
+    uint8_t ring[PMS5003_FRAME_SIZE] = { 0 };
+    uint32_t errors = 0;
+    uint32_t frames = 0;
+    size_t fed = 0;
+    size_t i = 0;
+    uint8_t byte = 0;
+
+    pms5003_parser_init(&parser);
+    // the input, then zeros: they start no frame, and flush whatever
+    // the parser still holds
+    for (i = 0; i < size + 2 * PMS5003_FRAME_SIZE; i++) {
+        byte = (i < size) ? data[i] : 0;
+        ring[fed % PMS5003_FRAME_SIZE] = byte;
+        fed++;
+        if (pms5003_parser_feed(&parser, byte, &frame)) {
+            fuzz_check_frame(ring, fed, &frame);
+            fuzz_assert(parser.in_sync);
+        }
+        // the counters only go up, one event at a time
+        fuzz_assert(parser.frames - frames <= 1);
+        fuzz_assert((parser.checksum_errors + parser.length_errors) -
+                    errors <= 1);
+        frames = parser.frames;
+        errors = parser.checksum_errors + parser.length_errors;
+        fuzz_assert(parser.pos <= sizeof(parser.buf));
+    }
+    fuzz_assert(fed == parser.discarded +
+                (size_t)parser.frames * PMS5003_FRAME_SIZE);
+    fuzz_assert(parser.resyncs <= parser.discarded);
+
+    return 0;
+}
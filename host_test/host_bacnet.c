@@ -0,0 +1,443 @@
+/*
+ * The BACnet server of main.c on a PC
+ *
+ * Same object table and service handlers as main.c.  The datalink is a
+ * recorder: PDUs are kept with the time they were sent, so tests can
+ * count them and benchmarks can time them.
+ */
+#include <string.h>
+#include <time.h>
+#include "host_bacnet.h"
+#include "nvstore_host.h"
+#include "apdu.h"
+#include "cov.h"
+#include "device.h"
+#include "handlers.h"
+#include "npdu.h"
+#include "tsm.h"
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+#include "lo.h"
+
+static host_pdu_t host_pdus[HOST_DATALINK_PDUS];
+static unsigned host_pdus_sent;
+static unsigned host_notifications;
+
+static object_functions_t Object_Table[] = {
+    {
+        OBJECT_DEVICE,
+        NULL, /* don't init - recursive! */
+        Device_Count,
+        Device_Index_To_Instance,
+        Device_Valid_Object_Instance_Number,
+        Device_Object_Name,
+        Device_Read_Property_Local,
+        Device_Write_Property_Local,
+        Device_Property_Lists,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+    },
+    {
+        OBJECT_ANALOG_VALUE,
+        Analog_Value_Init,
+        Analog_Value_Count,
+        Analog_Value_Index_To_Instance,
+        Analog_Value_Valid_Instance,
+        Analog_Value_Object_Name,
+        Analog_Value_Read_Property,
+        Analog_Value_Write_Property,
+        Analog_Value_Property_Lists,
+        NULL, NULL,
+        Analog_Value_Encode_Value_List,
+        Analog_Value_Change_Of_Value,
+        Analog_Value_Change_Of_Value_Clear,
+        NULL,
+        Analog_Value_Create,
+        Analog_Value_Delete,
+        Analog_Value_Instance_Property_Lists
+    },
+    {
+        OBJECT_BINARY_INPUT,
+        Binary_Input_Init,
+        Binary_Input_Count,
+        Binary_Input_Index_To_Instance,
+        Binary_Input_Valid_Instance,
+        Binary_Input_Object_Name,
+        Binary_Input_Read_Property,
+        Binary_Input_Write_Property,
+        Binary_Input_Property_Lists,
+        NULL, NULL,
+        Binary_Input_Encode_Value_List,
+        Binary_Input_Change_Of_Value,
+        Binary_Input_Change_Of_Value_Clear,
+        NULL,
+        Binary_Input_Create,
+        Binary_Input_Delete,
+        NULL
+    },
+    {
+        OBJECT_BINARY_OUTPUT,
+        Binary_Output_Init,
+        Binary_Output_Count,
+        Binary_Output_Index_To_Instance,
+        Binary_Output_Valid_Instance,
+        Binary_Output_Object_Name,
+        Binary_Output_Read_Property,
+        Binary_Output_Write_Property,
+        Binary_Output_Property_Lists,
+        NULL, NULL,
+        Binary_Output_Encode_Value_List,
+        Binary_Output_Change_Of_Value,
+        Binary_Output_Change_Of_Value_Clear,
+        NULL,
+        Binary_Output_Create,
+        Binary_Output_Delete,
+        NULL
+    },
+    {
+        OBJECT_BINARY_VALUE,
+        Binary_Value_Init,
+        Binary_Value_Count,
+        Binary_Value_Index_To_Instance,
+        Binary_Value_Valid_Instance,
+        Binary_Value_Object_Name,
+        Binary_Value_Read_Property,
+        Binary_Value_Write_Property,
+        Binary_Value_Property_Lists,
+        NULL, NULL,
+        Binary_Value_Encode_Value_List,
+        Binary_Value_Change_Of_Value,
+        Binary_Value_Change_Of_Value_Clear,
+        NULL,
+        Binary_Value_Create,
+        Binary_Value_Delete,
+        NULL
+    },
+    {
+        OBJECT_LOOP,
+        Loop_Init,
+        Loop_Count,
+        Loop_Index_To_Instance,
+        Loop_Valid_Instance,
+        Loop_Object_Name,
+        Loop_Read_Property,
+        Loop_Write_Property,
+        Loop_Property_Lists,
+        NULL, NULL,
+        Loop_Encode_Value_List,
+        Loop_Change_Of_Value,
+        Loop_Change_Of_Value_Clear,
+        NULL, NULL, NULL, NULL
+    },
+    {
+        MAX_BACNET_OBJECT_TYPE,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+        NULL, NULL, NULL, NULL, NULL, NULL
+    },
+};
+
+void host_bacnet_init(void)
+{
+    nvstore_host_erase_all();
+    host_bacnet_reset();
+}
+
+void host_bacnet_reset(void)
+{
+    Device_Init(&Object_Table[0]);
+    apdu_set_unrecognized_service_handler_handler(
+        handler_unrecognized_service);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROPERTY,
+                               handler_read_property);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_PROP_MULTIPLE,
+                               handler_read_property_multiple);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_WRITE_PROPERTY,
+                               handler_write_property);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_CREATE_OBJECT,
+                               handler_create_object);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_DELETE_OBJECT,
+                               handler_delete_object);
+    handler_cov_init();
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV,
+                               handler_cov_subscribe);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY,
+                               handler_cov_subscribe_property);
+    apdu_set_confirmed_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE,
+        handler_cov_subscribe_property_multiple);
+    host_datalink_clear();
+}
+
+uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void host_bacnet_address(unsigned n, BACNET_ADDRESS *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    // 192.168.1.n:47808, as B/IP would have it
+    addr->mac_len = 6;
+    addr->mac[0] = 192;
+    addr->mac[1] = 168;
+    addr->mac[2] = 1;
+    addr->mac[3] = (uint8_t)(n + 2);
+    addr->mac[4] = 0xBA;
+    addr->mac[5] = 0xC0;
+}
+
+void host_bacnet_receive(unsigned n, uint8_t *apdu, unsigned apdu_len)
+{
+    uint8_t pdu[MAX_MPDU];
+    BACNET_ADDRESS src;
+    BACNET_NPDU_DATA npdu_data;
+    int len = 0;
+
+    host_bacnet_address(n, &src);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    len = npdu_encode_pdu(pdu, NULL, NULL, &npdu_data);
+    memcpy(&pdu[len], apdu, apdu_len);
+    npdu_handler(&src, pdu, (uint16_t)(len + apdu_len));
+}
+
+// Hands a request to the stack and tells whether it was acknowledged
+static bool host_bacnet_request(unsigned n, uint8_t *apdu, int len)
+{
+    unsigned sent = host_datalink_sent();
+    const host_pdu_t *reply = NULL;
+
+    host_bacnet_receive(n, apdu, (unsigned)len);
+    // the reply is the first PDU sent; the notifications come later
+    reply = host_datalink_pdu(sent);
+
+    return reply && (host_pdu_type(reply) == PDU_TYPE_SIMPLE_ACK);
+}
+
+bool host_bacnet_subscribe(unsigned n, uint32_t pid, BACNET_OBJECT_TYPE type,
+                           uint32_t instance, bool confirmed,
+                           uint32_t lifetime, bool cancel)
+{
+    uint8_t apdu[MAX_APDU];
+    BACNET_SUBSCRIBE_COV_DATA data;
+
+    memset(&data, 0, sizeof(data));
+    data.subscriberProcessIdentifier = pid;
+    data.monitoredObjectIdentifier.type = type;
+    data.monitoredObjectIdentifier.instance = instance;
+    data.cancellationRequest = cancel;
+    data.issueConfirmedNotifications = confirmed;
+    data.lifetime = lifetime;
+
+    return host_bacnet_request(n, apdu,
+                               cov_subscribe_encode_apdu(apdu, 1, &data));
+}
+
+bool host_bacnet_subscribe_property(unsigned n, uint32_t pid,
+                                    BACNET_OBJECT_TYPE type,
+                                    uint32_t instance,
+                                    BACNET_PROPERTY_ID property,
+                                    bool confirmed, uint32_t lifetime,
+                                    bool cancel)
+{
+    uint8_t apdu[MAX_APDU];
+    BACNET_SUBSCRIBE_COV_DATA data;
+
+    memset(&data, 0, sizeof(data));
+    data.subscriberProcessIdentifier = pid;
+    data.monitoredObjectIdentifier.type = type;
+    data.monitoredObjectIdentifier.instance = instance;
+    data.cancellationRequest = cancel;
+    data.issueConfirmedNotifications = confirmed;
+    data.lifetime = lifetime;
+    data.monitoredProperty.propertyIdentifier = property;
+    data.monitoredProperty.propertyArrayIndex = BACNET_ARRAY_ALL;
+
+    return host_bacnet_request(n, apdu,
+                               cov_subscribe_property_encode_apdu(apdu, 1,
+                                                                  &data));
+}
+
+bool host_bacnet_subscribe_multiple(unsigned n,
+                                    uint32_t max_notification_delay,
+                                    BACNET_SUBSCRIBE_COV_DATA *references)
+{
+    uint8_t apdu[MAX_APDU];
+
+    return host_bacnet_request(n, apdu,
+                               cov_subscribe_property_multiple_encode_apdu(
+                                   apdu, 1, max_notification_delay,
+                                   references));
+}
+
+unsigned host_datalink_sent(void)
+{
+    return host_pdus_sent;
+}
+
+const host_pdu_t *host_datalink_pdu(unsigned n)
+{
+    if ((n >= host_pdus_sent) || (host_pdus_sent - n > HOST_DATALINK_PDUS)) {
+        return NULL;
+    }
+
+    return &host_pdus[n % HOST_DATALINK_PDUS];
+}
+
+void host_datalink_clear(void)
+{
+    host_pdus_sent = 0;
+    host_notifications = 0;
+}
+
+int host_pdu_apdu(const host_pdu_t *pdu, const uint8_t **apdu)
+{
+    BACNET_ADDRESS dest;
+    BACNET_ADDRESS src;
+    BACNET_NPDU_DATA npdu_data;
+    int offset = 0;
+
+    offset = npdu_decode((uint8_t *)pdu->pdu, &dest, &src, &npdu_data);
+    *apdu = &pdu->pdu[offset];
+
+    return pdu->pdu_len - offset;
+}
+
+uint8_t host_pdu_type(const host_pdu_t *pdu)
+{
+    const uint8_t *apdu = NULL;
+
+    host_pdu_apdu(pdu, &apdu);
+
+    return apdu[0] & 0xF0;
+}
+
+uint8_t host_pdu_service(const host_pdu_t *pdu)
+{
+    const uint8_t *apdu = NULL;
+
+    host_pdu_apdu(pdu, &apdu);
+    switch (apdu[0] & 0xF0) {
+    case PDU_TYPE_CONFIRMED_SERVICE_REQUEST:
+        return apdu[3];
+    case PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST:
+        return apdu[1];
+    default:
+        return apdu[2];
+    }
+}
+
+bool host_pdu_cov_object(const host_pdu_t *pdu, BACNET_OBJECT_ID *object,
+                         uint32_t *time_remaining)
+{
+    const uint8_t *apdu = NULL;
+    int apdu_len = host_pdu_apdu(pdu, &apdu);
+    int offset = 0;
+    BACNET_PROPERTY_VALUE values[4];
+    BACNET_COV_DATA data;
+    unsigned i = 0;
+
+    if ((apdu[0] & 0xF0) == PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
+        if (apdu[3] != SERVICE_CONFIRMED_COV_NOTIFICATION) {
+            return false;
+        }
+        offset = 4;
+    } else if ((apdu[0] & 0xF0) == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) {
+        if (apdu[1] != SERVICE_UNCONFIRMED_COV_NOTIFICATION) {
+            return false;
+        }
+        offset = 2;
+    } else {
+        return false;
+    }
+    for (i = 0; i < 4; i++) {
+        values[i].next = (i < 3) ? &values[i + 1] : NULL;
+    }
+    data.listOfValues = &values[0];
+    if (cov_notify_decode_service_request((uint8_t *)&apdu[offset],
+                                          (unsigned)(apdu_len - offset),
+                                          &data) <= 0) {
+        return false;
+    }
+    *object = data.monitoredObjectIdentifier;
+    if (time_remaining) {
+        *time_remaining = data.timeRemaining;
+    }
+
+    return true;
+}
+
+unsigned host_datalink_notifications(void)
+{
+    return host_notifications;
+}
+
+// The datalink of datalink.h: send records, receive never has anything
+
+int datalink_send_pdu(BACNET_ADDRESS *dest, BACNET_NPDU_DATA *npdu_data,
+                      uint8_t *pdu, unsigned pdu_len)
+{
+    host_pdu_t *sent = &host_pdus[host_pdus_sent % HOST_DATALINK_PDUS];
+    uint8_t type = 0;
+    uint8_t service = 0;
+
+    (void)npdu_data;
+    sent->time_ns = host_now_ns();
+    sent->dest = *dest;
+    sent->pdu_len = (uint16_t)pdu_len;
+    memcpy(sent->pdu, pdu, pdu_len);
+    host_pdus_sent++;
+    type = host_pdu_type(sent);
+    service = host_pdu_service(sent);
+    if (((type == PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) &&
+         ((service == SERVICE_UNCONFIRMED_COV_NOTIFICATION) ||
+          (service == SERVICE_UNCONFIRMED_COV_NOTIFICATION_MULTIPLE))) ||
+        ((type == PDU_TYPE_CONFIRMED_SERVICE_REQUEST) &&
+         ((service == SERVICE_CONFIRMED_COV_NOTIFICATION) ||
+          (service == SERVICE_CONFIRMED_COV_NOTIFICATION_MULTIPLE)))) {
+        host_notifications++;
+    }
+
+    return (int)pdu_len;
+}
+
+uint16_t datalink_receive(BACNET_ADDRESS *src, uint8_t *pdu,
+                          uint16_t max_pdu, unsigned timeout)
+{
+    (void)src;
+    (void)pdu;
+    (void)max_pdu;
+    (void)timeout;
+
+    return 0;
+}
+
+void datalink_cleanup(void)
+{
+}
+
+void datalink_get_broadcast_address(BACNET_ADDRESS *dest)
+{
+    memset(dest, 0, sizeof(*dest));
+    dest->mac_len = 6;
+    memset(dest->mac, 0xFF, 4);
+    dest->mac[4] = 0xBA;
+    dest->mac[5] = 0xC0;
+    dest->net = BACNET_BROADCAST_NETWORK;
+}
+
+void datalink_get_my_address(BACNET_ADDRESS *my_address)
+{
+    memset(my_address, 0, sizeof(*my_address));
+    my_address->mac_len = 6;
+    my_address->mac[0] = 192;
+    my_address->mac[1] = 168;
+    my_address->mac[2] = 1;
+    my_address->mac[3] = 1;
+    my_address->mac[4] = 0xBA;
+    my_address->mac[5] = 0xC0;
+}
@@ -0,0 +1,82 @@
+#ifndef HOST_BACNET_H
+#define HOST_BACNET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bacdef.h"
+#include "bacenum.h"
+#include "datalink.h"
+#include "cov.h"
+
+// The BACnet server of main.c on a PC: the same objects and service
+// handlers, with a datalink that keeps every PDU sent instead of putting
+// it on a wire.  Requests are handed to the stack as if they had come
+// from one of a set of made-up subscribers.
+
+// PDUs kept, oldest dropped first
+#define HOST_DATALINK_PDUS 1024
+
+typedef struct {
+    BACNET_ADDRESS dest;
+    uint64_t time_ns;           // host_now_ns() when it was sent
+    uint16_t pdu_len;
+    uint8_t pdu[MAX_MPDU];
+} host_pdu_t;
+
+// Object table and handlers as main.c sets them up, with nothing saved
+// in NVS: a device fresh from the factory
+void host_bacnet_init(void);
+
+// The same after a reset: what was saved in NVS is read back
+void host_bacnet_reset(void);
+
+uint64_t host_now_ns(void);
+
+// Address of made-up subscriber n, n < 250
+void host_bacnet_address(unsigned n, BACNET_ADDRESS *addr);
+
+// Hand an APDU from subscriber n to the stack, as npdu_handler() would
+void host_bacnet_receive(unsigned n, uint8_t *apdu, unsigned apdu_len);
+
+// SubscribeCOV from subscriber n; true if it was acknowledged.
+// lifetime 0 is an indefinite subscription.
+bool host_bacnet_subscribe(unsigned n, uint32_t pid, BACNET_OBJECT_TYPE type,
+                           uint32_t instance, bool confirmed,
+                           uint32_t lifetime, bool cancel);
+
+// SubscribeCOVProperty on one property from subscriber n
+bool host_bacnet_subscribe_property(unsigned n, uint32_t pid,
+                                    BACNET_OBJECT_TYPE type,
+                                    uint32_t instance,
+                                    BACNET_PROPERTY_ID property,
+                                    bool confirmed, uint32_t lifetime,
+                                    bool cancel);
+
+// SubscribeCOVPropertyMultiple from subscriber n: the references are
+// linked by next, and the first one gives the process, confirmation,
+// lifetime and cancellation
+bool host_bacnet_subscribe_multiple(unsigned n,
+                                    uint32_t max_notification_delay,
+                                    BACNET_SUBSCRIBE_COV_DATA *references);
+
+// Every PDU sent since the last clear
+unsigned host_datalink_sent(void);
+// The n-th PDU since the last clear, or NULL if it was not kept
+const host_pdu_t *host_datalink_pdu(unsigned n);
+void host_datalink_clear(void);
+
+// The APDU of a PDU: type and service choice, and its length
+int host_pdu_apdu(const host_pdu_t *pdu, const uint8_t **apdu);
+uint8_t host_pdu_type(const host_pdu_t *pdu);
+uint8_t host_pdu_service(const host_pdu_t *pdu);
+
+// The object a single-object COVNotification is about and the lifetime
+// left to the subscription (time_remaining may be NULL); false if the
+// PDU is not one
+bool host_pdu_cov_object(const host_pdu_t *pdu, BACNET_OBJECT_ID *object,
+                         uint32_t *time_remaining);
+
+// Sent PDUs that are COV notifications, confirmed or not
+unsigned host_datalink_notifications(void);
+
+#endif // HOST_BACNET_H
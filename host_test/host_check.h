@@ -0,0 +1,42 @@
+#ifndef HOST_CHECK_H
+#define HOST_CHECK_H
+
+#include <stdio.h>
+
+// Test checks for the host programs: a failed check is reported and
+// counted, and the test carries on; main() returns host_check_result().
+
+static unsigned host_check_failures;
+
+#define HOST_CHECK(cond)                                                  \
+    do {                                                                  \
+        if (!(cond)) {                                                    \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__,        \
+                    __LINE__, #cond);                                     \
+            host_check_failures++;                                        \
+        }                                                                 \
+    } while (0)
+
+#define HOST_CHECK_EQ(a, b)                                               \
+    do {                                                                  \
+        long long a_ = (long long)(a);                                    \
+        long long b_ = (long long)(b);                                    \
+        if (a_ != b_) {                                                   \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",\
+                    __FILE__, __LINE__, #a, #b, a_, b_);                  \
+            host_check_failures++;                                        \
+        }                                                                 \
+    } while (0)
+
+static inline int host_check_result(const char *name)
+{
+    if (host_check_failures) {
+        fprintf(stderr, "%s: %u checks failed\n", name, host_check_failures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+
+    return 0;
+}
+
+#endif // HOST_CHECK_H
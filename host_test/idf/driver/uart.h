@@ -0,0 +1,79 @@
+#ifndef DRIVER_UART_H
+#define DRIVER_UART_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+// The UART driver on the host: each port reads a file descriptor, a
+// pty or a pipe, given with host_uart_attach() (idf_host.h)
+
+typedef int uart_port_t;
+#define UART_NUM_MAX            3
+#define UART_PIN_NO_CHANGE      (-1)
+
+typedef enum {
+    UART_DATA_8_BITS = 3
+} uart_word_length_t;
+
+typedef enum {
+    UART_PARITY_DISABLE = 0
+} uart_parity_t;
+
+typedef enum {
+    UART_STOP_BITS_1 = 1
+} uart_stop_bits_t;
+
+typedef enum {
+    UART_HW_FLOWCTRL_DISABLE = 0
+} uart_hw_flowcontrol_t;
+
+typedef enum {
+    UART_SCLK_APB = 0
+} uart_sclk_t;
+
+typedef struct {
+    int baud_rate;
+    uart_word_length_t data_bits;
+    uart_parity_t parity;
+    uart_stop_bits_t stop_bits;
+    uart_hw_flowcontrol_t flow_ctrl;
+    uint8_t rx_flow_ctrl_thresh;
+    uart_sclk_t source_clk;
+} uart_config_t;
+
+typedef enum {
+    UART_DATA,
+    UART_BREAK,
+    UART_BUFFER_FULL,
+    UART_FIFO_OVF,
+    UART_FRAME_ERR,
+    UART_PARITY_ERR,
+    UART_DATA_BREAK,
+    UART_PATTERN_DET,
+    UART_EVENT_MAX
+} uart_event_type_t;
+
+typedef struct {
+    uart_event_type_t type;
+    size_t size;
+    bool timeout_flag;
+} uart_event_t;
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size,
+                              int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags);
+esp_err_t uart_driver_delete(uart_port_t uart_num);
+esp_err_t uart_param_config(uart_port_t uart_num,
+                            const uart_config_t *uart_config);
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num);
+esp_err_t uart_set_rx_timeout(uart_port_t uart_num, const uint8_t tout_thresh);
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length,
+                    TickType_t ticks_to_wait);
+esp_err_t uart_flush_input(uart_port_t uart_num);
+
+#endif // DRIVER_UART_H
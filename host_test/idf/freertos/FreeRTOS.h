@@ -0,0 +1,21 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+// The part of FreeRTOS the host build uses, on pthreads (idf_host.c)
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE         0
+#define pdTRUE          1
+#define pdPASS          pdTRUE
+#define pdFAIL          pdFALSE
+
+#define portMAX_DELAY   ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ 1000
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+
+#endif // FREERTOS_H
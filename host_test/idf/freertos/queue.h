@@ -0,0 +1,20 @@
+#ifndef FREERTOS_QUEUE_H
+#define FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+// Only the queues of the UART driver exist on the host: each holds the
+// events of one UART, made up from its file descriptor (idf_host.c)
+typedef struct host_queue *QueueHandle_t;
+typedef struct host_queue_set *QueueSetHandle_t;
+typedef QueueHandle_t QueueSetMemberHandle_t;
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length);
+BaseType_t xQueueAddToSet(QueueHandle_t queue, QueueSetHandle_t set);
+// A queue of the set with an event, or NULL after the timeout
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set,
+                                           TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#endif // FREERTOS_QUEUE_H
@@ -0,0 +1,21 @@
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *parameters);
+typedef void *TaskHandle_t;
+
+// A detached pthread; the stack size and priority are not used
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name,
+                       uint32_t stack_depth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *task);
+
+void vTaskDelay(TickType_t ticks);
+
+// Each thread is a task to notify, whoever created it
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#endif // FREERTOS_TASK_H
@@ -0,0 +1,14 @@
+#ifndef SDKCONFIG_H
+#define SDKCONFIG_H
+
+// menuconfig for the host build: two PM sensors, on UART 1 and 2, which
+// idf_host.c backs with file descriptors
+#define CONFIG_PM25_SENSOR_COUNT        2
+#define CONFIG_PM25_SENSOR1_UART        1
+#define CONFIG_PM25_SENSOR1_RX_PIN      25
+#define CONFIG_PM25_SENSOR1_TX_PIN      26
+#define CONFIG_PM25_SENSOR2_UART        2
+#define CONFIG_PM25_SENSOR2_RX_PIN      27
+#define CONFIG_PM25_SENSOR2_TX_PIN      33
+
+#endif // SDKCONFIG_H
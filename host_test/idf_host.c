@@ -0,0 +1,495 @@
+/*
+ * ESP-IDF and FreeRTOS on a PC, for the firmware in main/
+ *
+ * Just what pm25_sensor.c and display_widget.c call.  A UART is a file descriptor, read
+ * non-blocking; its event queue holds the events host_uart_event()
+ * posted, and has UART_DATA whenever the descriptor has bytes.  A queue
+ * set is a poll() over the descriptors of its queues, plus a pipe that
+ * wakes it for posted events.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "idf_host.h"
+
+#define HOST_QUEUE_EVENTS   16
+
+struct host_queue {
+    uart_port_t uart_num;
+    // posted events, oldest at head
+    uart_event_type_t events[HOST_QUEUE_EVENTS];
+    unsigned head;
+    unsigned count;
+};
+
+struct host_queue_set {
+    QueueHandle_t members[UART_NUM_MAX];
+    unsigned count;
+};
+
+typedef struct {
+    bool attached;
+    bool installed;
+    bool closed;                // the other side has gone
+    int fd;
+    struct host_queue queue;
+} host_uart_t;
+
+static host_uart_t host_uarts[UART_NUM_MAX];
+// posted events, across the test and the reader task
+static pthread_mutex_t host_lock = PTHREAD_MUTEX_INITIALIZER;
+// written to wake xQueueSelectFromSet() for a posted event
+static int host_wake[2] = { -1, -1 };
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+typedef struct {
+    TaskFunction_t function;
+    void *parameters;
+} host_task_t;
+
+static void *host_task_start(void *arg)
+{
+    host_task_t task = *(host_task_t *)arg;
+
+    free(arg);
+    task.function(task.parameters);
+
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name,
+                       uint32_t stack_depth, void *parameters,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+    host_task_t *task = malloc(sizeof(*task));
+    pthread_t thread;
+
+    (void)name;
+    (void)stack_depth;
+    (void)priority;
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->function = function;
+    task->parameters = parameters;
+    if (pthread_create(&thread, NULL, host_task_start, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    if (handle != NULL) {
+        *handle = NULL;
+    }
+
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * (1000000 / configTICK_RATE_HZ));
+}
+
+// The notification value of each thread, under host_notify_lock
+typedef struct {
+    uint32_t value;
+    pthread_cond_t given;
+} host_notify_t;
+
+static pthread_mutex_t host_notify_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread host_notify_t host_notify = {
+    0, PTHREAD_COND_INITIALIZER
+};
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &host_notify;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    host_notify_t *notify = task;
+
+    pthread_mutex_lock(&host_notify_lock);
+    notify->value++;
+    pthread_cond_signal(&notify->given);
+    pthread_mutex_unlock(&host_notify_lock);
+
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct timespec until;
+    uint32_t value = 0;
+    int waited = 0;
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += (time_t)(ticks / configTICK_RATE_HZ);
+    until.tv_nsec += (long)(ticks % configTICK_RATE_HZ) *
+                     (1000000000 / configTICK_RATE_HZ);
+    if (until.tv_nsec >= 1000000000) {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000;
+    }
+    pthread_mutex_lock(&host_notify_lock);
+    while ((host_notify.value == 0) && (waited == 0)) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&host_notify.given, &host_notify_lock);
+        } else {
+            waited = pthread_cond_timedwait(&host_notify.given,
+                                            &host_notify_lock, &until);
+        }
+    }
+    value = host_notify.value;
+    if (value > 0) {
+        host_notify.value = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&host_notify_lock);
+
+    return value;
+}
+
+static host_uart_t *host_uart(uart_port_t uart_num)
+{
+    if ((uart_num < 0) || (uart_num >= UART_NUM_MAX)) {
+        return NULL;
+    }
+
+    return &host_uarts[uart_num];
+}
+
+bool host_uart_attach(uart_port_t uart_num, int fd)
+{
+    host_uart_t *uart = host_uart(uart_num);
+    struct termios tio;
+    int flags = fcntl(fd, F_GETFL);
+
+    if ((uart == NULL) || (flags < 0) ||
+        (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        return false;
+    }
+    if (isatty(fd)) {
+        // bytes as they come, no line editing or translation
+        if (tcgetattr(fd, &tio) < 0) {
+            return false;
+        }
+        cfmakeraw(&tio);
+        if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+            return false;
+        }
+    }
+    uart->fd = fd;
+    uart->closed = false;
+    uart->attached = true;
+
+    return true;
+}
+
+bool host_uart_open(uart_port_t uart_num, const char *path)
+{
+    int fd = open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK);
+
+    if (fd < 0) {
+        return false;
+    }
+    if (!host_uart_attach(uart_num, fd)) {
+        close(fd);
+        return false;
+    }
+
+    return true;
+}
+
+void host_uart_event(uart_port_t uart_num, uart_event_type_t type)
+{
+    host_uart_t *uart = host_uart(uart_num);
+    struct host_queue *queue = NULL;
+    char wake = 0;
+
+    if ((uart == NULL) || !uart->installed) {
+        return;
+    }
+    queue = &uart->queue;
+    pthread_mutex_lock(&host_lock);
+    if (queue->count < HOST_QUEUE_EVENTS) {
+        queue->events[(queue->head + queue->count) % HOST_QUEUE_EVENTS] = type;
+        queue->count++;
+    }
+    pthread_mutex_unlock(&host_lock);
+    if (write(host_wake[1], &wake, 1) < 0) {
+        // the reader is awake anyway when the pipe is full
+    }
+}
+
+int host_uart_pending(uart_port_t uart_num)
+{
+    host_uart_t *uart = host_uart(uart_num);
+    int pending = 0;
+
+    if ((uart == NULL) || !uart->attached || uart->closed) {
+        return -1;
+    }
+    if (ioctl(uart->fd, FIONREAD, &pending) < 0) {
+        return -1;
+    }
+
+    return pending;
+}
+
+// No bytes to read: find out whether the other side has gone
+static void host_uart_check_closed(host_uart_t *uart)
+{
+    struct pollfd pfd = { .fd = uart->fd, .events = POLLIN };
+
+    if ((poll(&pfd, 1, 0) == 1) && (pfd.revents & (POLLHUP | POLLERR))) {
+        uart->closed = true;
+    }
+}
+
+esp_err_t uart_driver_install(uart_port_t uart_num, int rx_buffer_size,
+                              int tx_buffer_size, int queue_size,
+                              QueueHandle_t *uart_queue, int intr_alloc_flags)
+{
+    host_uart_t *uart = host_uart(uart_num);
+
+    (void)rx_buffer_size;
+    (void)tx_buffer_size;
+    (void)queue_size;
+    (void)intr_alloc_flags;
+    if ((uart == NULL) || !uart->attached || uart->installed) {
+        return ESP_FAIL;
+    }
+    if ((host_wake[0] < 0) && (pipe2(host_wake, O_NONBLOCK) < 0)) {
+        return ESP_FAIL;
+    }
+    memset(&uart->queue, 0, sizeof(uart->queue));
+    uart->queue.uart_num = uart_num;
+    uart->installed = true;
+    if (uart_queue != NULL) {
+        *uart_queue = &uart->queue;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t uart_num)
+{
+    host_uart_t *uart = host_uart(uart_num);
+
+    if ((uart == NULL) || !uart->installed) {
+        return ESP_FAIL;
+    }
+    uart->installed = false;
+
+    return ESP_OK;
+}
+
+esp_err_t uart_param_config(uart_port_t uart_num,
+                            const uart_config_t *uart_config)
+{
+    (void)uart_config;
+
+    return host_uart(uart_num) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t uart_set_pin(uart_port_t uart_num, int tx_io_num, int rx_io_num,
+                       int rts_io_num, int cts_io_num)
+{
+    (void)tx_io_num;
+    (void)rx_io_num;
+    (void)rts_io_num;
+    (void)cts_io_num;
+
+    return host_uart(uart_num) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t uart_set_rx_timeout(uart_port_t uart_num, const uint8_t tout_thresh)
+{
+    (void)tout_thresh;
+
+    return host_uart(uart_num) ? ESP_OK : ESP_FAIL;
+}
+
+int uart_read_bytes(uart_port_t uart_num, void *buf, uint32_t length,
+                    TickType_t ticks_to_wait)
+{
+    host_uart_t *uart = host_uart(uart_num);
+    ssize_t count = 0;
+
+    (void)ticks_to_wait;
+    if ((uart == NULL) || !uart->installed) {
+        return -1;
+    }
+    if (uart->closed) {
+        return 0;
+    }
+    count = read(uart->fd, buf, length);
+    if (count > 0) {
+        return (int)count;
+    }
+    if ((count == 0) || (errno == EIO)) {
+        // a pipe without writers, or a pty whose master is closed
+        uart->closed = true;
+    } else if ((errno != EAGAIN) && (errno != EINTR)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+esp_err_t uart_flush_input(uart_port_t uart_num)
+{
+    uint8_t buffer[256];
+
+    while (uart_read_bytes(uart_num, buffer, sizeof(buffer), 0) > 0) {
+    }
+
+    return ESP_OK;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length)
+{
+    (void)length;
+
+    return calloc(1, sizeof(struct host_queue_set));
+}
+
+BaseType_t xQueueAddToSet(QueueHandle_t queue, QueueSetHandle_t set)
+{
+    if ((queue == NULL) || (set == NULL) || (set->count == UART_NUM_MAX)) {
+        return pdFAIL;
+    }
+    set->members[set->count++] = queue;
+
+    return pdPASS;
+}
+
+// A member with a posted event
+static QueueHandle_t host_set_posted(QueueSetHandle_t set)
+{
+    QueueHandle_t member = NULL;
+    unsigned i = 0;
+
+    pthread_mutex_lock(&host_lock);
+    for (i = 0; (i < set->count) && (member == NULL); i++) {
+        if (set->members[i]->count > 0) {
+            member = set->members[i];
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+
+    return member;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set,
+                                           TickType_t ticks)
+{
+    struct pollfd pfd[1 + UART_NUM_MAX];
+    QueueHandle_t owner[1 + UART_NUM_MAX];
+    QueueHandle_t member = NULL;
+    host_uart_t *uart = NULL;
+    char drain[16];
+    int timeout = (ticks == portMAX_DELAY) ? -1 :
+                  (int)(ticks * 1000 / configTICK_RATE_HZ);
+    unsigned count = 0;
+    unsigned i = 0;
+
+    for (;;) {
+        member = host_set_posted(set);
+        if (member != NULL) {
+            return member;
+        }
+        pfd[0].fd = host_wake[0];
+        pfd[0].events = POLLIN;
+        count = 1;
+        for (i = 0; i < set->count; i++) {
+            uart = &host_uarts[set->members[i]->uart_num];
+            if (!uart->closed) {
+                pfd[count].fd = uart->fd;
+                pfd[count].events = POLLIN;
+                owner[count] = set->members[i];
+                count++;
+            }
+        }
+        if (poll(pfd, count, timeout) <= 0) {
+            return NULL;
+        }
+        if (pfd[0].revents & POLLIN) {
+            while (read(host_wake[0], drain, sizeof(drain)) > 0) {
+            }
+            continue;
+        }
+        for (i = 1; i < count; i++) {
+            if (pfd[i].revents & POLLIN) {
+                return owner[i];
+            }
+            if (pfd[i].revents & (POLLHUP | POLLERR)) {
+                // nothing left to read, and nobody to send more
+                host_uarts[owner[i]->uart_num].closed = true;
+            }
+        }
+    }
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+    host_uart_t *uart = &host_uarts[queue->uart_num];
+    uart_event_t *event = item;
+    int pending = 0;
+    bool posted = false;
+
+    (void)ticks;
+    memset(event, 0, sizeof(*event));
+    pthread_mutex_lock(&host_lock);
+    if (queue->count > 0) {
+        event->type = queue->events[queue->head];
+        queue->head = (queue->head + 1) % HOST_QUEUE_EVENTS;
+        queue->count--;
+        posted = true;
+    }
+    pthread_mutex_unlock(&host_lock);
+    if (posted) {
+        return pdTRUE;
+    }
+    pending = host_uart_pending(queue->uart_num);
+    if (pending > 0) {
+        event->type = UART_DATA;
+        event->size = (size_t)pending;
+        return pdTRUE;
+    }
+    if (pending == 0) {
+        host_uart_check_closed(uart);
+    }
+
+    return pdFALSE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+    pthread_mutex_lock(&host_lock);
+    queue->head = 0;
+    queue->count = 0;
+    pthread_mutex_unlock(&host_lock);
+
+    return pdPASS;
+}
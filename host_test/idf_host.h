@@ -0,0 +1,26 @@
+#ifndef IDF_HOST_H
+#define IDF_HOST_H
+
+#include <stdbool.h>
+#include "driver/uart.h"
+
+// The ESP-IDF and FreeRTOS calls of the firmware on a PC, in idf_host.c:
+// tasks are pthreads, and each UART reads a file descriptor.  A pty
+// stands in for the serial line, with a test or pms5003_emit writing
+// the sensor's side; a pipe or a file does as well.
+
+// Give a UART the descriptor it reads, before its driver is installed.
+// The descriptor is made non-blocking; a tty is set to raw mode.
+bool host_uart_attach(uart_port_t uart_num, int fd);
+
+// Open a path for a UART, as host_uart_attach() does with its descriptor
+bool host_uart_open(uart_port_t uart_num, const char *path);
+
+// Queue an event other than received data, as the driver posts on an
+// overflow or a line error
+void host_uart_event(uart_port_t uart_num, uart_event_type_t type);
+
+// Bytes the UART has not read yet, or -1 once the other side has closed
+int host_uart_pending(uart_port_t uart_num);
+
+#endif // IDF_HOST_H
@@ -0,0 +1,237 @@
+/*
+ * Non-volatile store for the host build
+ *
+ * nvstore.h kept in RAM.  It outlives handler_cov_init() and the other
+ * start-up code, so a test can "reset" the stack and see what it reads
+ * back.  Writes are counted, to see what a feature costs the flash.
+ */
+#include <string.h>
+#include "nvstore.h"
+#include "nvstore_host.h"
+
+#define NVSTORE_HOST_ENTRIES    64
+#define NVSTORE_HOST_BLOB       2048
+#define NVSTORE_HOST_NAME       16
+
+typedef enum {
+    NVSTORE_HOST_U8 = 1,
+    NVSTORE_HOST_U16,
+    NVSTORE_HOST_U32,
+    NVSTORE_HOST_BLOB_TYPE
+} nvstore_host_type_t;
+
+typedef struct {
+    char name_space[NVSTORE_HOST_NAME];
+    char key[NVSTORE_HOST_NAME];
+    nvstore_host_type_t type;
+    size_t length;
+    uint8_t value[NVSTORE_HOST_BLOB];
+} nvstore_host_entry_t;
+
+static nvstore_host_entry_t nvstore_host_entries[NVSTORE_HOST_ENTRIES];
+static char nvstore_host_open[NVSTORE_HOST_ENTRIES][NVSTORE_HOST_NAME];
+static bool nvstore_host_writable[NVSTORE_HOST_ENTRIES];
+static unsigned nvstore_host_write_count;
+
+void nvstore_host_erase_all(void)
+{
+    memset(nvstore_host_entries, 0, sizeof(nvstore_host_entries));
+    nvstore_host_write_count = 0;
+}
+
+unsigned nvstore_host_writes(void)
+{
+    return nvstore_host_write_count;
+}
+
+static nvstore_host_entry_t *nvstore_host_find(NVSTORE_HANDLE handle,
+                                               const char *key)
+{
+    unsigned i = 0;
+
+    if ((handle == 0) || (handle > NVSTORE_HOST_ENTRIES)) {
+        return NULL;
+    }
+    for (i = 0; i < NVSTORE_HOST_ENTRIES; i++) {
+        if (nvstore_host_entries[i].type &&
+            (strcmp(nvstore_host_entries[i].name_space,
+                    nvstore_host_open[handle - 1]) == 0) &&
+            (strcmp(nvstore_host_entries[i].key, key) == 0)) {
+            return &nvstore_host_entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static NVSTORE_STATUS nvstore_host_get(NVSTORE_HANDLE handle,
+                                       const char *key,
+                                       nvstore_host_type_t type,
+                                       void *value, size_t *length)
+{
+    nvstore_host_entry_t *entry = nvstore_host_find(handle, key);
+
+    if (!entry || (entry->type != type)) {
+        return NVSTORE_NOT_FOUND;
+    }
+    if (entry->length > *length) {
+        return NVSTORE_INVALID_LENGTH;
+    }
+    memcpy(value, entry->value, entry->length);
+    *length = entry->length;
+
+    return NVSTORE_OK;
+}
+
+static NVSTORE_STATUS nvstore_host_set(NVSTORE_HANDLE handle,
+                                       const char *key,
+                                       nvstore_host_type_t type,
+                                       const void *value, size_t length)
+{
+    nvstore_host_entry_t *entry = nvstore_host_find(handle, key);
+    unsigned i = 0;
+
+    if ((handle == 0) || (handle > NVSTORE_HOST_ENTRIES) ||
+        !nvstore_host_writable[handle - 1] ||
+        (length > NVSTORE_HOST_BLOB) || (strlen(key) >= NVSTORE_HOST_NAME)) {
+        return NVSTORE_FAILED;
+    }
+    for (i = 0; !entry && (i < NVSTORE_HOST_ENTRIES); i++) {
+        if (!nvstore_host_entries[i].type) {
+            entry = &nvstore_host_entries[i];
+            strcpy(entry->name_space, nvstore_host_open[handle - 1]);
+            strcpy(entry->key, key);
+        }
+    }
+    if (!entry) {
+        return NVSTORE_FAILED;
+    }
+    entry->type = type;
+    entry->length = length;
+    memcpy(entry->value, value, length);
+    nvstore_host_write_count++;
+
+    return NVSTORE_OK;
+}
+
+NVSTORE_STATUS nvstore_open(const char *name_space, bool read_write,
+                            NVSTORE_HANDLE *handle)
+{
+    unsigned i = 0;
+    unsigned n = 0;
+    bool found = false;
+
+    if (strlen(name_space) >= NVSTORE_HOST_NAME) {
+        return NVSTORE_FAILED;
+    }
+    // as NVS: a namespace is only there once something was written to it
+    for (n = 0; n < NVSTORE_HOST_ENTRIES; n++) {
+        if (nvstore_host_entries[n].type &&
+            (strcmp(nvstore_host_entries[n].name_space, name_space) == 0)) {
+            found = true;
+        }
+    }
+    if (!found && !read_write) {
+        return NVSTORE_NOT_FOUND;
+    }
+    for (i = 0; i < NVSTORE_HOST_ENTRIES; i++) {
+        if (nvstore_host_open[i][0] == '\0') {
+            strcpy(nvstore_host_open[i], name_space);
+            nvstore_host_writable[i] = read_write;
+            *handle = i + 1;
+            return NVSTORE_OK;
+        }
+    }
+
+    return NVSTORE_FAILED;
+}
+
+void nvstore_close(NVSTORE_HANDLE handle)
+{
+    if ((handle > 0) && (handle <= NVSTORE_HOST_ENTRIES)) {
+        nvstore_host_open[handle - 1][0] = '\0';
+    }
+}
+
+NVSTORE_STATUS nvstore_commit(NVSTORE_HANDLE handle)
+{
+    (void)handle;
+
+    return NVSTORE_OK;
+}
+
+NVSTORE_STATUS nvstore_get_u8(NVSTORE_HANDLE handle, const char *key,
+                              uint8_t *value)
+{
+    size_t length = sizeof(*value);
+
+    return nvstore_host_get(handle, key, NVSTORE_HOST_U8, value, &length);
+}
+
+NVSTORE_STATUS nvstore_set_u8(NVSTORE_HANDLE handle, const char *key,
+                              uint8_t value)
+{
+    return nvstore_host_set(handle, key, NVSTORE_HOST_U8, &value,
+                            sizeof(value));
+}
+
+NVSTORE_STATUS nvstore_get_u16(NVSTORE_HANDLE handle, const char *key,
+                               uint16_t *value)
+{
+    size_t length = sizeof(*value);
+
+    return nvstore_host_get(handle, key, NVSTORE_HOST_U16, value, &length);
+}
+
+NVSTORE_STATUS nvstore_set_u16(NVSTORE_HANDLE handle, const char *key,
+                               uint16_t value)
+{
+    return nvstore_host_set(handle, key, NVSTORE_HOST_U16, &value,
+                            sizeof(value));
+}
+
+NVSTORE_STATUS nvstore_get_u32(NVSTORE_HANDLE handle, const char *key,
+                               uint32_t *value)
+{
+    size_t length = sizeof(*value);
+
+    return nvstore_host_get(handle, key, NVSTORE_HOST_U32, value, &length);
+}
+
+NVSTORE_STATUS nvstore_set_u32(NVSTORE_HANDLE handle, const char *key,
+                               uint32_t value)
+{
+    return nvstore_host_set(handle, key, NVSTORE_HOST_U32, &value,
+                            sizeof(value));
+}
+
+NVSTORE_STATUS nvstore_get_blob(NVSTORE_HANDLE handle, const char *key,
+                                void *value, size_t *length)
+{
+    return nvstore_host_get(handle, key, NVSTORE_HOST_BLOB_TYPE, value,
+                            length);
+}
+
+NVSTORE_STATUS nvstore_set_blob(NVSTORE_HANDLE handle, const char *key,
+                                const void *value, size_t length)
+{
+    return nvstore_host_set(handle, key, NVSTORE_HOST_BLOB_TYPE, value,
+                            length);
+}
+
+NVSTORE_STATUS nvstore_erase_key(NVSTORE_HANDLE handle, const char *key)
+{
+    nvstore_host_entry_t *entry = nvstore_host_find(handle, key);
+
+    if ((handle == 0) || (handle > NVSTORE_HOST_ENTRIES) ||
+        !nvstore_host_writable[handle - 1]) {
+        return NVSTORE_FAILED;
+    }
+    if (!entry) {
+        return NVSTORE_NOT_FOUND;
+    }
+    memset(entry, 0, sizeof(*entry));
+    nvstore_host_write_count++;
+
+    return NVSTORE_OK;
+}
@@ -0,0 +1,12 @@
+#ifndef NVSTORE_HOST_H
+#define NVSTORE_HOST_H
+
+// The host build's nvstore.h, in RAM; it survives handler_cov_init()
+
+// Forget everything, as a freshly erased flash
+void nvstore_host_erase_all(void);
+
+// Values written or erased since the last nvstore_host_erase_all()
+unsigned nvstore_host_writes(void);
+
+#endif // NVSTORE_HOST_H
@@ -0,0 +1,40 @@
+# Static RAM of the object modules of host builds of the stack: the
+# sizes nm gives for the .bss and .data symbols of ai.c, av.c, bi.c,
+# bo.c and bv.c in each library.  Sizes are those of the host, where
+# pointers are 64-bit; the ESP32's are smaller.
+#
+#   cmake -DNM=nm "-DLIBRARIES=a.a|b.a" -P object_ram.cmake
+cmake_minimum_required(VERSION 3.16)
+
+string(REPLACE "|" ";" LIBRARIES "${LIBRARIES}")
+set(OBJECT_MODULES ai av bi bo bv)
+
+foreach(library ${LIBRARIES})
+    execute_process(COMMAND ${NM} -S ${library}
+        OUTPUT_VARIABLE symbols RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${NM} -S ${library} failed")
+    endif()
+    foreach(module ${OBJECT_MODULES})
+        set(ram_${module} 0)
+    endforeach()
+    set(module "")
+    string(REPLACE "\n" ";" lines "${symbols}")
+    foreach(line ${lines})
+        if(line MATCHES "^([a-z]+)\\.c\\.o:$")
+            set(module ${CMAKE_MATCH_1})
+        elseif(module IN_LIST OBJECT_MODULES AND
+               line MATCHES "^[0-9a-f]+ ([0-9a-f]+) [bBdD] ")
+            math(EXPR ram_${module} "${ram_${module}} + 0x${CMAKE_MATCH_1}")
+        endif()
+    endforeach()
+    get_filename_component(name ${library} NAME_WE)
+    set(total 0)
+    set(report "")
+    foreach(module ${OBJECT_MODULES})
+        math(EXPR total "${total} + ${ram_${module}}")
+        string(APPEND report " ${module}.c ${ram_${module}}")
+    endforeach()
+    message("${name}: static RAM of the objects, bytes:${report}, "
+        "total ${total}")
+endforeach()
@@ -0,0 +1,142 @@
+/*
+ * PM sensor reader on the PC
+ *
+ * pm25_sensor.c as the firmware runs it, reading each sensor from a
+ * path instead of a UART: the pty printed by pms5003_emit --pty, a
+ * serial adapter with a real PMS5003 on it, a FIFO or a capture in
+ * binary.  "-" reads standard input, so an emitter may be piped in.
+ *
+ *   pm25_host /dev/pts/3 /dev/ttyUSB0
+ *   pms5003_emit --out - --frames 100 | pm25_host - --min-frames 100
+ *
+ * Each frame is printed as the reader publishes it.  Once every input
+ * is closed, the counters of each sensor are printed.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "idf_host.h"
+#include "pm25_sensor.h"
+
+// as the sensors of sdkconfig.h
+static const uart_port_t host_uart[PM25_SENSOR_COUNT] = {
+    CONFIG_PM25_SENSOR1_UART, CONFIG_PM25_SENSOR2_UART
+};
+static bool host_quiet = false;
+
+static void host_listener(unsigned sensor)
+{
+    pm25_snapshot_t snapshot;
+
+    if (host_quiet) {
+        return;
+    }
+    // the reader task waits on this: a line at a time is all it gets
+    pm25_get_snapshot(sensor, &snapshot);
+    printf("sensor %u: #%lu PM1.0 %.1f PM2.5 %.1f PM10 %.1f "
+           "(raw %u %u %u)\n", sensor, (unsigned long)snapshot.sequence,
+           (double)snapshot.filtered[PM25_CHANNEL_PM1_0],
+           (double)snapshot.filtered[PM25_CHANNEL_PM2_5],
+           (double)snapshot.filtered[PM25_CHANNEL_PM10],
+           snapshot.frame.pm1_0_standard, snapshot.frame.pm2_5_standard,
+           snapshot.frame.pm10_standard);
+    fflush(stdout);
+}
+
+static void host_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [--quiet] [--min-frames N] PATH...\n"
+            "  PATH            input of a sensor, - for standard input;\n"
+            "                  at most %u, in sensor order\n"
+            "  --quiet         print the counters only\n"
+            "  --min-frames N  fail if a sensor received fewer frames\n",
+            name, (unsigned)PM25_SENSOR_COUNT);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] = {
+        { "quiet", no_argument, NULL, 'q' },
+        { "min-frames", required_argument, NULL, 'm' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    unsigned long min_frames = 0;
+    unsigned inputs = 0;
+    unsigned sensor = 0;
+    pm25_stats_t stats;
+    bool open = false;
+    bool ok = true;
+    int option = 0;
+
+    while ((option = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        switch (option) {
+        case 'q':
+            host_quiet = true;
+            break;
+        case 'm':
+            min_frames = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            host_usage(argv[0]);
+            return 2;
+        }
+    }
+    inputs = (unsigned)(argc - optind);
+    if ((inputs == 0) || (inputs > PM25_SENSOR_COUNT)) {
+        host_usage(argv[0]);
+        return 2;
+    }
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        const char *path = "/dev/null";    // a sensor that is not there
+
+        if (sensor < inputs) {
+            path = argv[optind + (int)sensor];
+        }
+        if (strcmp(path, "-") == 0) {
+            open = host_uart_attach(host_uart[sensor], STDIN_FILENO);
+        } else {
+            open = host_uart_open(host_uart[sensor], path);
+        }
+        if (!open) {
+            perror(path);
+            return 1;
+        }
+    }
+    pm25_set_listener(host_listener);
+    pm25_sensor_init();
+
+    // until every input has closed
+    do {
+        usleep(10000);
+        for (sensor = 0, open = false; sensor < inputs; sensor++) {
+            open |= host_uart_pending(host_uart[sensor]) >= 0;
+        }
+    } while (open);
+    // and the reader has published what it read last
+    usleep(20000);
+
+    for (sensor = 0; sensor < inputs; sensor++) {
+        pm25_get_stats(sensor, &stats);
+        printf("sensor %u: frames %lu checksum %lu length %lu resyncs %lu "
+               "discarded %lu overflows %lu line %lu\n", sensor,
+               (unsigned long)stats.frames,
+               (unsigned long)stats.checksum_errors,
+               (unsigned long)stats.length_errors,
+               (unsigned long)stats.resyncs, (unsigned long)stats.discarded,
+               (unsigned long)stats.overflows,
+               (unsigned long)stats.line_errors);
+        if (stats.frames < min_frames) {
+            fprintf(stderr, "sensor %u: %lu frames, expected at least %lu\n",
+                    sensor, (unsigned long)stats.frames, min_frames);
+            ok = false;
+        }
+    }
+
+    return ok ? 0 : 1;
+}
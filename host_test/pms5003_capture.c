@@ -0,0 +1,68 @@
+/*
+ * PMS5003 capture files
+ */
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "pms5003_capture.h"
+
+static int pms5003_capture_digit(int c)
+{
+    if (isdigit(c)) {
+        return c - '0';
+    }
+    if (isxdigit(c)) {
+        return tolower(c) - 'a' + 10;
+    }
+
+    return -1;
+}
+
+long pms5003_capture_read(const char *path, uint8_t *buf, size_t size)
+{
+    FILE *file = fopen(path, "r");
+    size_t length = 0;
+    bool bad = false;
+    int digits = 0;
+    int byte = 0;
+    int c = 0;
+
+    if (file == NULL) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return -1;
+    }
+    do {
+        c = fgetc(file);
+        if (c == '#') {
+            while ((c != EOF) && (c != '\n')) {
+                c = fgetc(file);
+            }
+        }
+        if ((c == EOF) || isspace(c)) {
+            // the end of a byte, two digits long
+            if (digits == 2) {
+                if (length == size) {
+                    bad = true;
+                } else {
+                    buf[length++] = (uint8_t)byte;
+                }
+            } else if (digits != 0) {
+                bad = true;
+            }
+            byte = 0;
+            digits = 0;
+        } else if ((pms5003_capture_digit(c) < 0) || (++digits > 2)) {
+            bad = true;
+        } else {
+            byte = (byte << 4) | pms5003_capture_digit(c);
+        }
+    } while ((c != EOF) && !bad);
+    fclose(file);
+    if (bad) {
+        fprintf(stderr, "%s: not a capture, or longer than %zu bytes\n",
+                path, size);
+        return -1;
+    }
+
+    return (long)length;
+}
@@ -0,0 +1,14 @@
+#ifndef PMS5003_CAPTURE_H
+#define PMS5003_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// PMS5003 capture files: the bytes of a UART stream in hex, separated by
+// white space, with '#' comments to the end of the line.
+
+// Read a capture into buf, at most size bytes.  Returns the number of
+// bytes read, or -1 if the file cannot be read or is not a capture.
+long pms5003_capture_read(const char *path, uint8_t *buf, size_t size);
+
+#endif // PMS5003_CAPTURE_H
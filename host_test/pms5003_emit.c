@@ -0,0 +1,366 @@
+/*
+ * PMS5003 stream emitter
+ *
+ * Sends what a PMS5003 would over a serial line, to a pty that the
+ * firmware's reader (pm25_host, or anything that opens a serial port)
+ * reads, or to a pipe, a FIFO or a file.  The frames come from
+ * pms5003_sim.c, with its faults, or from a capture file, and what is
+ * sent can be recorded as a capture to replay later.
+ *
+ *   pms5003_emit --pty --pm25 35 --noise 5 --drop 20 --stall 50
+ *   pms5003_emit --out - --replay data/pms5003_faults.hex | pm25_host -
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "pms5003_capture.h"
+#include "pms5003_sim.h"
+
+#define EMIT_CAPTURE_MAX    (1 << 20)
+
+typedef struct {
+    pms5003_sim_config_t sim;
+    uint32_t seed;
+    unsigned long frames;       // 0: for ever, or the whole capture
+    unsigned period_ms;         // between frames
+    unsigned stall_ms;          // pause of a stalled frame
+    unsigned baud;              // pace of the bytes, 0 for no pacing
+    unsigned linger_ms;         // pty kept open after the last byte
+    const char *out;            // path, "-" for stdout, NULL for a pty
+    const char *replay;
+    const char *record;
+} emit_options_t;
+
+static int emit_fd = -1;
+static FILE *emit_record = NULL;
+static unsigned emit_record_column = 0;
+
+static void emit_sleep_us(unsigned long us)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(us / 1000000),
+        .tv_nsec = (long)(us % 1000000) * 1000,
+    };
+
+    while ((nanosleep(&ts, &ts) < 0) && (errno == EINTR)) {
+    }
+}
+
+static void emit_usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [--pty | --out PATH] [options]\n"
+            "  --pty             send to a new pty, whose name is printed\n"
+            "  --out PATH        send to a file, FIFO or device, - for stdout\n"
+            "  --replay FILE     send a capture instead of simulated frames\n"
+            "  --record FILE     write what is sent as a capture\n"
+            "  --frames N        frames to send, 0 for ever (default 0)\n"
+            "  --period MS       time between frames (default 1000)\n"
+            "  --baud N          pace the bytes as on a line, 0 for no\n"
+            "                    pacing (default 9600)\n"
+            "  --pm25 N          mean PM2.5, ug/m3 (default 12)\n"
+            "  --noise N         spread of the readings (default 3)\n"
+            "  --drop N          frames with a byte lost, per 1000\n"
+            "  --dup N           frames with a byte received twice, per 1000\n"
+            "  --corrupt N       frames with a bad checksum, per 1000\n"
+            "  --stall N         frames that pause halfway, per 1000\n"
+            "  --stall-ms MS     length of the pause (default 50)\n"
+            "  --seed N          seed of the simulator (default 1)\n"
+            "  --linger MS       keep the pty open after the last frame\n"
+            "                    (default 1000)\n",
+            name);
+}
+
+static bool emit_parse(int argc, char **argv, emit_options_t *options)
+{
+    static const struct option long_options[] = {
+        { "pty", no_argument, NULL, 'P' },
+        { "out", required_argument, NULL, 'o' },
+        { "replay", required_argument, NULL, 'r' },
+        { "record", required_argument, NULL, 'R' },
+        { "frames", required_argument, NULL, 'n' },
+        { "period", required_argument, NULL, 'p' },
+        { "baud", required_argument, NULL, 'b' },
+        { "pm25", required_argument, NULL, 'm' },
+        { "noise", required_argument, NULL, 'N' },
+        { "drop", required_argument, NULL, 'd' },
+        { "dup", required_argument, NULL, 'D' },
+        { "corrupt", required_argument, NULL, 'c' },
+        { "stall", required_argument, NULL, 's' },
+        { "stall-ms", required_argument, NULL, 'S' },
+        { "seed", required_argument, NULL, 'x' },
+        { "linger", required_argument, NULL, 'l' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    bool pty = false;
+    unsigned long value = 0;
+    int option = 0;
+
+    memset(options, 0, sizeof(*options));
+    options->sim.pm2_5 = 12;
+    options->sim.noise = 3;
+    options->seed = 1;
+    options->period_ms = 1000;
+    options->stall_ms = 50;
+    options->baud = 9600;
+    options->linger_ms = 1000;
+    while ((option = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+        value = optarg ? strtoul(optarg, NULL, 0) : 0;
+        switch (option) {
+        case 'P':
+            pty = true;
+            break;
+        case 'o':
+            options->out = optarg;
+            break;
+        case 'r':
+            options->replay = optarg;
+            break;
+        case 'R':
+            options->record = optarg;
+            break;
+        case 'n':
+            options->frames = value;
+            break;
+        case 'p':
+            options->period_ms = (unsigned)value;
+            break;
+        case 'b':
+            options->baud = (unsigned)value;
+            break;
+        case 'm':
+            options->sim.pm2_5 = (uint16_t)value;
+            break;
+        case 'N':
+            options->sim.noise = (uint16_t)value;
+            break;
+        case 'd':
+            options->sim.drop_permille = (uint16_t)value;
+            break;
+        case 'D':
+            options->sim.dup_permille = (uint16_t)value;
+            break;
+        case 'c':
+            options->sim.corrupt_permille = (uint16_t)value;
+            break;
+        case 's':
+            options->sim.stall_permille = (uint16_t)value;
+            break;
+        case 'S':
+            options->stall_ms = (unsigned)value;
+            break;
+        case 'x':
+            options->seed = (uint32_t)value;
+            break;
+        case 'l':
+            options->linger_ms = (unsigned)value;
+            break;
+        default:
+            return false;
+        }
+    }
+    // one of the two, and nothing else on the command line
+    return (optind == argc) && (pty != (options->out != NULL));
+}
+
+// A pty whose other side reads like a serial port; prints its name
+static int emit_open_pty(void)
+{
+    struct termios tio;
+    const char *name = NULL;
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    int line = -1;
+
+    if ((master < 0) || (grantpt(master) < 0) || (unlockpt(master) < 0) ||
+        ((name = ptsname(master)) == NULL)) {
+        perror("pty");
+        return -1;
+    }
+    // kept open, so the reader may come and go without hanging up the
+    // line, and set raw for those that do not set it themselves
+    line = open(name, O_RDWR | O_NOCTTY);
+    if ((line < 0) || (tcgetattr(line, &tio) < 0)) {
+        perror(name);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tcsetattr(line, TCSANOW, &tio);
+    printf("%s\n", name);
+    fflush(stdout);
+
+    return master;
+}
+
+static int emit_open(const emit_options_t *options)
+{
+    int fd = -1;
+
+    if (options->out == NULL) {
+        return emit_open_pty();
+    }
+    if (strcmp(options->out, "-") == 0) {
+        return STDOUT_FILENO;
+    }
+    fd = open(options->out, O_WRONLY | O_CREAT | O_TRUNC | O_NOCTTY, 0644);
+    if (fd < 0) {
+        perror(options->out);
+    }
+
+    return fd;
+}
+
+static void emit_record_bytes(const uint8_t *data, size_t length)
+{
+    size_t i = 0;
+
+    for (i = 0; (emit_record != NULL) && (i < length); i++) {
+        fprintf(emit_record, "%02X%s", data[i],
+                (++emit_record_column % 16) ? " " : "\n");
+    }
+}
+
+// Write bytes at the pace of the line: ten bits each, start and stop
+// included
+static bool emit_send(const emit_options_t *options, const uint8_t *data,
+                      size_t length)
+{
+    size_t chunk = 0;
+    ssize_t sent = 0;
+
+    emit_record_bytes(data, length);
+    while (length > 0) {
+        // about a millisecond of bytes at a time
+        chunk = options->baud ? 1 + options->baud / 10000 : length;
+        if (chunk > length) {
+            chunk = length;
+        }
+        sent = write(emit_fd, data, chunk);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write");
+            return false;
+        }
+        data += sent;
+        length -= (size_t)sent;
+        if (options->baud) {
+            emit_sleep_us((unsigned long)sent * 10 * 1000000 / options->baud);
+        }
+    }
+
+    return true;
+}
+
+static bool emit_simulated(const emit_options_t *options)
+{
+    pms5003_sim_t sim;
+    uint8_t buf[PMS5003_SIM_MAX_BYTES];
+    unsigned long frame = 0;
+    size_t length = 0;
+    size_t split = 0;
+
+    pms5003_sim_init(&sim, &options->sim, options->seed);
+    for (frame = 0; (options->frames == 0) || (frame < options->frames);
+         frame++) {
+        if ((frame > 0) && options->period_ms) {
+            emit_sleep_us(options->period_ms * 1000UL);
+        }
+        length = pms5003_sim_next(&sim, buf, &split, NULL);
+        if (split > 0) {
+            if (!emit_send(options, buf, split)) {
+                return false;
+            }
+            emit_sleep_us(options->stall_ms * 1000UL);
+        }
+        if (!emit_send(options, &buf[split], length - split)) {
+            return false;
+        }
+    }
+    fprintf(stderr, "pms5003_emit: %lu frames, dropped %lu, duplicated %lu, "
+            "corrupted %lu, stalled %lu\n", (unsigned long)sim.frames,
+            (unsigned long)sim.dropped, (unsigned long)sim.duplicated,
+            (unsigned long)sim.corrupted, (unsigned long)sim.stalled);
+
+    return true;
+}
+
+// The capture a frame's worth of bytes at a time, a period apart
+static bool emit_replay(const emit_options_t *options)
+{
+    static uint8_t capture[EMIT_CAPTURE_MAX];
+    long length = pms5003_capture_read(options->replay, capture,
+                                       sizeof(capture));
+    unsigned long frame = 0;
+    size_t pos = 0;
+    size_t chunk = 0;
+
+    if (length < 0) {
+        return false;
+    }
+    while (pos < (size_t)length) {
+        if ((options->frames != 0) && (frame == options->frames)) {
+            break;
+        }
+        if ((frame > 0) && options->period_ms) {
+            emit_sleep_us(options->period_ms * 1000UL);
+        }
+        chunk = (size_t)length - pos;
+        if (chunk > PMS5003_FRAME_SIZE) {
+            chunk = PMS5003_FRAME_SIZE;
+        }
+        if (!emit_send(options, &capture[pos], chunk)) {
+            return false;
+        }
+        pos += chunk;
+        frame++;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    emit_options_t options;
+    bool ok = false;
+
+    if (!emit_parse(argc, argv, &options)) {
+        emit_usage(argv[0]);
+        return 2;
+    }
+    emit_fd = emit_open(&options);
+    if (emit_fd < 0) {
+        return 1;
+    }
+    if (options.record != NULL) {
+        emit_record = fopen(options.record, "w");
+        if (emit_record == NULL) {
+            perror(options.record);
+            return 1;
+        }
+        fprintf(emit_record, "# PMS5003 capture: bytes in hex, '#' starts "
+                "a comment\n# recorded by pms5003_emit\n");
+    }
+    ok = options.replay ? emit_replay(&options) : emit_simulated(&options);
+    if (emit_record != NULL) {
+        if (emit_record_column % 16) {
+            fprintf(emit_record, "\n");
+        }
+        fclose(emit_record);
+    }
+    if (options.out == NULL) {
+        // the reader may still be catching up
+        emit_sleep_us(options.linger_ms * 1000UL);
+    }
+    close(emit_fd);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/*
+ * Proprietary properties of the Analog Values
+ *
+ * A ReadPropertyMultiple of ALL lists, for each object, only the
+ * proprietary properties the object has: Raw_Value on bound objects, the
+ * filter parameters on objects whose source filters.  Each one listed
+ * must read without an error.
+ */
+#include <string.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "av.h"
+#include "bacapp.h"
+#include "bacdcode.h"
+#include "device.h"
+#include "rpm.h"
+
+#define TEST_PROPERTIES 64
+
+typedef struct {
+    BACNET_PROPERTY_ID property[TEST_PROPERTIES];
+    unsigned count;
+    unsigned errors;
+} test_rpm_result_t;
+
+// ReadPropertyMultiple of ALL for one Analog Value, and what came back
+static bool test_read_all(uint32_t instance, test_rpm_result_t *result)
+{
+    uint8_t request[MAX_APDU];
+    const host_pdu_t *pdu = NULL;
+    const uint8_t *ack = NULL;
+    uint8_t *apdu = NULL;
+    BACNET_OBJECT_TYPE type = OBJECT_DEVICE;
+    uint32_t ack_instance = 0;
+    uint32_t array_index = 0;
+    int ack_len = 0;
+    int len = 0;
+    int pos = 0;
+
+    memset(result, 0, sizeof(*result));
+    len = rpm_encode_apdu_init(&request[0], 1);
+    len += rpm_encode_apdu_object_begin(&request[len], OBJECT_ANALOG_VALUE,
+                                        instance);
+    len += rpm_encode_apdu_object_property(&request[len], PROP_ALL,
+                                           BACNET_ARRAY_ALL);
+    len += rpm_encode_apdu_object_end(&request[len]);
+    host_datalink_clear();
+    host_bacnet_receive(1, request, (unsigned)len);
+    pdu = host_datalink_pdu(0);
+    if ((pdu == NULL) || (host_pdu_type(pdu) != PDU_TYPE_COMPLEX_ACK)) {
+        return false;
+    }
+    ack_len = host_pdu_apdu(pdu, &ack);
+    // the decoders want a writable buffer
+    apdu = (uint8_t *)ack;
+    pos = 3;
+    len = rpm_ack_decode_object_id(&apdu[pos], ack_len - pos, &type,
+                                   &ack_instance);
+    if ((len <= 0) || (type != OBJECT_ANALOG_VALUE) ||
+        (ack_instance != instance)) {
+        return false;
+    }
+    pos += len;
+    while ((pos < ack_len) &&
+           !rpm_ack_decode_object_end(&apdu[pos], ack_len - pos)) {
+        len = rpm_ack_decode_object_property(&apdu[pos], ack_len - pos,
+                                             &result->property[result->count],
+                                             &array_index);
+        if ((len <= 0) || (result->count == TEST_PROPERTIES)) {
+            return false;
+        }
+        pos += len;
+        // a value in tag 4, or an error in tag 5, each one octet
+        if (decode_is_opening_tag_number(&apdu[pos], 5)) {
+            result->errors++;
+        } else if (!decode_is_opening_tag_number(&apdu[pos], 4)) {
+            return false;
+        }
+        len = bacapp_data_len(&apdu[pos], ack_len - pos,
+                              result->property[result->count]);
+        if (len < 0) {
+            return false;
+        }
+        pos += 1 + len + 1;
+        result->count++;
+    }
+
+    return true;
+}
+
+static bool test_listed(const test_rpm_result_t *result,
+                        BACNET_PROPERTY_ID property)
+{
+    unsigned i = 0;
+
+    for (i = 0; i < result->count; i++) {
+        if (result->property[i] == property) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void test_object(uint32_t instance, bool bound, bool filtered)
+{
+    test_rpm_result_t result;
+    struct special_property_list_t list;
+
+    HOST_CHECK(test_read_all(instance, &result));
+    HOST_CHECK_EQ(result.errors, 0);
+    HOST_CHECK(test_listed(&result, PROP_PRESENT_VALUE));
+    HOST_CHECK_EQ(test_listed(&result, PROP_PM_RAW_VALUE), bound);
+    HOST_CHECK_EQ(test_listed(&result, PROP_PM_MEDIAN_WINDOW), filtered);
+    HOST_CHECK_EQ(test_listed(&result, PROP_PM_EMA_ALPHA), filtered);
+    HOST_CHECK_EQ(test_listed(&result, PROP_PM_MEAN_WINDOW), filtered);
+    Device_Objects_Property_List(OBJECT_ANALOG_VALUE, instance, &list);
+    HOST_CHECK_EQ(list.Proprietary.count, (bound ? 1 : 0) +
+                  (filtered ? 3 : 0));
+}
+
+int main(void)
+{
+    host_bacnet_init();
+    Analog_Value_Bind(1, true);
+    Analog_Value_Filter_Set(1, 5, 0.3f, 1);
+    Analog_Value_Source_Update(1, 12.0f, 14.0f);
+    Analog_Value_Bind(2, true);
+    Analog_Value_Filter_Set(3, 3, 1.0f, 4);
+    // a created object has none
+    HOST_CHECK(Analog_Value_Create(100));
+
+    test_object(0, false, false);
+    test_object(1, true, true);
+    test_object(2, true, false);
+    test_object(3, false, true);
+    test_object(100, false, false);
+    // deleted and made again, it starts without them
+    Analog_Value_Bind(100, true);
+    test_object(100, true, false);
+    HOST_CHECK(Analog_Value_Delete(100));
+    HOST_CHECK(Analog_Value_Create(100));
+    test_object(100, false, false);
+
+    return host_check_result("test_av_properties");
+}
@@ -0,0 +1,136 @@
+/*
+ * COV subscription index under churn
+ *
+ * Objects are subscribed and cancelled in a random order, changed while
+ * they wait to be notified, and after every step each changed object
+ * must be notified once per subscriber, and nothing else.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "handlers.h"
+#include "av.h"
+
+// 25 objects of the application and 32 made by CreateObject
+#define TEST_FIXED      25
+#define TEST_CREATED    32
+#define TEST_OBJECTS    (TEST_FIXED + TEST_CREATED)
+// the capacity of the index, MAX_COV_OBJECTS
+#define TEST_INDEX      32
+
+static uint32_t test_instance(unsigned n)
+{
+    return (n < TEST_FIXED) ? n : 100 + (n - TEST_FIXED);
+}
+
+static unsigned test_object(uint32_t instance)
+{
+    return (instance < TEST_FIXED) ? instance :
+           TEST_FIXED + (instance - 100);
+}
+
+static float test_values[TEST_OBJECTS];
+
+static void test_change(unsigned n)
+{
+    test_values[n] += 10.0f;
+    Analog_Value_Present_Value_Set(test_instance(n), test_values[n], 16);
+}
+
+// Runs the COV task and counts the notifications for each object
+static void test_notified(unsigned counts[TEST_OBJECTS])
+{
+    unsigned first = host_datalink_sent();
+    unsigned i = 0;
+    const host_pdu_t *pdu = NULL;
+    BACNET_OBJECT_ID object;
+
+    memset(counts, 0, TEST_OBJECTS * sizeof(counts[0]));
+    handler_cov_task();
+    for (i = first; i < host_datalink_sent(); i++) {
+        pdu = host_datalink_pdu(i);
+        HOST_CHECK(pdu != NULL);
+        if (pdu && host_pdu_cov_object(pdu, &object, NULL)) {
+            HOST_CHECK_EQ(object.type, OBJECT_ANALOG_VALUE);
+            counts[test_object(object.instance)]++;
+        }
+    }
+}
+
+static void test_churn(void)
+{
+    bool subscribed[TEST_OBJECTS] = { false };
+    bool changed[TEST_OBJECTS] = { false };
+    unsigned counts[TEST_OBJECTS];
+    unsigned count = 0;
+    unsigned step = 0;
+    unsigned n = 0;
+    bool ok = false;
+
+    srand(1);
+    for (step = 0; step < 20000; step++) {
+        n = (unsigned)rand() % TEST_OBJECTS;
+        if (subscribed[n]) {
+            ok = host_bacnet_subscribe(1, 7, OBJECT_ANALOG_VALUE,
+                                       test_instance(n), false, 0, true);
+            HOST_CHECK(ok);
+            subscribed[n] = false;
+            count--;
+        } else if (count < TEST_INDEX) {
+            ok = host_bacnet_subscribe(1, 7, OBJECT_ANALOG_VALUE,
+                                       test_instance(n), false, 0, false);
+            HOST_CHECK(ok);
+            subscribed[n] = true;
+            count++;
+            // the first notification goes out with the next task
+            changed[n] = true;
+        }
+        // leave some objects waiting in the changed-object set while
+        // others come and go around them in the index
+        n = (unsigned)rand() % TEST_OBJECTS;
+        test_change(n);
+        changed[n] = true;
+        if ((step % 4) != 3) {
+            continue;
+        }
+        test_notified(counts);
+        for (n = 0; n < TEST_OBJECTS; n++) {
+            HOST_CHECK_EQ(counts[n], (subscribed[n] && changed[n]) ? 1 : 0);
+            changed[n] = false;
+        }
+    }
+    // the index has not lost any room: it takes a full load again
+    for (n = 0; n < TEST_OBJECTS; n++) {
+        if (subscribed[n]) {
+            host_bacnet_subscribe(1, 7, OBJECT_ANALOG_VALUE, test_instance(n),
+                                  false, 0, true);
+            subscribed[n] = false;
+        }
+    }
+    test_notified(counts);
+    for (n = 0; n < TEST_INDEX; n++) {
+        HOST_CHECK(host_bacnet_subscribe(2, 9, OBJECT_ANALOG_VALUE,
+                                         test_instance(TEST_OBJECTS - 1 - n),
+                                         false, 0, false));
+    }
+    HOST_CHECK(!host_bacnet_subscribe(2, 9, OBJECT_ANALOG_VALUE,
+                                      test_instance(0), false, 0, false));
+    test_notified(counts);
+    for (n = 0; n < TEST_OBJECTS; n++) {
+        HOST_CHECK_EQ(counts[n], (n >= TEST_OBJECTS - TEST_INDEX) ? 1 : 0);
+    }
+}
+
+int main(void)
+{
+    unsigned n = 0;
+
+    host_bacnet_init();
+    for (n = TEST_FIXED; n < TEST_OBJECTS; n++) {
+        HOST_CHECK(Analog_Value_Create(test_instance(n)));
+    }
+    test_churn();
+
+    return host_check_result("test_cov");
+}
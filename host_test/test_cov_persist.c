@@ -0,0 +1,240 @@
+/*
+ * COV subscriptions across resets
+ *
+ * The NVS of nvstore_host.c outlives host_bacnet_reset(), so each test
+ * runs the server for a while, resets it, and looks at what came back:
+ * which subscriptions, and how much of their lifetime is left.
+ */
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "nvstore_host.h"
+#include "av.h"
+#include "device.h"
+#include "handlers.h"
+#include "nvstore.h"
+
+// as h_cov.c
+#define TEST_CHECKPOINT 60
+#define TEST_PERSIST_DELAY 2
+#define TEST_NAMESPACE  "bacnet_cov"
+
+// an Analog Value made by CreateObject
+#define TEST_CREATED    100
+
+// The server task, one pass a second
+static void test_run(unsigned seconds)
+{
+    while (seconds--) {
+        handler_cov_timer_seconds(1);
+        handler_cov_task();
+    }
+}
+
+// Resets the server.  Every restored subscription is sent a
+// notification; remaining[instance] is the lifetime it has left, 0 for
+// an indefinite one, or -1 if nothing was restored for the instance.
+#define TEST_INSTANCES  8
+
+static void test_reset(long remaining[TEST_INSTANCES])
+{
+    unsigned first = 0;
+    unsigned i = 0;
+    const host_pdu_t *pdu = NULL;
+    BACNET_OBJECT_ID object;
+    uint32_t time_remaining = 0;
+
+    host_bacnet_reset();
+    for (i = 0; i < TEST_INSTANCES; i++) {
+        remaining[i] = -1;
+    }
+    first = host_datalink_sent();
+    handler_cov_task();
+    for (i = first; i < host_datalink_sent(); i++) {
+        pdu = host_datalink_pdu(i);
+        if (pdu && host_pdu_cov_object(pdu, &object, &time_remaining) &&
+            (object.instance < TEST_INSTANCES)) {
+            remaining[object.instance] = (long)time_remaining;
+        }
+    }
+}
+
+static void test_resume(void)
+{
+    long remaining[TEST_INSTANCES];
+
+    host_bacnet_init();
+    HOST_CHECK(host_bacnet_subscribe(1, 1, OBJECT_ANALOG_VALUE, 1, false,
+                                     600, false));
+    HOST_CHECK(host_bacnet_subscribe(1, 2, OBJECT_ANALOG_VALUE, 2, false, 0,
+                                     false));
+    test_run(500);
+    test_reset(remaining);
+    // 100 s were left; the reset costs at most a checkpoint interval
+    HOST_CHECK(remaining[1] <= 100);
+    HOST_CHECK(remaining[1] >= 100 - TEST_CHECKPOINT);
+    HOST_CHECK_EQ(remaining[2], 0);
+}
+
+// A device that resets every 10 s must not keep a subscription alive:
+// its lifetime runs down across the boots
+static void test_reset_loop(void)
+{
+    long remaining[TEST_INSTANCES];
+    long before = 300;
+    unsigned boots = 0;
+
+    host_bacnet_init();
+    HOST_CHECK(host_bacnet_subscribe(1, 3, OBJECT_ANALOG_VALUE, 3, false,
+                                     300, false));
+    test_run(10);
+    for (boots = 1; boots < 30; boots++) {
+        test_reset(remaining);
+        if (remaining[3] < 0) {
+            break;
+        }
+        HOST_CHECK(remaining[3] > 0);
+        HOST_CHECK(remaining[3] < before);
+        before = remaining[3];
+        test_run(10);
+    }
+    // gone before 300 s of running time
+    HOST_CHECK(boots > 1);
+    HOST_CHECK(boots * 10 <= 300);
+}
+
+// What expired while the device was off is dropped, and the table
+// saved again without it
+static void test_expired(void)
+{
+    long remaining[TEST_INSTANCES];
+
+    host_bacnet_init();
+    HOST_CHECK(host_bacnet_subscribe(1, 4, OBJECT_ANALOG_VALUE, 4, false, 70,
+                                     false));
+    HOST_CHECK(host_bacnet_subscribe(1, 5, OBJECT_ANALOG_VALUE, 5, false, 0,
+                                     false));
+    test_run(5);
+    test_reset(remaining);
+    HOST_CHECK(remaining[4] > 0);
+    HOST_CHECK_EQ(remaining[5], 0);
+    test_reset(remaining);
+    HOST_CHECK_EQ(remaining[4], -1);
+    HOST_CHECK_EQ(remaining[5], 0);
+    test_run(5);
+    test_reset(remaining);
+    HOST_CHECK_EQ(remaining[4], -1);
+    HOST_CHECK_EQ(remaining[5], 0);
+}
+
+// The clock checkpoints are one small write a minute, and only while
+// a subscription has a lifetime
+static void test_writes(void)
+{
+    unsigned writes = 0;
+
+    host_bacnet_init();
+    HOST_CHECK(host_bacnet_subscribe(1, 6, OBJECT_ANALOG_VALUE, 6, false, 0,
+                                     false));
+    test_run(10);
+    writes = nvstore_host_writes();
+    test_run(3600);
+    HOST_CHECK_EQ(nvstore_host_writes(), writes);
+    HOST_CHECK(host_bacnet_subscribe(1, 7, OBJECT_ANALOG_VALUE, 7, false,
+                                     7200, false));
+    test_run(10);
+    writes = nvstore_host_writes();
+    test_run(3600);
+    HOST_CHECK(nvstore_host_writes() - writes <= 3600 / TEST_CHECKPOINT + 1);
+    printf("NVS writes in an hour with a lifetime running: %u\n",
+           nvstore_host_writes() - writes);
+}
+
+// Subscriptions in the table saved in NVS, or -1 if none was saved
+static long test_saved(void)
+{
+    NVSTORE_HANDLE handle = 0;
+    uint16_t count = 0;
+    long saved = -1;
+
+    if (nvstore_open(TEST_NAMESPACE, false, &handle) == NVSTORE_OK) {
+        if (nvstore_get_u16(handle, "count", &count) == NVSTORE_OK) {
+            saved = count;
+        }
+        nvstore_close(handle);
+    }
+
+    return saved;
+}
+
+// Notifications about an object since PDU first
+static unsigned test_notified(unsigned first, uint32_t instance)
+{
+    const host_pdu_t *pdu = NULL;
+    BACNET_OBJECT_ID object;
+    unsigned count = 0;
+    unsigned i = 0;
+
+    for (i = first; i < host_datalink_sent(); i++) {
+        pdu = host_datalink_pdu(i);
+        if (pdu && host_pdu_cov_object(pdu, &object, NULL) &&
+            (object.type == OBJECT_ANALOG_VALUE) &&
+            (object.instance == instance)) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+// A deleted object takes its subscriptions with it, out of RAM at once
+// and out of NVS with the next save: made again under the same
+// identifier, it has no subscribers
+static void test_deleted(void)
+{
+    BACNET_DELETE_OBJECT_DATA data = {
+        OBJECT_ANALOG_VALUE, TEST_CREATED, ERROR_CLASS_OBJECT,
+        ERROR_CODE_OTHER
+    };
+    unsigned first = 0;
+
+    host_bacnet_init();
+    HOST_CHECK(Analog_Value_Create(TEST_CREATED));
+    HOST_CHECK(host_bacnet_subscribe(1, 8, OBJECT_ANALOG_VALUE, TEST_CREATED,
+                                     false, 0, false));
+    HOST_CHECK(host_bacnet_subscribe(2, 9, OBJECT_ANALOG_VALUE, TEST_CREATED,
+                                     false, 600, false));
+    HOST_CHECK(host_bacnet_subscribe(1, 10, OBJECT_ANALOG_VALUE, 1, false, 0,
+                                     false));
+    test_run(TEST_PERSIST_DELAY + 1);
+    HOST_CHECK_EQ(test_saved(), 3);
+
+    // a change waiting to be sent when the object goes
+    Analog_Value_Present_Value_Set(TEST_CREATED, 40.0f, 16);
+    HOST_CHECK(Device_Delete_Object(&data));
+    HOST_CHECK(Analog_Value_Create(TEST_CREATED));
+    first = host_datalink_sent();
+    Analog_Value_Present_Value_Set(TEST_CREATED, 42.0f, 16);
+    Analog_Value_Present_Value_Set(1, 42.0f, 16);
+    handler_cov_task();
+    HOST_CHECK_EQ(test_notified(first, TEST_CREATED), 0);
+    HOST_CHECK_EQ(test_notified(first, 1), 1);
+
+    test_run(TEST_PERSIST_DELAY + 1);
+    HOST_CHECK_EQ(test_saved(), 1);
+    // and the subscriber may subscribe to the new object
+    HOST_CHECK(host_bacnet_subscribe(1, 8, OBJECT_ANALOG_VALUE, TEST_CREATED,
+                                     false, 0, false));
+    test_run(TEST_PERSIST_DELAY + 1);
+    HOST_CHECK_EQ(test_saved(), 2);
+}
+
+int main(void)
+{
+    test_resume();
+    test_reset_loop();
+    test_expired();
+    test_writes();
+    test_deleted();
+
+    return host_check_result("test_cov_persist");
+}
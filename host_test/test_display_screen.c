@@ -0,0 +1,173 @@
+/*
+ * The monitor's screen, rendered on a PC
+ *
+ * The screen table of display_screen.c, drawn by display_widget.c and
+ * display_driver.c into the RAM panel, from the BACnet objects of
+ * main.c.  Each frame, as the board's panel would show it, must match
+ * its golden PPM in data/ byte for byte; a frame that differs is left
+ * in the working directory to look at.  After a change to the screen,
+ * run with --update to write the new goldens, and check them by eye.
+ *
+ *   test_display_screen host_test/data [--update]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_bacnet.h"
+#include "host_check.h"
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+#include "display_driver.h"
+#include "display_panel.h"
+#include "display_screen.h"
+#include "display_widget.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "server_task.h"
+
+#define TEST_PPM_MAX    (64 + DISPLAY_WIDTH * DISPLAY_HEIGHT * 3)
+
+static const char *test_data_dir;
+static bool test_update;
+
+// One thread: nothing to lock the objects against
+void server_objects_lock(void)
+{
+}
+
+void server_objects_unlock(void)
+{
+}
+
+void display_screen_ip(char *text, size_t size)
+{
+    snprintf(text, size, "192.168.1.50");
+}
+
+static long test_read_file(const char *path, uint8_t *buf, size_t size)
+{
+    FILE *file = fopen(path, "rb");
+    size_t length = 0;
+
+    if (file == NULL) {
+        return -1;
+    }
+    length = fread(buf, 1, size, file);
+    fclose(file);
+
+    return (long)length;
+}
+
+// The frame on the panel against data/<name>.ppm
+static void test_frame(const char *name)
+{
+    static uint8_t frame[TEST_PPM_MAX];
+    static uint8_t golden[TEST_PPM_MAX];
+    char golden_path[512];
+    char frame_path[512];
+    long frame_length = 0;
+    long golden_length = 0;
+    long differ = 0;
+    long i = 0;
+
+    snprintf(golden_path, sizeof(golden_path), "%s/%s.ppm", test_data_dir,
+             name);
+    snprintf(frame_path, sizeof(frame_path), "%s.ppm", name);
+    if (test_update) {
+        HOST_CHECK_EQ(display_panel_mem_write_ppm(golden_path), 0);
+        printf("%s written\n", golden_path);
+        return;
+    }
+    HOST_CHECK_EQ(display_panel_mem_write_ppm(frame_path), 0);
+    frame_length = test_read_file(frame_path, frame, sizeof(frame));
+    golden_length = test_read_file(golden_path, golden, sizeof(golden));
+    if (golden_length < 0) {
+        fprintf(stderr, "%s: no golden frame, see %s\n", golden_path,
+                frame_path);
+        HOST_CHECK(golden_length >= 0);
+        return;
+    }
+    HOST_CHECK_EQ(frame_length, golden_length);
+    for (i = 0; (i < frame_length) && (i < golden_length); i++) {
+        differ += frame[i] != golden[i];
+    }
+    if (differ) {
+        fprintf(stderr, "%s: %ld bytes differ from %s\n", frame_path,
+                differ, golden_path);
+    } else {
+        remove(frame_path);
+    }
+    HOST_CHECK_EQ(differ, 0);
+}
+
+// Each value changed notifies the drawing task, and only the widgets
+// of the objects that changed are drawn again
+static void test_update_drawn(unsigned expected)
+{
+    HOST_CHECK(ulTaskNotifyTake(pdTRUE, 0) > 0);
+    HOST_CHECK_EQ(display_widgets_update(), expected);
+}
+
+int main(int argc, char **argv)
+{
+    display_panel_stats_t stats;
+    unsigned i = 0;
+
+    if ((argc < 2) || ((argc == 3) && strcmp(argv[2], "--update")) ||
+        (argc > 3)) {
+        fprintf(stderr, "usage: %s DATA_DIR [--update]\n", argv[0]);
+        return 2;
+    }
+    test_data_dir = argv[1];
+    test_update = (argc == 3);
+    host_bacnet_init();
+    HOST_CHECK_EQ(display_init(), 0);
+
+    display_screen_splash();
+    test_frame("screen_splash");
+
+    // a clean room, fan off
+    Analog_Value_Present_Value_Set(0, 6.4f, 16);
+    Analog_Value_Present_Value_Set(1, 9.8f, 16);
+    Analog_Value_Present_Value_Set(2, 14.1f, 16);
+    Analog_Value_Present_Value_Set(3, 25.0f, 16);
+    Binary_Output_Present_Value_Set(0, BINARY_INACTIVE, 16);
+    Binary_Input_Present_Value_Set(0, BINARY_INACTIVE);
+    Binary_Value_Present_Value_Set(0, BINARY_INACTIVE);
+    display_screen_init();
+    // labels and values, all of them the first time
+    HOST_CHECK_EQ(display_widgets_update(), 19);
+    for (i = 0; i < 40; i++) {
+        display_screen_chart_add(8.0f + (float)(i % 5));
+    }
+    display_flush();
+    test_frame("screen_clean");
+
+    // nothing changed, nothing sent
+    display_panel_stats(&stats, true);
+    HOST_CHECK_EQ(display_widgets_update(), 0);
+    display_panel_stats(&stats, false);
+    HOST_CHECK_EQ(stats.transactions, 0);
+
+    // smoke: PM2.5 past the red threshold, the fan on, a sensor error
+    Analog_Value_Present_Value_Set(1, 48.3f, 16);
+    test_update_drawn(1);
+    Analog_Value_Present_Value_Set(0, 31.0f, 16);
+    Analog_Value_Present_Value_Set(2, 52.7f, 16);
+    Binary_Output_Present_Value_Set(0, BINARY_ACTIVE, 16);
+    Binary_Input_Present_Value_Set(0, BINARY_ACTIVE);
+    Binary_Value_Present_Value_Set(0, BINARY_ACTIVE);
+    test_update_drawn(5);
+    // a change too small to show draws nothing
+    Analog_Value_Present_Value_Set(3, 25.01f, 16);
+    test_update_drawn(0);
+    for (i = 0; i < 60; i++) {
+        display_screen_chart_add(10.0f + (float)i);
+    }
+    display_flush();
+    test_frame("screen_alarm");
+
+    return host_check_result("test_display_screen");
+}
@@ -0,0 +1,325 @@
+/*
+ * PM sensor reader on pseudo-terminals
+ *
+ * pm25_sensor.c as it is, with a pty in place of each UART: the test
+ * writes the sensor's side of both, and reads what the reader task
+ * published.  Each sensor must parse, filter and count its own stream,
+ * whatever the other one does.
+ */
+#define _GNU_SOURCE
+#include <pty.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "host_check.h"
+#include "idf_host.h"
+#include "esp_timer.h"
+#include "pm25_sensor.h"
+#include "pms5003_capture.h"
+
+// as the sensors of sdkconfig.h
+static const uart_port_t test_uart[PM25_SENSOR_COUNT] = {
+    CONFIG_PM25_SENSOR1_UART, CONFIG_PM25_SENSOR2_UART
+};
+// the sensor's side of each pty
+static int test_line[PM25_SENSOR_COUNT];
+static atomic_uint test_notified[PM25_SENSOR_COUNT];
+
+#define TEST_CAPTURE_MAX    4096
+#define TEST_TIMEOUT_US     5000000
+
+static void test_listener(unsigned sensor)
+{
+    if (sensor < PM25_SENSOR_COUNT) {
+        atomic_fetch_add(&test_notified[sensor], 1);
+    }
+}
+
+static void test_send(unsigned sensor, const uint8_t *data, size_t length)
+{
+    ssize_t sent = 0;
+
+    while (length > 0) {
+        sent = write(test_line[sensor], data, length);
+        if (sent <= 0) {
+            HOST_CHECK(sent > 0);
+            return;
+        }
+        data += sent;
+        length -= (size_t)sent;
+    }
+}
+
+// Until the reader has taken everything sent; false on a timeout
+static bool test_drained(unsigned sensor)
+{
+    int64_t start = esp_timer_get_time();
+
+    while (host_uart_pending(test_uart[sensor]) != 0) {
+        if (esp_timer_get_time() - start > TEST_TIMEOUT_US) {
+            return false;
+        }
+        usleep(1000);
+    }
+    // and has published what it read
+    usleep(20000);
+
+    return true;
+}
+
+// Until the sensor has published this many frames
+static bool test_wait_frames(unsigned sensor, uint32_t frames)
+{
+    int64_t start = esp_timer_get_time();
+    pm25_stats_t stats;
+
+    for (;;) {
+        pm25_get_stats(sensor, &stats);
+        if (stats.frames >= frames) {
+            return true;
+        }
+        if (esp_timer_get_time() - start > TEST_TIMEOUT_US) {
+            return false;
+        }
+        usleep(1000);
+    }
+}
+
+// Until a counter of the sensor, at offset in pm25_stats_t, reaches
+// a value
+static bool test_wait_stats(unsigned sensor, size_t offset, uint32_t value)
+{
+    int64_t start = esp_timer_get_time();
+    pm25_stats_t stats;
+    uint32_t counter = 0;
+
+    for (;;) {
+        pm25_get_stats(sensor, &stats);
+        memcpy(&counter, (const char *)&stats + offset, sizeof(counter));
+        if (counter >= value) {
+            return true;
+        }
+        if (esp_timer_get_time() - start > TEST_TIMEOUT_US) {
+            return false;
+        }
+        usleep(1000);
+    }
+}
+
+static void test_frame(uint16_t pm2_5, uint8_t buf[PMS5003_FRAME_SIZE])
+{
+    uint16_t words[14] = { PMS5003_FRAME_LEN };
+    uint16_t sum = 0;
+    unsigned i = 0;
+
+    words[1] = (uint16_t)(pm2_5 * 7 / 10);
+    words[2] = pm2_5;
+    words[3] = (uint16_t)(pm2_5 * 6 / 5);
+    words[4] = words[1];
+    words[5] = words[2];
+    words[6] = words[3];
+    words[7] = (uint16_t)(200 + 100 * pm2_5);
+    buf[0] = PMS5003_START1;
+    buf[1] = PMS5003_START2;
+    for (i = 0; i < 14; i++) {
+        buf[2 + 2 * i] = (uint8_t)(words[i] >> 8);
+        buf[3 + 2 * i] = (uint8_t)(words[i] & 0xFF);
+    }
+    for (i = 0; i < PMS5003_FRAME_SIZE - 2; i++) {
+        sum += buf[i];
+    }
+    buf[PMS5003_FRAME_SIZE - 2] = (uint8_t)(sum >> 8);
+    buf[PMS5003_FRAME_SIZE - 1] = (uint8_t)(sum & 0xFF);
+}
+
+static void test_check_stats(unsigned sensor, const pm25_stats_t *expected)
+{
+    pm25_stats_t stats;
+
+    pm25_get_stats(sensor, &stats);
+    HOST_CHECK_EQ(stats.frames, expected->frames);
+    HOST_CHECK_EQ(stats.checksum_errors, expected->checksum_errors);
+    HOST_CHECK_EQ(stats.length_errors, expected->length_errors);
+    HOST_CHECK_EQ(stats.resyncs, expected->resyncs);
+    HOST_CHECK_EQ(stats.discarded, expected->discarded);
+    HOST_CHECK_EQ(stats.overflows, expected->overflows);
+    HOST_CHECK_EQ(stats.line_errors, expected->line_errors);
+}
+
+// Both captures at once, interleaved in chunks of random size: each
+// sensor counts as test_pms5003_parser does with its capture alone
+static void test_captures(const char *dir)
+{
+    static uint8_t capture[PM25_SENSOR_COUNT][TEST_CAPTURE_MAX];
+    const char *name[PM25_SENSOR_COUNT] = {
+        "pms5003_clean.hex", "pms5003_faults.hex"
+    };
+    const pm25_stats_t expected[PM25_SENSOR_COUNT] = {
+        { .frames = 8, .discarded = 11 },
+        { .frames = 7, .checksum_errors = 2, .length_errors = 3,
+          .resyncs = 6, .discarded = 106 },
+    };
+    long length[PM25_SENSOR_COUNT];
+    size_t sent[PM25_SENSOR_COUNT] = { 0 };
+    char path[512];
+    pms5003_frame_t frame;
+    unsigned sensor = 0;
+    size_t chunk = 0;
+
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        snprintf(path, sizeof(path), "%s/%s", dir, name[sensor]);
+        length[sensor] = pms5003_capture_read(path, capture[sensor],
+                                              TEST_CAPTURE_MAX);
+        HOST_CHECK(length[sensor] > 0);
+        if (length[sensor] <= 0) {
+            return;
+        }
+    }
+    srand(3);
+    while ((sent[0] < (size_t)length[0]) || (sent[1] < (size_t)length[1])) {
+        sensor = (unsigned)rand() % PM25_SENSOR_COUNT;
+        chunk = 1 + (size_t)rand() % 40;
+        if (chunk > (size_t)length[sensor] - sent[sensor]) {
+            chunk = (size_t)length[sensor] - sent[sensor];
+        }
+        test_send(sensor, &capture[sensor][sent[sensor]], chunk);
+        sent[sensor] += chunk;
+        if ((rand() % 4) == 0) {
+            usleep(500);
+        }
+    }
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        HOST_CHECK(test_wait_frames(sensor, expected[sensor].frames));
+        HOST_CHECK(test_drained(sensor));
+        test_check_stats(sensor, &expected[sensor]);
+        // told at least once, and never more than once per frame
+        HOST_CHECK(atomic_load(&test_notified[sensor]) >= 1);
+        HOST_CHECK(atomic_load(&test_notified[sensor]) <=
+                   expected[sensor].frames);
+    }
+    HOST_CHECK(pm25_get_frame(0, &frame));
+    HOST_CHECK_EQ(frame.pm2_5_standard, 12);
+    HOST_CHECK(pm25_get_frame(1, &frame));
+    HOST_CHECK_EQ(frame.pm2_5_standard, 29);
+}
+
+// One frame at a time to sensor 1: each is published with its number and
+// time, and the filtered channels follow a pm_filter fed the same values
+static void test_publish(void)
+{
+    pm_filter_config_t config;
+    pm_filter_t filter;
+    pm25_snapshot_t snapshot;
+    pm25_stats_t stats;
+    uint8_t buf[PMS5003_FRAME_SIZE];
+    const uint16_t values[] = { 30, 31, 29, 400, 30, 32, 33, 35, 31, 30 };
+    pm_filter_config_t bad = { 4, 1, 1.0f };
+    int64_t last_us = 0;
+    unsigned notified = atomic_load(&test_notified[1]);
+    unsigned i = 0;
+
+    // new parameters restart the filter with the next frame, so it
+    // follows one started here
+    HOST_CHECK(pm25_get_filter(1, PM25_CHANNEL_PM2_5, &config));
+    config.median_window = 3;
+    config.mean_window = 2;
+    HOST_CHECK(pm25_set_filter(1, PM25_CHANNEL_PM2_5, &config));
+    pm_filter_init(&filter, &config);
+    pm25_get_stats(1, &stats);
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        test_frame(values[i], buf);
+        test_send(1, buf, sizeof(buf));
+        HOST_CHECK(test_wait_frames(1, stats.frames + i + 1));
+        pm25_get_snapshot(1, &snapshot);
+        HOST_CHECK_EQ(snapshot.sequence, stats.frames + i + 1);
+        HOST_CHECK_EQ(snapshot.frame.pm2_5_standard, values[i]);
+        HOST_CHECK(snapshot.time_us > last_us);
+        last_us = snapshot.time_us;
+        HOST_CHECK(snapshot.filtered[PM25_CHANNEL_PM2_5] ==
+                   pm_filter_update(&filter, (float)values[i]));
+        HOST_CHECK(pm25_get_pm2_5(1) == snapshot.filtered[PM25_CHANNEL_PM2_5]);
+        HOST_CHECK(pm25_get_raw(1, PM25_CHANNEL_PM2_5) == (float)values[i]);
+        HOST_CHECK_EQ(atomic_load(&test_notified[1]), notified + i + 1);
+    }
+    // the spike of 400 never came through the median
+    HOST_CHECK(pm25_get_pm2_5(1) < 40.0f);
+    HOST_CHECK(!pm25_set_filter(1, PM25_CHANNEL_PM2_5, &bad));
+    HOST_CHECK(!pm25_set_filter(1, PM25_CHANNEL_PARTICLES_03UM, &config));
+}
+
+// Sensor 0 loses bytes mid-frame: the driver reports an overflow, and
+// the rest of that frame must not be joined to what came before
+static void test_overflow(void)
+{
+    pm25_stats_t before;
+    pm25_stats_t other;
+    pm25_stats_t stats;
+    pm25_stats_t expected;
+    uint8_t buf[PMS5003_FRAME_SIZE];
+
+    pm25_get_stats(0, &before);
+    pm25_get_stats(1, &other);
+    test_frame(50, buf);
+    test_send(0, buf, PMS5003_FRAME_SIZE / 2);
+    HOST_CHECK(test_drained(0));
+    host_uart_event(test_uart[0], UART_FIFO_OVF);
+    // the driver flushes what is buffered when it reports the overflow
+    HOST_CHECK(test_wait_stats(0, offsetof(pm25_stats_t, overflows),
+                               before.overflows + 1));
+    test_send(0, &buf[PMS5003_FRAME_SIZE / 2], PMS5003_FRAME_SIZE / 2);
+    test_send(0, buf, sizeof(buf));
+    HOST_CHECK(test_wait_frames(0, before.frames + 1));
+    HOST_CHECK(test_drained(0));
+    expected = before;
+    expected.frames++;
+    expected.overflows++;
+    // the second half of the broken frame
+    expected.discarded += PMS5003_FRAME_SIZE / 2;
+    expected.resyncs++;
+    test_check_stats(0, &expected);
+
+    // a line error does the same, and counts as one
+    test_send(0, buf, PMS5003_FRAME_SIZE / 2);
+    HOST_CHECK(test_drained(0));
+    host_uart_event(test_uart[0], UART_FRAME_ERR);
+    HOST_CHECK(test_wait_stats(0, offsetof(pm25_stats_t, line_errors),
+                               expected.line_errors + 1));
+    test_send(0, &buf[PMS5003_FRAME_SIZE / 2], PMS5003_FRAME_SIZE / 2);
+    test_send(0, buf, sizeof(buf));
+    HOST_CHECK(test_wait_frames(0, expected.frames + 1));
+    HOST_CHECK(test_drained(0));
+    expected.frames++;
+    expected.line_errors++;
+    expected.discarded += PMS5003_FRAME_SIZE / 2;
+    expected.resyncs++;
+    test_check_stats(0, &expected);
+
+    // the other sensor saw none of it
+    pm25_get_stats(1, &stats);
+    HOST_CHECK(memcmp(&stats, &other, sizeof(stats)) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = (argc > 1) ? argv[1] : "data";
+    int uart_side = -1;
+    unsigned sensor = 0;
+
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        if (openpty(&test_line[sensor], &uart_side, NULL, NULL, NULL) < 0) {
+            perror("openpty");
+            return 1;
+        }
+        HOST_CHECK(host_uart_attach(test_uart[sensor], uart_side));
+    }
+    pm25_set_listener(test_listener);
+    pm25_sensor_init();
+
+    test_captures(dir);
+    test_publish();
+    test_overflow();
+
+    return host_check_result("test_pm25_sensor");
+}
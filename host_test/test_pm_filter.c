@@ -0,0 +1,194 @@
+/*
+ * PM channel filters
+ *
+ * Each stage against a plain computation over the same window, on random
+ * streams with repeated values and outliers, and the pipeline on a step
+ * with a spike in it.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_check.h"
+#include "pm_filter.h"
+
+#define TEST_SAMPLES    20000
+
+static uint32_t test_rng = 1;
+
+// xorshift32, as pms5003_sim.c
+static uint32_t test_random(void)
+{
+    uint32_t x = test_rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    test_rng = x;
+
+    return x;
+}
+
+// A PM2.5 reading: whole ug/m3, so values repeat, and now and then a spike
+static float test_sample(void)
+{
+    if ((test_random() % 50) == 0) {
+        return (float)(500 + test_random() % 500);
+    }
+
+    return (float)(10 + test_random() % 8);
+}
+
+static int test_compare(const void *a, const void *b)
+{
+    float x = *(const float *)a;
+    float y = *(const float *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void test_config_valid(void)
+{
+    pm_filter_config_t config = { 5, 4, 0.3f };
+
+    HOST_CHECK(pm_filter_config_valid(&config));
+    config.median_window = 4;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.median_window = PM_FILTER_MEDIAN_MAX + 2;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.median_window = 0;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.median_window = 1;
+    config.mean_window = 0;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.mean_window = PM_FILTER_MEAN_MAX + 1;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.mean_window = PM_FILTER_MEAN_MAX;
+    HOST_CHECK(pm_filter_config_valid(&config));
+    config.ema_alpha = 0.0f;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.ema_alpha = 1.5f;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.ema_alpha = NAN;
+    HOST_CHECK(!pm_filter_config_valid(&config));
+    config.ema_alpha = 1.0f;
+    HOST_CHECK(pm_filter_config_valid(&config));
+}
+
+// Every stage off: the samples go through as they are
+static void test_off(void)
+{
+    pm_filter_config_t config = { 1, 1, 1.0f };
+    pm_filter_t filter;
+    unsigned i = 0;
+    float sample = 0.0f;
+
+    pm_filter_init(&filter, &config);
+    for (i = 0; i < 1000; i++) {
+        sample = test_sample();
+        HOST_CHECK(pm_filter_update(&filter, sample) == sample);
+    }
+}
+
+// The median of the samples seen so far, up to a full window
+static void test_median(unsigned window)
+{
+    pm_filter_config_t config = { (uint8_t)window, 1, 1.0f };
+    pm_filter_t filter;
+    float history[TEST_SAMPLES];
+    float sorted[PM_FILTER_MEDIAN_MAX];
+    unsigned count = 0;
+    unsigned i = 0;
+
+    pm_filter_init(&filter, &config);
+    for (i = 0; i < TEST_SAMPLES; i++) {
+        history[i] = test_sample();
+        count = (i + 1 < window) ? i + 1 : window;
+        memcpy(sorted, &history[i + 1 - count], count * sizeof(float));
+        qsort(sorted, count, sizeof(float), test_compare);
+        HOST_CHECK_EQ(pm_filter_update(&filter, history[i]),
+                      sorted[count / 2]);
+    }
+}
+
+static void test_ema(void)
+{
+    pm_filter_config_t config = { 1, 1, 0.5f };
+    pm_filter_t filter;
+
+    pm_filter_init(&filter, &config);
+    // the first sample starts the average
+    HOST_CHECK(pm_filter_update(&filter, 8.0f) == 8.0f);
+    HOST_CHECK(pm_filter_update(&filter, 16.0f) == 12.0f);
+    HOST_CHECK(pm_filter_update(&filter, 16.0f) == 14.0f);
+    HOST_CHECK(pm_filter_update(&filter, 16.0f) == 15.0f);
+    HOST_CHECK(pm_filter_update(&filter, 0.0f) == 7.5f);
+}
+
+// The running sum against the sum over the window, for long enough that
+// rounding would show if it built up
+static void test_mean(unsigned window)
+{
+    pm_filter_config_t config = { 1, (uint8_t)window, 1.0f };
+    pm_filter_t filter;
+    float history[TEST_SAMPLES];
+    unsigned count = 0;
+    unsigned i = 0;
+    unsigned j = 0;
+    double sum = 0.0;
+    float value = 0.0f;
+
+    pm_filter_init(&filter, &config);
+    for (i = 0; i < TEST_SAMPLES; i++) {
+        // fractional values, as the EMA hands on
+        history[i] = test_sample() + (float)(test_random() % 1000) / 1000.0f;
+        count = (i + 1 < window) ? i + 1 : window;
+        sum = 0.0;
+        for (j = i + 1 - count; j <= i; j++) {
+            sum += history[j];
+        }
+        value = pm_filter_update(&filter, history[i]);
+        HOST_CHECK(fabs(value - sum / count) < 0.01);
+    }
+}
+
+// The default pipeline on a step from 10 to 30 with a spike before it:
+// the spike never reaches the output, and the step is followed
+static void test_pipeline(void)
+{
+    pm_filter_config_t config = { 5, 4, 0.3f };
+    pm_filter_t filter;
+    unsigned i = 0;
+    float value = 0.0f;
+
+    pm_filter_init(&filter, &config);
+    for (i = 0; i < 20; i++) {
+        value = pm_filter_update(&filter, (i == 10) ? 999.0f : 10.0f);
+        HOST_CHECK(value == 10.0f);
+    }
+    for (i = 0; i < 60; i++) {
+        value = pm_filter_update(&filter, 30.0f);
+        HOST_CHECK((value >= 10.0f) && (value <= 30.0f));
+    }
+    HOST_CHECK(fabs(value - 30.0f) < 0.01);
+    // init starts over
+    pm_filter_init(&filter, &config);
+    HOST_CHECK(pm_filter_update(&filter, 5.0f) == 5.0f);
+}
+
+int main(void)
+{
+    unsigned window = 0;
+
+    test_config_valid();
+    test_off();
+    for (window = 3; window <= PM_FILTER_MEDIAN_MAX; window += 2) {
+        test_median(window);
+    }
+    test_ema();
+    for (window = 2; window <= PM_FILTER_MEAN_MAX; window++) {
+        test_mean(window);
+    }
+    test_pipeline();
+
+    return host_check_result("test_pm_filter");
+}
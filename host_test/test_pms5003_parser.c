@@ -0,0 +1,148 @@
+/*
+ * PMS5003 parser against captured streams
+ *
+ * Each capture is fed in chunks of every size, and split in two at every
+ * byte, as the UART driver may hand it over: the frames and the counters
+ * must come out the same every time.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "host_check.h"
+#include "pms5003_capture.h"
+#include "pms5003_parser.h"
+
+#define TEST_CAPTURE_MAX    4096
+
+typedef struct {
+    uint32_t frames;
+    uint32_t checksum_errors;
+    uint32_t length_errors;
+    uint32_t resyncs;
+    uint32_t discarded;
+    uint16_t pm2_5[16];         // PM2.5 of the first frames
+} test_result_t;
+
+static uint8_t test_capture[TEST_CAPTURE_MAX];
+
+static void test_result(const pms5003_parser_t *parser, test_result_t *result)
+{
+    result->frames = parser->frames;
+    result->checksum_errors = parser->checksum_errors;
+    result->length_errors = parser->length_errors;
+    result->resyncs = parser->resyncs;
+    result->discarded = parser->discarded;
+}
+
+// Feed data[0..length) in chunks; split[] ends each chunk but the last
+static void test_feed(const uint8_t *data, size_t length,
+                      const size_t *split, size_t splits,
+                      test_result_t *result)
+{
+    pms5003_parser_t parser;
+    pms5003_frame_t frame;
+    size_t start = 0;
+    size_t end = 0;
+    size_t chunk = 0;
+    size_t i = 0;
+
+    memset(result, 0, sizeof(*result));
+    pms5003_parser_init(&parser);
+    for (chunk = 0; chunk <= splits; chunk++) {
+        end = (chunk < splits) ? split[chunk] : length;
+        for (i = start; i < end; i++) {
+            if (pms5003_parser_feed(&parser, data[i], &frame) &&
+                (parser.frames <= 16)) {
+                result->pm2_5[parser.frames - 1] = frame.pm2_5_standard;
+            }
+        }
+        start = end;
+    }
+    test_result(&parser, result);
+}
+
+static void test_check(const test_result_t *result,
+                       const test_result_t *expected)
+{
+    HOST_CHECK_EQ(result->frames, expected->frames);
+    HOST_CHECK_EQ(result->checksum_errors, expected->checksum_errors);
+    HOST_CHECK_EQ(result->length_errors, expected->length_errors);
+    HOST_CHECK_EQ(result->resyncs, expected->resyncs);
+    HOST_CHECK_EQ(result->discarded, expected->discarded);
+    HOST_CHECK(memcmp(result->pm2_5, expected->pm2_5,
+                      sizeof(result->pm2_5)) == 0);
+}
+
+// The capture in one piece, in chunks of 1..64 bytes, and in two pieces
+// split at every byte, which among others cuts each frame between its
+// start bytes and between the start bytes and the frame length
+static void test_capture_file(const char *dir, const char *name,
+                              const test_result_t *expected)
+{
+    char path[512];
+    size_t split[TEST_CAPTURE_MAX];
+    test_result_t result;
+    size_t chunk = 0;
+    size_t i = 0;
+    long length = 0;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    length = pms5003_capture_read(path, test_capture, sizeof(test_capture));
+    HOST_CHECK(length > 0);
+    if (length <= 0) {
+        return;
+    }
+    test_feed(test_capture, (size_t)length, NULL, 0, &result);
+    test_check(&result, expected);
+    for (chunk = 1; chunk <= 64; chunk++) {
+        for (i = 0; (i + 1) * chunk < (size_t)length; i++) {
+            split[i] = (i + 1) * chunk;
+        }
+        test_feed(test_capture, (size_t)length, split, i, &result);
+        test_check(&result, expected);
+    }
+    for (i = 1; i < (size_t)length; i++) {
+        split[0] = i;
+        test_feed(test_capture, (size_t)length, split, 1, &result);
+        test_check(&result, expected);
+    }
+}
+
+// Joined mid-frame: the tail of that frame is skipped, and no resync is
+// counted before the first frame
+static void test_clean(const char *dir)
+{
+    test_result_t expected = {
+        .frames = 8,
+        .discarded = 11,
+        .pm2_5 = { 13, 11, 12, 14, 15, 13, 12, 12 },
+    };
+
+    test_capture_file(dir, "pms5003_clean.hex", &expected);
+}
+
+// Link faults; the comments of the capture say which frames are lost
+static void test_faults(const char *dir)
+{
+    test_result_t expected = {
+        .frames = 7,
+        .checksum_errors = 2,
+        .length_errors = 3,
+        .resyncs = 6,
+        // bad checksum 32, lost byte 32 + 31, garbage 2, cut start
+        // bytes 2 + 3 + 4
+        .discarded = 32 + 32 + 31 + 2 + 2 + 3 + 4,
+        .pm2_5 = { 20, 22, 25, 26, 27, 28, 29 },
+    };
+
+    test_capture_file(dir, "pms5003_faults.hex", &expected);
+}
+
+int main(int argc, char **argv)
+{
+    const char *dir = (argc > 1) ? argv[1] : "data";
+
+    test_clean(dir);
+    test_faults(dir);
+
+    return host_check_result("test_pms5003_parser");
+}
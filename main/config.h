@@ -2,10 +2,11 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "sdkconfig.h"
+
 // Use BACNET_ prefix to avoid confusion with ESP-IDF CONFIG_ macros
 //#define BACNET_SERVER_DEVICE_ID 123456
 #define BACNET_IP_PORT 47808
-#define MAX_ANALOG_VALUES 3
 
 
 #endif
\ No newline at end of file
@@ -0,0 +1,500 @@
+/*
+ * Control task: runs the BACnet Loop objects
+ *
+ * Each loop reads its controlled variable and setpoint from the objects
+ * its references name and commands the object its manipulated variable
+ * reference names, at its own Update_Interval.  One task runs them all,
+ * waking when the next loop is due.  A new sensor frame or a written
+ * value also wakes it, and on/off loops act on those at once.
+ *
+ * It runs above the BACnet server task, so network traffic can hold it
+ * up by one step of the server at most, never by a backlog of packets.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+#include "lo.h"
+#include "pm25_sensor.h"
+#include "point_binding.h"
+#include "server_task.h"
+#include "control_task.h"
+
+static const char *TAG = "CONTROL";
+
+/** Object instance definitions (must match main.c) */
+#define PM2_5_OBJECT_INSTANCE           1
+#define PM2_5_SETPOINT_OBJECT_INSTANCE  3
+#define FAN_COMMAND_OBJECT_INSTANCE     0
+#define SENSOR_ERROR_OBJECT_INSTANCE    0
+#define FAN_LOOP_OBJECT_INSTANCE        0
+
+// The sensor whose frames wake the loops and set SENSOR_ERROR
+#define CONTROL_SENSOR                  0
+// With no loop due the task still wakes this often, to notice a sensor
+// that has gone quiet
+#define CONTROL_IDLE_MS                 1000
+#define SENSOR_TIMEOUT_MS               30000
+// Log the sample-to-actuation latency once per this many samples
+#define CONTROL_REPORT_SAMPLES          60
+
+// Why the task was woken, as task notification bits
+#define CONTROL_EVENT_SAMPLE            0x01
+#define CONTROL_EVENT_WRITE             0x02
+
+// Running state of one loop, restarted whenever its settings change
+typedef struct {
+    uint32_t generation;        // of the settings this state belongs to
+    bool started;
+    int64_t next_us;            // when the loop is next due
+    int64_t last_us;            // last evaluation, for the PID time step
+    float integral;             // PID integral term, in output units
+    float prior_value;          // controlled variable at the last evaluation
+    float output;
+    bool written;               // output has been written since the start
+    float written_output;
+} control_loop_t;
+
+// One evaluation of a loop: its inputs are copied under the lock, the
+// output computed without it, and written back under it again
+typedef struct {
+    BACNET_LOOP_SETTINGS settings;
+    uint32_t generation;
+    bool active;                // configured, so it has an Update_Interval
+    bool due;
+    bool out_of_service;
+    BACNET_RELIABILITY reliability;
+    float controlled_value;
+    uint16_t controlled_units;
+    float setpoint;
+    float output;
+    bool output_changed;
+} control_pass_t;
+
+// Time from the last byte of a frame being parsed to the loops having
+// written the outputs that follow from it, over the report window
+typedef struct {
+    uint32_t samples;
+    int64_t min_us;
+    int64_t max_us;
+    int64_t total_us;
+} control_latency_t;
+
+static TaskHandle_t control_handle = NULL;
+static control_loop_t control_loops[MAX_LOOPS];
+static control_pass_t control_passes[MAX_LOOPS];
+static control_latency_t control_latency;
+
+// Runs in the sensor reader task
+static void control_sensor_listener(unsigned sensor)
+{
+    if ((sensor == CONTROL_SENSOR) && (control_handle != NULL)) {
+        xTaskNotify(control_handle, CONTROL_EVENT_SAMPLE, eSetBits);
+    }
+}
+
+// Runs in the server task, while it handles the WriteProperty: a
+// setpoint, or a controlled variable that is out of service
+static void control_value_written(uint32_t object_instance)
+{
+    if (control_handle != NULL) {
+        xTaskNotify(control_handle, CONTROL_EVENT_WRITE, eSetBits);
+    }
+}
+
+void control_task_init(void)
+{
+    BACNET_LOOP_SETTINGS settings;
+
+    // FAN_CONTROL: the fan runs while PM2.5 is above its setpoint
+    Loop_Settings(FAN_LOOP_OBJECT_INSTANCE, &settings, NULL);
+    Loop_Reference_Set(&settings.Controlled_Variable_Reference,
+                       OBJECT_ANALOG_VALUE, PM2_5_OBJECT_INSTANCE);
+    Loop_Reference_Set(&settings.Setpoint_Reference,
+                       OBJECT_ANALOG_VALUE, PM2_5_SETPOINT_OBJECT_INSTANCE);
+    Loop_Reference_Set(&settings.Manipulated_Variable_Reference,
+                       OBJECT_BINARY_OUTPUT, FAN_COMMAND_OBJECT_INSTANCE);
+    settings.Mode = LOOP_MODE_ON_OFF;
+    settings.Action = ACTION_DIRECT;
+    // on above setpoint + 1, off below setpoint - 1 ug/m3
+    settings.Deadband = 2.0f;
+    settings.Update_Interval = 1000;
+    // the lowest priority, so operators win
+    settings.Priority_For_Writing = BACNET_MAX_PRIORITY;
+    Loop_Settings_Set(FAN_LOOP_OBJECT_INSTANCE, &settings);
+    Loop_Name_Set(FAN_LOOP_OBJECT_INSTANCE, "FAN_CONTROL");
+}
+
+// Present_Value of a referenced object; binary objects read as 0 or 1
+static bool control_read(const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *reference,
+                         float *value, uint16_t *units)
+{
+    uint32_t instance = reference->objectIdentifier.instance;
+
+    *units = UNITS_NO_UNITS;
+    switch (reference->objectIdentifier.type) {
+    case OBJECT_ANALOG_VALUE:
+        if (!Analog_Value_Valid_Instance(instance)) {
+            return false;
+        }
+        *value = Analog_Value_Present_Value(instance);
+        *units = Analog_Value_Units(instance);
+        return true;
+    case OBJECT_BINARY_INPUT:
+        if (!Binary_Input_Valid_Instance(instance)) {
+            return false;
+        }
+        *value = (Binary_Input_Present_Value(instance) == BINARY_ACTIVE) ? 1.0f : 0.0f;
+        return true;
+    case OBJECT_BINARY_OUTPUT:
+        if (!Binary_Output_Valid_Instance(instance)) {
+            return false;
+        }
+        *value = (Binary_Output_Present_Value(instance) == BINARY_ACTIVE) ? 1.0f : 0.0f;
+        return true;
+    case OBJECT_BINARY_VALUE:
+        if (!Binary_Value_Valid_Instance(instance)) {
+            return false;
+        }
+        *value = (Binary_Value_Present_Value(instance) == BINARY_ACTIVE) ? 1.0f : 0.0f;
+        return true;
+    case OBJECT_LOOP:
+        // cascaded loops: the output of one is the setpoint of another
+        if (!Loop_Valid_Instance(instance)) {
+            return false;
+        }
+        *value = Loop_Present_Value(instance);
+        *units = UNITS_PERCENT;
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+// Command the manipulated variable.  A binary object is active while the
+// output is in the upper half of its range.
+static bool control_write(const control_pass_t *pass, float output)
+{
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *reference =
+        &pass->settings.Manipulated_Variable_Reference;
+    uint32_t instance = reference->objectIdentifier.instance;
+    uint8_t priority = pass->settings.Priority_For_Writing;
+    float midpoint = (pass->settings.Maximum_Output +
+                      pass->settings.Minimum_Output) / 2.0f;
+    BACNET_BINARY_PV state = (output > midpoint) ? BINARY_ACTIVE : BINARY_INACTIVE;
+
+    switch (reference->objectIdentifier.type) {
+    case OBJECT_ANALOG_VALUE:
+        return Analog_Value_Present_Value_Set(instance, output, priority);
+    case OBJECT_BINARY_OUTPUT:
+        return Binary_Output_Present_Value_Set(instance, state, priority);
+    case OBJECT_BINARY_VALUE:
+        // Binary Values take local writes at the lowest priority only
+        return Binary_Value_Present_Value_Set(instance, state);
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static float control_clamp(float value, float min, float max)
+{
+    if (value < min) {
+        return min;
+    }
+    if (value > max) {
+        return max;
+    }
+
+    return value;
+}
+
+// The output of one loop, from the inputs in its pass
+static float control_evaluate(control_loop_t *loop, const control_pass_t *pass,
+                              int64_t now_us)
+{
+    const BACNET_LOOP_SETTINGS *settings = &pass->settings;
+    float sign = (settings->Action == ACTION_DIRECT) ? 1.0f : -1.0f;
+    // direct action: the output rises as the controlled variable rises
+    float error = sign * (pass->controlled_value - pass->setpoint);
+    float half_band = settings->Deadband / 2.0f;
+    float dt = settings->Update_Interval / 1000.0f;
+    float derivative = 0.0f;
+    float output = 0.0f;
+
+    if (!loop->started) {
+        loop->integral = 0.0f;
+        loop->prior_value = pass->controlled_value;
+        loop->output = settings->Minimum_Output;
+        loop->started = true;
+    } else if (now_us > loop->last_us) {
+        dt = (now_us - loop->last_us) / 1000000.0f;
+    }
+    loop->last_us = now_us;
+
+    if (settings->Mode == LOOP_MODE_ON_OFF) {
+        if (error > half_band) {
+            loop->output = settings->Maximum_Output;
+        } else if (error < -half_band) {
+            loop->output = settings->Minimum_Output;
+        }
+        // inside the band the output stays as it was
+        loop->prior_value = pass->controlled_value;
+        return loop->output;
+    }
+
+    // PID, with the derivative taken on the controlled variable so a
+    // setpoint step does not kick the output, and the integral clamped
+    // to what the output range can use
+    loop->integral += settings->Integral_Constant * error * dt;
+    loop->integral = control_clamp(loop->integral,
+                                   settings->Minimum_Output - settings->Bias,
+                                   settings->Maximum_Output - settings->Bias);
+    if (dt > 0.0f) {
+        derivative = sign * (pass->controlled_value - loop->prior_value) / dt;
+    }
+    loop->prior_value = pass->controlled_value;
+    output = settings->Bias + settings->Proportional_Constant * error +
+             loop->integral + settings->Derivative_Constant * derivative;
+    loop->output = control_clamp(output, settings->Minimum_Output,
+                                 settings->Maximum_Output);
+
+    return loop->output;
+}
+
+static void control_latency_record(int64_t latency_us)
+{
+    control_latency_t *latency = &control_latency;
+
+    if ((latency->samples == 0) || (latency_us < latency->min_us)) {
+        latency->min_us = latency_us;
+    }
+    if (latency_us > latency->max_us) {
+        latency->max_us = latency_us;
+    }
+    latency->total_us += latency_us;
+    latency->samples++;
+    if (latency->samples >= CONTROL_REPORT_SAMPLES) {
+        ESP_LOGI(TAG, "Sample to actuation: min=%lld, avg=%lld, max=%lld us "
+                 "over %lu samples", (long long)latency->min_us,
+                 (long long)(latency->total_us / latency->samples),
+                 (long long)latency->max_us, (unsigned long)latency->samples);
+        memset(latency, 0, sizeof(*latency));
+    }
+}
+
+// Copy what the due loops read.  Called with the lock held.
+static void control_gather(uint32_t events, int64_t now_us)
+{
+    control_pass_t *pass = NULL;
+    control_loop_t *loop = NULL;
+    uint16_t units = UNITS_NO_UNITS;
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_LOOPS; i++) {
+        pass = &control_passes[i];
+        loop = &control_loops[i];
+        memset(pass, 0, sizeof(*pass));
+        Loop_Settings(Loop_Index_To_Instance(i), &pass->settings,
+                      &pass->generation);
+        if (pass->generation != loop->generation) {
+            memset(loop, 0, sizeof(*loop));
+            loop->generation = pass->generation;
+            loop->next_us = now_us;
+        }
+        // an unconfigured loop is idle
+        if (Loop_Reference_Empty(&pass->settings.Controlled_Variable_Reference) ||
+            Loop_Reference_Empty(&pass->settings.Manipulated_Variable_Reference)) {
+            continue;
+        }
+        pass->active = true;
+        pass->due = (now_us >= loop->next_us) ||
+            ((events != 0) && (pass->settings.Mode == LOOP_MODE_ON_OFF));
+        if (!pass->due) {
+            continue;
+        }
+        pass->out_of_service = Loop_Out_Of_Service(Loop_Index_To_Instance(i));
+        pass->reliability = RELIABILITY_NO_FAULT_DETECTED;
+        // kept if the loop cannot run
+        pass->output = loop->output;
+        pass->setpoint = pass->settings.Setpoint;
+        if (!control_read(&pass->settings.Controlled_Variable_Reference,
+                          &pass->controlled_value, &pass->controlled_units)) {
+            pass->reliability = RELIABILITY_CONFIGURATION_ERROR;
+        }
+        if (!Loop_Reference_Empty(&pass->settings.Setpoint_Reference) &&
+            !control_read(&pass->settings.Setpoint_Reference,
+                          &pass->setpoint, &units)) {
+            pass->reliability = RELIABILITY_CONFIGURATION_ERROR;
+        }
+        if (pass->out_of_service) {
+            // the loop passes on the value written to it
+            pass->output = Loop_Present_Value(Loop_Index_To_Instance(i));
+        }
+    }
+}
+
+// Write the outputs of the due loops.  Called with the lock held.
+static void control_apply(void)
+{
+    control_pass_t *pass = NULL;
+    control_loop_t *loop = NULL;
+    unsigned i = 0;
+
+    for (i = 0; i < MAX_LOOPS; i++) {
+        pass = &control_passes[i];
+        loop = &control_loops[i];
+        if (!pass->due) {
+            continue;
+        }
+        // write only what changed, so an operator's relinquish of a
+        // higher priority is not undone by a stream of equal commands
+        if ((pass->reliability == RELIABILITY_NO_FAULT_DETECTED) &&
+            (!loop->written || (loop->written_output != pass->output))) {
+            if (control_write(pass, pass->output)) {
+                pass->output_changed = true;
+                loop->written = true;
+                loop->written_output = pass->output;
+            } else {
+                pass->reliability = RELIABILITY_CONFIGURATION_ERROR;
+            }
+        }
+        Loop_Update(Loop_Index_To_Instance(i), pass->controlled_value,
+                    pass->controlled_units, pass->setpoint, pass->output,
+                    pass->reliability);
+    }
+}
+
+// Bring SENSOR_ERROR in line with the age of the sensor data.  Called
+// with the lock held; true if it changed.
+static bool control_sensor_error(BACNET_BINARY_PV error_state)
+{
+    if (Binary_Value_Valid_Instance(SENSOR_ERROR_OBJECT_INSTANCE) &&
+        (Binary_Value_Present_Value(SENSOR_ERROR_OBJECT_INSTANCE) != error_state)) {
+        Binary_Value_Present_Value_Set(SENSOR_ERROR_OBJECT_INSTANCE, error_state);
+        return true;
+    }
+
+    return false;
+}
+
+// One pass of the scheduler; returns how long it may sleep
+static TickType_t control_run(uint32_t events)
+{
+    static uint32_t last_sequence = 0;
+    pm25_snapshot_t snapshot;
+    control_pass_t *pass = NULL;
+    control_loop_t *loop = NULL;
+    BACNET_BINARY_PV error_state = BINARY_INACTIVE;
+    bool error_changed = false;
+    bool new_sample = false;
+    int64_t now_us = esp_timer_get_time();
+    int64_t wake_us = now_us + CONTROL_IDLE_MS * 1000LL;
+    int64_t age_ms = 0;
+    unsigned i = 0;
+
+    // wait-free, so done before taking the lock
+    pm25_get_snapshot(CONTROL_SENSOR, &snapshot);
+    new_sample = (snapshot.time_us != 0) && (snapshot.sequence != last_sequence);
+    last_sequence = snapshot.sequence;
+    if (snapshot.time_us != 0) {
+        age_ms = (now_us - snapshot.time_us) / 1000;
+    }
+    if ((snapshot.time_us == 0) || (age_ms > SENSOR_TIMEOUT_MS)) {
+        error_state = BINARY_ACTIVE;
+    }
+
+    // only object access under the lock; computing and logging wait
+    // until it is released
+    server_objects_lock();
+    if (events & CONTROL_EVENT_SAMPLE) {
+        // the new frame into the objects the loops read
+        point_binding_task();
+    }
+    control_gather(events, now_us);
+    server_objects_unlock();
+
+    for (i = 0; i < MAX_LOOPS; i++) {
+        pass = &control_passes[i];
+        loop = &control_loops[i];
+        if (!pass->due) {
+            continue;
+        }
+        loop->next_us = now_us + pass->settings.Update_Interval * 1000LL;
+        if (!pass->out_of_service &&
+            (pass->reliability == RELIABILITY_NO_FAULT_DETECTED)) {
+            pass->output = control_evaluate(loop, pass, now_us);
+        }
+    }
+
+    server_objects_lock();
+    control_apply();
+    error_changed = control_sensor_error(error_state);
+    server_objects_unlock();
+
+    if (new_sample && (events & CONTROL_EVENT_SAMPLE)) {
+        control_latency_record(esp_timer_get_time() - snapshot.time_us);
+    }
+    for (i = 0; i < MAX_LOOPS; i++) {
+        pass = &control_passes[i];
+        loop = &control_loops[i];
+        // on/off loops switch rarely; a PID output moves on every pass
+        if (pass->output_changed && (pass->settings.Mode == LOOP_MODE_ON_OFF)) {
+            ESP_LOGI(TAG, "Loop %u: controlled %.1f, setpoint %.1f - output %.1f",
+                     i, pass->controlled_value, pass->setpoint, pass->output);
+        } else if (pass->output_changed) {
+            ESP_LOGD(TAG, "Loop %u: controlled %.1f, setpoint %.1f - output %.1f",
+                     i, pass->controlled_value, pass->setpoint, pass->output);
+        }
+        if (pass->active && (loop->next_us < wake_us)) {
+            wake_us = loop->next_us;
+        }
+    }
+    if (error_changed) {
+        if (error_state == BINARY_INACTIVE) {
+            ESP_LOGI(TAG, "Sensor error state: OK");
+        } else if (snapshot.time_us == 0) {
+            ESP_LOGW(TAG, "Sensor error state: ERROR, no sensor data received yet");
+        } else {
+            ESP_LOGW(TAG, "Sensor error state: ERROR, data stale: %lld ms since last update",
+                     (long long)age_ms);
+        }
+    }
+
+    now_us = esp_timer_get_time();
+    if (wake_us <= now_us) {
+        return 0;
+    }
+
+    return pdMS_TO_TICKS((wake_us - now_us + 999) / 1000);
+}
+
+void control_task(void *arg)
+{
+    uint32_t events = 0;
+    TickType_t wait = 0;
+
+    control_handle = xTaskGetCurrentTaskHandle();
+    pm25_set_listener(control_sensor_listener);
+    Analog_Value_Write_Notify_Set(control_value_written);
+    ESP_LOGI(TAG, "Control task started, %u loops", (unsigned)MAX_LOOPS);
+
+    for (;;) {
+        wait = control_run(events);
+        events = 0;
+        // several notifications while running still mean one pass
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+    }
+}
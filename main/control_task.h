@@ -0,0 +1,23 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Configure the default loops: FAN_CONTROL (Loop 0) switches FAN_COMMAND
+// on PM2.5 against PM2.5_SETPOINT.  Call after the objects are
+// initialized and bound; BACnet writes can change them afterwards.
+void control_task_init(void);
+
+// Runs the Loop objects and keeps SENSOR_ERROR in line with the age of
+// the sensor data.  Woken when a loop is due, by each new frame of the
+// first sensor and by writes of Analog Values.  Create it at a priority
+// above the BACnet server task and below the sensor reader.
+void control_task(void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_TASK_H */
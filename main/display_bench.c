@@ -0,0 +1,162 @@
+/*
+ * Display self-benchmark: test patterns at a sweep of SPI clocks
+ *
+ * Each pattern is drawn BENCH_FRAMES times and timed until the panel has
+ * read the last pixel.  The refresh times and SPI waits come from
+ * display_get_stats(), the transactions and bytes from the panel.
+ * Platform-free, like display_driver.c: on a host the clock changes
+ * nothing and the times are the composing alone.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#else
+#define ESP_LOGI(tag, format, ...) printf("I (%s) " format "\n", tag, ##__VA_ARGS__)
+#endif
+#include "display_driver.h"
+#include "display_panel.h"
+#include "display_bench.h"
+#include "fonts.h"
+
+static const char *TAG = "DISPLAY_BENCH";
+
+#define BENCH_FRAMES    10
+
+// The ESP32 divides its 80 MHz SPI clock by a whole number
+static const uint32_t bench_clocks_hz[] = {
+    10000000, 20000000, 26666667, 40000000, 80000000,
+};
+
+typedef struct {
+    const char *name;
+    void (*draw)(int frame);
+} bench_pattern_t;
+
+// The whole screen in one colour: a single address window
+static void bench_clear(int frame)
+{
+    display_clear((frame & 1) ? DISP_BLUE : DISP_BLACK);
+}
+
+// The whole screen in text: every strip composed
+static void bench_text(int frame)
+{
+    char line[32];
+
+    for (int y = 0; y + 8 <= display_get_height(); y += 10) {
+        snprintf(line, sizeof(line), "%02d %06d ABCDEFGHIJKLMNOPQ", frame, y * 37 + frame);
+        display_draw_string(0, y, line, DISP_WHITE, DISP_BLACK);
+    }
+}
+
+// The usual update: five values cleared and redrawn
+static void bench_values(int frame)
+{
+    char value[24];
+
+    for (int i = 0; i < 5; i++) {
+        snprintf(value, sizeof(value), "%d.%d ug/m3", 10 + frame * 7 + i, frame % 10);
+        display_fill_rect(65, 39 + i * 12, 80, 10, DISP_BLACK);
+        display_draw_string(65, 39 + i * 12, value, DISP_GREEN, DISP_BLACK);
+    }
+}
+
+// A large value in the run-length font
+static void bench_big_value(int frame)
+{
+    char value[16];
+
+    snprintf(value, sizeof(value), "%d.%d", 100 + frame * 13, frame % 10);
+    display_fill_rect(45, 51, 81, 23, DISP_BLACK);
+    display_draw_string_font(45, 51, value, DISP_YELLOW, DISP_BLACK, &font_sans24);
+}
+
+static const bench_pattern_t bench_patterns[] = {
+    { "clear", bench_clear },
+    { "text", bench_text },
+    { "values", bench_values },
+    { "big value", bench_big_value },
+};
+
+static void bench_run(const bench_pattern_t *pattern)
+{
+    display_stats_t stats;
+    int64_t start_us = 0;
+    int64_t elapsed_us = 0;
+
+    // Start from a black screen with nothing in flight
+    display_clear(DISP_BLACK);
+    display_flush();
+    display_panel_wait(display_panel_queued());
+    display_get_stats(NULL, true);
+
+    start_us = display_panel_time_us();
+    for (int frame = 0; frame < BENCH_FRAMES; frame++) {
+        pattern->draw(frame);
+        display_flush();
+    }
+    display_panel_wait(display_panel_queued());
+    elapsed_us = display_panel_time_us() - start_us;
+
+    display_get_stats(&stats, true);
+    ESP_LOGI(TAG, "%5lu kHz %-9s %7lld us/frame, refresh p50 %lu us max %lu us, "
+             "SPI wait %lu us, %lu transactions, %lu bytes/frame, %lld KB/s",
+             (unsigned long)(stats.spi_clock_hz / 1000), pattern->name,
+             (long long)(elapsed_us / BENCH_FRAMES),
+             (unsigned long)stats.refresh_p50_us, (unsigned long)stats.refresh_max_us,
+             (unsigned long)stats.wait_mean_us,
+             (unsigned long)(stats.transactions / BENCH_FRAMES),
+             (unsigned long)(stats.bytes / BENCH_FRAMES),
+             (long long)(elapsed_us ? (int64_t)stats.bytes * 1000 / elapsed_us : 0));
+}
+
+// Chart rows: sent outside display_flush(), so timed here alone
+static void bench_chart(void)
+{
+    display_panel_stats_t panel;
+    int64_t start_us = 0;
+    int64_t elapsed_us = 0;
+
+    display_scroll_init(display_get_height() / 2, DISP_BLACK);
+    display_panel_wait(display_panel_queued());
+    display_panel_stats(NULL, true);
+
+    start_us = display_panel_time_us();
+    for (int row = 0; row < BENCH_FRAMES; row++) {
+        display_scroll_add_row(row * 17, DISP_GREEN, DISP_BLACK);
+    }
+    display_panel_wait(display_panel_queued());
+    elapsed_us = display_panel_time_us() - start_us;
+
+    display_panel_stats(&panel, true);
+    ESP_LOGI(TAG, "%5lu kHz %-9s %7lld us/row, %lu transactions, %lu bytes/row",
+             (unsigned long)(display_panel_clock() / 1000), "chart row",
+             (long long)(elapsed_us / BENCH_FRAMES),
+             (unsigned long)(panel.transactions / BENCH_FRAMES),
+             (unsigned long)(panel.bytes / BENCH_FRAMES));
+    display_scroll_init(display_get_height(), DISP_BLACK);
+}
+
+void display_benchmark(void)
+{
+    uint32_t clock_hz = display_panel_clock();
+
+    ESP_LOGI(TAG, "Benchmark: %d frames of each pattern at each clock",
+             BENCH_FRAMES);
+    for (unsigned c = 0; c < sizeof(bench_clocks_hz) / sizeof(bench_clocks_hz[0]); c++) {
+        if (display_set_spi_clock(bench_clocks_hz[c]) != 0) {
+            ESP_LOGI(TAG, "%lu Hz refused, sweep stopped", (unsigned long)bench_clocks_hz[c]);
+            break;
+        }
+        for (unsigned p = 0; p < sizeof(bench_patterns) / sizeof(bench_patterns[0]); p++) {
+            bench_run(&bench_patterns[p]);
+        }
+        bench_chart();
+    }
+
+    display_set_spi_clock(clock_hz);
+    display_clear(DISP_BLACK);
+    display_flush();
+    display_get_stats(NULL, true);
+}
@@ -0,0 +1,19 @@
+#ifndef DISPLAY_BENCH_H
+#define DISPLAY_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Display self-benchmark: draws test patterns at a range of SPI clocks
+// and logs, for each, the time per frame, the refresh times and SPI
+// waits, and the transactions and bytes sent.  Call after display_init()
+// and before display_scroll_init(); it takes the screen for a few
+// seconds and leaves it cleared, at the clock it found.
+void display_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_BENCH_H */
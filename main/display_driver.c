@@ -1,60 +1,147 @@
+/*
+ * Display driver: records drawing, composes it and sends it to the panel
+ *
+ * Platform-free; the panel is display_panel_st7789.c on the board, or
+ * display_panel_mem.c for host builds.
+ */
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#ifdef ESP_PLATFORM
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "esp_log.h"
-#include "driver/spi_master.h"
-#include "driver/gpio.h"
-#include "esp_lcd_panel_io.h"
-#include "esp_lcd_panel_ops.h"
-#include "esp_lcd_panel_vendor.h"
+#include "esp_attr.h"
+#include "sdkconfig.h"
+#else
+#include <pthread.h>
+#define ESP_LOGI(tag, format, ...) printf("I (%s) " format "\n", tag, ##__VA_ARGS__)
+#define DMA_ATTR
+#define CONFIG_DISPLAY_GLYPH_CACHE_SIZE 4096
+#endif
 #include "display_driver.h"
+#include "display_panel.h"
 #include "fonts.h"
 
 static const char *TAG = "DISPLAY_DRIVER";
 
-// ===========================================
-// Display settings for Ideaspark 1.9"170x320
-// ===========================================
-#define LCD_HOST           SPI2_HOST
-#define TFT_MOSI           23
-#define TFT_SCLK           18
-#define TFT_CS             15
-#define TFT_DC             2
-#define TFT_RST            4
-#define TFT_BL             32
-#define SPI_CLOCK_HZ       (10 * 1000 * 1000)
-#define TFT_OFFSET_X 35
-#define TFT_OFFSET_Y 0
-#define DISPLAY_WIDTH  170
-#define DISPLAY_HEIGHT 320 
-#define SPI_CLOCK_HZ       (10 * 1000 * 1000)
+// Drawing is deferred: each call records an operation covering a
+// rectangle, and display_flush() composes the dirty rectangles into DMA
+// strips and sends them.  There are two strips, so one is composed while
+// the other is being sent.
+#define STRIP_PIXELS       (DISPLAY_WIDTH * 20)
 
+// Operations recorded between flushes; more flush early
+#define DISPLAY_OPS_MAX    32
 
-/*
-// ========================================
-// display settings for TTGO 1.14" 135x240
-// ========================================
-#define LCD_HOST           SPI2_HOST
-#define TFT_MOSI 19    
-#define TFT_SCLK 18
-#define TFT_CS   5
-#define TFT_DC   16
-#define TFT_RST  23   
-#define TFT_BL   4     
-#define TFT_OFFSET_X 52
-#define TFT_OFFSET_Y 40
-#define DISPLAY_WIDTH  170
-#define DISPLAY_HEIGHT 320
-#define SPI_CLOCK_HZ       (10 * 1000 * 1000)
-*/
+// Characters of one string, more than fit across the screen
+#define DISPLAY_TEXT_MAX   32
+
+// Log the flush times once per this many flushes
+#define FLUSH_REPORT_FLUSHES 20
+
+// Rendered glyphs are cached in slots of this many pixels; bigger glyphs
+// are drawn from the font data every time
+#define GLYPH_SLOT_PIXELS  64
+#define GLYPH_SLOTS        ((int)(CONFIG_DISPLAY_GLYPH_CACHE_SIZE / sizeof(glyph_slot_t)))
+
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+} display_rect_t;
+
+typedef enum {
+    DISPLAY_OP_FILL,
+    DISPLAY_OP_TEXT
+} display_op_kind_t;
+
+// Every operation is opaque over its rectangle: text paints its
+// background and the spacing between characters
+typedef struct {
+    display_op_kind_t kind;
+    display_rect_t rect;
+    uint16_t color;        // display-ready
+    uint16_t bg_color;     // display-ready, text only
+    const font_t *font;    // text only
+    char text[DISPLAY_TEXT_MAX + 1];
+    uint16_t shades[16];   // display-ready, run-length fonts: per coverage level
+} display_op_t;
+
+// A glyph rendered in panel-native colours, char_width x char_height
+typedef struct {
+    const font_t *font;       // NULL when free
+    uint16_t color;
+    uint16_t bg_color;
+    char c;
+    uint32_t last_used;
+    uint16_t pixels[GLYPH_SLOT_PIXELS];
+} glyph_slot_t;
+
+typedef struct {
+    uint32_t flushes;
+    uint32_t transfers;
+    uint32_t pixels;
+    int64_t total_us;
+    int64_t max_us;
+    int64_t wait_us;
+    uint32_t glyph_hits;
+    uint32_t glyph_misses;
+} flush_timing_t;
+
+// Totals for display_get_stats(), and the last refreshes for percentiles
+typedef struct {
+    uint32_t refreshes;
+    uint32_t pixels;
+    uint32_t glyph_hits;
+    uint32_t glyph_misses;
+    uint32_t refresh_us[DISPLAY_STATS_WINDOW];
+    uint32_t wait_us[DISPLAY_STATS_WINDOW];
+} display_totals_t;
 
 // Static variables
-static esp_lcd_panel_handle_t panel_handle = NULL;
-static esp_lcd_panel_io_handle_t io_handle = NULL;
+static bool display_ready = false;
 static const font_t *current_font = &font_5x8;  // Default font
 
+static display_op_t ops[DISPLAY_OPS_MAX];
+static int op_count = 0;
+
+// Allocated once, in DMA-capable internal RAM
+static DMA_ATTR uint16_t strips[2][STRIP_PIXELS];
+// display_panel_queued() once each strip was last sent
+static uint32_t strip_sent[2] = { 0, 0 };
+// Colour a strip is filled with, all of it, or -1 once composed
+static int32_t strip_solid[2] = { -1, -1 };
+static int next_strip = 0;
+
+// Rows from scroll_top down scroll in hardware, DISPLAY_HEIGHT for none;
+// other drawing stays above them.  scroll_next is the row of the area,
+// counted from its top in frame memory, that the next row goes to.
+static int scroll_top = DISPLAY_HEIGHT;
+static int scroll_next = 0;
+
+static flush_timing_t flush_timing;
+// Written by the drawing task at the end of each refresh and read by
+// display_get_stats() from others, both under totals_lock
+static display_totals_t display_totals;
+#ifdef ESP_PLATFORM
+static portMUX_TYPE totals_lock = portMUX_INITIALIZER_UNLOCKED;
+#define TOTALS_LOCK()   taskENTER_CRITICAL(&totals_lock)
+#define TOTALS_UNLOCK() taskEXIT_CRITICAL(&totals_lock)
+#else
+static pthread_mutex_t totals_lock = PTHREAD_MUTEX_INITIALIZER;
+#define TOTALS_LOCK()   pthread_mutex_lock(&totals_lock)
+#define TOTALS_UNLOCK() pthread_mutex_unlock(&totals_lock)
+#endif
+// Time blocked on SPI, and glyph cache lookups, in the current refresh
+static int64_t refresh_wait_us = 0;
+static uint32_t refresh_glyph_hits = 0;
+static uint32_t refresh_glyph_misses = 0;
+
+static glyph_slot_t glyph_cache[GLYPH_SLOTS > 0 ? GLYPH_SLOTS : 1];
+static uint32_t glyph_clock = 0;
+
 // COLOR TRANSFORMATION - FROM YOUR WORKING TESTS
 static inline uint16_t display_color(uint16_t color) {
     switch (color & 0xFFFF) {
@@ -80,174 +167,419 @@ static uint16_t color_to_display(uint16_t color) {
     return swap_color_bytes(display_color(color));
 }
 
-// Draw a character with specified font
-static void draw_char_with_font(int x, int y, char c, uint16_t color, uint16_t bg_color, const font_t *font) {
-    if (!panel_handle || !font) return;
-    
-    if (x < 0 || x >= DISPLAY_WIDTH - font->char_width || 
-        y < 0 || y >= DISPLAY_HEIGHT - font->char_height) {
-        return;
+// A colour level/top of the way from the background to the text colour,
+// display-ready.  Blended after display_color(), which inverts each
+// field and swaps red and blue, so blending field by field gives the
+// same colour.
+static uint16_t color_blend_to_display(uint16_t color, uint16_t bg_color, int level, int top) {
+    uint16_t fg = display_color(color);
+    uint16_t bg = display_color(bg_color);
+    int r = ((fg >> 11) * level + (bg >> 11) * (top - level) + top / 2) / top;
+    int g = (((fg >> 5) & 0x3F) * level + ((bg >> 5) & 0x3F) * (top - level) + top / 2) / top;
+    int b = ((fg & 0x1F) * level + (bg & 0x1F) * (top - level) + top / 2) / top;
+
+    return swap_color_bytes((uint16_t)((r << 11) | (g << 5) | b));
+}
+
+// A character's entry in a run-length font
+static const font_glyph_t *rle_glyph(const font_t *font, char c) {
+    if (c >= font->start_char && c <= font->end_char) {
+        return &font->glyphs[c - font->start_char];
     }
-    
-    int index = 0;
+    return &font->glyphs[0];  // First character as fallback
+}
+
+// Columns a character draws, and from its left to the next character
+static int glyph_width(const font_t *font, char c) {
+    return font->glyphs ? rle_glyph(font, c)->width : font->char_width;
+}
+
+static int glyph_advance(const font_t *font, char c) {
+    return font->glyphs ? rle_glyph(font, c)->advance : font->char_width + font->char_spacing;
+}
+
+// Index of a character's data in the font
+static int glyph_index(char c, const font_t *font) {
     if (c >= font->start_char && c <= font->end_char) {
-        index = (c - font->start_char) * font->bytes_per_char;
-    } else {
-        index = 0;  // Use first character (space) as fallback
+        return (c - font->start_char) * font->bytes_per_char;
     }
-    
-    uint16_t display_color_val = color_to_display(color);
-    uint16_t display_bg_color = color_to_display(bg_color);
-    
-    // Draw character pixel by pixel
-    // For simple fonts (like 5x8), each byte represents one column
+    return 0;  // Use first character (space) as fallback
+}
+
+static int rect_area(const display_rect_t *rect) {
+    return rect->width * rect->height;
+}
+
+static bool rect_intersect(const display_rect_t *a, const display_rect_t *b, display_rect_t *out) {
+    int x0 = (a->x > b->x) ? a->x : b->x;
+    int y0 = (a->y > b->y) ? a->y : b->y;
+    int x1 = (a->x + a->width < b->x + b->width) ? a->x + a->width : b->x + b->width;
+    int y1 = (a->y + a->height < b->y + b->height) ? a->y + a->height : b->y + b->height;
+
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    out->x = x0;
+    out->y = y0;
+    out->width = x1 - x0;
+    out->height = y1 - y0;
+    return true;
+}
+
+static bool rect_contains(const display_rect_t *outer, const display_rect_t *inner) {
+    return inner->x >= outer->x && inner->y >= outer->y &&
+           inner->x + inner->width <= outer->x + outer->width &&
+           inner->y + inner->height <= outer->y + outer->height;
+}
+
+// Merge two rectangles when their union is itself a rectangle, so that
+// the merged one covers no pixel that neither did
+static bool rect_merge(const display_rect_t *a, const display_rect_t *b, display_rect_t *out) {
+    display_rect_t both;
+    display_rect_t bounds;
+    int overlap = rect_intersect(a, b, &both) ? rect_area(&both) : 0;
+
+    bounds.x = (a->x < b->x) ? a->x : b->x;
+    bounds.y = (a->y < b->y) ? a->y : b->y;
+    bounds.width = ((a->x + a->width > b->x + b->width) ? a->x + a->width : b->x + b->width) - bounds.x;
+    bounds.height = ((a->y + a->height > b->y + b->height) ? a->y + a->height : b->y + b->height) - bounds.y;
+    if (rect_area(&bounds) != rect_area(a) + rect_area(b) - overlap) {
+        return false;
+    }
+    *out = bounds;
+    return true;
+}
+
+// Record an operation; the ones it hides completely are dropped
+static display_op_t *display_op_add(display_op_kind_t kind, const display_rect_t *rect) {
+    int kept = 0;
+
+    for (int i = 0; i < op_count; i++) {
+        if (!rect_contains(rect, &ops[i].rect)) {
+            ops[kept++] = ops[i];
+        }
+    }
+    op_count = kept;
+    if (op_count == DISPLAY_OPS_MAX) {
+        display_flush();
+    }
+
+    display_op_t *op = &ops[op_count++];
+    op->kind = kind;
+    op->rect = *rect;
+    return op;
+}
+
+// Render a glyph: one byte per column of the font data, bit 0 at the top
+static void glyph_render(const font_t *font, char c, uint16_t color, uint16_t bg_color,
+                         uint16_t *pixels) {
+    const uint8_t *glyph = &font->data[glyph_index(c, font)];
+
     for (int fy = 0; fy < font->char_height; fy++) {
         for (int fx = 0; fx < font->char_width; fx++) {
-            int pixel_x = x + fx;
-            int pixel_y = y + fy;
-            
             uint8_t pixel = 0;
-            
-            // Check if this pixel should be on based on font data
-            // For 5x8 font, each column is 1 byte (8 bits high)
-            if (fx < font->bytes_per_char) {
-                uint8_t font_byte = font->data[index + fx];
-                // For 8-bit high fonts, we check each bit
-                // For taller fonts, we'd need more complex logic
-                if (fy < 8) {
-                    pixel = (font_byte >> fy) & 0x01;
+
+            if (fx < font->bytes_per_char && fy < 8) {
+                pixel = (glyph[fx] >> fy) & 0x01;
+            }
+            *pixels++ = pixel ? color : bg_color;
+        }
+    }
+}
+
+// The rendered glyph from the cache, rendering it into the least recently
+// used slot on a miss; NULL if it is too big for a slot, or run-length
+static const uint16_t *glyph_lookup(const font_t *font, char c, uint16_t color, uint16_t bg_color) {
+    glyph_slot_t *victim = NULL;
+
+    if (font->glyphs || font->char_width * font->char_height > GLYPH_SLOT_PIXELS || GLYPH_SLOTS == 0) {
+        return NULL;
+    }
+    glyph_clock++;
+    for (int i = 0; i < GLYPH_SLOTS; i++) {
+        glyph_slot_t *slot = &glyph_cache[i];
+
+        if (slot->font == font && slot->c == c &&
+            slot->color == color && slot->bg_color == bg_color) {
+            slot->last_used = glyph_clock;
+            flush_timing.glyph_hits++;
+            refresh_glyph_hits++;
+            return slot->pixels;
+        }
+        if (!victim || !slot->font ||
+            (victim->font && (int32_t)(slot->last_used - victim->last_used) < 0)) {
+            victim = slot;
+        }
+    }
+
+    victim->font = font;
+    victim->c = c;
+    victim->color = color;
+    victim->bg_color = bg_color;
+    victim->last_used = glyph_clock;
+    glyph_render(font, c, color, bg_color, victim->pixels);
+    flush_timing.glyph_misses++;
+    refresh_glyph_misses++;
+    return victim->pixels;
+}
+
+// Decode a run-length glyph straight into the strip.  Each run inside
+// the part is written as one stretch of its shade; runs of rows above
+// the part are only stepped over.
+static void compose_runs(const display_op_t *op, char c, int cell_x, const display_rect_t *part,
+                         const display_rect_t *strip, uint16_t *buf) {
+    const font_t *font = op->font;
+    const font_glyph_t *glyph = rle_glyph(font, c);
+    const uint8_t *run = &font->data[glyph->offset];
+    int level_mask = (1 << font->bpp) - 1;
+    int part_end = part->x + part->width;
+    int glyph_end = cell_x + glyph->width;
+    int rows = part->y + part->height - op->rect.y;
+
+    if (glyph_end > part_end) glyph_end = part_end;
+
+    for (int fy = 0; fy < rows; fy++) {
+        int y = op->rect.y + fy;
+        bool shown = y >= part->y;
+        uint16_t *out = &buf[(y - strip->y) * strip->width];
+
+        for (int x = cell_x; x < cell_x + glyph->width; run++) {
+            int end = x + (*run >> font->bpp) + 1;
+
+            if (shown) {
+                uint16_t shade = op->shades[*run & level_mask];
+                int to = (end < glyph_end) ? end : glyph_end;
+
+                for (x = (x > part->x) ? x : part->x; x < to; x++) {
+                    out[x - strip->x] = shade;
                 }
             }
-            
-            uint16_t pixel_color = pixel ? display_color_val : display_bg_color;
-            
-            // Only draw if not transparent background
-            if (pixel_color != display_bg_color || bg_color != DISP_BLACK) {
-                esp_lcd_panel_draw_bitmap(panel_handle, pixel_x, pixel_y, 
-                                          pixel_x + 1, pixel_y + 1, &pixel_color);
+            x = end;
+        }
+        if (shown) {
+            // The spacing after the character
+            for (int x = (glyph_end > part->x) ? glyph_end : part->x; x < part_end; x++) {
+                out[x - strip->x] = op->bg_color;
             }
         }
     }
 }
 
-// ========== API IMPLEMENTATION ==========
+// Paint the part of a text operation inside area into the strip, a
+// character at a time: rows of cached glyphs are copied, glyphs too big
+// for the cache are drawn from the font data, and run-length glyphs are
+// decoded run by run
+static void compose_text(const display_op_t *op, const display_rect_t *area,
+                         const display_rect_t *strip, uint16_t *buf) {
+    const font_t *font = op->font;
+    int cell_x = op->rect.x;
 
-int display_init(void) {
-    ESP_LOGI(TAG, "Initializing TTGO T-Display");
-    
-    // 1. Initialize SPI bus
-    spi_bus_config_t buscfg = {
-        .sclk_io_num = TFT_SCLK,
-        .mosi_io_num = TFT_MOSI,
-        .miso_io_num = -1,
-        .quadwp_io_num = -1,
-        .quadhd_io_num = -1,
-        .max_transfer_sz = DISPLAY_WIDTH * DISPLAY_HEIGHT * 2,
-    };
-    
-    esp_err_t ret = spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI bus initialization failed: %s", esp_err_to_name(ret));
-        return -1;
+    for (int ci = 0; op->text[ci] && cell_x < area->x + area->width; ci++) {
+        char c = op->text[ci];
+        display_rect_t cell = { cell_x, op->rect.y, glyph_advance(font, c), font->char_height };
+        display_rect_t part;
+
+        cell_x += cell.width;
+        if (!rect_intersect(&cell, area, &part)) {
+            continue;
+        }
+        if (font->glyphs) {
+            compose_runs(op, c, cell.x, &part, strip, buf);
+            continue;
+        }
+
+        const uint16_t *glyph = glyph_lookup(font, c, op->color, op->bg_color);
+        const uint8_t *data = &font->data[glyph_index(c, font)];
+
+        for (int y = part.y; y < part.y + part.height; y++) {
+            int fy = y - op->rect.y;
+            uint16_t *out = &buf[(y - strip->y) * strip->width + (part.x - strip->x)];
+            int x = part.x;
+
+            // Glyph columns, then the spacing after the character
+            int glyph_end = cell.x + font->char_width;
+            if (glyph_end > part.x + part.width) glyph_end = part.x + part.width;
+            if (glyph && x < glyph_end) {
+                memcpy(out, &glyph[fy * font->char_width + (x - cell.x)],
+                       (glyph_end - x) * sizeof(uint16_t));
+                out += glyph_end - x;
+                x = glyph_end;
+            }
+            for (; x < glyph_end; x++) {
+                int fx = x - cell.x;
+                uint8_t pixel = 0;
+
+                if (fx < font->bytes_per_char && fy < 8) {
+                    pixel = (data[fx] >> fy) & 0x01;
+                }
+                *out++ = pixel ? op->color : op->bg_color;
+            }
+            for (; x < part.x + part.width; x++) {
+                *out++ = op->bg_color;
+            }
+        }
     }
-    
-    // 2. Configure LCD panel IO
-    esp_lcd_panel_io_spi_config_t io_config = {
-        .dc_gpio_num = TFT_DC,
-        .cs_gpio_num = TFT_CS,
-        .pclk_hz = SPI_CLOCK_HZ,
-        .lcd_cmd_bits = 8,
-        .lcd_param_bits = 8,
-        .spi_mode = 3,
-        .trans_queue_depth = 10,
-        .on_color_trans_done = NULL,
-        .user_ctx = NULL,
-        .flags = {
-            .dc_low_on_data = 0,
-            .octal_mode = 0,
-            .sio_mode = 0,
-            .lsb_first = 0,
-            .cs_high_active = 0,
-        },
-    };
-    
-    ret = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_HOST, &io_config, &io_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure LCD IO: %s", esp_err_to_name(ret));
-        spi_bus_free(LCD_HOST);
-        return -1;
+}
+
+// Paint every operation that touches the strip, oldest first
+static void compose_strip(const display_rect_t *strip, uint16_t *buf) {
+    for (int i = 0; i < op_count; i++) {
+        const display_op_t *op = &ops[i];
+        display_rect_t area;
+
+        if (!rect_intersect(&op->rect, strip, &area)) {
+            continue;
+        }
+        if (op->kind == DISPLAY_OP_TEXT) {
+            compose_text(op, &area, strip, buf);
+            continue;
+        }
+        for (int y = area.y; y < area.y + area.height; y++) {
+            uint16_t *out = &buf[(y - strip->y) * strip->width + (area.x - strip->x)];
+            for (int x = 0; x < area.width; x++) {
+                *out++ = op->color;
+            }
+        }
     }
-    
-    // 3. Install ST7789 panel driver
-    esp_lcd_panel_dev_config_t panel_config = {
-        .reset_gpio_num = TFT_RST,
-        .color_space = ESP_LCD_COLOR_SPACE_RGB,
-        .bits_per_pixel = 16,
-    };
-    
-    ret = esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to install ST7789 driver: %s", esp_err_to_name(ret));
-        spi_bus_free(LCD_HOST);
-        return -1;
+}
+
+// Colour of the rectangle if the last operation to touch it is a fill
+// covering all of it, else -1
+static int32_t rect_solid_color(const display_rect_t *rect) {
+    for (int i = op_count - 1; i >= 0; i--) {
+        display_rect_t area;
+
+        if (rect_intersect(&ops[i].rect, rect, &area)) {
+            if (ops[i].kind == DISPLAY_OP_FILL && rect_contains(&ops[i].rect, rect)) {
+                return ops[i].color;
+            }
+            return -1;
+        }
     }
-    
-    // 4. Initialize display panel
-    esp_lcd_panel_reset(panel_handle);
-    esp_lcd_panel_init(panel_handle);
-    
-    // Set Memory Access Control (MADCTL) - BGR mode
-    uint8_t madctl = 0x08;  // BGR MODE
-    esp_lcd_panel_io_tx_param(io_handle, 0x36, &madctl, 1);
-    vTaskDelay(pdMS_TO_TICKS(50));
-    
-    // Set Display offset
-    esp_lcd_panel_set_gap(panel_handle, TFT_OFFSET_X, TFT_OFFSET_Y);
+    return -1;
+}
 
-    // Turn on display
-    esp_lcd_panel_disp_on_off(panel_handle, true);
-    
-    // 5. Enable backlight
-    gpio_reset_pin(TFT_BL);
-    gpio_set_direction(TFT_BL, GPIO_MODE_OUTPUT);
-    gpio_set_level(TFT_BL, 1);
-    
-    ESP_LOGI(TAG, "Display initialized successfully");
-    return 0;
+// Wait until the panel has read a strip, counting the time blocked
+static void strip_wait(int strip) {
+    int64_t start_us = display_panel_time_us();
+
+    display_panel_wait(strip_sent[strip]);
+    refresh_wait_us += display_panel_time_us() - start_us;
 }
 
-void display_clear(uint16_t color) {
-    if (!panel_handle) return;
-    
-    uint16_t display_color = color_to_display(color);
-    uint16_t *line = malloc(DISPLAY_WIDTH * sizeof(uint16_t));
-    if (!line) {
-        ESP_LOGE(TAG, "Failed to allocate line buffer");
-        return;
+// Send a rectangle of one colour in a single address window: one strip
+// filled with the colour is sent again for each chunk of the rectangle
+static void fill_window(const display_rect_t *rect, uint16_t color) {
+    int strip = (strip_solid[0] == color) ? 0 : (strip_solid[1] == color) ? 1 : next_strip;
+
+    if (strip_solid[strip] != color) {
+        // Still being sent with other pixels in it
+        strip_wait(strip);
+        for (int i = 0; i < STRIP_PIXELS; i++) {
+            strips[strip][i] = color;
+        }
+        strip_solid[strip] = color;
     }
-    
-    // Fill line buffer
-    for (int x = 0; x < DISPLAY_WIDTH; x++) {
-        line[x] = display_color;
+
+    strip_sent[strip] = display_panel_fill(rect->x, rect->y, rect->width, rect->height,
+                                           strips[strip], STRIP_PIXELS);
+    if (strip == next_strip) {
+        next_strip ^= 1;
     }
-    
-    // Draw line by line
-    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
-        esp_lcd_panel_draw_bitmap(panel_handle, 0, y, DISPLAY_WIDTH, y + 1, line);
+}
+
+static void flush_timing_record(int64_t elapsed_us, uint32_t transfers, uint32_t pixels) {
+    flush_timing_t *timing = &flush_timing;
+    display_totals_t *totals = &display_totals;
+    unsigned slot;
+
+    TOTALS_LOCK();
+    slot = totals->refreshes % DISPLAY_STATS_WINDOW;
+    totals->refresh_us[slot] = (uint32_t)elapsed_us;
+    totals->wait_us[slot] = (uint32_t)refresh_wait_us;
+    totals->pixels += pixels;
+    totals->glyph_hits += refresh_glyph_hits;
+    totals->glyph_misses += refresh_glyph_misses;
+    totals->refreshes++;
+    TOTALS_UNLOCK();
+    refresh_glyph_hits = 0;
+    refresh_glyph_misses = 0;
+
+    if (elapsed_us > timing->max_us) {
+        timing->max_us = elapsed_us;
+    }
+    timing->total_us += elapsed_us;
+    timing->wait_us += refresh_wait_us;
+    timing->transfers += transfers;
+    timing->pixels += pixels;
+    timing->flushes++;
+    if (timing->flushes >= FLUSH_REPORT_FLUSHES) {
+        ESP_LOGI(TAG, "display_flush: avg %lld us (%lld us waiting for SPI), max %lld us, "
+                 "%lu transfers, %lu pixels over %lu flushes; glyph cache %lu hits, %lu misses",
+                 (long long)(timing->total_us / timing->flushes),
+                 (long long)(timing->wait_us / timing->flushes),
+                 (long long)timing->max_us, (unsigned long)timing->transfers,
+                 (unsigned long)timing->pixels, (unsigned long)timing->flushes,
+                 (unsigned long)timing->glyph_hits, (unsigned long)timing->glyph_misses);
+        memset(timing, 0, sizeof(*timing));
     }
+}
+
+// ========== API IMPLEMENTATION ==========
+
+int display_init(void) {
+    if (display_panel_init() != 0) {
+        return -1;
+    }
+    display_ready = true;
+    return 0;
+}
+
+void display_clear(uint16_t color) {
+    if (!display_ready) return;
     
-    free(line);
+    display_rect_t screen = { 0, 0, DISPLAY_WIDTH, scroll_top };
+    display_op_t *op = display_op_add(DISPLAY_OP_FILL, &screen);
+    op->color = color_to_display(color);
 }
 
 // NEW: Draw string with specific font
 void display_draw_string_font(int x, int y, const char *text, uint16_t color, uint16_t bg_color, const font_t *font) {
-    if (!panel_handle || !text || !font) return;
+    if (!display_ready || !text || !font) return;
     
+    // Only characters wholly on screen are drawn
+    if (y < 0 || y >= scroll_top - font->char_height) return;
+
     int current_x = x;
-    while (*text) {
-        draw_char_with_font(current_x, y, *text, color, bg_color, font);
-        current_x += font->char_width + font->char_spacing;
-        text++;
+    int run_x = 0;
+    int run_end = 0;
+    int count = 0;
+    char run[DISPLAY_TEXT_MAX + 1];
+
+    for (; *text && count < DISPLAY_TEXT_MAX; current_x += glyph_advance(font, *text), text++) {
+        if (current_x < 0) continue;
+        if (current_x >= DISPLAY_WIDTH - glyph_width(font, *text)) break;
+        if (count == 0) {
+            run_x = current_x;
+        }
+        run[count++] = *text;
+        run_end = current_x + glyph_width(font, *text);
+    }
+    if (count == 0 || run_end <= run_x) return;
+    run[count] = '\0';
+
+    display_rect_t rect = { run_x, y, run_end - run_x, font->char_height };
+    display_op_t *op = display_op_add(DISPLAY_OP_TEXT, &rect);
+    op->color = color_to_display(color);
+    op->bg_color = color_to_display(bg_color);
+    op->font = font;
+    memcpy(op->text, run, count + 1);
+    if (font->glyphs) {
+        int top = (1 << font->bpp) - 1;
+
+        for (int level = 0; level <= top; level++) {
+            op->shades[level] = color_blend_to_display(color, bg_color, level, top);
+        }
     }
 }
 
@@ -257,41 +589,148 @@ void display_draw_string(int x, int y, const char *text, uint16_t color, uint16_
 }
 
 void display_fill_rect(int x, int y, int width, int height, uint16_t color) {
-    if (!panel_handle) return;
+    if (!display_ready) return;
     
     // Clamp coordinates
     if (x < 0) x = 0;
     if (y < 0) y = 0;
     if (x + width > DISPLAY_WIDTH) width = DISPLAY_WIDTH - x;
-    if (y + height > DISPLAY_HEIGHT) height = DISPLAY_HEIGHT - y;
+    if (y + height > scroll_top) height = scroll_top - y;
     if (width <= 0 || height <= 0) return;
     
-    uint16_t display_color = color_to_display(color);
-    uint16_t *line = malloc(width * sizeof(uint16_t));
-    if (!line) {
-        ESP_LOGE(TAG, "Failed to allocate line buffer");
-        return;
+    display_rect_t rect = { x, y, width, height };
+    display_op_t *op = display_op_add(DISPLAY_OP_FILL, &rect);
+    op->color = color_to_display(color);
+}
+
+void display_flush(void) {
+    if (!display_ready || op_count == 0) return;
+
+    int64_t start_us = display_panel_time_us();
+    uint32_t first_trans = display_panel_queued();
+
+    refresh_wait_us = 0;
+    uint32_t pixels = 0;
+    display_rect_t dirty[DISPLAY_OPS_MAX];
+    int dirty_count = 0;
+    bool merged;
+
+    for (int i = 0; i < op_count; i++) {
+        dirty[dirty_count++] = ops[i].rect;
     }
-    
-    // Fill line buffer
-    for (int i = 0; i < width; i++) {
-        line[i] = display_color;
+
+    // A field is cleared and then redrawn, the screen cleared and then
+    // labelled: merge until no two dirty rectangles form a rectangle
+    do {
+        merged = false;
+        for (int i = 0; i < dirty_count && !merged; i++) {
+            for (int j = i + 1; j < dirty_count; j++) {
+                if (rect_merge(&dirty[i], &dirty[j], &dirty[i])) {
+                    dirty[j] = dirty[--dirty_count];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    } while (merged);
+
+    for (int i = 0; i < dirty_count; i++) {
+        const display_rect_t *rect = &dirty[i];
+        int rows = STRIP_PIXELS / rect->width;
+        int32_t solid = rect_solid_color(rect);
+
+        pixels += rect_area(rect);
+        if (solid >= 0) {
+            fill_window(rect, (uint16_t)solid);
+            continue;
+        }
+
+        for (int y = rect->y; y < rect->y + rect->height; y += rows) {
+            display_rect_t strip = { rect->x, y, rect->width, rows };
+            uint16_t *buf = strips[next_strip];
+
+            if (strip.y + strip.height > rect->y + rect->height) {
+                strip.height = rect->y + rect->height - strip.y;
+            }
+
+            // Compose this strip while the other one is still being sent
+            strip_wait(next_strip);
+            compose_strip(&strip, buf);
+            strip_solid[next_strip] = -1;
+            strip_sent[next_strip] = display_panel_draw(strip.x, strip.y, strip.width,
+                                                        strip.height, buf);
+            next_strip ^= 1;
+        }
     }
-    
-    // Draw line by line for the rectangle area
-    for (int row = 0; row < height; row++) {
-        esp_lcd_panel_draw_bitmap(panel_handle, x, y + row, x + width, y + row + 1, line);
+
+    op_count = 0;
+    flush_timing_record(display_panel_time_us() - start_us,
+                        display_panel_queued() - first_trans, pixels);
+}
+
+void display_scroll_init(int top, uint16_t bg_color) {
+    if (!display_ready || top < 0 || top > DISPLAY_HEIGHT) return;
+
+    if (top == DISPLAY_HEIGHT) {
+        // No chart: the whole screen scrolls by nothing
+        display_flush();
+        scroll_top = DISPLAY_HEIGHT;
+        display_panel_scroll_area(0, DISPLAY_HEIGHT);
+        display_panel_scroll_start(0);
+        return;
     }
-    
-    free(line);
+
+    display_rect_t area = { 0, top, DISPLAY_WIDTH, DISPLAY_HEIGHT - top };
+
+    // What is recorded may still draw over the area
+    display_flush();
+    fill_window(&area, color_to_display(bg_color));
+    scroll_top = top;
+    scroll_next = 0;
+    display_panel_scroll_area(top, area.height);
+    display_panel_scroll_start(top);
+}
+
+void display_scroll_add_row(int length, uint16_t color, uint16_t bg_color) {
+    if (!display_ready || scroll_top >= DISPLAY_HEIGHT) return;
+
+    uint16_t fg = color_to_display(color);
+    uint16_t bg = color_to_display(bg_color);
+    uint16_t *buf = strips[next_strip];
+
+    if (length < 0) length = 0;
+    if (length > DISPLAY_WIDTH) length = DISPLAY_WIDTH;
+
+    strip_wait(next_strip);
+    for (int x = 0; x < DISPLAY_WIDTH; x++) {
+        buf[x] = (x < length) ? fg : bg;
+    }
+    strip_solid[next_strip] = -1;
+    strip_sent[next_strip] = display_panel_draw(0, scroll_top + scroll_next, DISPLAY_WIDTH, 1, buf);
+    next_strip ^= 1;
+
+    // Start the area on the row after it, so the new one is at the bottom
+    scroll_next = (scroll_next + 1) % (DISPLAY_HEIGHT - scroll_top);
+    display_panel_scroll_start(scroll_top + scroll_next);
 }
 
 void display_set_backlight(int percent) {
     if (percent < 0) percent = 0;
     if (percent > 100) percent = 100;
     
-    // Simple on/off for now (could implement PWM)
-    gpio_set_level(TFT_BL, percent > 0 ? 1 : 0);
+    display_panel_set_backlight(percent);
+}
+
+int display_set_spi_clock(uint32_t clock_hz) {
+    if (!display_ready) return -1;
+
+    // What is recorded goes at the old rate
+    display_flush();
+    if (display_panel_set_clock(clock_hz) != 0) {
+        return -1;
+    }
+    ESP_LOGI(TAG, "SPI clock %lu Hz", (unsigned long)display_panel_clock());
+    return 0;
 }
 
 int display_get_width(void) {
@@ -313,3 +752,62 @@ void display_set_font(const font_t *font) {
 const font_t* display_get_font(void) {
     return current_font;
 }
+
+// Value below which percent of the sorted times fall
+static uint32_t percentile(const uint32_t *sorted, unsigned count, unsigned percent) {
+    return count ? sorted[(count - 1) * percent / 100] : 0;
+}
+
+// Called from any task: copies the totals under the lock, and sorts the
+// copy outside it
+void display_get_stats(display_stats_t *stats, bool reset) {
+    display_totals_t copy;
+    const display_totals_t *totals = &copy;
+    uint32_t sorted[DISPLAY_STATS_WINDOW];
+    unsigned count = 0;
+    uint64_t wait_sum = 0;
+    display_panel_stats_t panel;
+
+    TOTALS_LOCK();
+    copy = display_totals;
+    if (reset) {
+        memset(&display_totals, 0, sizeof(display_totals));
+    }
+    TOTALS_UNLOCK();
+
+    count = (totals->refreshes < DISPLAY_STATS_WINDOW) ? totals->refreshes : DISPLAY_STATS_WINDOW;
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+        display_panel_stats(&panel, false);
+        stats->refreshes = totals->refreshes;
+        stats->transactions = panel.transactions;
+        stats->bytes = panel.bytes;
+        stats->pixels = totals->pixels;
+        stats->glyph_hits = totals->glyph_hits;
+        stats->glyph_misses = totals->glyph_misses;
+        stats->spi_clock_hz = display_panel_clock();
+
+        // Few enough to sort on each read
+        for (unsigned i = 0; i < count; i++) {
+            uint32_t value = totals->refresh_us[i];
+            unsigned j = i;
+
+            for (; j > 0 && sorted[j - 1] > value; j--) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = value;
+            wait_sum += totals->wait_us[i];
+            if (totals->wait_us[i] > stats->wait_max_us) {
+                stats->wait_max_us = totals->wait_us[i];
+            }
+        }
+        stats->refresh_p50_us = percentile(sorted, count, 50);
+        stats->refresh_p90_us = percentile(sorted, count, 90);
+        stats->refresh_p99_us = percentile(sorted, count, 99);
+        stats->refresh_max_us = count ? sorted[count - 1] : 0;
+        stats->wait_mean_us = count ? (uint32_t)(wait_sum / count) : 0;
+    }
+    if (reset) {
+        display_panel_stats(NULL, true);
+    }
+}
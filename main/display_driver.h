@@ -1,6 +1,7 @@
 #ifndef DISPLAY_DRIVER_H
 #define DISPLAY_DRIVER_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // Don't define font_t here, it's defined in fonts.h
@@ -25,15 +26,56 @@ extern "C" {
 typedef struct font_t font_t;
 
 // Function declarations
+// Drawing calls are recorded and only reach the panel at display_flush(),
+// which sends the rectangles they touched and returns without waiting
+// for the transfers to finish
 int display_init(void);
 void display_clear(uint16_t color);
 void display_draw_string(int x, int y, const char *text, uint16_t color, uint16_t bg_color);
 void display_draw_string_font(int x, int y, const char *text, uint16_t color, uint16_t bg_color, const font_t *font);
 void display_fill_rect(int x, int y, int width, int height, uint16_t color);
+void display_flush(void);
+
+// A chart along the bottom of the screen, scrolled by the panel: from
+// top down the screen is cleared to bg_color and kept for rows added one
+// at a time, each drawn at the bottom as the others move up a row.  A
+// row is length pixels of color from the left.  Clears, rectangles and
+// strings stay above top from then on, until a top of the screen height
+// ends the chart.
+void display_scroll_init(int top, uint16_t bg_color);
+void display_scroll_add_row(int length, uint16_t color, uint16_t bg_color);
 void display_set_backlight(int percent);
 int display_get_width(void);
 int display_get_height(void);
 
+// Display performance.  Totals run from display_init() or the last
+// reset; times are over the last DISPLAY_STATS_WINDOW refreshes, the
+// display_flush() calls that sent something.  A refresh returns while
+// its last strips are still being sent, so its time is composing plus
+// waiting for SPI to free a strip.  Safe to read from another task; the
+// counters read may be a refresh apart.
+#define DISPLAY_STATS_WINDOW 64
+
+typedef struct {
+    uint32_t refreshes;
+    uint32_t transactions;      // SPI: commands, parameters and pixel chunks
+    uint32_t bytes;             // sent over SPI
+    uint32_t pixels;            // composed and sent by refreshes
+    uint32_t refresh_p50_us;
+    uint32_t refresh_p90_us;
+    uint32_t refresh_p99_us;
+    uint32_t refresh_max_us;
+    uint32_t wait_mean_us;      // per refresh, blocked waiting for SPI
+    uint32_t wait_max_us;
+    uint32_t glyph_hits;
+    uint32_t glyph_misses;
+    uint32_t spi_clock_hz;
+} display_stats_t;
+
+void display_get_stats(display_stats_t *stats, bool reset);
+// Change the SPI clock; 0 on success
+int display_set_spi_clock(uint32_t clock_hz);
+
 // Font management functions
 void display_set_font(const font_t *font);
 const font_t* display_get_font(void);
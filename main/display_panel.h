@@ -0,0 +1,69 @@
+#ifndef DISPLAY_PANEL_H
+#define DISPLAY_PANEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// The panel behind display_driver.c: the ST7789 on SPI on the board
+// (display_panel_st7789.c), or a framebuffer in RAM for host builds
+// (display_panel_mem.c).  Pixels are RGB565 as the panel takes them,
+// converted by color_to_display().
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DISPLAY_WIDTH  170
+#define DISPLAY_HEIGHT 320
+
+int display_panel_init(void);
+
+// Queue pixels for a window, a row at a time.  The buffer is read after
+// the call returns, until display_panel_wait() on the returned count.
+uint32_t display_panel_draw(int x, int y, int width, int height, const uint16_t *pixels);
+
+// Queue a window filled from a buffer of buffer_pixels, sent again and
+// again until the window is full, under one address window
+uint32_t display_panel_fill(int x, int y, int width, int height,
+                            const uint16_t *pixels, size_t buffer_pixels);
+
+// Transfers queued so far, and waiting for the panel to read them all
+uint32_t display_panel_queued(void);
+void display_panel_wait(uint32_t queued);
+
+// Vertical scrolling: the height rows from top on wrap around, and the
+// row of frame memory at first is shown at top.  Rows are screen rows;
+// memory rows above top and below the area stay where they are.
+void display_panel_scroll_area(int top, int height);
+void display_panel_scroll_start(int first);
+
+void display_panel_set_backlight(int percent);
+int64_t display_panel_time_us(void);
+
+// SPI clock: set waits for what is queued, then sends at the new rate;
+// 0 on success.  The clock read back is the one asked for.
+int display_panel_set_clock(uint32_t clock_hz);
+uint32_t display_panel_clock(void);
+
+// What was sent over SPI since the last reset.  The RAM panel counts
+// what the board would have sent.
+typedef struct {
+    uint32_t transactions;  // a command, its parameters and each data chunk
+    uint32_t bytes;
+} display_panel_stats_t;
+
+void display_panel_stats(display_panel_stats_t *stats, bool reset);
+
+#ifndef ESP_PLATFORM
+// Host builds: the frame memory so far, before scrolling
+const uint16_t *display_panel_mem_framebuffer(void);
+// The frame as the board's panel shows it, as a binary PPM; 0 on success
+int display_panel_mem_write_ppm(const char *path);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_PANEL_H */
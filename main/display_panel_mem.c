@@ -0,0 +1,183 @@
+/*
+ * Display panel: a framebuffer in RAM, for building the display on a host
+ *
+ * Not part of the firmware build.  Compile display_driver.c, this file
+ * and the fonts with the host compiler to render, benchmark and compare
+ * frames without the board.  Each call is counted as the SPI path would
+ * send it through esp_lcd: CASET and RASET each a command and a
+ * parameter transaction, then RAMWR, then one transaction per data chunk.
+ * Transfers complete at once.  Scrolling is applied when the frame is
+ * written out, as the panel applies it when it refreshes the glass.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "display_panel.h"
+
+// Bytes in a command, and in the parameters of CASET or RASET
+#define CMD_BYTES    1
+#define WINDOW_BYTES 4
+#define VSCRDEF_BYTES 6
+#define VSCSAD_BYTES  2
+
+static uint16_t framebuffer[DISPLAY_HEIGHT][DISPLAY_WIDTH];
+static display_panel_stats_t panel_stats;
+static uint32_t trans_queued = 0;
+static uint32_t panel_clock_hz = 10 * 1000 * 1000;
+
+// The window being written, and where the next pixel goes
+static int window_x0, window_x1, window_y1;
+static int cursor_x, cursor_y;
+
+// Vertical scrolling, no area by default
+static int scroll_top = 0;
+static int scroll_height = 0;
+static int scroll_first = 0;
+
+static void panel_window(int x, int y, int width, int height) {
+    window_x0 = x;
+    window_x1 = x + width - 1;
+    window_y1 = y + height - 1;
+    cursor_x = x;
+    cursor_y = y;
+    panel_stats.transactions += 4;
+    panel_stats.bytes += 2 * (CMD_BYTES + WINDOW_BYTES);
+}
+
+// Pixels continue in the window, a row at a time, as RAMWR does
+static void panel_write(const uint16_t *pixels, size_t count) {
+    panel_stats.transactions++;
+    panel_stats.bytes += count * sizeof(uint16_t);
+    for (size_t i = 0; i < count && cursor_y <= window_y1; i++) {
+        if (cursor_x >= 0 && cursor_x < DISPLAY_WIDTH && cursor_y >= 0 && cursor_y < DISPLAY_HEIGHT) {
+            framebuffer[cursor_y][cursor_x] = pixels[i];
+        }
+        if (++cursor_x > window_x1) {
+            cursor_x = window_x0;
+            cursor_y++;
+        }
+    }
+}
+
+// The memory row shown on a screen row
+static int shown_row(int y) {
+    if (y < scroll_top || y >= scroll_top + scroll_height) {
+        return y;
+    }
+    return scroll_top + (y - scroll_top + scroll_first - scroll_top) % scroll_height;
+}
+
+int display_panel_init(void) {
+    memset(framebuffer, 0, sizeof(framebuffer));
+    memset(&panel_stats, 0, sizeof(panel_stats));
+    scroll_top = 0;
+    scroll_height = 0;
+    scroll_first = 0;
+    return 0;
+}
+
+uint32_t display_panel_draw(int x, int y, int width, int height, const uint16_t *pixels) {
+    panel_window(x, y, width, height);
+    panel_stats.transactions++;     // RAMWR
+    panel_stats.bytes += CMD_BYTES;
+    panel_write(pixels, (size_t)width * height);
+    return ++trans_queued;
+}
+
+uint32_t display_panel_fill(int x, int y, int width, int height,
+                            const uint16_t *pixels, size_t buffer_pixels) {
+    size_t remaining = (size_t)width * height;
+
+    panel_window(x, y, width, height);
+    panel_stats.transactions++;     // RAMWR
+    panel_stats.bytes += CMD_BYTES;
+    while (remaining > 0) {
+        size_t chunk = (remaining > buffer_pixels) ? buffer_pixels : remaining;
+
+        panel_write(pixels, chunk);
+        trans_queued++;
+        remaining -= chunk;
+    }
+    return trans_queued;
+}
+
+void display_panel_scroll_area(int top, int height) {
+    scroll_top = top;
+    scroll_height = height;
+    panel_stats.transactions += 2;
+    panel_stats.bytes += CMD_BYTES + VSCRDEF_BYTES;
+}
+
+void display_panel_scroll_start(int first) {
+    scroll_first = first;
+    panel_stats.transactions += 2;
+    panel_stats.bytes += CMD_BYTES + VSCSAD_BYTES;
+}
+
+uint32_t display_panel_queued(void) {
+    return trans_queued;
+}
+
+void display_panel_wait(uint32_t queued) {
+    (void)queued;
+}
+
+void display_panel_set_backlight(int percent) {
+    (void)percent;
+}
+
+int64_t display_panel_time_us(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+int display_panel_set_clock(uint32_t clock_hz) {
+    panel_clock_hz = clock_hz;
+    return 0;
+}
+
+uint32_t display_panel_clock(void) {
+    return panel_clock_hz;
+}
+
+void display_panel_stats(display_panel_stats_t *stats, bool reset) {
+    if (stats) {
+        *stats = panel_stats;
+    }
+    if (reset) {
+        memset(&panel_stats, 0, sizeof(panel_stats));
+    }
+}
+
+const uint16_t *display_panel_mem_framebuffer(void) {
+    return &framebuffer[0][0];
+}
+
+int display_panel_mem_write_ppm(const char *path) {
+    FILE *file = fopen(path, "wb");
+
+    if (!file) {
+        return -1;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    for (int y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (int x = 0; x < DISPLAY_WIDTH; x++) {
+            // Undo the byte swap; the board's panel inverts the colours
+            // and takes them as BGR, which display_color() makes up for
+            uint16_t sent = framebuffer[shown_row(y)][x];
+            uint16_t shown = (uint16_t)~((sent << 8) | (sent >> 8));
+            uint8_t rgb[3] = {
+                (uint8_t)((shown & 0x1F) * 255 / 31),
+                (uint8_t)(((shown >> 5) & 0x3F) * 255 / 63),
+                (uint8_t)((shown >> 11) * 255 / 31),
+            };
+
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+    return (fclose(file) == 0) ? 0 : -1;
+}
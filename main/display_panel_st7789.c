@@ -0,0 +1,312 @@
+/*
+ * Display panel: the ST7789 on SPI, through esp_lcd
+ *
+ * Transfers are queued and sent by DMA; the on_color_trans_done callback
+ * counts them out, so the renderer knows when it may reuse a buffer.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/spi_master.h"
+#include "driver/gpio.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_commands.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+#include "sdkconfig.h"
+#include "display_panel.h"
+
+static const char *TAG = "DISPLAY_PANEL";
+
+// ===========================================
+// Display settings for Ideaspark 1.9"170x320
+// ===========================================
+#define LCD_HOST           SPI2_HOST
+#define TFT_MOSI           23
+#define TFT_SCLK           18
+#define TFT_CS             15
+#define TFT_DC             2
+#define TFT_RST            4
+#define TFT_BL             32
+#define SPI_CLOCK_HZ       (CONFIG_DISPLAY_SPI_CLOCK_MHZ * 1000 * 1000)
+#define TFT_OFFSET_X 35
+#define TFT_OFFSET_Y 0
+#define TFT_MEMORY_ROWS    320
+
+
+/*
+// ========================================
+// display settings for TTGO 1.14" 135x240
+// (DISPLAY_WIDTH and DISPLAY_HEIGHT are in display_panel.h)
+// ========================================
+#define LCD_HOST           SPI2_HOST
+#define TFT_MOSI 19
+#define TFT_SCLK 18
+#define TFT_CS   5
+#define TFT_DC   16
+#define TFT_RST  23
+#define TFT_BL   4
+#define TFT_OFFSET_X 52
+#define TFT_OFFSET_Y 40
+#define TFT_MEMORY_ROWS    320
+#define SPI_CLOCK_HZ       (CONFIG_DISPLAY_SPI_CLOCK_MHZ * 1000 * 1000)
+*/
+
+static esp_lcd_panel_handle_t panel_handle = NULL;
+static esp_lcd_panel_io_handle_t io_handle = NULL;
+static uint32_t panel_clock_hz = 0;
+
+// Bytes in a command, and in the parameters of CASET or RASET
+#define CMD_BYTES    1
+#define WINDOW_BYTES 4
+
+// Counted as esp_lcd sends them: a command and its parameters are two
+// transactions, and so are RAMWR and the first chunk of pixels
+static display_panel_stats_t panel_stats;
+
+// Pixel transfers queued and completed: the SPI driver reads pixel
+// buffers after esp_lcd_panel_draw_bitmap() returns, so a buffer can only
+// be reused once its transfer is counted as done
+static volatile uint32_t trans_queued = 0;
+static volatile uint32_t trans_done = 0;
+static SemaphoreHandle_t trans_done_sem = NULL;
+
+// Called from the SPI interrupt when a pixel transfer has been sent
+static bool color_trans_done(esp_lcd_panel_io_handle_t panel_io,
+                             esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+    BaseType_t woken = pdFALSE;
+
+    trans_done++;
+    xSemaphoreGiveFromISR(trans_done_sem, &woken);
+    return woken == pdTRUE;
+}
+
+// Panel IO at a clock, and the ST7789 driver on it, set up as the board
+// needs; the hardware reset only the first time
+static int panel_create(uint32_t clock_hz, bool reset) {
+    esp_lcd_panel_io_spi_config_t io_config = {
+        .dc_gpio_num = TFT_DC,
+        .cs_gpio_num = TFT_CS,
+        .pclk_hz = clock_hz,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+        .spi_mode = 3,
+        .trans_queue_depth = 10,
+        .on_color_trans_done = color_trans_done,
+        .user_ctx = NULL,
+        .flags = {
+            .dc_low_on_data = 0,
+            .octal_mode = 0,
+            .sio_mode = 0,
+            .lsb_first = 0,
+            .cs_high_active = 0,
+        },
+    };
+
+    esp_err_t ret = esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)LCD_HOST, &io_config, &io_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to configure LCD IO: %s", esp_err_to_name(ret));
+        return -1;
+    }
+
+    // Install ST7789 panel driver
+    esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = TFT_RST,
+        .color_space = ESP_LCD_COLOR_SPACE_RGB,
+        .bits_per_pixel = 16,
+    };
+
+    ret = esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install ST7789 driver: %s", esp_err_to_name(ret));
+        esp_lcd_panel_io_del(io_handle);
+        return -1;
+    }
+
+    // Initialize display panel
+    if (reset) {
+        esp_lcd_panel_reset(panel_handle);
+    }
+    esp_lcd_panel_init(panel_handle);
+
+    // Set Memory Access Control (MADCTL) - BGR mode
+    uint8_t madctl = 0x08;  // BGR MODE
+    esp_lcd_panel_io_tx_param(io_handle, 0x36, &madctl, 1);
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    // Set Display offset
+    esp_lcd_panel_set_gap(panel_handle, TFT_OFFSET_X, TFT_OFFSET_Y);
+
+    // Turn on display
+    esp_lcd_panel_disp_on_off(panel_handle, true);
+    panel_clock_hz = clock_hz;
+    return 0;
+}
+
+int display_panel_init(void) {
+    ESP_LOGI(TAG, "Initializing TTGO T-Display");
+
+    // 1. Initialize SPI bus
+    spi_bus_config_t buscfg = {
+        .sclk_io_num = TFT_SCLK,
+        .mosi_io_num = TFT_MOSI,
+        .miso_io_num = -1,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = DISPLAY_WIDTH * DISPLAY_HEIGHT * 2,
+    };
+
+    trans_done_sem = xSemaphoreCreateBinary();
+    if (!trans_done_sem) {
+        ESP_LOGE(TAG, "Failed to create transfer semaphore");
+        return -1;
+    }
+
+    esp_err_t ret = spi_bus_initialize(LCD_HOST, &buscfg, SPI_DMA_CH_AUTO);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI bus initialization failed: %s", esp_err_to_name(ret));
+        return -1;
+    }
+
+    // 2. Panel IO and ST7789 driver
+    if (panel_create(SPI_CLOCK_HZ, true) != 0) {
+        spi_bus_free(LCD_HOST);
+        return -1;
+    }
+
+    // 3. Enable backlight
+    gpio_reset_pin(TFT_BL);
+    gpio_set_direction(TFT_BL, GPIO_MODE_OUTPUT);
+    gpio_set_level(TFT_BL, 1);
+
+    ESP_LOGI(TAG, "Display initialized successfully, SPI at %lu Hz", (unsigned long)panel_clock_hz);
+    return 0;
+}
+
+// The IO's clock is fixed when it is created: make a new one, and the
+// panel driver on it.  The panel keeps its memory.
+int display_panel_set_clock(uint32_t clock_hz) {
+    uint32_t old_clock_hz = panel_clock_hz;
+
+    display_panel_wait(trans_queued);
+    esp_lcd_panel_del(panel_handle);
+    esp_lcd_panel_io_del(io_handle);
+    panel_handle = NULL;
+    io_handle = NULL;
+    if (panel_create(clock_hz, false) == 0) {
+        return 0;
+    }
+    // Back to the clock that worked
+    panel_create(old_clock_hz, false);
+    return -1;
+}
+
+uint32_t display_panel_clock(void) {
+    return panel_clock_hz;
+}
+
+void display_panel_stats(display_panel_stats_t *stats, bool reset) {
+    if (stats) {
+        *stats = panel_stats;
+    }
+    if (reset) {
+        memset(&panel_stats, 0, sizeof(panel_stats));
+    }
+}
+
+uint32_t display_panel_draw(int x, int y, int width, int height, const uint16_t *pixels) {
+    trans_queued++;
+    if (esp_lcd_panel_draw_bitmap(panel_handle, x, y, x + width, y + height, pixels) != ESP_OK) {
+        trans_queued--;
+        return trans_queued;
+    }
+    // CASET, RASET, RAMWR and the pixels
+    panel_stats.transactions += 6;
+    panel_stats.bytes += 3 * CMD_BYTES + 2 * WINDOW_BYTES + (uint32_t)width * height * sizeof(uint16_t);
+    return trans_queued;
+}
+
+uint32_t display_panel_fill(int x, int y, int width, int height,
+                            const uint16_t *pixels, size_t buffer_pixels) {
+    int x_end = x + width - 1 + TFT_OFFSET_X;
+    int y_end = y + height - 1 + TFT_OFFSET_Y;
+    int x_start = x + TFT_OFFSET_X;
+    int y_start = y + TFT_OFFSET_Y;
+    uint8_t caset[4] = { x_start >> 8, x_start & 0xFF, x_end >> 8, x_end & 0xFF };
+    uint8_t raset[4] = { y_start >> 8, y_start & 0xFF, y_end >> 8, y_end & 0xFF };
+    size_t remaining = (size_t)width * height;
+    int cmd = LCD_CMD_RAMWR;
+
+    // The window esp_lcd_panel_draw_bitmap() would set, gap included
+    esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_CASET, caset, sizeof(caset));
+    esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_RASET, raset, sizeof(raset));
+    panel_stats.transactions += 4;
+    panel_stats.bytes += 2 * (CMD_BYTES + WINDOW_BYTES);
+    while (remaining > 0) {
+        size_t chunk = (remaining > buffer_pixels) ? buffer_pixels : remaining;
+
+        // RAMWR once, then the panel carries on where the last chunk ended
+        trans_queued++;
+        if (esp_lcd_panel_io_tx_color(io_handle, cmd, pixels, chunk * sizeof(uint16_t)) != ESP_OK) {
+            trans_queued--;
+            break;
+        }
+        panel_stats.transactions += (cmd == -1) ? 1 : 2;
+        panel_stats.bytes += ((cmd == -1) ? 0 : CMD_BYTES) + chunk * sizeof(uint16_t);
+        cmd = -1;
+        remaining -= chunk;
+    }
+    return trans_queued;
+}
+
+// VSCRDEF: top fixed area, scroll area and bottom fixed area, which add
+// up to the 320 rows of ST7789 memory whatever the glass shows
+void display_panel_scroll_area(int top, int height) {
+    int fixed_top = top + TFT_OFFSET_Y;
+    int fixed_bottom = TFT_MEMORY_ROWS - fixed_top - height;
+    uint8_t vscrdef[6] = {
+        fixed_top >> 8, fixed_top & 0xFF,
+        height >> 8, height & 0xFF,
+        fixed_bottom >> 8, fixed_bottom & 0xFF,
+    };
+
+    esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_VSCRDEF, vscrdef, sizeof(vscrdef));
+    panel_stats.transactions += 2;
+    panel_stats.bytes += CMD_BYTES + sizeof(vscrdef);
+}
+
+// VSCSAD: the memory row shown first in the scroll area
+void display_panel_scroll_start(int first) {
+    int row = first + TFT_OFFSET_Y;
+    uint8_t vscsad[2] = { row >> 8, row & 0xFF };
+
+    esp_lcd_panel_io_tx_param(io_handle, LCD_CMD_VSCSAD, vscsad, sizeof(vscsad));
+    panel_stats.transactions += 2;
+    panel_stats.bytes += CMD_BYTES + sizeof(vscsad);
+}
+
+uint32_t display_panel_queued(void) {
+    return trans_queued;
+}
+
+// Wait until the panel has read every pixel buffer queued up to the
+// given value of trans_queued
+void display_panel_wait(uint32_t queued) {
+    while ((int32_t)(trans_done - queued) < 0) {
+        xSemaphoreTake(trans_done_sem, portMAX_DELAY);
+    }
+}
+
+void display_panel_set_backlight(int percent) {
+    // Simple on/off for now (could implement PWM)
+    gpio_set_level(TFT_BL, percent > 0 ? 1 : 0);
+}
+
+int64_t display_panel_time_us(void) {
+    return esp_timer_get_time();
+}
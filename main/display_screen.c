@@ -0,0 +1,131 @@
+/*
+ * Display screen for BACnet PM2.5 Monitor - the table of widgets and
+ * the chart.  The values are widgets bound to the BACnet objects and are
+ * redrawn only when their object changes.  Below them, the PM2.5 of the
+ * last hour scrolls up, a row per sample, in the panel's hardware
+ * scroll area.
+ */
+#include "display_driver.h"
+#include "display_screen.h"
+#include "display_widget.h"
+#include "fonts.h"
+
+/* Display layout */
+#define LINE_HEIGHT      10
+#define BIG_LINE_HEIGHT  24    // PM2.5 value, in font_sans24
+#define LINE_SPACING     2
+#define LEFT_MARGIN      5
+#define TOP_MARGIN       5
+
+/* Consistent Y positions for all lines */
+#define LINE1_Y (TOP_MARGIN)                                // ID: 123456
+#define LINE2_Y (LINE1_Y + LINE_HEIGHT + LINE_SPACING)      // IP:
+#define LINE3_Y (LINE2_Y + LINE_HEIGHT + LINE_SPACING + LINE_HEIGHT)  // PM1.0: (after space)
+#define LINE4_Y (LINE3_Y + LINE_HEIGHT + LINE_SPACING)      // PM2.5: (big)
+#define LINE5_Y (LINE4_Y + BIG_LINE_HEIGHT + LINE_SPACING)  // PM10:
+#define LINE6_Y (LINE5_Y + LINE_HEIGHT + LINE_SPACING + LINE_HEIGHT)  // Setpoint: (after space)
+#define LINE7_Y (LINE6_Y + LINE_HEIGHT + LINE_SPACING)      // FAN ON/OFF:
+#define LINE8_Y (LINE7_Y + LINE_HEIGHT + LINE_SPACING)      // FAN STATUS:
+#define LINE9_Y (LINE8_Y + LINE_HEIGHT + LINE_SPACING)      // Sensor Error:
+#define LINE10_Y (LINE9_Y + LINE_HEIGHT + LINE_SPACING + LINE_HEIGHT)  // chart title (after space)
+
+/* PM2.5 chart: one row per sample to the bottom of the screen, the
+ * newest at the bottom, as long as the value is against full scale */
+#define CHART_TOP        (LINE10_Y + LINE_HEIGHT + LINE_SPACING)
+#define CHART_FULL_SCALE 100.0f     // ug/m3 across the width
+
+/* X positions for dynamic data (right of labels) */
+#define DATA_X_PM        65    // X position for PM values
+#define DATA_X_PM_BIG    45    // X position for the big PM2.5 value
+#define UNIT_X_PM_BIG    128   // and its unit
+#define BIG_TEXT_OFFSET  10    // small text beside it, on its baseline
+#define DATA_X_SETPOINT  75    // X position for setpoint
+#define DATA_X_IP        35    // X position for IP address
+#define DATA_X_FAN       85    // X position for FAN status
+#define DATA_X_ERROR     95    // X position for sensor error
+
+/* Object instance definitions */
+#define PM1_0_OBJECT_INSTANCE           0
+#define PM2_5_OBJECT_INSTANCE           1
+#define PM10_OBJECT_INSTANCE            2
+#define PM2_5_SETPOINT_INSTANCE         3
+#define FAN_COMMAND_OBJECT_INSTANCE     0    // Binary_Output: Command to control fan
+#define FAN_STATUS_OBJECT_INSTANCE      0    // Binary_Input: Actual fan status from GPIO
+#define SENSOR_ERROR_OBJECT_INSTANCE    0
+
+static const widget_color_rule_t pm25_colors[] = {
+    { 35.0f, DISP_RED },
+    { 12.0f, DISP_YELLOW },
+};
+
+#define LABEL(ypos, label, fg) \
+    { .kind = WIDGET_LABEL, .x = LEFT_MARGIN, .y = (ypos), .color = (fg), .show.text = (label) }
+
+#define PM_VALUE(ypos, instance, fg) \
+    { .kind = WIDGET_ANALOG, .x = DATA_X_PM, .y = (ypos), .width = 80, .color = (fg), \
+      .object_type = OBJECT_ANALOG_VALUE, .object_instance = (instance), \
+      .show.analog = { .format = "%.1f ug/m3" } }
+
+static const display_widget_t screen[] = {
+    LABEL(LINE1_Y, "ID: 123456", DISP_WHITE),
+    LABEL(LINE2_Y, "IP:", DISP_WHITE),
+    LABEL(LINE3_Y, "PM1.0:", DISP_CYAN),
+    LABEL(LINE4_Y + BIG_TEXT_OFFSET, "PM2.5:", DISP_WHITE),
+    LABEL(LINE5_Y, "PM10:", DISP_CYAN),
+    LABEL(LINE6_Y, "Setpoint:", DISP_WHITE),
+    LABEL(LINE7_Y, "FAN ON/OFF:", DISP_WHITE),
+    LABEL(LINE8_Y, "FAN STATUS:", DISP_WHITE),
+    LABEL(LINE9_Y, "Sensor Error:", DISP_WHITE),
+    { .kind = WIDGET_LABEL, .x = UNIT_X_PM_BIG, .y = LINE4_Y + BIG_TEXT_OFFSET,
+      .color = DISP_WHITE, .show.text = "ug/m3" },
+    LABEL(LINE10_Y, "PM2.5, last hour:", DISP_WHITE),
+    { .kind = WIDGET_TEXT, .x = DATA_X_IP, .y = LINE2_Y, .width = 100, .color = DISP_WHITE,
+      .show.get_text = display_screen_ip },
+    PM_VALUE(LINE3_Y, PM1_0_OBJECT_INSTANCE, DISP_CYAN),
+    { .kind = WIDGET_ANALOG, .x = DATA_X_PM_BIG, .y = LINE4_Y, .width = UNIT_X_PM_BIG - DATA_X_PM_BIG - 2,
+      .color = DISP_GREEN, .font = &font_sans24,
+      .object_type = OBJECT_ANALOG_VALUE, .object_instance = PM2_5_OBJECT_INSTANCE,
+      .show.analog = { .format = "%.1f", .rules = pm25_colors,
+                       .rule_count = sizeof(pm25_colors) / sizeof(pm25_colors[0]) } },
+    PM_VALUE(LINE5_Y, PM10_OBJECT_INSTANCE, DISP_CYAN),
+    { .kind = WIDGET_ANALOG, .x = DATA_X_SETPOINT, .y = LINE6_Y, .width = 80, .color = DISP_WHITE,
+      .object_type = OBJECT_ANALOG_VALUE, .object_instance = PM2_5_SETPOINT_INSTANCE,
+      .show.analog = { .format = "%.1f ug/m3" } },
+    { .kind = WIDGET_BINARY, .x = DATA_X_FAN, .y = LINE7_Y, .width = 30, .color = DISP_WHITE,
+      .object_type = OBJECT_BINARY_OUTPUT, .object_instance = FAN_COMMAND_OBJECT_INSTANCE,
+      .show.binary = { "ON", DISP_GREEN, "OFF" } },
+    { .kind = WIDGET_BINARY, .x = DATA_X_FAN, .y = LINE8_Y, .width = 30, .color = DISP_WHITE,
+      .object_type = OBJECT_BINARY_INPUT, .object_instance = FAN_STATUS_OBJECT_INSTANCE,
+      .show.binary = { "ON", DISP_GREEN, "OFF" } },
+    { .kind = WIDGET_BINARY, .x = DATA_X_ERROR, .y = LINE9_Y, .width = 40, .color = DISP_GREEN,
+      .object_type = OBJECT_BINARY_VALUE, .object_instance = SENSOR_ERROR_OBJECT_INSTANCE,
+      .show.binary = { "ERROR", DISP_RED, "OK" } },
+};
+
+void display_screen_splash(void)
+{
+    display_clear(DISP_BLACK);
+    display_draw_string(LEFT_MARGIN, 50, "BACnet Monitor", DISP_WHITE, DISP_BLACK);
+    display_draw_string(LEFT_MARGIN, 70, "Starting...", DISP_GREEN, DISP_BLACK);
+    display_flush();
+}
+
+void display_screen_init(void)
+{
+    display_widgets_init(screen, sizeof(screen) / sizeof(screen[0]));
+    display_scroll_init(CHART_TOP, DISP_BLACK);
+}
+
+void display_screen_chart_add(float pm2_5)
+{
+    uint16_t color = DISP_GREEN;
+
+    for (unsigned r = 0; r < sizeof(pm25_colors) / sizeof(pm25_colors[0]); r++) {
+        if (pm2_5 > pm25_colors[r].above) {
+            color = pm25_colors[r].color;
+            break;
+        }
+    }
+    display_scroll_add_row((int)(pm2_5 * display_get_width() / CHART_FULL_SCALE + 0.5f),
+                           color, DISP_BLACK);
+}
@@ -0,0 +1,33 @@
+#ifndef DISPLAY_SCREEN_H
+#define DISPLAY_SCREEN_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The monitor's screen: where each label and value goes, the objects the
+// values show, their colours, and the PM2.5 chart below them.  Free of
+// ESP-IDF calls, so the host build renders the same screen the board
+// shows (host_test/test_display_screen.c).
+
+// "Starting..." while the device comes up; flushed
+void display_screen_splash(void);
+
+// Take the screen: bind its values to their objects and start the chart.
+// Call from the task that draws it; display_widgets_update() draws it.
+void display_screen_init(void);
+
+// A PM2.5 sample at the bottom of the chart, coloured as the value is
+void display_screen_chart_add(float pm2_5);
+
+// The device's address, as the IP line shows it.  Provided by whatever
+// runs the screen: display_task.c on the board.
+void display_screen_ip(char *text, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_SCREEN_H */
@@ -5,6 +5,19 @@
 extern "C" {
 #endif
 
+/* Proprietary properties of the Device, read only, all Unsigned: the
+ * display's performance (see display_get_stats()); times in us */
+#define PROP_DISPLAY_REFRESHES          530
+#define PROP_DISPLAY_SPI_TRANSACTIONS   531
+#define PROP_DISPLAY_SPI_BYTES          532
+#define PROP_DISPLAY_REFRESH_P50        533
+#define PROP_DISPLAY_REFRESH_P90        534
+#define PROP_DISPLAY_REFRESH_P99        535
+#define PROP_DISPLAY_REFRESH_MAX        536
+#define PROP_DISPLAY_SPI_WAIT           537     /* mean per refresh */
+#define PROP_DISPLAY_SPI_WAIT_MAX       538
+#define PROP_DISPLAY_SPI_CLOCK          539     /* Hz */
+
 void display_task(void *arg);
 
 #ifdef __cplusplus
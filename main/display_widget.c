@@ -0,0 +1,280 @@
+/*
+ * Display widgets: a screen of labels and values bound to BACnet objects
+ *
+ * The objects report every change through handler_cov_object_changed().
+ * Each object on screen keeps a version, bumped there, and the drawing
+ * task is notified.  An update reads only the widgets whose object moved
+ * on, under the object lock, and draws the ones whose text or colour
+ * came out different.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "av.h"
+#include "bi.h"
+#include "bo.h"
+#include "bv.h"
+#include "handlers.h"
+#include "display_driver.h"
+#include "server_task.h"
+#include "display_widget.h"
+
+static const char *TAG = "WIDGETS";
+
+#define MAX_WIDGETS         24
+#define MAX_WIDGET_POINTS   16
+#define WIDGET_TEXT_MAX     24
+
+// An object shown on screen
+typedef struct {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    volatile uint32_t version;      // bumped on each change
+} widget_point_t;
+
+typedef struct {
+    int point;                      // index in widget_points, -1 for none
+    uint32_t version;               // of the point, or text_version, when read
+    bool drawn;
+    char text[WIDGET_TEXT_MAX];     // as drawn
+    uint16_t color;
+} widget_state_t;
+
+static const display_widget_t *widgets;
+static unsigned widget_count;
+static widget_state_t widget_states[MAX_WIDGETS];
+static widget_point_t widget_points[MAX_WIDGET_POINTS];
+static unsigned widget_point_count;
+static volatile uint32_t text_version;
+static TaskHandle_t widget_task;
+static bool screen_drawn;
+
+// Read on each update, then compared with what is drawn
+static char fresh_text[MAX_WIDGETS][WIDGET_TEXT_MAX];
+static uint16_t fresh_color[MAX_WIDGETS];
+
+static const font_t *widget_font(const display_widget_t *widget)
+{
+    return widget->font ? widget->font : display_get_font();
+}
+
+static int widget_height(const display_widget_t *widget)
+{
+    return widget->font ? widget->font->char_height : WIDGET_HEIGHT;
+}
+
+// Called by the objects, with the object lock held, on every change
+static void widget_object_changed(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    for (unsigned i = 0; i < widget_point_count; i++) {
+        widget_point_t *point = &widget_points[i];
+
+        if ((point->object_type == object_type) &&
+            (point->object_instance == object_instance)) {
+            point->version++;
+            xTaskNotifyGive(widget_task);
+            return;
+        }
+    }
+}
+
+static int widget_point_bind(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    for (unsigned i = 0; i < widget_point_count; i++) {
+        if ((widget_points[i].object_type == object_type) &&
+            (widget_points[i].object_instance == object_instance)) {
+            return (int)i;
+        }
+    }
+    if (widget_point_count >= MAX_WIDGET_POINTS) {
+        ESP_LOGW(TAG, "No room to watch object %d:%lu, its widgets are drawn once",
+                 (int)object_type, (unsigned long)object_instance);
+        return -1;
+    }
+    widget_points[widget_point_count].object_type = object_type;
+    widget_points[widget_point_count].object_instance = object_instance;
+    widget_points[widget_point_count].version = 0;
+    return (int)widget_point_count++;
+}
+
+static bool widget_binary_value(BACNET_OBJECT_TYPE object_type, uint32_t object_instance,
+                                BACNET_BINARY_PV *value)
+{
+    switch (object_type) {
+        case OBJECT_BINARY_INPUT:
+            if (!Binary_Input_Valid_Instance(object_instance)) return false;
+            *value = Binary_Input_Present_Value(object_instance);
+            return true;
+        case OBJECT_BINARY_OUTPUT:
+            if (!Binary_Output_Valid_Instance(object_instance)) return false;
+            *value = Binary_Output_Present_Value(object_instance);
+            return true;
+        case OBJECT_BINARY_VALUE:
+            if (!Binary_Value_Valid_Instance(object_instance)) return false;
+            *value = Binary_Value_Present_Value(object_instance);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The text and colour a widget shows now.  Values are read from the
+// objects, so this takes the object lock for them.
+static void widget_read(const display_widget_t *widget, char *text, size_t size, uint16_t *color)
+{
+    BACNET_BINARY_PV state = BINARY_INACTIVE;
+    float value = 0.0f;
+
+    *color = widget->color;
+    switch (widget->kind) {
+        case WIDGET_ANALOG:
+            if ((widget->object_type != OBJECT_ANALOG_VALUE) ||
+                !Analog_Value_Valid_Instance(widget->object_instance)) {
+                snprintf(text, size, "ERR");
+                break;
+            }
+            value = Analog_Value_Present_Value(widget->object_instance);
+            snprintf(text, size, widget->show.analog.format, value);
+            for (unsigned i = 0; i < widget->show.analog.rule_count; i++) {
+                if (value > widget->show.analog.rules[i].above) {
+                    *color = widget->show.analog.rules[i].color;
+                    break;
+                }
+            }
+            break;
+        case WIDGET_BINARY:
+            if (!widget_binary_value(widget->object_type, widget->object_instance, &state)) {
+                snprintf(text, size, "ERR");
+            } else if (state == BINARY_ACTIVE) {
+                snprintf(text, size, "%s", widget->show.binary.active_text);
+                *color = widget->show.binary.active_color;
+            } else {
+                snprintf(text, size, "%s", widget->show.binary.inactive_text);
+            }
+            break;
+        case WIDGET_TEXT:
+            widget->show.get_text(text, size);
+            break;
+        default:
+            snprintf(text, size, "%s", widget->show.text);
+            break;
+    }
+}
+
+void display_widgets_init(const display_widget_t *screen, unsigned count)
+{
+    if (count > MAX_WIDGETS) {
+        ESP_LOGW(TAG, "%u widgets, only the first %u are shown", count, MAX_WIDGETS);
+        count = MAX_WIDGETS;
+    }
+    widgets = screen;
+    widget_count = count;
+    widget_point_count = 0;
+    widget_task = xTaskGetCurrentTaskHandle();
+    screen_drawn = false;
+
+    for (unsigned i = 0; i < widget_count; i++) {
+        widget_state_t *state = &widget_states[i];
+
+        memset(state, 0, sizeof(*state));
+        state->point = -1;
+        if ((widgets[i].kind == WIDGET_ANALOG) || (widgets[i].kind == WIDGET_BINARY)) {
+            state->point = widget_point_bind(widgets[i].object_type, widgets[i].object_instance);
+        }
+    }
+
+    // The point table is complete before the objects can call in
+    handler_cov_object_changed_notify_set(widget_object_changed);
+    ESP_LOGI(TAG, "%u widgets watching %u objects", widget_count, widget_point_count);
+}
+
+unsigned display_widgets_update(void)
+{
+    bool dirty[MAX_WIDGETS];
+    unsigned drawn = 0;
+
+    if (!screen_drawn) {
+        display_clear(DISP_BLACK);
+    }
+
+    // Read what changed under the lock, draw it after
+    server_objects_lock();
+    for (unsigned i = 0; i < widget_count; i++) {
+        const display_widget_t *widget = &widgets[i];
+        widget_state_t *state = &widget_states[i];
+        uint32_t version = 0;
+
+        dirty[i] = false;
+        if ((widget->kind == WIDGET_LABEL) || (widget->kind == WIDGET_TEXT)) {
+            continue;
+        }
+        if (state->point >= 0) {
+            version = widget_points[state->point].version;
+        }
+        if (state->drawn && (version == state->version)) {
+            continue;
+        }
+        state->version = version;
+        dirty[i] = true;
+        widget_read(widget, fresh_text[i], WIDGET_TEXT_MAX, &fresh_color[i]);
+    }
+    server_objects_unlock();
+
+    for (unsigned i = 0; i < widget_count; i++) {
+        const display_widget_t *widget = &widgets[i];
+        widget_state_t *state = &widget_states[i];
+
+        if (widget->kind == WIDGET_LABEL) {
+            if (!screen_drawn) {
+                display_draw_string_font(widget->x, widget->y, widget->show.text,
+                                         widget->color, DISP_BLACK, widget_font(widget));
+                drawn++;
+            }
+            continue;
+        }
+        if ((widget->kind == WIDGET_TEXT) &&
+            (!state->drawn || (state->version != text_version))) {
+            state->version = text_version;
+            dirty[i] = true;
+            widget_read(widget, fresh_text[i], WIDGET_TEXT_MAX, &fresh_color[i]);
+        }
+        if (!dirty[i]) {
+            continue;
+        }
+        if (state->drawn && (fresh_color[i] == state->color) &&
+            (strcmp(fresh_text[i], state->text) == 0)) {
+            continue;
+        }
+
+        display_fill_rect(widget->x, widget->y, widget->width, widget_height(widget), DISP_BLACK);
+        display_draw_string_font(widget->x, widget->y, fresh_text[i], fresh_color[i], DISP_BLACK,
+                                 widget_font(widget));
+        memcpy(state->text, fresh_text[i], WIDGET_TEXT_MAX);
+        state->color = fresh_color[i];
+        state->drawn = true;
+        drawn++;
+    }
+
+    screen_drawn = true;
+    display_flush();
+    return drawn;
+}
+
+void display_widgets_invalidate_text(void)
+{
+    text_version++;
+    display_widgets_notify();
+}
+
+void display_widgets_notify(void)
+{
+    if (widget_task) {
+        xTaskNotifyGive(widget_task);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef DISPLAY_WIDGET_H
+#define DISPLAY_WIDGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bacenum.h"
+#include "fonts.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Height of the area cleared behind a value in the default font
+#define WIDGET_HEIGHT 10
+
+// What a widget shows
+typedef enum {
+    WIDGET_LABEL = 0,   // fixed text, drawn with the screen
+    WIDGET_ANALOG,      // Present_Value of an Analog Value, formatted
+    WIDGET_BINARY,      // Present_Value of a binary object, as one of two texts
+    WIDGET_TEXT         // text from a function, redrawn on display_widgets_invalidate_text()
+} widget_kind_t;
+
+// A value above the threshold takes the colour; the first match wins
+typedef struct {
+    float above;
+    uint16_t color;
+} widget_color_rule_t;
+
+// One widget of a screen.  A value is drawn in color, over a cleared
+// area width pixels wide, and redrawn only when its object reports a
+// change and the text or colour it gives is different.
+typedef struct {
+    widget_kind_t kind;
+    int x;
+    int y;
+    int width;
+    uint16_t color;
+    const font_t *font;                 // NULL for the display's font
+    BACNET_OBJECT_TYPE object_type;     // WIDGET_ANALOG, WIDGET_BINARY
+    uint32_t object_instance;
+    union {
+        const char *text;               // WIDGET_LABEL
+        struct {
+            const char *format;         // printf format of a float
+            const widget_color_rule_t *rules;
+            unsigned rule_count;
+        } analog;                       // WIDGET_ANALOG
+        struct {
+            const char *active_text;
+            uint16_t active_color;
+            const char *inactive_text;  // in color
+        } binary;                       // WIDGET_BINARY
+        void (*get_text)(char *text, size_t size);  // WIDGET_TEXT
+    } show;
+} display_widget_t;
+
+// Take the screen and bind its values to their objects.  Call from the
+// task that draws it, which is notified of changes from then on.
+void display_widgets_init(const display_widget_t *widgets, unsigned count);
+
+// Redraw the widgets whose objects changed, all of them the first time,
+// and flush.  Returns how many were drawn.
+unsigned display_widgets_update(void);
+
+// The WIDGET_TEXT widgets have something new to show
+void display_widgets_invalidate_text(void);
+
+// Wake the drawing task for something else it shows
+void display_widgets_notify(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISPLAY_WIDGET_H */
@@ -10,6 +10,7 @@
 #include "esp_log.h"
 #include "bacnet_config.h"
 #include "server_task.h"
+#include "control_task.h"
 #include "wifi.h"
 #include "device.h"
 #include "config.h"
@@ -33,8 +34,11 @@
 #include "bi.h"
 #include "bo.h"
 #include "bv.h"
+#include "lo.h"
+#include "objpool.h"
 #include "sdkconfig.h"
 #include "pm25_sensor.h"            // Our PM sensor module
+#include "point_binding.h"
 #include "config.h"
 #include "display_task.h"
 
@@ -55,6 +59,9 @@
 // Binary Value instances
 #define SENSOR_ERROR_OBJECT_INSTANCE   0      // Instance 0 for SENSOR_ERROR
 
+// Loop instances
+#define FAN_LOOP_OBJECT_INSTANCE       0      // Instance 0 for FAN_CONTROL
+
 static const char *TAG = "main";
 
 static void Init_Service_Handlers(void);
@@ -82,22 +89,6 @@ void app_main(void)
     // Initialize PM sensor
     pm25_sensor_init();
 
-    // Initialize BACnet objects FIRST
-    ESP_LOGI(TAG, "Initializing BACnet objects...");
-    Analog_Value_Init();
-    Binary_Input_Init();
-    Binary_Output_Init();
-    Binary_Value_Init();
-
-    // Verify the setpoint is initialized to 25.0
-    float setpoint = Analog_Value_Present_Value(PM2_5_SETPOINT_OBJECT_INSTANCE);
-    ESP_LOGI(TAG, "Initial PM2.5 setpoint value: %.1f", setpoint);
-
-    // You can also explicitly set it to ensure it's 25.0
-    Analog_Value_Present_Value_Set(PM2_5_SETPOINT_OBJECT_INSTANCE, 25.0, 16);
-    setpoint = Analog_Value_Present_Value(PM2_5_SETPOINT_OBJECT_INSTANCE);
-    ESP_LOGI(TAG, "After explicit set, PM2.5 setpoint: %.1f", setpoint);
-
     /* allow the device ID to be set */
     Device_Set_Object_Instance_Number(SERVER_DEVICE_ID);
 
@@ -113,7 +104,14 @@ void app_main(void)
     printf("  Instance %d: PM1.0 Concentration\n", PM1_0_OBJECT_INSTANCE);
     printf("  Instance %d: PM2.5 Concentration\n", PM2_5_OBJECT_INSTANCE);
     printf("  Instance %d: PM10 Concentration\n", PM10_OBJECT_INSTANCE);
-    printf("  Instance %d: PM2.5_SETPOINT (Default: 25.0 μg/m³)\n\n", PM2_5_SETPOINT_OBJECT_INSTANCE);
+    printf("  Instance %d: PM2.5_SETPOINT (Default: 25.0 μg/m³)\n", PM2_5_SETPOINT_OBJECT_INSTANCE);
+    printf("  Instances 4-6: PM1.0, PM2.5, PM10 Atmospheric\n");
+    printf("  Instances 7-12: Particles >0.3, 0.5, 1.0, 2.5, 5.0, 10um per 0.1L\n");
+    if (PM25_SENSOR_COUNT > 1) {
+        printf("  Instances 13-%d: sensors 2-%d, 12 each, in the order of the PMS5003 frame\n",
+               ANALOG_VALUES_FIXED - 1, PM25_SENSOR_COUNT);
+    }
+    printf("\n");
 
     printf("Binary Input Objects:\n");
     printf("  Instance %d: FAN_STATUS\n\n", FAN_STATUS_OBJECT_INSTANCE);
@@ -122,14 +120,32 @@ void app_main(void)
     printf("  Instance %d: FAN_COMMAND\n\n", FAN_COMMAND_OBJECT_INSTANCE);
 
     printf("Binary Value Objects:\n");
-    printf("  Instance %d: SENSOR_ERROR\n", SENSOR_ERROR_OBJECT_INSTANCE);
+    printf("  Instance %d: SENSOR_ERROR\n\n", SENSOR_ERROR_OBJECT_INSTANCE);
+
+    printf("Loop Objects:\n");
+    printf("  Instance %d: FAN_CONTROL (on/off, FAN_COMMAND from PM2.5 and PM2.5_SETPOINT)\n", FAN_LOOP_OBJECT_INSTANCE);
+    printf("  Instances 1-%d: unconfigured, set up over BACnet\n\n", MAX_LOOPS - 1);
+
+    printf("CreateObject adds up to %d Analog Values, Binary Inputs, Binary Outputs\n"
+           "and Binary Values each, at any free instance; DeleteObject removes them\n",
+           BACNET_CREATED_OBJECTS);
 
     /* load any static address bindings to show up
       in our device bindings list */
     address_init();
 
+    // Device_Init() in here runs every object's Init, once
+    ESP_LOGI(TAG, "Initializing BACnet objects...");
     Init_Service_Handlers();
 
+    // Only now, or Init would wipe them: names, units and data sources
+    // (point_binding.c), then the default control loops
+    point_binding_init();
+    control_task_init();
+
+    float setpoint = Analog_Value_Present_Value(PM2_5_SETPOINT_OBJECT_INSTANCE);
+    ESP_LOGI(TAG, "Initial PM2.5 setpoint value: %.1f", setpoint);
+
     printf("[DEBUG] Total Analog Value objects registered: %u\n", Analog_Value_Count());
     printf("[DEBUG] Total Binary Input objects registered: %u\n", Binary_Input_Count());
     printf("[DEBUG] Total Binary Output objects registered: %u\n", Binary_Output_Count());
@@ -152,9 +168,16 @@ void app_main(void)
     ESP_LOGI(TAG, "SENSOR_ERROR available as Binary Value object instance %d", SENSOR_ERROR_OBJECT_INSTANCE);
 
     // Start the BACnet server listener task
+    server_task_init();
     xTaskCreate(server_task, "bacnet_server", 8192, NULL, 1, NULL);
     ESP_LOGI(TAG, "Created BACnet server listener task");
 
+    // Start the control task that runs the Loop objects: above the
+    // server and the display, so neither network traffic nor drawing
+    // delays it, and below the sensor reader that wakes it
+    xTaskCreate(control_task, "control", 4096, NULL, 4, NULL);
+    ESP_LOGI(TAG, "Created control task");
+
     // Start the display task
     xTaskCreate(display_task, "display_task", 4096, NULL, 2, NULL);
     ESP_LOGI(TAG, "Created display task");
@@ -176,7 +199,10 @@ static object_functions_t Object_Table[] = {
         NULL,  // Object_Value_List
         NULL,  // Object_COV
         NULL,  // Object_COV_Clear
-        NULL   // Object_Intrinsic_Reporting
+        NULL,  // Object_Intrinsic_Reporting
+        NULL,  // Object_Create
+        NULL,  // Object_Delete
+        NULL   // Object_RPM_Instance_List
     },
     {
         OBJECT_ANALOG_VALUE,
@@ -190,10 +216,13 @@ static object_functions_t Object_Table[] = {
         Analog_Value_Property_Lists,
         NULL,  // Object_RR_Info
         NULL,  // Object_Iterator
-        NULL,  // Object_Value_List
-        NULL,  // Object_COV
-        NULL,  // Object_COV_Clear
-        NULL   // Object_Intrinsic_Reporting
+        Analog_Value_Encode_Value_List,
+        Analog_Value_Change_Of_Value,
+        Analog_Value_Change_Of_Value_Clear,
+        NULL,  // Object_Intrinsic_Reporting
+        Analog_Value_Create,
+        Analog_Value_Delete,
+        Analog_Value_Instance_Property_Lists
     },
     {
         OBJECT_BINARY_INPUT,
@@ -207,10 +236,13 @@ static object_functions_t Object_Table[] = {
         Binary_Input_Property_Lists,
         NULL,  // Object_RR_Info
         NULL,  // Object_Iterator
-        NULL,  // Object_Value_List
-        NULL,  // Object_COV
-        NULL,  // Object_COV_Clear
-        NULL   // Object_Intrinsic_Reporting
+        Binary_Input_Encode_Value_List,
+        Binary_Input_Change_Of_Value,
+        Binary_Input_Change_Of_Value_Clear,
+        NULL,  // Object_Intrinsic_Reporting
+        Binary_Input_Create,
+        Binary_Input_Delete,
+        NULL   // Object_RPM_Instance_List
     },
     {
         OBJECT_BINARY_OUTPUT,
@@ -224,10 +256,13 @@ static object_functions_t Object_Table[] = {
         Binary_Output_Property_Lists,
         NULL,  // Object_RR_Info
         NULL,  // Object_Iterator
-        NULL,  // Object_Value_List
-        NULL,  // Object_COV
-        NULL,  // Object_COV_Clear
-        NULL   // Object_Intrinsic_Reporting
+        Binary_Output_Encode_Value_List,
+        Binary_Output_Change_Of_Value,
+        Binary_Output_Change_Of_Value_Clear,
+        NULL,  // Object_Intrinsic_Reporting
+        Binary_Output_Create,
+        Binary_Output_Delete,
+        NULL   // Object_RPM_Instance_List
     },
     {
         OBJECT_BINARY_VALUE,
@@ -241,10 +276,39 @@ static object_functions_t Object_Table[] = {
         Binary_Value_Property_Lists,
         NULL,  // Object_RR_Info
         NULL,  // Object_Iterator
-        NULL,  // Object_Value_List
-        NULL,  // Object_COV
-        NULL,  // Object_COV_Clear
-        NULL   // Object_Intrinsic_Reporting
+        Binary_Value_Encode_Value_List,
+        Binary_Value_Change_Of_Value,
+        Binary_Value_Change_Of_Value_Clear,
+        NULL,  // Object_Intrinsic_Reporting
+        Binary_Value_Create,
+        Binary_Value_Delete,
+        NULL   // Object_RPM_Instance_List
+    },
+    {
+        OBJECT_LOOP,
+        Loop_Init,
+        Loop_Count,
+        Loop_Index_To_Instance,
+        Loop_Valid_Instance,
+        Loop_Object_Name,
+        Loop_Read_Property,
+        Loop_Write_Property,
+        Loop_Property_Lists,
+        NULL,  // Object_RR_Info
+        NULL,  // Object_Iterator
+        Loop_Encode_Value_List,
+        Loop_Change_Of_Value,
+        Loop_Change_Of_Value_Clear,
+        NULL,  // Object_Intrinsic_Reporting
+        NULL,  // Object_Create
+        NULL,  // Object_Delete
+        NULL   // Object_RPM_Instance_List
+    },
+    {
+        // end of the table: Device_Init() and the lookups stop here
+        MAX_BACNET_OBJECT_TYPE,
+        NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+        NULL, NULL, NULL, NULL, NULL, NULL
     },
 };
 
@@ -270,9 +334,16 @@ static void Init_Service_Handlers(void)
     apdu_set_confirmed_handler(SERVICE_CONFIRMED_WRITE_PROP_MULTIPLE, handler_write_property_multiple);
     apdu_set_confirmed_handler(SERVICE_CONFIRMED_READ_RANGE, handler_read_range);
     apdu_set_confirmed_handler(SERVICE_CONFIRMED_REINITIALIZE_DEVICE, handler_reinitialize_device);
+    /* Analog, Binary Input, Output and Value objects can be added and removed */
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_CREATE_OBJECT, handler_create_object);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_DELETE_OBJECT, handler_delete_object);
     apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_UTC_TIME_SYNCHRONIZATION, handler_timesync_utc);
     apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_TIME_SYNCHRONIZATION, handler_timesync);
+    /* restore the COV subscriptions saved in NVS before the reset */
+    handler_cov_init();
     apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV, handler_cov_subscribe);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY, handler_cov_subscribe_property);
+    apdu_set_confirmed_handler(SERVICE_CONFIRMED_SUBSCRIBE_COV_PROPERTY_MULTIPLE, handler_cov_subscribe_property_multiple);
     apdu_set_unconfirmed_handler(SERVICE_UNCONFIRMED_COV_NOTIFICATION, handler_ucov_notification);
     /* handle communication so we can shutup when asked */
     apdu_set_confirmed_handler(SERVICE_CONFIRMED_DEVICE_COMMUNICATION_CONTROL, handler_device_communication_control);
@@ -1,38 +1,85 @@
+#include <stdatomic.h>
+#include <string.h>
 #include "pm25_sensor.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/uart.h"
+#include "pms5003_parser.h"
+#include "pm_filter.h"
+#include "pm_trend.h"
+#ifdef CONFIG_PM25_SIMULATOR
+#include "pms5003_sim.h"
+#endif
 
 static const char *TAG = "pm25_sensor";
 
-// PMS5003 data structure
+// Wiring of each sensor (menuconfig, "PM Sensor Configuration")
 typedef struct {
-    uint16_t framelen;
-    uint16_t pm10_standard, pm25_standard, pm100_standard;
-    uint16_t pm10_env, pm25_env, pm100_env;
-    uint16_t particles_03um, particles_05um, particles_10um, particles_25um, particles_50um, particles_100um;
-    uint16_t unused;
-    uint16_t checksum;
-} pms5003_data_t;
-
-// Global variables to store all PM values
-static float current_pm1_0 = 0.0f;
-static float current_pm2_5 = 0.0f;
-static float current_pm10 = 0.0f;
-static SemaphoreHandle_t pm_mutex = NULL;
+    uart_port_t uart_num;
+    int rx_pin;
+    int tx_pin;
+} pm25_sensor_config_t;
+
+static const pm25_sensor_config_t pm_sensor_config[PM25_SENSOR_COUNT] = {
+    { CONFIG_PM25_SENSOR1_UART, CONFIG_PM25_SENSOR1_RX_PIN, CONFIG_PM25_SENSOR1_TX_PIN },
+#if PM25_SENSOR_COUNT > 1
+    { CONFIG_PM25_SENSOR2_UART, CONFIG_PM25_SENSOR2_RX_PIN, CONFIG_PM25_SENSOR2_TX_PIN },
+#endif
+};
+
+// Filter parameters are written by the BACnet task and picked up by the
+// sensor task before the next frame, when the generation has moved
+#define PM_FILTER_DEFAULT_MEDIAN    5
+#define PM_FILTER_DEFAULT_ALPHA     0.3f
+#define PM_FILTER_DEFAULT_MEAN      1
+
+// Everything about one sensor
+typedef struct {
+    // Published sensor state.  The reader task is the only writer: it
+    // fills the buffer readers are not using, then bumps the sequence to
+    // publish it.  Readers copy the published buffer and retry only if
+    // another publication started meanwhile, so they never wait for the
+    // writer, even one preempted halfway through an update.
+    pm25_snapshot_t snapshots[2];
+    atomic_uint sequence;           // publications; latest is in [seq & 1]
+    pm_filter_config_t filter_config[PM25_FILTERED_CHANNELS];
+    atomic_uint filter_generation;
+    // reader task only
+    QueueHandle_t uart_queue;       // UART events, NULL if not installed
+    pms5003_parser_t parser;
+    pm_filter_t filters[PM25_FILTERED_CHANNELS];
+    unsigned applied_generation;
+    pms5003_frame_t frame;
+    int64_t frame_time_us;
+    uint32_t overflows;
+    uint32_t line_errors;
+} pm25_sensor_t;
+
+static pm25_sensor_t pm_sensors[PM25_SENSOR_COUNT];
+
+// Told about every new frame, so consumers need not poll the snapshots
+static pm25_listener_t pm_listener = NULL;
+
+// UART events: each driver posts one per received chunk to its queue,
+// and the queues of all sensors are in one set, so a single reader task
+// sleeps until any sensor has bytes and sees every frame they send
+static QueueSetHandle_t pm_queue_set = NULL;
 
 // UART configuration for PMS5003
-#define PMS_UART_NUM           UART_NUM_1
-#define PMS_RX_PIN             25
-#define PMS_TX_PIN             26
 #define PMS_UART_BAUD_RATE     9600
 #define PMS_UART_BUFFER_SIZE   1024
+#define PMS_UART_QUEUE_SIZE    16
+// Report received bytes after this many idle symbols; the sensor pauses
+// between frames, so this is usually once per frame
+#define PMS_UART_RX_TIMEOUT    4
 
-// Initialize UART for PMS5003
-static esp_err_t pms5003_uart_init(void)
+// Initialize the UART of one PMS5003 and add its events to the set
+static esp_err_t pms5003_uart_init(unsigned sensor)
 {
+    const pm25_sensor_config_t *config = &pm_sensor_config[sensor];
     uart_config_t uart_config = {
         .baud_rate = PMS_UART_BAUD_RATE,
         .data_bits = UART_DATA_8_BITS,
@@ -41,188 +88,519 @@ static esp_err_t pms5003_uart_init(void)
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
         .source_clk = UART_SCLK_APB,
     };
-    
-    esp_err_t ret = uart_driver_install(PMS_UART_NUM, PMS_UART_BUFFER_SIZE * 2, 0, 0, NULL, 0);
+    QueueHandle_t queue = NULL;
+
+    esp_err_t ret = uart_driver_install(config->uart_num, PMS_UART_BUFFER_SIZE * 2, 0,
+                                        PMS_UART_QUEUE_SIZE, &queue, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Sensor %u: failed to install UART driver", sensor);
+        return ret;
+    }
+
+    // before the pins are connected, while the queue is surely empty
+    if (xQueueAddToSet(queue, pm_queue_set) != pdPASS) {
+        ESP_LOGE(TAG, "Sensor %u: failed to add UART events to the set", sensor);
+        uart_driver_delete(config->uart_num);
+        return ESP_FAIL;
+    }
+
+    ret = uart_param_config(config->uart_num, &uart_config);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to install UART driver");
+        ESP_LOGE(TAG, "Sensor %u: failed to configure UART parameters", sensor);
         return ret;
     }
-    
-    ret = uart_param_config(PMS_UART_NUM, &uart_config);
+
+    ret = uart_set_pin(config->uart_num, config->tx_pin, config->rx_pin,
+                       UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to configure UART parameters");
+        ESP_LOGE(TAG, "Sensor %u: failed to set UART pins", sensor);
         return ret;
     }
-    
-    ret = uart_set_pin(PMS_UART_NUM, PMS_TX_PIN, PMS_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+
+    ret = uart_set_rx_timeout(config->uart_num, PMS_UART_RX_TIMEOUT);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to set UART pins");
+        ESP_LOGE(TAG, "Sensor %u: failed to set UART RX timeout", sensor);
         return ret;
     }
-    
+    pm_sensors[sensor].uart_queue = queue;
+
     return ESP_OK;
 }
 
-// Read data from PMS5003
-static esp_err_t pms5003_read_data(pms5003_data_t *data)
+// One channel of a frame, as received
+static float pms5003_channel(const pms5003_frame_t *frame, unsigned channel)
 {
-    uint8_t buffer[32];
-    int length = 0;
-    
-    // Read until we get start bytes 0x42 0x4D
-    while (1) {
-        length = uart_read_bytes(PMS_UART_NUM, buffer, 2, pdMS_TO_TICKS(1000));
-        if (length == 2 && buffer[0] == 0x42 && buffer[1] == 0x4D) {
-            break;
+    switch (channel) {
+    case PM25_CHANNEL_PM1_0:
+        return (float)frame->pm1_0_standard;
+    case PM25_CHANNEL_PM2_5:
+        return (float)frame->pm2_5_standard;
+    case PM25_CHANNEL_PM10:
+        return (float)frame->pm10_standard;
+    case PM25_CHANNEL_PM1_0_ENV:
+        return (float)frame->pm1_0_env;
+    case PM25_CHANNEL_PM2_5_ENV:
+        return (float)frame->pm2_5_env;
+    case PM25_CHANNEL_PM10_ENV:
+        return (float)frame->pm10_env;
+    case PM25_CHANNEL_PARTICLES_03UM:
+        return (float)frame->particles_03um;
+    case PM25_CHANNEL_PARTICLES_05UM:
+        return (float)frame->particles_05um;
+    case PM25_CHANNEL_PARTICLES_10UM:
+        return (float)frame->particles_10um;
+    case PM25_CHANNEL_PARTICLES_25UM:
+        return (float)frame->particles_25um;
+    case PM25_CHANNEL_PARTICLES_50UM:
+        return (float)frame->particles_50um;
+    case PM25_CHANNEL_PARTICLES_100UM:
+        return (float)frame->particles_100um;
+    default:
+        return 0.0f;
+    }
+}
+
+// Run one frame through the filters of every filtered channel
+static void pms5003_filter(pm25_sensor_t *pm, const pms5003_frame_t *frame,
+                           float filtered[PM25_FILTERED_CHANNELS])
+{
+    unsigned generation = atomic_load_explicit(&pm->filter_generation,
+                                               memory_order_acquire);
+    pm_filter_config_t config[PM25_FILTERED_CHANNELS];
+    bool valid = true;
+    unsigned channel = 0;
+
+    if (generation != pm->applied_generation) {
+        for (channel = 0; channel < PM25_FILTERED_CHANNELS; channel++) {
+            config[channel] = pm->filter_config[channel];
+            // a write in progress may tear it; then take it next frame
+            valid = valid && pm_filter_config_valid(&config[channel]);
+        }
+        for (channel = 0; valid && (channel < PM25_FILTERED_CHANNELS); channel++) {
+            if ((config[channel].median_window !=
+                 pm->filters[channel].config.median_window) ||
+                (config[channel].mean_window !=
+                 pm->filters[channel].config.mean_window) ||
+                (config[channel].ema_alpha !=
+                 pm->filters[channel].config.ema_alpha)) {
+                pm_filter_init(&pm->filters[channel], &config[channel]);
+            }
+        }
+        if (valid) {
+            pm->applied_generation = generation;
         }
     }
-    
-    // Read the rest of the frame (30 bytes)
-    length = uart_read_bytes(PMS_UART_NUM, buffer, 30, pdMS_TO_TICKS(1000));
-    if (length != 30) {
-        ESP_LOGE(TAG, "Failed to read complete frame");
-        return ESP_FAIL;
+    for (channel = 0; channel < PM25_FILTERED_CHANNELS; channel++) {
+        filtered[channel] = pm_filter_update(&pm->filters[channel],
+                                             pms5003_channel(frame, channel));
     }
-    
-    // Parse data
-    data->framelen = (buffer[0] << 8) | buffer[1];
-    data->pm10_standard = (buffer[2] << 8) | buffer[3];
-    data->pm25_standard = (buffer[4] << 8) | buffer[5];
-    data->pm100_standard = (buffer[6] << 8) | buffer[7];
-    data->pm10_env = (buffer[8] << 8) | buffer[9];
-    data->pm25_env = (buffer[10] << 8) | buffer[11];
-    data->pm100_env = (buffer[12] << 8) | buffer[13];
-    data->particles_03um = (buffer[14] << 8) | buffer[15];
-    data->particles_05um = (buffer[16] << 8) | buffer[17];
-    data->particles_10um = (buffer[18] << 8) | buffer[19];
-    data->particles_25um = (buffer[20] << 8) | buffer[21];
-    data->particles_50um = (buffer[22] << 8) | buffer[23];
-    data->particles_100um = (buffer[24] << 8) | buffer[25];
-    data->unused = (buffer[26] << 8) | buffer[27];
-    data->checksum = (buffer[28] << 8) | buffer[29];
-    
-    // Verify checksum
-    uint16_t sum = 0x42 + 0x4D;
-    for (int i = 0; i < 28; i++) {
-        sum += buffer[i];
-    }
-    
-    if (sum != data->checksum) {
-        ESP_LOGE(TAG, "Checksum error: calculated 0x%04X, received 0x%04X", sum, data->checksum);
-        return ESP_FAIL;
+}
+
+// Publish the latest frame and the parser counters in one snapshot
+static void pms5003_publish(pm25_sensor_t *pm, bool have_frame)
+{
+    unsigned sequence = atomic_load_explicit(&pm->sequence, memory_order_relaxed);
+    const pm25_snapshot_t *current = &pm->snapshots[sequence & 1];
+    pm25_snapshot_t *next = &pm->snapshots[(sequence + 1) & 1];
+
+    // a reader may still be copying next from two publications ago:
+    // order the last publication before overwriting it, so the reader
+    // sees the sequence move and retries
+    atomic_thread_fence(memory_order_release);
+    if (have_frame) {
+        next->frame = pm->frame;
+        pms5003_filter(pm, &pm->frame, next->filtered);
+        next->time_us = pm->frame_time_us;
+        next->sequence = pm->parser.frames;
+    } else {
+        next->frame = current->frame;
+        memcpy(next->filtered, current->filtered, sizeof(next->filtered));
+        next->time_us = current->time_us;
+        next->sequence = current->sequence;
+    }
+    next->stats.frames = pm->parser.frames;
+    next->stats.checksum_errors = pm->parser.checksum_errors;
+    next->stats.length_errors = pm->parser.length_errors;
+    next->stats.resyncs = pm->parser.resyncs;
+    next->stats.discarded = pm->parser.discarded;
+    next->stats.overflows = pm->overflows;
+    next->stats.line_errors = pm->line_errors;
+    atomic_store_explicit(&pm->sequence, sequence + 1, memory_order_release);
+    // the first sensor, which drives the fan, is the one charted
+    if (have_frame && (pm == &pm_sensors[0])) {
+        pm_trend_add(next->filtered[PM25_CHANNEL_PM2_5], next->time_us);
+    }
+    if (have_frame && (pm_listener != NULL)) {
+        pm_listener((unsigned)(pm - pm_sensors));
     }
-    
-    return ESP_OK;
 }
 
-// Task to read data from PMS5003 sensor
+// Parse received bytes; true if they completed a frame
+static bool pms5003_feed(pm25_sensor_t *pm, const uint8_t *data, int length)
+{
+    bool have_frame = false;
+    int i = 0;
+
+    for (i = 0; i < length; i++) {
+        // a chunk rarely holds two frames; the later one wins
+        if (pms5003_parser_feed(&pm->parser, data[i], &pm->frame)) {
+            pm->frame_time_us = esp_timer_get_time();
+            have_frame = true;
+        }
+    }
+
+    return have_frame;
+}
+
+// Handle one UART event of a sensor
+static void pms5003_service(unsigned sensor)
+{
+    pm25_sensor_t *pm = &pm_sensors[sensor];
+    uart_port_t uart_num = pm_sensor_config[sensor].uart_num;
+    uart_event_t event;
+    uint8_t buffer[64];
+    bool have_frame = false;
+    int length = 0;
+
+    // the set may still name a queue that an overflow has reset
+    if (xQueueReceive(pm->uart_queue, &event, 0) != pdTRUE) {
+        return;
+    }
+    switch (event.type) {
+    case UART_DATA:
+        // drain everything buffered, not just this event's chunk
+        do {
+            length = uart_read_bytes(uart_num, buffer, sizeof(buffer), 0);
+            if (pms5003_feed(pm, buffer, length)) {
+                have_frame = true;
+            }
+        } while (length == (int)sizeof(buffer));
+        break;
+    case UART_FIFO_OVF:
+    case UART_BUFFER_FULL:
+        // bytes were lost: whatever is buffered is not contiguous
+        ESP_LOGW(TAG, "Sensor %u: UART overflow, flushing", sensor);
+        pm->overflows++;
+        uart_flush_input(uart_num);
+        xQueueReset(pm->uart_queue);
+        pms5003_parser_resync(&pm->parser);
+        break;
+    case UART_FRAME_ERR:
+    case UART_PARITY_ERR:
+        pm->line_errors++;
+        pms5003_parser_resync(&pm->parser);
+        break;
+    default:
+        break;
+    }
+    pms5003_publish(pm, have_frame);
+}
+
+// Task to read data from all PMS5003 sensors
 static void pms5003_read_task(void *pvParameters)
 {
-    pms5003_data_t data;
-    
-    ESP_LOGI(TAG, "PMS5003 sensor task started");
-    
+    QueueSetMemberHandle_t member = NULL;
+    unsigned sensor = 0;
+
+    ESP_LOGI(TAG, "PMS5003 reader task started, %u sensor(s)",
+             (unsigned)PM25_SENSOR_COUNT);
+
     for (;;) {
-        if (pms5003_read_data(&data) == ESP_OK) {
-            // Store all PM values with mutex protection
-            if (pm_mutex != NULL) {
-                if (xSemaphoreTake(pm_mutex, portMAX_DELAY) == pdTRUE) {
-                    
-                    current_pm1_0 = (float)data.pm10_standard;    // Note: pm10_standard is actually PM1.0
-                    current_pm2_5 = (float)data.pm25_standard;
-                    current_pm10 = (float)data.pm100_standard;
-                    xSemaphoreGive(pm_mutex);
-                    
-        //            ESP_LOGI(TAG, "PM1.0: %.1f, PM2.5: %.1f, PM10: %.1f μg/m³", 
-        //                    (float)data.pm10_standard, 
-        //                   (float)data.pm25_standard,
-        //                    (float)data.pm100_standard);
-                }
-            } else {
-                current_pm1_0 = (float)data.pm10_standard;
-                current_pm2_5 = (float)data.pm25_standard;
-                current_pm10 = (float)data.pm100_standard;
+        member = xQueueSelectFromSet(pm_queue_set, portMAX_DELAY);
+        for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+            if ((member != NULL) && (member == pm_sensors[sensor].uart_queue)) {
+                pms5003_service(sensor);
+                break;
+            }
+        }
+    }
+}
+
+#ifdef CONFIG_PM25_SIMULATOR
+// The sensor sends a frame about once a second
+#define PMS_SIM_PERIOD_MS       1000
+// Pause of a stalled frame, well past the UART RX timeout
+#define PMS_SIM_STALL_MS        50
+// Log the injected faults against what the parser saw this often
+#define PMS_SIM_REPORT_FRAMES   60
+
+static void pms5003_sim_report(unsigned sensor, const pms5003_sim_t *sim,
+                               uint32_t bytes, int64_t parse_us)
+{
+    const pms5003_parser_t *parser = &pm_sensors[sensor].parser;
+
+    ESP_LOGI(TAG, "Sensor %u simulated: sent=%lu (dropped=%lu dup=%lu "
+             "corrupt=%lu stalled=%lu), parsed=%lu checksum=%lu length=%lu "
+             "resyncs=%lu discarded=%lu",
+             sensor, (unsigned long)sim->frames, (unsigned long)sim->dropped,
+             (unsigned long)sim->duplicated, (unsigned long)sim->corrupted,
+             (unsigned long)sim->stalled, (unsigned long)parser->frames,
+             (unsigned long)parser->checksum_errors,
+             (unsigned long)parser->length_errors,
+             (unsigned long)parser->resyncs, (unsigned long)parser->discarded);
+    if (parse_us > 0) {
+        ESP_LOGI(TAG, "Sensor %u parser: %lu bytes in %lld us, %lu bytes/ms",
+                 sensor, (unsigned long)bytes, (long long)parse_us,
+                 (unsigned long)(bytes * 1000LL / parse_us));
+    }
+}
+
+// Stands in for the reader task: every sensor is fed a synthetic stream
+// through the same parser, filters and publication as the UART data
+static void pms5003_sim_task(void *pvParameters)
+{
+    static pms5003_sim_t sims[PM25_SENSOR_COUNT];
+    const pms5003_sim_config_t config = {
+        .pm2_5 = CONFIG_PM25_SIMULATOR_PM2_5,
+        .noise = CONFIG_PM25_SIMULATOR_NOISE,
+        .drop_permille = CONFIG_PM25_SIMULATOR_FAULTS,
+        .dup_permille = CONFIG_PM25_SIMULATOR_FAULTS,
+        .corrupt_permille = CONFIG_PM25_SIMULATOR_FAULTS,
+        .stall_permille = CONFIG_PM25_SIMULATOR_FAULTS,
+    };
+    uint8_t buffer[PMS5003_SIM_MAX_BYTES];
+    uint32_t bytes[PM25_SENSOR_COUNT] = { 0 };
+    int64_t parse_us[PM25_SENSOR_COUNT] = { 0 };
+    int64_t start_us = 0;
+    size_t length = 0;
+    size_t split = 0;
+    bool have_frame = false;
+    unsigned sensor = 0;
+
+    ESP_LOGW(TAG, "PMS5003 simulator running, %u sensor(s)",
+             (unsigned)PM25_SENSOR_COUNT);
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        pms5003_sim_init(&sims[sensor], &config, sensor + 1);
+    }
+
+    for (;;) {
+        for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+            pm25_sensor_t *pm = &pm_sensors[sensor];
+
+            length = pms5003_sim_next(&sims[sensor], buffer, &split, NULL);
+            if (split > 0) {
+                // the first part arrives alone, like an RX timeout mid-frame
+                pms5003_publish(pm, pms5003_feed(pm, buffer, (int)split));
+                vTaskDelay(pdMS_TO_TICKS(PMS_SIM_STALL_MS));
+            }
+            start_us = esp_timer_get_time();
+            have_frame = pms5003_feed(pm, &buffer[split], (int)(length - split));
+            parse_us[sensor] += esp_timer_get_time() - start_us;
+            bytes[sensor] += length - split;
+            pms5003_publish(pm, have_frame);
+            if ((sims[sensor].frames % PMS_SIM_REPORT_FRAMES) == 0) {
+                pms5003_sim_report(sensor, &sims[sensor], bytes[sensor],
+                                   parse_us[sensor]);
             }
-        } else {
-            ESP_LOGW(TAG, "Failed to read from PMS5003");
         }
-        
-        // Read every 5 seconds
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        vTaskDelay(pdMS_TO_TICKS(PMS_SIM_PERIOD_MS));
     }
 }
+#endif
 
-// Public function to initialize the PM sensor
+// Public function to initialize the PM sensors
 void pm25_sensor_init(void)
 {
-    // Create mutex for PM data protection
-    pm_mutex = xSemaphoreCreateMutex();
-    if (pm_mutex == NULL) {
-        ESP_LOGE(TAG, "Failed to create PM mutex");
+    unsigned sensor = 0;
+    unsigned channel = 0;
+    unsigned running = 0;
+
+    memset(pm_sensors, 0, sizeof(pm_sensors));
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        pm25_sensor_t *pm = &pm_sensors[sensor];
+
+        atomic_store(&pm->sequence, 0);
+        pms5003_parser_init(&pm->parser);
+        for (channel = 0; channel < PM25_FILTERED_CHANNELS; channel++) {
+            pm->filter_config[channel].median_window = PM_FILTER_DEFAULT_MEDIAN;
+            pm->filter_config[channel].ema_alpha = PM_FILTER_DEFAULT_ALPHA;
+            pm->filter_config[channel].mean_window = PM_FILTER_DEFAULT_MEAN;
+            pm_filter_init(&pm->filters[channel], &pm->filter_config[channel]);
+        }
+        atomic_store(&pm->filter_generation, 0);
+    }
+    pm_trend_init();
+
+#ifdef CONFIG_PM25_SIMULATOR
+    // no UARTs: the simulator is the only writer
+    xTaskCreate(pms5003_sim_task, "pms5003_sim", 4096, NULL, 5, NULL);
+    return;
+#endif
+
+    pm_queue_set = xQueueCreateSet(PMS_UART_QUEUE_SIZE * PM25_SENSOR_COUNT);
+    if (pm_queue_set == NULL) {
+        ESP_LOGE(TAG, "Failed to create the UART event queue set");
+        return;
     }
-    
-    // Initialize UART
-    if (pms5003_uart_init() != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize UART for PMS5003");
+
+    // Initialize UARTs; a sensor that fails stays without data
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        if (pms5003_uart_init(sensor) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to initialize UART for PMS5003 sensor %u", sensor);
+        } else {
+            running++;
+        }
+    }
+    if (running == 0) {
         return;
     }
-    
-    // Start PMS5003 reading task
+
+    // One reader task serves every sensor
     xTaskCreate(pms5003_read_task, "pms5003_read", 4096, NULL, 5, NULL);
-    
-    ESP_LOGI(TAG, "PM sensor initialized");
+
+    ESP_LOGI(TAG, "PM sensors initialized: %u of %u", running,
+             (unsigned)PM25_SENSOR_COUNT);
 }
 
-// Public function to get PM1.0 value
-float pm25_get_pm1_0(void)
-{
-    float value = 0.0f;
-    
-    if (pm_mutex != NULL) {
-        if (xSemaphoreTake(pm_mutex, portMAX_DELAY) == pdTRUE) {
-            value = current_pm1_0;
-            xSemaphoreGive(pm_mutex);
-        }
-    } else {
-        value = current_pm1_0;
+// Public function to set who is told about new frames
+void pm25_set_listener(pm25_listener_t listener)
+{
+    pm_listener = listener;
+}
+
+// Public function to get a consistent copy of everything published
+void pm25_get_snapshot(unsigned sensor, pm25_snapshot_t *snapshot)
+{
+    pm25_sensor_t *pm = NULL;
+    unsigned sequence = 0;
+
+    if (sensor >= PM25_SENSOR_COUNT) {
+        memset(snapshot, 0, sizeof(*snapshot));
+        return;
     }
-    
-    return value;
+    pm = &pm_sensors[sensor];
+    do {
+        sequence = atomic_load_explicit(&pm->sequence, memory_order_acquire);
+        *snapshot = pm->snapshots[sequence & 1];
+        atomic_thread_fence(memory_order_acquire);
+        // the writer only touches this buffer after publishing the other
+        // one, so an unchanged sequence means the copy is whole
+    } while (atomic_load_explicit(&pm->sequence, memory_order_relaxed) != sequence);
+}
+
+// Public function to get a channel of a snapshot, filtered if it can be
+float pm25_snapshot_value(const pm25_snapshot_t *snapshot, unsigned channel)
+{
+    if (channel < PM25_FILTERED_CHANNELS) {
+        return snapshot->filtered[channel];
+    }
+
+    return pms5003_channel(&snapshot->frame, channel);
+}
 
+// Public function to get a channel of a snapshot as received
+float pm25_snapshot_raw(const pm25_snapshot_t *snapshot, unsigned channel)
+{
+    return pms5003_channel(&snapshot->frame, channel);
+}
+
+// Public function to get PM1.0 value
+float pm25_get_pm1_0(unsigned sensor)
+{
+    pm25_snapshot_t snapshot;
+
+    pm25_get_snapshot(sensor, &snapshot);
+
+    return snapshot.filtered[PM25_CHANNEL_PM1_0];
 }
 
 // Public function to get PM2.5 value
-float pm25_get_pm2_5(void)
-{
-    float value = 0.0f;
-    
-    if (pm_mutex != NULL) {
-        if (xSemaphoreTake(pm_mutex, portMAX_DELAY) == pdTRUE) {
-            value = current_pm2_5;
-            xSemaphoreGive(pm_mutex);
-        }
-    } else {
-        value = current_pm2_5;
-    }
-    
-    return value;
+float pm25_get_pm2_5(unsigned sensor)
+{
+    pm25_snapshot_t snapshot;
 
+    pm25_get_snapshot(sensor, &snapshot);
+
+    return snapshot.filtered[PM25_CHANNEL_PM2_5];
 }
 
 // Public function to get PM10 value
-float pm25_get_pm10(void)
-{
-    float value = 0.0f;
-    
-    if (pm_mutex != NULL) {
-        if (xSemaphoreTake(pm_mutex, portMAX_DELAY) == pdTRUE) {
-            value = current_pm10;
-            xSemaphoreGive(pm_mutex);
-        }
-    } else {
-        value = current_pm10;
+float pm25_get_pm10(unsigned sensor)
+{
+    pm25_snapshot_t snapshot;
+
+    pm25_get_snapshot(sensor, &snapshot);
+
+    return snapshot.filtered[PM25_CHANNEL_PM10];
+}
+
+// Public function to get the unfiltered value of a channel
+float pm25_get_raw(unsigned sensor, unsigned channel)
+{
+    pm25_snapshot_t snapshot;
+
+    pm25_get_snapshot(sensor, &snapshot);
+
+    return pm25_snapshot_raw(&snapshot, channel);
+}
+
+// Public function to get the filter parameters of a channel
+bool pm25_get_filter(unsigned sensor, unsigned channel, pm_filter_config_t *config)
+{
+    if ((sensor >= PM25_SENSOR_COUNT) || (channel >= PM25_FILTERED_CHANNELS) ||
+        (config == NULL)) {
+        return false;
+    }
+    *config = pm_sensors[sensor].filter_config[channel];
+
+    return true;
+}
+
+// Public function to check and store new filter parameters for a channel
+bool pm25_set_filter(unsigned sensor, unsigned channel,
+                     const pm_filter_config_t *config)
+{
+    pm25_sensor_t *pm = NULL;
+
+    if ((sensor >= PM25_SENSOR_COUNT) || (channel >= PM25_FILTERED_CHANNELS) ||
+        (config == NULL) || !pm_filter_config_valid(config)) {
+        return false;
+    }
+    pm = &pm_sensors[sensor];
+    pm->filter_config[channel] = *config;
+    atomic_fetch_add_explicit(&pm->filter_generation, 1, memory_order_release);
+
+    return true;
+}
+
+// Public function to get the time of the last valid frame
+bool pm25_get_last_update_ms(unsigned sensor, uint32_t *time_ms)
+{
+    pm25_snapshot_t snapshot;
+
+    pm25_get_snapshot(sensor, &snapshot);
+    if (snapshot.time_us == 0) {
+        return false;
     }
-    
-    return value;
+    if (time_ms != NULL) {
+        *time_ms = (uint32_t)(snapshot.time_us / 1000);
+    }
+
+    return true;
+}
+
+// Public function to get every channel of the last valid frame
+bool pm25_get_frame(unsigned sensor, pms5003_frame_t *frame)
+{
+    pm25_snapshot_t snapshot;
 
-}
\ No newline at end of file
+    if (frame == NULL) {
+        return false;
+    }
+    pm25_get_snapshot(sensor, &snapshot);
+    *frame = snapshot.frame;
+
+    return (snapshot.time_us != 0);
+}
+
+// Public function to get the PMS5003 stream counters
+void pm25_get_stats(unsigned sensor, pm25_stats_t *stats)
+{
+    pm25_snapshot_t snapshot;
+
+    if (stats == NULL) {
+        return;
+    }
+    pm25_get_snapshot(sensor, &snapshot);
+    *stats = snapshot.stats;
+}
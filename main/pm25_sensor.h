@@ -2,11 +2,86 @@
 #define PM25_SENSOR_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "pms5003_parser.h"
+#include "pm_filter.h"
 
-// Public function declarations
+// Number of PMS5003 sensors, each on its own UART (menuconfig)
+#define PM25_SENSOR_COUNT       CONFIG_PM25_SENSOR_COUNT
+
+// Sensor channels, in the order of the PMS5003 frame.  The first
+// PM25_FILTERED_CHANNELS are conditioned (see pm_filter.h), the others
+// are published as received.
+typedef enum {
+    PM25_CHANNEL_PM1_0 = 0,         // ug/m3, standard particle
+    PM25_CHANNEL_PM2_5,
+    PM25_CHANNEL_PM10,
+    PM25_CHANNEL_PM1_0_ENV,         // ug/m3, atmospheric environment
+    PM25_CHANNEL_PM2_5_ENV,
+    PM25_CHANNEL_PM10_ENV,
+    PM25_CHANNEL_PARTICLES_03UM,    // particles over 0.3 um in 0.1 L of air
+    PM25_CHANNEL_PARTICLES_05UM,
+    PM25_CHANNEL_PARTICLES_10UM,
+    PM25_CHANNEL_PARTICLES_25UM,
+    PM25_CHANNEL_PARTICLES_50UM,
+    PM25_CHANNEL_PARTICLES_100UM,
+    PM25_CHANNEL_COUNT
+} pm25_channel_t;
+#define PM25_FILTERED_CHANNELS  3
+
+// PMS5003 stream counters
+typedef struct {
+    uint32_t frames;            // valid frames received
+    uint32_t checksum_errors;   // frames dropped for a bad checksum
+    uint32_t length_errors;     // frames dropped for a bad frame length
+    uint32_t resyncs;           // times the frame alignment was lost
+    uint32_t discarded;         // bytes skipped while resynchronizing
+    uint32_t overflows;         // UART overflows, input flushed
+    uint32_t line_errors;       // UART framing and parity errors
+} pm25_stats_t;
+
+// Everything the sensor task publishes, read as one consistent copy
+typedef struct {
+    pms5003_frame_t frame;      // last valid frame, raw
+    float filtered[PM25_FILTERED_CHANNELS]; // the same frame, conditioned
+    int64_t time_us;            // esp_timer time of that frame, 0 if none yet
+    uint32_t sequence;          // number of that frame, 1 for the first
+    pm25_stats_t stats;
+} pm25_snapshot_t;
+
+// Told by the reader task each time a sensor publishes a new frame.  It
+// runs in that task, so it must only hand the news on, not act on it.
+typedef void (*pm25_listener_t)(unsigned sensor);
+
+// Public function declarations.  Sensors are numbered from 0; an
+// invalid sensor number reads as a sensor that has no data yet.
 void pm25_sensor_init(void);
-float pm25_get_pm1_0(void);
-float pm25_get_pm2_5(void);
-float pm25_get_pm10(void);
+// One listener at most; NULL removes it
+void pm25_set_listener(pm25_listener_t listener);
+// Wait-free: never blocks, whatever the reader task is doing
+void pm25_get_snapshot(unsigned sensor, pm25_snapshot_t *snapshot);
+// Value of a channel in a snapshot: conditioned if it is filtered
+float pm25_snapshot_value(const pm25_snapshot_t *snapshot, unsigned channel);
+// Value of a channel in a snapshot as received
+float pm25_snapshot_raw(const pm25_snapshot_t *snapshot, unsigned channel);
+// Filtered values
+float pm25_get_pm1_0(unsigned sensor);
+float pm25_get_pm2_5(unsigned sensor);
+float pm25_get_pm10(unsigned sensor);
+// Unfiltered value of a channel, as in the last frame
+float pm25_get_raw(unsigned sensor, unsigned channel);
+// Filter parameters of a filtered channel (see pm_filter.h).  A change
+// restarts that channel's filters with the next frame.  Both return false
+// for a channel without filters; the setter also for invalid parameters.
+bool pm25_get_filter(unsigned sensor, unsigned channel, pm_filter_config_t *config);
+bool pm25_set_filter(unsigned sensor, unsigned channel,
+                     const pm_filter_config_t *config);
+// Time (esp_timer ms) of the last valid frame; false if none yet
+bool pm25_get_last_update_ms(unsigned sensor, uint32_t *time_ms);
+// All channels of the last valid frame; false if none yet
+bool pm25_get_frame(unsigned sensor, pms5003_frame_t *frame);
+// Stream and UART counters, to judge the health of a sensor
+void pm25_get_stats(unsigned sensor, pm25_stats_t *stats);
 
 #endif // PM25_SENSOR_H
\ No newline at end of file
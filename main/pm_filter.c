@@ -0,0 +1,123 @@
+/*
+ * Sensor signal conditioning: median, EMA and sliding mean
+ *
+ * Plain C with no ESP-IDF dependencies.  Each stage costs a bounded
+ * amount per sample: the median moves at most PM_FILTER_MEDIAN_MAX
+ * values, the EMA and the mean are a few operations.
+ */
+#include <string.h>
+#include "pm_filter.h"
+
+bool pm_filter_config_valid(const pm_filter_config_t *config)
+{
+    if ((config->median_window < 1) ||
+        (config->median_window > PM_FILTER_MEDIAN_MAX) ||
+        ((config->median_window % 2) == 0)) {
+        return false;
+    }
+    if ((config->mean_window < 1) ||
+        (config->mean_window > PM_FILTER_MEAN_MAX)) {
+        return false;
+    }
+    // also rejects NaN
+    if (!((config->ema_alpha > 0.0f) && (config->ema_alpha <= 1.0f))) {
+        return false;
+    }
+
+    return true;
+}
+
+void pm_filter_init(pm_filter_t *filter, const pm_filter_config_t *config)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->config = *config;
+}
+
+// Replace the oldest sample of the window with the new one, keeping
+// median_sorted in order, and return the median of what is there
+static float pm_filter_median(pm_filter_t *filter, float sample)
+{
+    float *sorted = filter->median_sorted;
+    unsigned count = filter->median_count;
+    unsigned i = 0;
+
+    if (count == filter->config.median_window) {
+        // take the oldest sample out of the sorted window
+        float oldest = filter->median_ring[filter->median_pos];
+
+        for (i = 0; i < count; i++) {
+            if (sorted[i] == oldest) {
+                break;
+            }
+        }
+        for (; (i + 1) < count; i++) {
+            sorted[i] = sorted[i + 1];
+        }
+        count--;
+    }
+    // insert the new sample in order
+    for (i = count; (i > 0) && (sorted[i - 1] > sample); i--) {
+        sorted[i] = sorted[i - 1];
+    }
+    sorted[i] = sample;
+    count++;
+    filter->median_count = (uint8_t)count;
+    filter->median_ring[filter->median_pos] = sample;
+    filter->median_pos = (uint8_t)((filter->median_pos + 1) %
+                                   filter->config.median_window);
+
+    return sorted[count / 2];
+}
+
+static float pm_filter_ema(pm_filter_t *filter, float sample)
+{
+    if (!filter->ema_valid) {
+        filter->ema = sample;
+        filter->ema_valid = true;
+    } else {
+        filter->ema += filter->config.ema_alpha * (sample - filter->ema);
+    }
+
+    return filter->ema;
+}
+
+static float pm_filter_mean(pm_filter_t *filter, float sample)
+{
+    unsigned window = filter->config.mean_window;
+    unsigned i = 0;
+
+    if (filter->mean_count == window) {
+        filter->mean_sum -= filter->mean_ring[filter->mean_pos];
+    } else {
+        filter->mean_count++;
+    }
+    filter->mean_ring[filter->mean_pos] = sample;
+    filter->mean_sum += sample;
+    filter->mean_pos = (uint8_t)((filter->mean_pos + 1) % window);
+    if ((filter->mean_pos == 0) && (filter->mean_count == window)) {
+        // once per window: recompute, so rounding cannot accumulate
+        filter->mean_sum = 0.0f;
+        for (i = 0; i < window; i++) {
+            filter->mean_sum += filter->mean_ring[i];
+        }
+    }
+
+    return filter->mean_sum / (float)filter->mean_count;
+}
+
+float pm_filter_update(pm_filter_t *filter, float sample)
+{
+    float value = sample;
+
+    if (filter->config.median_window > 1) {
+        value = pm_filter_median(filter, value);
+    }
+    if (filter->config.ema_alpha < 1.0f) {
+        value = pm_filter_ema(filter, value);
+    }
+    if (filter->config.mean_window > 1) {
+        value = pm_filter_mean(filter, value);
+    }
+
+    return value;
+}
@@ -0,0 +1,47 @@
+#ifndef PM_FILTER_H
+#define PM_FILTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Signal conditioning for one sensor channel, applied in this order:
+//   median of the last N samples  - rejects single-sample outliers
+//   exponential moving average    - smooths the noise
+//   mean of the last M samples    - averages over a fixed window
+// A window of 1, or an alpha of 1.0, turns that stage off.
+// All state lives in the struct; nothing is allocated.
+#define PM_FILTER_MEDIAN_MAX    9
+#define PM_FILTER_MEAN_MAX      16
+
+typedef struct {
+    uint8_t median_window;      // 1..PM_FILTER_MEDIAN_MAX, odd
+    uint8_t mean_window;        // 1..PM_FILTER_MEAN_MAX
+    float ema_alpha;            // 0 < alpha <= 1, weight of the new sample
+} pm_filter_config_t;
+
+typedef struct {
+    pm_filter_config_t config;
+    // median: the window in arrival order and sorted
+    float median_ring[PM_FILTER_MEDIAN_MAX];
+    float median_sorted[PM_FILTER_MEDIAN_MAX];
+    uint8_t median_pos;
+    uint8_t median_count;
+    // EMA
+    float ema;
+    bool ema_valid;
+    // sliding mean: running sum over the window
+    float mean_ring[PM_FILTER_MEAN_MAX];
+    float mean_sum;
+    uint8_t mean_pos;
+    uint8_t mean_count;
+} pm_filter_t;
+
+bool pm_filter_config_valid(const pm_filter_config_t *config);
+
+// Start over with the given configuration, which must be valid
+void pm_filter_init(pm_filter_t *filter, const pm_filter_config_t *config);
+
+// Filter one sample and return the conditioned value
+float pm_filter_update(pm_filter_t *filter, float sample);
+
+#endif // PM_FILTER_H
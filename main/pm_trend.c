@@ -0,0 +1,72 @@
+/*
+ * PM2.5 trend: interval means in a single-writer ring
+ *
+ * The writer stores a sample, then publishes it by moving the count of
+ * samples ever stored.  The reader copies the slots behind that count.
+ * A slot is only written again PM_TREND_SAMPLES intervals later, so a
+ * reader that keeps up never sees one change under it.
+ */
+#include <stdatomic.h>
+#include <stddef.h>
+#include "pm_trend.h"
+
+static float trend_ring[PM_TREND_SAMPLES];
+static atomic_uint trend_count;          // samples stored so far
+
+// writer only: the interval being averaged
+static float trend_sum;
+static unsigned trend_readings;
+static int64_t trend_start_us;
+
+static pm_trend_listener_t trend_listener = NULL;
+
+void pm_trend_init(void)
+{
+    atomic_store(&trend_count, 0);
+    trend_sum = 0.0f;
+    trend_readings = 0;
+    trend_start_us = 0;
+}
+
+void pm_trend_set_listener(pm_trend_listener_t listener)
+{
+    trend_listener = listener;
+}
+
+void pm_trend_add(float value, int64_t time_us)
+{
+    unsigned count = 0;
+
+    // a reading past the interval closes it and starts the next
+    if ((trend_readings > 0) && ((time_us - trend_start_us) >= PM_TREND_INTERVAL_US)) {
+        count = atomic_load_explicit(&trend_count, memory_order_relaxed);
+        trend_ring[count % PM_TREND_SAMPLES] = trend_sum / (float)trend_readings;
+        atomic_store_explicit(&trend_count, count + 1, memory_order_release);
+        trend_sum = 0.0f;
+        trend_readings = 0;
+        if (trend_listener != NULL) {
+            trend_listener();
+        }
+    }
+    if (trend_readings == 0) {
+        trend_start_us = time_us;
+    }
+    trend_sum += value;
+    trend_readings++;
+}
+
+unsigned pm_trend_read(uint32_t *cursor, float *samples, unsigned max)
+{
+    unsigned count = atomic_load_explicit(&trend_count, memory_order_acquire);
+    unsigned copied = 0;
+
+    if ((count - *cursor) > PM_TREND_SAMPLES) {
+        *cursor = count - PM_TREND_SAMPLES;
+    }
+    while ((*cursor != count) && (copied < max)) {
+        samples[copied++] = trend_ring[*cursor % PM_TREND_SAMPLES];
+        (*cursor)++;
+    }
+
+    return copied;
+}
@@ -0,0 +1,29 @@
+#ifndef PM_TREND_H
+#define PM_TREND_H
+
+#include <stdint.h>
+
+// PM2.5 history for the screen: the mean of the readings over each
+// interval, kept in a fixed ring.  The sensor task is the only writer,
+// the display task the only reader; neither waits for the other.
+// Plain C with no ESP-IDF dependencies.
+#define PM_TREND_SAMPLES        150
+#define PM_TREND_INTERVAL_US    (24LL * 1000 * 1000)    // 150 samples: one hour
+
+// Told, from the sensor task, when a sample is added
+typedef void (*pm_trend_listener_t)(void);
+
+void pm_trend_init(void);
+// One listener at most; NULL removes it
+void pm_trend_set_listener(pm_trend_listener_t listener);
+
+// Sensor task: a reading and when it was taken.  Readings are averaged
+// until the interval is over, then stored as one sample.
+void pm_trend_add(float value, int64_t time_us);
+
+// Copy the samples stored after *cursor, oldest first, at most max of
+// them, and move the cursor past them.  Samples older than the ring are
+// skipped.  A cursor of 0 starts at the oldest sample kept.
+unsigned pm_trend_read(uint32_t *cursor, float *samples, unsigned max);
+
+#endif /* PM_TREND_H */
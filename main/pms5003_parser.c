@@ -0,0 +1,133 @@
+/*
+ * PMS5003 byte-stream parser
+ *
+ * Plain C with no ESP-IDF dependencies: it is fed whatever the UART
+ * delivers, in chunks of any size, and reports each valid frame.
+ */
+#include <string.h>
+#include "pms5003_parser.h"
+
+// Parser states
+enum {
+    PMS5003_WAIT_START1 = 0,
+    PMS5003_WAIT_START2,
+    PMS5003_READ_FRAME
+};
+
+void pms5003_parser_init(pms5003_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+    parser->state = PMS5003_WAIT_START1;
+}
+
+void pms5003_parser_resync(pms5003_parser_t *parser)
+{
+    if (parser->in_sync) {
+        parser->in_sync = false;
+        parser->resyncs++;
+    }
+    parser->state = PMS5003_WAIT_START1;
+}
+
+// A byte that cannot start a frame
+static void pms5003_parser_discard(pms5003_parser_t *parser)
+{
+    pms5003_parser_resync(parser);
+    parser->discarded++;
+}
+
+static uint16_t pms5003_word(const uint8_t *data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static void pms5003_decode(const uint8_t *buf, pms5003_frame_t *frame)
+{
+    // buf[0..1] is the frame length, the data words follow
+    frame->pm1_0_standard = pms5003_word(&buf[2]);
+    frame->pm2_5_standard = pms5003_word(&buf[4]);
+    frame->pm10_standard = pms5003_word(&buf[6]);
+    frame->pm1_0_env = pms5003_word(&buf[8]);
+    frame->pm2_5_env = pms5003_word(&buf[10]);
+    frame->pm10_env = pms5003_word(&buf[12]);
+    frame->particles_03um = pms5003_word(&buf[14]);
+    frame->particles_05um = pms5003_word(&buf[16]);
+    frame->particles_10um = pms5003_word(&buf[18]);
+    frame->particles_25um = pms5003_word(&buf[20]);
+    frame->particles_50um = pms5003_word(&buf[22]);
+    frame->particles_100um = pms5003_word(&buf[24]);
+}
+
+bool pms5003_parser_feed(pms5003_parser_t *parser, uint8_t byte,
+                         pms5003_frame_t *frame)
+{
+    bool complete = false;
+
+    switch (parser->state) {
+    case PMS5003_WAIT_START1:
+        if (byte == PMS5003_START1) {
+            parser->state = PMS5003_WAIT_START2;
+        } else {
+            pms5003_parser_discard(parser);
+        }
+        break;
+    case PMS5003_WAIT_START2:
+        if (byte == PMS5003_START2) {
+            parser->state = PMS5003_READ_FRAME;
+            parser->pos = 0;
+            parser->sum = PMS5003_START1 + PMS5003_START2;
+        } else if (byte == PMS5003_START1) {
+            // the previous 0x42 was garbage, this one may start a frame
+            pms5003_parser_discard(parser);
+            parser->state = PMS5003_WAIT_START2;
+        } else {
+            // the 0x42 and this byte
+            pms5003_parser_discard(parser);
+            parser->discarded++;
+        }
+        break;
+    case PMS5003_READ_FRAME:
+        parser->buf[parser->pos++] = byte;
+        if (parser->pos <= PMS5003_FRAME_LEN) {
+            // everything but the checksum itself
+            parser->sum += byte;
+        }
+        if ((parser->pos == 2) &&
+            (pms5003_word(&parser->buf[0]) != PMS5003_FRAME_LEN)) {
+            // not a frame after all, but the length bytes themselves may
+            // start the next one: they are looked at again, as start bytes
+            parser->length_errors++;
+            pms5003_parser_resync(parser);
+            if ((parser->buf[0] == PMS5003_START1) &&
+                (parser->buf[1] == PMS5003_START2)) {
+                parser->discarded += 2;
+                parser->state = PMS5003_READ_FRAME;
+                parser->pos = 0;
+                parser->sum = PMS5003_START1 + PMS5003_START2;
+            } else if (parser->buf[1] == PMS5003_START1) {
+                parser->discarded += 3;
+                parser->state = PMS5003_WAIT_START2;
+            } else {
+                parser->discarded += 4;
+            }
+        } else if (parser->pos == sizeof(parser->buf)) {
+            parser->state = PMS5003_WAIT_START1;
+            if (parser->sum == pms5003_word(&parser->buf[PMS5003_FRAME_LEN])) {
+                pms5003_decode(parser->buf, frame);
+                parser->frames++;
+                parser->in_sync = true;
+                complete = true;
+            } else {
+                parser->checksum_errors++;
+                parser->discarded += PMS5003_FRAME_SIZE;
+                pms5003_parser_resync(parser);
+            }
+        }
+        break;
+    default:
+        pms5003_parser_resync(parser);
+        break;
+    }
+
+    return complete;
+}
@@ -0,0 +1,47 @@
+#ifndef PMS5003_PARSER_H
+#define PMS5003_PARSER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// PMS5003 frame: 0x42 0x4D, frame length (28), 13 data words, checksum
+#define PMS5003_START1          0x42
+#define PMS5003_START2          0x4D
+#define PMS5003_FRAME_LEN       28
+#define PMS5003_FRAME_SIZE      (4 + PMS5003_FRAME_LEN)
+
+// One validated PMS5003 frame
+typedef struct {
+    uint16_t pm1_0_standard, pm2_5_standard, pm10_standard;
+    uint16_t pm1_0_env, pm2_5_env, pm10_env;
+    uint16_t particles_03um, particles_05um, particles_10um;
+    uint16_t particles_25um, particles_50um, particles_100um;
+} pms5003_frame_t;
+
+// Byte-stream parser state.  It holds no more than one frame, so any
+// amount of garbage is skipped one byte at a time without rescanning.
+typedef struct {
+    uint8_t state;
+    uint8_t pos;                // bytes of the frame after the start bytes
+    uint8_t buf[PMS5003_FRAME_SIZE - 2];
+    uint16_t sum;
+    bool in_sync;               // the last frame was good
+    // counters
+    uint32_t frames;            // valid frames
+    uint32_t checksum_errors;   // frames with a bad checksum
+    uint32_t length_errors;     // frames with a bad frame length
+    uint32_t resyncs;           // times the stream was lost and searched for
+    uint32_t discarded;         // bytes skipped while searching
+} pms5003_parser_t;
+
+void pms5003_parser_init(pms5003_parser_t *parser);
+
+// Start searching for a frame again, eg. after the UART lost bytes
+void pms5003_parser_resync(pms5003_parser_t *parser);
+
+// Feed one received byte.  Returns true when it completes a valid frame,
+// which is then copied to *frame.
+bool pms5003_parser_feed(pms5003_parser_t *parser, uint8_t byte,
+                         pms5003_frame_t *frame);
+
+#endif // PMS5003_PARSER_H
@@ -0,0 +1,168 @@
+/*
+ * PMS5003 stream simulator
+ *
+ * Plain C with no ESP-IDF dependencies.  Each frame is encoded as the
+ * sensor sends it, then damaged as configured.
+ */
+#include <string.h>
+#include "pms5003_sim.h"
+
+void pms5003_sim_init(pms5003_sim_t *sim, const pms5003_sim_config_t *config,
+                      uint32_t seed)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->config = *config;
+    // xorshift has to start from a non-zero state
+    sim->rng = seed ? seed : 1;
+}
+
+// xorshift32
+static uint32_t pms5003_sim_random(pms5003_sim_t *sim)
+{
+    uint32_t x = sim->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim->rng = x;
+
+    return x;
+}
+
+static bool pms5003_sim_chance(pms5003_sim_t *sim, uint16_t permille)
+{
+    return (permille > 0) && ((pms5003_sim_random(sim) % 1000) < permille);
+}
+
+// value +-spread, never below zero
+static uint16_t pms5003_sim_noisy(pms5003_sim_t *sim, uint32_t value,
+                                  uint32_t spread)
+{
+    int32_t noisy = (int32_t)value;
+
+    if (spread > 0) {
+        noisy += (int32_t)(pms5003_sim_random(sim) % (2 * spread + 1)) -
+                 (int32_t)spread;
+    }
+    if (noisy < 0) {
+        noisy = 0;
+    } else if (noisy > UINT16_MAX) {
+        noisy = UINT16_MAX;
+    }
+
+    return (uint16_t)noisy;
+}
+
+// Readings around the configured PM2.5, in the proportions of indoor air
+static void pms5003_sim_readings(pms5003_sim_t *sim, pms5003_frame_t *frame)
+{
+    uint32_t pm2_5 = pms5003_sim_noisy(sim, sim->config.pm2_5,
+                                       sim->config.noise);
+    uint32_t count = 200 + 100 * pm2_5;
+    uint32_t env_permille = 1000;
+
+    frame->pm2_5_standard = (uint16_t)pm2_5;
+    frame->pm1_0_standard = pms5003_sim_noisy(sim, pm2_5 * 7 / 10,
+                                              sim->config.noise / 2);
+    frame->pm10_standard = pms5003_sim_noisy(sim, pm2_5 * 6 / 5,
+                                             sim->config.noise);
+    // the two calibrations only part above some 30 ug/m3, where the
+    // atmospheric values rise at two thirds of the rate
+    if (pm2_5 > 30) {
+        env_permille = (30 + (pm2_5 - 30) * 2 / 3) * 1000 / pm2_5;
+    }
+    frame->pm1_0_env = (uint16_t)(frame->pm1_0_standard * env_permille / 1000);
+    frame->pm2_5_env = (uint16_t)(frame->pm2_5_standard * env_permille / 1000);
+    frame->pm10_env = (uint16_t)(frame->pm10_standard * env_permille / 1000);
+    frame->particles_03um = pms5003_sim_noisy(sim, count, count / 20);
+    frame->particles_05um = pms5003_sim_noisy(sim, count / 3, count / 60);
+    frame->particles_10um = pms5003_sim_noisy(sim, count / 12, count / 240);
+    frame->particles_25um = pms5003_sim_noisy(sim, count / 72, 2);
+    frame->particles_50um = pms5003_sim_noisy(sim, count / 288, 1);
+    frame->particles_100um = pms5003_sim_noisy(sim, count / 864, 1);
+}
+
+static size_t pms5003_sim_word(uint8_t *buf, size_t pos, uint16_t word)
+{
+    buf[pos++] = (uint8_t)(word >> 8);
+    buf[pos++] = (uint8_t)(word & 0xFF);
+
+    return pos;
+}
+
+// The frame as the sensor sends it
+static void pms5003_sim_encode(const pms5003_frame_t *frame,
+                               uint8_t buf[PMS5003_FRAME_SIZE])
+{
+    uint16_t sum = 0;
+    size_t pos = 0;
+    size_t i = 0;
+
+    buf[pos++] = PMS5003_START1;
+    buf[pos++] = PMS5003_START2;
+    pos = pms5003_sim_word(buf, pos, PMS5003_FRAME_LEN);
+    pos = pms5003_sim_word(buf, pos, frame->pm1_0_standard);
+    pos = pms5003_sim_word(buf, pos, frame->pm2_5_standard);
+    pos = pms5003_sim_word(buf, pos, frame->pm10_standard);
+    pos = pms5003_sim_word(buf, pos, frame->pm1_0_env);
+    pos = pms5003_sim_word(buf, pos, frame->pm2_5_env);
+    pos = pms5003_sim_word(buf, pos, frame->pm10_env);
+    pos = pms5003_sim_word(buf, pos, frame->particles_03um);
+    pos = pms5003_sim_word(buf, pos, frame->particles_05um);
+    pos = pms5003_sim_word(buf, pos, frame->particles_10um);
+    pos = pms5003_sim_word(buf, pos, frame->particles_25um);
+    pos = pms5003_sim_word(buf, pos, frame->particles_50um);
+    pos = pms5003_sim_word(buf, pos, frame->particles_100um);
+    // reserved word
+    pos = pms5003_sim_word(buf, pos, 0);
+    for (i = 0; i < pos; i++) {
+        sum += buf[i];
+    }
+    pms5003_sim_word(buf, pos, sum);
+}
+
+size_t pms5003_sim_next(pms5003_sim_t *sim, uint8_t *buf, size_t *split,
+                        pms5003_frame_t *frame)
+{
+    pms5003_frame_t readings;
+    uint8_t clean[PMS5003_FRAME_SIZE];
+    size_t drop = PMS5003_FRAME_SIZE;
+    size_t dup = PMS5003_FRAME_SIZE;
+    size_t length = 0;
+    size_t i = 0;
+
+    pms5003_sim_readings(sim, &readings);
+    pms5003_sim_encode(&readings, clean);
+    sim->frames++;
+    if (pms5003_sim_chance(sim, sim->config.corrupt_permille)) {
+        clean[PMS5003_FRAME_SIZE - 1] ^= 0x01;
+        sim->corrupted++;
+    }
+    if (pms5003_sim_chance(sim, sim->config.drop_permille)) {
+        drop = pms5003_sim_random(sim) % PMS5003_FRAME_SIZE;
+        sim->dropped++;
+    }
+    if (pms5003_sim_chance(sim, sim->config.dup_permille)) {
+        dup = pms5003_sim_random(sim) % PMS5003_FRAME_SIZE;
+        sim->duplicated++;
+    }
+    for (i = 0; i < PMS5003_FRAME_SIZE; i++) {
+        if (i == drop) {
+            continue;
+        }
+        buf[length++] = clean[i];
+        if (i == dup) {
+            buf[length++] = clean[i];
+        }
+    }
+    *split = 0;
+    if (pms5003_sim_chance(sim, sim->config.stall_permille)) {
+        *split = 1 + (pms5003_sim_random(sim) % (length - 1));
+        sim->stalled++;
+    }
+    if (frame != NULL) {
+        *frame = readings;
+    }
+
+    return length;
+}
@@ -0,0 +1,48 @@
+#ifndef PMS5003_SIM_H
+#define PMS5003_SIM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "pms5003_parser.h"
+
+// Synthetic PMS5003 byte stream, as the UART would deliver it: readings
+// around a configured level, and on request the faults a real link
+// shows.  Plain C with no ESP-IDF dependencies; the same seed gives the
+// same stream.
+
+// Longest output of one frame: every byte sent twice
+#define PMS5003_SIM_MAX_BYTES   (2 * PMS5003_FRAME_SIZE)
+
+typedef struct {
+    uint16_t pm2_5;             // mean PM2.5, ug/m3; the rest follow it
+    uint16_t noise;             // readings spread +-noise around the mean
+    // chance of each fault, per 1000 frames
+    uint16_t drop_permille;     // one byte of the frame is lost
+    uint16_t dup_permille;      // one byte is received twice
+    uint16_t corrupt_permille;  // the checksum is wrong
+    uint16_t stall_permille;    // the frame arrives in two chunks
+} pms5003_sim_config_t;
+
+typedef struct {
+    pms5003_sim_config_t config;
+    uint32_t rng;
+    // what was sent, to compare with what the parser reports
+    uint32_t frames;            // frames generated, good or not
+    uint32_t dropped;
+    uint32_t duplicated;
+    uint32_t corrupted;
+    uint32_t stalled;
+} pms5003_sim_t;
+
+void pms5003_sim_init(pms5003_sim_t *sim, const pms5003_sim_config_t *config,
+                      uint32_t seed);
+
+// Write the bytes of the next frame to buf, which must hold
+// PMS5003_SIM_MAX_BYTES, and return how many there are.  *split is where
+// a stalled frame pauses, or 0 if it arrives in one piece.  *frame, if
+// not NULL, is set to the readings that were encoded.
+size_t pms5003_sim_next(pms5003_sim_t *sim, uint8_t *buf, size_t *split,
+                        pms5003_frame_t *frame);
+
+#endif // PMS5003_SIM_H
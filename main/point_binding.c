@@ -0,0 +1,272 @@
+/*
+ * Point bindings: which data source feeds which BACnet object
+ *
+ * Sources push into the objects' Present_Value when they have new data,
+ * so reading a property is a plain field load and COV detection runs
+ * once per update rather than once per read.
+ */
+#include <stddef.h>
+#include <stdio.h>
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "av.h"
+#include "bi.h"
+#include "pm25_sensor.h"
+#include "point_binding.h"
+
+static const char *TAG = "point_binding";
+
+#define SENSOR_POINT(instance, object_name, unit, increment, pm_channel) \
+    { .object_type = OBJECT_ANALOG_VALUE, .object_instance = (instance), \
+      .name = (object_name), .units = (unit), \
+      .cov_increment = (increment), .source = POINT_SOURCE_SENSOR, \
+      .from.pm = { .sensor = 0, .channel = (pm_channel) } }
+
+// Instances must match main.c.  PMS5003 counts are whole numbers; the
+// particle counts move in the tens even in clean air.  The points of
+// further sensors are made from the first sensor's at start-up.
+static const point_binding_t point_defaults[] = {
+    SENSOR_POINT(0, "PM1.0 Concentration", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM1_0),
+    SENSOR_POINT(1, "PM2.5 Concentration", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM2_5),
+    SENSOR_POINT(2, "PM10 Concentration", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM10),
+    {
+        .object_type = OBJECT_ANALOG_VALUE,
+        .object_instance = 3,
+        .name = "PM2.5_SETPOINT",
+        .units = UNITS_MICROGRAMS_PER_CUBIC_METER,
+        // written by operators, so every change is reported
+        .cov_increment = 0.1f,
+        .source = POINT_SOURCE_STORED,
+        .from.initial = 25.0f,
+    },
+    SENSOR_POINT(4, "PM1.0 Atmospheric", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM1_0_ENV),
+    SENSOR_POINT(5, "PM2.5 Atmospheric", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM2_5_ENV),
+    SENSOR_POINT(6, "PM10 Atmospheric", UNITS_MICROGRAMS_PER_CUBIC_METER,
+                 1.0f, PM25_CHANNEL_PM10_ENV),
+    // particles per 0.1 L of air, which has no BACnet unit
+    SENSOR_POINT(7, "Particles >0.3um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_03UM),
+    SENSOR_POINT(8, "Particles >0.5um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_05UM),
+    SENSOR_POINT(9, "Particles >1.0um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_10UM),
+    SENSOR_POINT(10, "Particles >2.5um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_25UM),
+    SENSOR_POINT(11, "Particles >5.0um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_50UM),
+    SENSOR_POINT(12, "Particles >10um per 0.1L", UNITS_NO_UNITS,
+                 10.0f, PM25_CHANNEL_PARTICLES_100UM),
+    {
+        // FAN_STATUS: the TTGO button, pressed pulls the pin low
+        .object_type = OBJECT_BINARY_INPUT,
+        .object_instance = 0,
+        .source = POINT_SOURCE_GPIO,
+        .from.gpio = { .pin = 35, .active_low = true },
+    },
+};
+
+#define POINT_DEFAULT_COUNT (sizeof(point_defaults) / sizeof(point_defaults[0]))
+
+// Further sensors take PM25_CHANNEL_COUNT instances each, in channel
+// order, after the instances above
+#define POINT_SENSOR_INSTANCE_BASE  13
+#define POINT_BINDING_MAX \
+    (POINT_DEFAULT_COUNT + (PM25_SENSOR_COUNT - 1) * PM25_CHANNEL_COUNT)
+#define POINT_NAME_SIZE             32
+
+// av.c keeps the first ANALOG_VALUES_FIXED instances for these points
+_Static_assert(ANALOG_VALUES_FIXED == 1 + PM25_SENSOR_COUNT * PM25_CHANNEL_COUNT,
+               "ANALOG_VALUES_FIXED (av.h) does not match the sensor channels");
+
+static point_binding_t point_bindings[POINT_BINDING_MAX];
+static unsigned point_binding_count = 0;
+#if PM25_SENSOR_COUNT > 1
+static char point_names[PM25_SENSOR_COUNT - 1][PM25_CHANNEL_COUNT][POINT_NAME_SIZE];
+#endif
+
+// Copy the first sensor's points for the others, with their own
+// instances and names
+static void point_binding_build(void)
+{
+    unsigned i = 0;
+
+    point_binding_count = 0;
+    for (i = 0; i < POINT_DEFAULT_COUNT; i++) {
+        point_bindings[point_binding_count++] = point_defaults[i];
+    }
+#if PM25_SENSOR_COUNT > 1
+    unsigned sensor = 0;
+    unsigned channel = 0;
+
+    for (sensor = 1; sensor < PM25_SENSOR_COUNT; sensor++) {
+        for (i = 0; i < POINT_DEFAULT_COUNT; i++) {
+            point_binding_t *binding = &point_bindings[point_binding_count];
+            char *name = NULL;
+
+            if (point_defaults[i].source != POINT_SOURCE_SENSOR) {
+                continue;
+            }
+            channel = point_defaults[i].from.pm.channel;
+            name = point_names[sensor - 1][channel];
+            *binding = point_defaults[i];
+            binding->object_instance = POINT_SENSOR_INSTANCE_BASE +
+                (sensor - 1) * PM25_CHANNEL_COUNT + channel;
+            binding->from.pm.sensor = sensor;
+            snprintf(name, POINT_NAME_SIZE, "%s #%u",
+                     point_defaults[i].name, sensor + 1);
+            binding->name = name;
+            point_binding_count++;
+        }
+    }
+#endif
+}
+
+// Give a filtered sensor point the filter parameters the sensor uses
+static void point_binding_filter_sync(const point_binding_t *binding)
+{
+    pm_filter_config_t config;
+
+    if (pm25_get_filter(binding->from.pm.sensor, binding->from.pm.channel,
+                        &config)) {
+        Analog_Value_Filter_Set(binding->object_instance,
+                                config.median_window, config.ema_alpha,
+                                config.mean_window);
+    }
+}
+
+// Hand filter parameters written over BACnet to the sensor
+static void point_binding_filter_apply(const point_binding_t *binding)
+{
+    pm_filter_config_t config;
+    unsigned median_window = 0;
+    unsigned mean_window = 0;
+    float ema_alpha = 0.0f;
+
+    if (!Analog_Value_Filter_Pending(binding->object_instance, &median_window,
+                                     &ema_alpha, &mean_window)) {
+        return;
+    }
+    config.median_window = (uint8_t)median_window;
+    config.mean_window = (uint8_t)mean_window;
+    config.ema_alpha = ema_alpha;
+    if (!pm25_set_filter(binding->from.pm.sensor, binding->from.pm.channel,
+                         &config)) {
+        ESP_LOGW(TAG, "AV %lu: filter parameters rejected",
+                 (unsigned long)binding->object_instance);
+    }
+    // either way, show what the sensor is using
+    point_binding_filter_sync(binding);
+}
+
+static void point_binding_gpio_init(const point_binding_t *binding)
+{
+    gpio_config_t io_conf = {
+        .pin_bit_mask = (1ULL << binding->from.gpio.pin),
+        .mode = GPIO_MODE_INPUT,
+        // GPIO 34-39 have no pulls; the boards have external ones
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+
+    gpio_config(&io_conf);
+    ESP_LOGI(TAG, "GPIO %d configured as input", binding->from.gpio.pin);
+}
+
+static bool point_binding_gpio_active(const point_binding_t *binding)
+{
+    int level = gpio_get_level(binding->from.gpio.pin);
+
+    return binding->from.gpio.active_low ? (level == 0) : (level != 0);
+}
+
+void point_binding_init(void)
+{
+    const point_binding_t *binding = NULL;
+    unsigned i = 0;
+
+    point_binding_build();
+    for (i = 0; i < point_binding_count; i++) {
+        binding = &point_bindings[i];
+        if (binding->object_type == OBJECT_ANALOG_VALUE) {
+            Analog_Value_Name_Set(binding->object_instance,
+                                  (char *)binding->name);
+            Analog_Value_Units_Set(binding->object_instance, binding->units);
+            Analog_Value_COV_Increment_Set(binding->object_instance,
+                                           binding->cov_increment);
+        }
+        switch (binding->source) {
+        case POINT_SOURCE_STORED:
+            if (binding->object_type == OBJECT_ANALOG_VALUE) {
+                Analog_Value_Present_Value_Set(binding->object_instance,
+                                               binding->from.initial, 16);
+            }
+            break;
+        case POINT_SOURCE_SENSOR:
+            Analog_Value_Bind(binding->object_instance, true);
+            point_binding_filter_sync(binding);
+            break;
+        case POINT_SOURCE_GPIO:
+            point_binding_gpio_init(binding);
+            Binary_Input_Source_Update(binding->object_instance,
+                                       point_binding_gpio_active(binding));
+            break;
+        case POINT_SOURCE_COMPUTED:
+            Analog_Value_Bind(binding->object_instance, true);
+            break;
+        default:
+            break;
+        }
+    }
+    ESP_LOGI(TAG, "%u points bound, %u sensor(s)", point_binding_count,
+             (unsigned)PM25_SENSOR_COUNT);
+}
+
+void point_binding_task(void)
+{
+    static uint32_t last_sequence[PM25_SENSOR_COUNT];
+    const point_binding_t *binding = NULL;
+    pm25_snapshot_t snapshot[PM25_SENSOR_COUNT];
+    bool new_frame[PM25_SENSOR_COUNT];
+    unsigned sensor = 0;
+    float value = 0.0f;
+    unsigned i = 0;
+
+    // one copy per sensor and pass serves all of its points
+    for (sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+        pm25_get_snapshot(sensor, &snapshot[sensor]);
+        new_frame[sensor] = (snapshot[sensor].time_us != 0) &&
+            (snapshot[sensor].sequence != last_sequence[sensor]);
+        last_sequence[sensor] = snapshot[sensor].sequence;
+    }
+    for (i = 0; i < point_binding_count; i++) {
+        binding = &point_bindings[i];
+        switch (binding->source) {
+        case POINT_SOURCE_SENSOR:
+            sensor = binding->from.pm.sensor;
+            point_binding_filter_apply(binding);
+            if (new_frame[sensor]) {
+                Analog_Value_Source_Update(binding->object_instance,
+                    pm25_snapshot_value(&snapshot[sensor], binding->from.pm.channel),
+                    pm25_snapshot_raw(&snapshot[sensor], binding->from.pm.channel));
+            }
+            break;
+        case POINT_SOURCE_GPIO:
+            // the object reports only a change of state
+            Binary_Input_Source_Update(binding->object_instance,
+                                       point_binding_gpio_active(binding));
+            break;
+        case POINT_SOURCE_COMPUTED:
+            value = binding->from.compute();
+            Analog_Value_Source_Update(binding->object_instance, value, value);
+            break;
+        default:
+            break;
+        }
+    }
+}
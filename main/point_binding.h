@@ -0,0 +1,56 @@
+#ifndef POINT_BINDING_H
+#define POINT_BINDING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "bacenum.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Where the Present_Value of a BACnet object comes from
+typedef enum {
+    POINT_SOURCE_STORED = 0,    // written over BACnet, kept by the object
+    POINT_SOURCE_SENSOR,        // a PM sensor channel, pushed on each frame
+    POINT_SOURCE_GPIO,          // an input pin, polled
+    POINT_SOURCE_COMPUTED       // a function, evaluated on each pass
+} point_source_t;
+
+// One object and its data source.  Name, units and COV increment apply
+// to Analog Values; a Binary Input keeps its own.
+typedef struct {
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    const char *name;
+    uint16_t units;
+    float cov_increment;
+    point_source_t source;
+    union {
+        float initial;              // POINT_SOURCE_STORED
+        struct {
+            unsigned sensor;
+            unsigned channel;       // a pm25_channel_t
+        } pm;                       // POINT_SOURCE_SENSOR
+        struct {
+            int pin;
+            bool active_low;
+        } gpio;                     // POINT_SOURCE_GPIO
+        float (*compute)(void);     // POINT_SOURCE_COMPUTED
+    } from;
+} point_binding_t;
+
+// Name the objects, set up their sources and bind them.  Call after the
+// PM sensor is initialized and after Device_Init(), which runs the Init
+// of every object and would undo all of it.
+void point_binding_init(void);
+
+// Push what changed into the bound objects, which run their COV
+// detection.  Call on every pass of the BACnet task.
+void point_binding_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* POINT_BINDING_H */
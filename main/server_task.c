@@ -8,6 +8,7 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 
@@ -19,134 +20,107 @@
 #include "handlers.h"
 #include "address.h"
 #include "apdu.h"
+#include "tsm.h"
 #include "txbuf.h"
 
-/* Include object headers for control logic */
 #include "av.h"
-#include "bo.h"
-#include "bv.h"
 #include "pm25_sensor.h"
+#include "point_binding.h"
+#include "server_task.h"
 
 static const char *TAG = "SERVER_TASK";
 
 /** Buffer used for receiving */
 static uint8_t rx_buffer[MAX_MPDU] = { 0 };
 
-/** Sensor monitoring variables */
-static uint32_t last_sensor_update_time = 0;
-static bool sensor_has_data = false;
-static const uint32_t SENSOR_TIMEOUT_MS = 30000;  // 30 seconds timeout
+/** Held while the BACnet objects or the stack are in use */
+static SemaphoreHandle_t objects_mutex = NULL;
 
 /** Object instance definitions (must match main.c) */
+#define PM1_0_OBJECT_INSTANCE           0
 #define PM2_5_OBJECT_INSTANCE           1
+#define PM10_OBJECT_INSTANCE            2
 #define PM2_5_SETPOINT_OBJECT_INSTANCE  3
-#define FAN_COMMAND_OBJECT_INSTANCE     0
-#define SENSOR_ERROR_OBJECT_INSTANCE    0
+
+void server_task_init(void)
+{
+    objects_mutex = xSemaphoreCreateMutex();
+}
+
+/* a mutex, so a higher priority task waiting for it lends the server
+   its priority until the server lets go */
+void server_objects_lock(void)
+{
+    xSemaphoreTake(objects_mutex, portMAX_DELAY);
+}
+
+void server_objects_unlock(void)
+{
+    xSemaphoreGive(objects_mutex);
+}
 
 /**
- * @brief Check sensor data and control fan based on PM2.5 levels
+ * @brief Log the confirmed COV delivery counters when they have moved
  */
-static void check_sensor_and_control_fan(void)
+static void log_cov_delivery(void)
 {
-    float pm25_value = 0.0;
-    float setpoint_value = 25.0;  // Default fallback
-    BACNET_BINARY_PV current_fan_state;
-    bool sensor_error = false;
-    
-    /* Get current PM2.5 value */
-    if (Analog_Value_Valid_Instance(PM2_5_OBJECT_INSTANCE)) {
-        pm25_value = Analog_Value_Present_Value(PM2_5_OBJECT_INSTANCE);
-       // ESP_LOGI(TAG, "DEBUG: PM2.5 reading: %.1f", pm25_value);
-        
-        /* Update last sensor data time */
-        last_sensor_update_time = (uint32_t)(esp_timer_get_time() / 1000);
-        sensor_has_data = true;
-    } else {
-       // ESP_LOGW(TAG, "PM2.5 object instance %d not valid", PM2_5_OBJECT_INSTANCE);
-    }
-    
-    /* Get PM2.5 setpoint */
-    if (Analog_Value_Valid_Instance(PM2_5_SETPOINT_OBJECT_INSTANCE)) {
-        setpoint_value = Analog_Value_Present_Value(PM2_5_SETPOINT_OBJECT_INSTANCE);
-      //  ESP_LOGI(TAG, "DEBUG: PM2.5 setpoint: %.1f (instance %d)", setpoint_value, PM2_5_SETPOINT_OBJECT_INSTANCE);
-    } else {
-        ESP_LOGW(TAG, "PM2.5 setpoint object instance %d not valid", PM2_5_SETPOINT_OBJECT_INSTANCE);
-    }
-    
-   // ESP_LOGI(TAG, "DEBUG: Comparison: PM2.5=%.1f, Setpoint=%.1f, Difference=%.1f", 
-   //          pm25_value, setpoint_value, pm25_value - setpoint_value);
-    
-    /* Check sensor data freshness */
-    if (sensor_has_data) {
-        uint32_t current_time = (uint32_t)(esp_timer_get_time() / 1000);
-        uint32_t time_since_update = current_time - last_sensor_update_time;
-        
-        if (time_since_update > SENSOR_TIMEOUT_MS) {
-            ESP_LOGW(TAG, "Sensor data stale: %lu ms since last update", time_since_update);
-            sensor_error = true;
-        } else {
-            sensor_error = false;
-        }
-    } else {
-        /* No sensor data ever received */
-        sensor_error = true;
-        ESP_LOGW(TAG, "No sensor data received yet");
-    }
-    
-    /* Control fan based on PM2.5 vs setpoint */
-    if (Binary_Output_Valid_Instance(FAN_COMMAND_OBJECT_INSTANCE)) {
-        current_fan_state = Binary_Output_Present_Value(FAN_COMMAND_OBJECT_INSTANCE);
-        
-        // Use a small tolerance for floating point comparison
-        if (pm25_value > (setpoint_value + 0.1f)) {  // Added 0.1 tolerance
-            /* PM2.5 is above setpoint - turn fan ON */
-            if (current_fan_state != BINARY_ACTIVE) {
-                ESP_LOGI(TAG, "ACTION: PM2.5 (%.1f) > Setpoint (%.1f) - Turning fan ON", 
-                        pm25_value, setpoint_value);
-                Binary_Output_Present_Value_Set(FAN_COMMAND_OBJECT_INSTANCE, BINARY_ACTIVE, 16);
-            } else {
-                ESP_LOGI(TAG, "Fan already ON (PM2.5=%.1f, Setpoint=%.1f)", 
-                        pm25_value, setpoint_value);
-            }
-        } else {
-            /* PM2.5 is at or below setpoint - turn fan OFF */
-            if (current_fan_state != BINARY_INACTIVE) {
-                ESP_LOGI(TAG, "ACTION: PM2.5 (%.1f) <= Setpoint (%.1f) - Turning fan OFF", 
-                        pm25_value, setpoint_value);
-                Binary_Output_Present_Value_Set(FAN_COMMAND_OBJECT_INSTANCE, BINARY_INACTIVE, 16);
-            } else {
-            //    ESP_LOGI(TAG, "Fan already OFF (PM2.5=%.1f, Setpoint=%.1f)", 
-            //            pm25_value, setpoint_value);
-            }
-        }
-    } else {
-        ESP_LOGW(TAG, "FAN_COMMAND_OBJECT_INSTANCE %d not valid", FAN_COMMAND_OBJECT_INSTANCE);
-    }
-    
-    /* Set sensor error state */
-    if (Binary_Value_Valid_Instance(SENSOR_ERROR_OBJECT_INSTANCE)) {
-        BACNET_BINARY_PV current_error_state = Binary_Value_Present_Value(SENSOR_ERROR_OBJECT_INSTANCE);
-        BACNET_BINARY_PV desired_error_state = sensor_error ? BINARY_ACTIVE : BINARY_INACTIVE;
-        
-        if (current_error_state != desired_error_state) {
-            ESP_LOGI(TAG, "Sensor error state: %s", sensor_error ? "ERROR" : "OK");
-            Binary_Value_Present_Value_Set(SENSOR_ERROR_OBJECT_INSTANCE, desired_error_state);
-        }
-    } else {
-        ESP_LOGW(TAG, "SENSOR_ERROR_OBJECT_INSTANCE %d not valid", SENSOR_ERROR_OBJECT_INSTANCE);
+    static uint32_t last_retries = 0;
+    static uint32_t last_collapsed = 0;
+    static uint32_t last_failures = 0;
+    uint32_t retries = 0;
+    uint32_t collapsed = 0;
+    uint32_t failures = 0;
+
+    handler_cov_delivery_counters(&retries, &collapsed, &failures);
+    if ((retries != last_retries) || (collapsed != last_collapsed) ||
+        (failures != last_failures)) {
+        ESP_LOGI(TAG, "COV delivery: retries=%lu, collapsed=%lu, failures=%lu",
+            (unsigned long)retries, (unsigned long)collapsed,
+            (unsigned long)failures);
+        last_retries = retries;
+        last_collapsed = collapsed;
+        last_failures = failures;
     }
 }
 
 /**
- * @brief Initialize sensor monitoring
- * 
- * Call this once at startup to initialize monitoring variables
+ * @brief Drive the COV lifetime and TSM retry timers, then service COV
+ *
+ * Called on every pass of the server loop.  Lifetimes tick in whole
+ * seconds; the remainder is carried so no time is lost between calls.
  */
-static void init_sensor_monitoring(void)
+static void service_cov_and_timers(void)
 {
-    last_sensor_update_time = (uint32_t)(esp_timer_get_time() / 1000);
-    sensor_has_data = false;
-    ESP_LOGI(TAG, "Sensor monitoring initialized");
+    static uint32_t last_seconds_time = 0;
+    static uint32_t last_tsm_time = 0;
+    uint32_t current_time = (uint32_t)(esp_timer_get_time() / 1000);
+    uint32_t elapsed_ms = 0;
+    uint32_t elapsed_seconds = 0;
+
+    if (last_tsm_time == 0) {
+        last_tsm_time = current_time;
+        last_seconds_time = current_time;
+    }
+
+    /* confirmed COV notification retries and timeouts */
+    elapsed_ms = current_time - last_tsm_time;
+    if (elapsed_ms) {
+        if (elapsed_ms > UINT16_MAX) {
+            elapsed_ms = UINT16_MAX;
+        }
+        tsm_timer_milliseconds((uint16_t)elapsed_ms);
+        last_tsm_time = current_time;
+    }
+
+    /* COV subscription lifetimes */
+    elapsed_seconds = (current_time - last_seconds_time) / 1000;
+    if (elapsed_seconds) {
+        handler_cov_timer_seconds(elapsed_seconds);
+        last_seconds_time += elapsed_seconds * 1000;
+    }
+
+    /* send notifications for any subscribed object that changed */
+    handler_cov_task();
 }
 
 void server_task(void *arg)
@@ -154,13 +128,11 @@ void server_task(void *arg)
     BACNET_ADDRESS src = { 0 }; 
     uint16_t pdu_len = 0;
     uint32_t last_check_time = 0;
-    const uint32_t CHECK_INTERVAL_MS = 5000;  // Check every 5 seconds
+    const uint32_t CHECK_INTERVAL_MS = 5000;  // Log every 5 seconds
+    uint32_t sensor_time = 0;
     
     ESP_LOGI(TAG, "BACnet server task started");
     
-    /* Initialize sensor monitoring */
-    init_sensor_monitoring();
-    
     /* Get initial time */
     last_check_time = (uint32_t)(esp_timer_get_time() / 1000);
 
@@ -170,18 +142,30 @@ void server_task(void *arg)
         /* Receive BACnet packet with 100ms timeout (reduced from 5 seconds) */
         pdu_len = datalink_receive(&src, &rx_buffer[0], MAX_MPDU, 100);
 
+        /* the lock is taken per step, never while waiting for a packet,
+           so the control task gets in between steps */
         if (pdu_len) {
             /* Process the received packet */
+            server_objects_lock();
             npdu_handler(&src, &rx_buffer[0], pdu_len);
+            server_objects_unlock();
         }
+
+        /* sensor and input values into the objects, marking COV changes */
+        server_objects_lock();
+        point_binding_task();
+        server_objects_unlock();
+        server_objects_lock();
+        service_cov_and_timers();
+        server_objects_unlock();
         
-        /* Check sensor and control fan periodically */
+        /* Log the counters periodically; fan control is control_task.c */
         if ((current_time - last_check_time) >= CHECK_INTERVAL_MS) {
-            check_sensor_and_control_fan();
+            log_cov_delivery();
             last_check_time = current_time;
             
             /* Log current states for debugging */
-            if (sensor_has_data) {
+            if (pm25_get_last_update_ms(0, &sensor_time)) {
                 float pm25 = 0.0;
                 float setpoint = 0.0;
                 
@@ -195,6 +179,16 @@ void server_task(void *arg)
                 
                 ESP_LOGD(TAG, "Monitoring: PM2.5=%.1f, Setpoint=%.1f", pm25, setpoint);
             }
+            
+            for (unsigned sensor = 0; sensor < PM25_SENSOR_COUNT; sensor++) {
+                pm25_stats_t stats;
+                pm25_get_stats(sensor, &stats);
+                ESP_LOGD(TAG, "PMS5003 #%u: frames=%lu, checksum errors=%lu, resyncs=%lu, "
+                         "overflows=%lu, line errors=%lu", sensor + 1,
+                         (unsigned long)stats.frames, (unsigned long)stats.checksum_errors,
+                         (unsigned long)stats.resyncs, (unsigned long)stats.overflows,
+                         (unsigned long)stats.line_errors);
+            }
         }
         
         /* Small delay to prevent watchdog */
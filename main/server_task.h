@@ -5,8 +5,17 @@
 extern "C" {
 #endif
 
+// Create the lock below; call before starting any task that takes it
+void server_task_init(void);
 void server_task(void *arg);
 
+// Exclusive use of the BACnet objects and the stack.  The server task
+// holds it for one step at a time, a packet or a pass over the points,
+// never while it waits for a packet.  Other tasks hold it only around
+// object access.
+void server_objects_lock(void);
+void server_objects_unlock(void);
+
 #ifdef __cplusplus
 }
 #endif